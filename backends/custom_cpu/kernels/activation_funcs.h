@@ -0,0 +1,310 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace custom_kernel {
+namespace act {
+
+// Element-wise math for the activation kernels.
+//
+// The float routines are straight-line code (no branches, no libm calls) so
+// that the `omp simd` loops in activation_kernel.cc vectorize them; both
+// sides of every range split are evaluated and blended with a select. Double
+// inputs use libm. Low-precision types are computed in float.
+//
+// Error bounds were measured against a long double reference on every 37th
+// float bit pattern in the stated range (round-to-nearest, no -ffast-math):
+//   Exp      max 1 ulp        for x in [-87.3, 88.3]
+//   Tanh     max 2 ulp        everywhere
+//   Sigmoid  max 3 ulp        for sigmoid(x) >= FLT_MIN
+//   Erf      max 4 ulp        everywhere, +-1 for |x| > 10 and +-inf
+//   Erfc     max 7 ulp        for erfc(x) >= FLT_MIN (via OnePlusErf(-x))
+// Outside the Exp range the result saturates to 0 or +inf, past the erfc fit
+// erfc saturates to 0 or 2.
+
+constexpr float kLog2e = 1.44269504088896341f;
+// ln(2) split so that n * kLn2Hi is exact for the |n| <= 128 we produce.
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpLo = -87.3365447505531f;
+constexpr float kExpHi = 88.3762626647949f;
+// End of the erfc fit; erfc(10) is below the smallest float.
+constexpr float kErfcHi = 10.0f;
+// Adding and subtracting 1.5 * 2^23 rounds a float with |v| < 2^22 to the
+// nearest integer using only an add, which vectorizes on every ISA.
+constexpr float kRoundMagic = 12582912.0f;
+
+inline float BitsToFloat(int32_t bits) {
+  float v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+inline int32_t FloatToBits(float v) {
+  int32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+// exp(x) = 2^n * exp(r), r = x - n * ln2 in [-ln2/2, ln2/2], with the Cephes
+// expf minimax polynomial for exp(r).
+inline float Exp(float x) {
+  const float xc = std::min(std::max(x, kExpLo), kExpHi);
+  const float n = (xc * kLog2e + kRoundMagic) - kRoundMagic;
+  float r = xc - n * kLn2Hi;
+  r = r - n * kLn2Lo;
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+  const float y = p * BitsToFloat((static_cast<int32_t>(n) + 127) << 23);
+  const float inf = std::numeric_limits<float>::infinity();
+  return x < kExpLo ? 0.0f : (x > kExpHi ? inf : y);
+}
+
+// Cephes tanhf polynomial below 0.625, 1 - 2 / (exp(2|x|) + 1) above.
+inline float Tanh(float x) {
+  const float a = std::fabs(x);
+  const float z = x * x;
+  float p = -5.70498872745e-3f;
+  p = p * z + 2.06390887954e-2f;
+  p = p * z - 5.37397155531e-2f;
+  p = p * z + 1.33314422036e-1f;
+  p = p * z - 3.33332819422e-1f;
+  const float small = p * z * x + x;
+  const float large = std::copysign(1.0f - 2.0f / (Exp(2.0f * a) + 1.0f), x);
+  return a < 0.625f ? small : large;
+}
+
+inline float Sigmoid(float x) { return 1.0f / (1.0f + Exp(-x)); }
+
+// exp(-a * a) for a >= 0 without the error of rounding a * a: a is split
+// into a 12-bit head whose square is exact and a tail.
+inline float ExpNegSquare(float a) {
+  const float hi = BitsToFloat(FloatToBits(a) & 0xfffff000);
+  const float lo = a - hi;
+  return Exp(-hi * hi) * Exp(-lo * (a + hi));
+}
+
+// erf(a) / a on [0, 0.5] as a polynomial in a^2 (minimax fit).
+inline float ErfSmall(float a) {
+  const float z = a * a;
+  float p = 4.728139928e-03f;
+  p = p * z - 2.676265946e-02f;
+  p = p * z + 1.128291895e-01f;
+  p = p * z - 3.761261450e-01f;
+  p = p * z + 1.128379166e+00f;
+  return p * a;
+}
+
+// erfc(a) for a >= 0.5 as exp(-a^2) * Q(1 / (1 + a / 2)); Q is a minimax fit
+// on [0.5, 10], beyond which erfc underflows and 0 is returned. Starting at
+// 0.5 rather than 1 keeps erfc accurate where 1 - erf would cancel.
+inline float ErfcLarge(float x) {
+  // Clamped so that a huge or infinite x never reaches ExpNegSquare, whose
+  // head/tail split turns into inf - inf there.
+  const float a = std::min(x, kErfcHi);
+  const float u = 1.0f / (1.0f + 0.5f * a);
+  float q = -7.485871980e-02f;
+  q = q * u + 3.530319522e-01f;
+  q = q * u - 6.140856009e-01f;
+  q = q * u + 4.094875623e-01f;
+  q = q * u - 1.100853636e-01f;
+  q = q * u + 2.362404422e-01f;
+  q = q * u + 2.345996947e-01f;
+  q = q * u + 2.836807339e-01f;
+  q = q * u + 2.819765989e-01f;
+  q = q * u + 3.849863562e-06f;
+  return x > kErfcHi ? 0.0f : ExpNegSquare(a) * q;
+}
+
+inline float Erf(float x) {
+  const float a = std::fabs(x);
+  const float r = a < 0.5f ? ErfSmall(a) : 1.0f - ErfcLarge(a);
+  return std::copysign(r, x);
+}
+
+// 1 + erf(x), i.e. erfc(-x), kept accurate for negative x where the sum
+// would cancel.
+inline float OnePlusErf(float x) {
+  const float a = std::fabs(x);
+  const float small = ErfSmall(a);
+  const float large = ErfcLarge(a);
+  const float pos = a < 0.5f ? 1.0f + small : 2.0f - large;
+  const float neg = a < 0.5f ? 1.0f - small : large;
+  return x < 0.0f ? neg : pos;
+}
+
+inline double Exp(double x) { return std::exp(x); }
+inline double Tanh(double x) { return std::tanh(x); }
+inline double Sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+inline double OnePlusErf(double x) { return std::erfc(-x); }
+
+// Type the functors compute in.
+template <typename T>
+struct MathType {
+  using type = float;
+};
+
+template <>
+struct MathType<double> {
+  using type = double;
+};
+
+// Activation functors. Forward functors map x to out; grad functors map
+// (v, dout) to dx, where v is whichever of x and out the phi grad kernel
+// receives (named in the parameter list).
+
+struct ReluFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    return x > MT(0) ? x : MT(0);
+  }
+};
+
+struct ReluGradFunctor {
+  template <typename MT>
+  MT operator()(MT out, MT dout) const {
+    return out > MT(0) ? dout : MT(0);
+  }
+};
+
+struct LeakyReluFunctor {
+  float alpha;
+  template <typename MT>
+  MT operator()(MT x) const {
+    return x > MT(0) ? x : x * static_cast<MT>(alpha);
+  }
+};
+
+struct LeakyReluGradFunctor {
+  float alpha;
+  template <typename MT>
+  MT operator()(MT x, MT dout) const {
+    return x > MT(0) ? dout : dout * static_cast<MT>(alpha);
+  }
+};
+
+struct SigmoidFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    return Sigmoid(x);
+  }
+};
+
+struct SigmoidGradFunctor {
+  template <typename MT>
+  MT operator()(MT out, MT dout) const {
+    return dout * out * (MT(1) - out);
+  }
+};
+
+struct TanhFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    return Tanh(x);
+  }
+};
+
+struct TanhGradFunctor {
+  template <typename MT>
+  MT operator()(MT out, MT dout) const {
+    return dout * (MT(1) - out * out);
+  }
+};
+
+// silu(x) = x * sigmoid(x).
+struct SiluFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    return x * Sigmoid(x);
+  }
+};
+
+struct SiluGradFunctor {
+  template <typename MT>
+  MT operator()(MT x, MT dout) const {
+    const MT s = Sigmoid(x);
+    return dout * s * (MT(1) + x * (MT(1) - s));
+  }
+};
+
+struct ExpFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    return Exp(x);
+  }
+};
+
+struct ExpGradFunctor {
+  template <typename MT>
+  MT operator()(MT out, MT dout) const {
+    return dout * out;
+  }
+};
+
+// gelu(x) = x * Phi(x) with the exact normal CDF, or with the tanh
+// approximation when kApproximate is set. The latter is evaluated as
+// x * sigmoid(2 * k * (x + c * x^3)), which equals
+// 0.5 * x * (1 + tanh(k * (x + c * x^3))) but does not cancel for x < 0.
+constexpr double kGeluC = 0.044715;
+constexpr double kSqrt2OverPi = 0.79788456080286535588;
+constexpr double kSqrt1_2 = 0.70710678118654752440;
+constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+
+template <bool kApproximate>
+struct GeluFunctor {
+  template <typename MT>
+  MT operator()(MT x) const {
+    if (kApproximate) {
+      const MT z = static_cast<MT>(kSqrt2OverPi) *
+                   (x + static_cast<MT>(kGeluC) * x * x * x);
+      return x * Sigmoid(MT(2) * z);
+    }
+    return MT(0.5) * x * OnePlusErf(x * static_cast<MT>(kSqrt1_2));
+  }
+};
+
+template <bool kApproximate>
+struct GeluGradFunctor {
+  template <typename MT>
+  MT operator()(MT x, MT dout) const {
+    if (kApproximate) {
+      const MT x2 = x * x;
+      const MT z = static_cast<MT>(kSqrt2OverPi) *
+                   (x + static_cast<MT>(kGeluC) * x2 * x);
+      const MT dz = static_cast<MT>(kSqrt2OverPi) *
+                    (MT(1) + static_cast<MT>(3 * kGeluC) * x2);
+      const MT s = Sigmoid(MT(2) * z);
+      return dout * (s + MT(2) * x * s * (MT(1) - s) * dz);
+    }
+    const MT cdf = MT(0.5) * OnePlusErf(x * static_cast<MT>(kSqrt1_2));
+    const MT pdf = static_cast<MT>(kInvSqrt2Pi) * Exp(MT(-0.5) * x * x);
+    return dout * (cdf + x * pdf);
+  }
+};
+
+}  // namespace act
+}  // namespace custom_kernel
@@ -0,0 +1,331 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+
+#include "kernels/activation_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+// Elements per parallel task: enough to amortize scheduling, small enough
+// that a task's inputs and output stay in L2.
+constexpr int64_t kActivationBlock = 16 * 1024;
+
+template <typename T, typename Functor>
+void ActivationTransform(const T* x,
+                         int64_t numel,
+                         const Functor& functor,
+                         T* out) {
+  using MT = typename act::MathType<T>::type;
+  const int64_t blocks = (numel + kActivationBlock - 1) / kActivationBlock;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (blocks > 1)
+#endif
+  for (int64_t b = 0; b < blocks; ++b) {
+    const int64_t end = std::min(numel, (b + 1) * kActivationBlock);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = b * kActivationBlock; i < end; ++i) {
+      out[i] = static_cast<T>(functor(static_cast<MT>(x[i])));
+    }
+  }
+}
+
+template <typename T, typename Functor>
+void ActivationGradTransform(const T* v,
+                             const T* dout,
+                             int64_t numel,
+                             const Functor& functor,
+                             T* dx) {
+  using MT = typename act::MathType<T>::type;
+  const int64_t blocks = (numel + kActivationBlock - 1) / kActivationBlock;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (blocks > 1)
+#endif
+  for (int64_t b = 0; b < blocks; ++b) {
+    const int64_t end = std::min(numel, (b + 1) * kActivationBlock);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = b * kActivationBlock; i < end; ++i) {
+      dx[i] = static_cast<T>(
+          functor(static_cast<MT>(v[i]), static_cast<MT>(dout[i])));
+    }
+  }
+}
+
+template <typename T, typename Functor>
+void Activation(const phi::Context& dev_ctx,
+                const phi::DenseTensor& x,
+                const Functor& functor,
+                phi::DenseTensor* out) {
+  out->Resize(x.dims());
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  ActivationTransform(x.data<T>(), x.numel(), functor, out_data);
+}
+
+// v is x or out, whichever the grad functor is defined on.
+template <typename T, typename Functor>
+void ActivationGrad(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& v,
+                    const phi::DenseTensor& dout,
+                    const Functor& functor,
+                    phi::DenseTensor* dx) {
+  PD_CHECK(v.numel() == dout.numel(),
+           "The number of elements of the activation input (%d) and of its "
+           "gradient (%d) must be equal.",
+           v.numel(),
+           dout.numel());
+  dx->Resize(dout.dims());
+  auto dx_data = dev_ctx.template Alloc<T>(dx);
+  ActivationGradTransform(
+      v.data<T>(), dout.data<T>(), dout.numel(), functor, dx_data);
+}
+
+template <typename T>
+void ReluKernel(const phi::Context& dev_ctx,
+                const phi::DenseTensor& x,
+                phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::ReluFunctor(), out);
+}
+
+template <typename T>
+void ReluGradKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& out,
+                    const phi::DenseTensor& dout,
+                    phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, out, dout, act::ReluGradFunctor(), dx);
+}
+
+template <typename T>
+void LeakyReluKernel(const phi::Context& dev_ctx,
+                     const phi::DenseTensor& x,
+                     float alpha,
+                     phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::LeakyReluFunctor{alpha}, out);
+}
+
+template <typename T>
+void LeakyReluGradKernel(const phi::Context& dev_ctx,
+                         const phi::DenseTensor& x,
+                         const phi::DenseTensor& dout,
+                         float alpha,
+                         phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, x, dout, act::LeakyReluGradFunctor{alpha}, dx);
+}
+
+template <typename T>
+void SigmoidKernel(const phi::Context& dev_ctx,
+                   const phi::DenseTensor& x,
+                   phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::SigmoidFunctor(), out);
+}
+
+template <typename T>
+void SigmoidGradKernel(const phi::Context& dev_ctx,
+                       const phi::DenseTensor& out,
+                       const phi::DenseTensor& dout,
+                       phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, out, dout, act::SigmoidGradFunctor(), dx);
+}
+
+template <typename T>
+void TanhKernel(const phi::Context& dev_ctx,
+                const phi::DenseTensor& x,
+                phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::TanhFunctor(), out);
+}
+
+template <typename T>
+void TanhGradKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& out,
+                    const phi::DenseTensor& dout,
+                    phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, out, dout, act::TanhGradFunctor(), dx);
+}
+
+template <typename T>
+void SiluKernel(const phi::Context& dev_ctx,
+                const phi::DenseTensor& x,
+                phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::SiluFunctor(), out);
+}
+
+template <typename T>
+void SiluGradKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& x,
+                    const phi::DenseTensor& dout,
+                    phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, x, dout, act::SiluGradFunctor(), dx);
+}
+
+template <typename T>
+void ExpKernel(const phi::Context& dev_ctx,
+               const phi::DenseTensor& x,
+               phi::DenseTensor* out) {
+  Activation<T>(dev_ctx, x, act::ExpFunctor(), out);
+}
+
+template <typename T>
+void ExpGradKernel(const phi::Context& dev_ctx,
+                   const phi::DenseTensor& out,
+                   const phi::DenseTensor& dout,
+                   phi::DenseTensor* dx) {
+  ActivationGrad<T>(dev_ctx, out, dout, act::ExpGradFunctor(), dx);
+}
+
+template <typename T>
+void GeluKernel(const phi::Context& dev_ctx,
+                const phi::DenseTensor& x,
+                bool approximate,
+                phi::DenseTensor* out) {
+  if (approximate) {
+    Activation<T>(dev_ctx, x, act::GeluFunctor<true>(), out);
+  } else {
+    Activation<T>(dev_ctx, x, act::GeluFunctor<false>(), out);
+  }
+}
+
+template <typename T>
+void GeluGradKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& x,
+                    const phi::DenseTensor& out_grad,
+                    bool approximate,
+                    phi::DenseTensor* x_grad) {
+  if (approximate) {
+    ActivationGrad<T>(
+        dev_ctx, x, out_grad, act::GeluGradFunctor<true>(), x_grad);
+  } else {
+    ActivationGrad<T>(
+        dev_ctx, x, out_grad, act::GeluGradFunctor<false>(), x_grad);
+  }
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(relu,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ReluKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(relu_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ReluGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(leaky_relu,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::LeakyReluKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(leaky_relu_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::LeakyReluGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(sigmoid,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SigmoidKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(sigmoid_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SigmoidGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(tanh,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::TanhKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(tanh_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::TanhGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(silu,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SiluKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(silu_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SiluGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(exp,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ExpKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(exp_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ExpGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(gelu,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GeluKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
+
+PD_BUILD_PHI_KERNEL(gelu_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GeluGradKernel,
+                    float,
+                    double,
+                    phi::dtype::bfloat16) {}
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/copy_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void ConcatKernel(const phi::Context& dev_ctx,
+                  const std::vector<const phi::DenseTensor*>& ins,
+                  const phi::Scalar& axis_scalar,
+                  phi::DenseTensor* out) {
+  PD_CHECK(!ins.empty(), "The number of inputs of concat must be > 0.");
+  auto out_dims = ins[0]->dims();
+  int rank = out_dims.size();
+  int axis = phi::funcs::CanonicalAxis(axis_scalar.to<int>(), rank);
+
+  out_dims[axis] = 0;
+  for (auto in : ins) {
+    auto in_dims = in->dims();
+    PD_CHECK(in_dims.size() == rank,
+             "The rank of all inputs of concat must be %d, but got %d.",
+             rank,
+             in_dims.size());
+    out_dims[axis] += in_dims[axis];
+  }
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+
+  int64_t outer, inner;
+  std::vector<const char*> pieces;
+  std::vector<size_t> piece_bytes;
+  for (auto in : ins) {
+    if (in->numel() == 0) continue;
+    funcs::SplitDimsAtAxis(in->dims(), axis, &outer, &inner);
+    pieces.push_back(reinterpret_cast<const char*>(in->data<T>()));
+    piece_bytes.push_back(inner * sizeof(T));
+  }
+  if (pieces.empty()) return;
+  funcs::BuildJoinPlan(
+      pieces, piece_bytes, outer, reinterpret_cast<char*>(out_data))
+      .Execute();
+}
+
+template <typename T>
+void ConcatGradKernel(const phi::Context& dev_ctx,
+                      const std::vector<const phi::DenseTensor*>& ins,
+                      const phi::DenseTensor& out_grad,
+                      const phi::Scalar& axis_scalar,
+                      std::vector<phi::DenseTensor*> outs) {
+  int rank = out_grad.dims().size();
+  int axis = phi::funcs::CanonicalAxis(axis_scalar.to<int>(), rank);
+
+  int64_t outer = 1, inner;
+  std::vector<char*> pieces;
+  std::vector<size_t> piece_bytes;
+  for (size_t i = 0; i < ins.size(); ++i) {
+    if (ins[i]->numel() == 0) continue;
+    funcs::SplitDimsAtAxis(ins[i]->dims(), axis, &outer, &inner);
+    char* dst = nullptr;
+    if (outs[i]) {
+      outs[i]->Resize(ins[i]->dims());
+      dst = reinterpret_cast<char*>(dev_ctx.template Alloc<T>(outs[i]));
+    }
+    pieces.push_back(dst);
+    piece_bytes.push_back(inner * sizeof(T));
+  }
+  if (pieces.empty()) return;
+  funcs::BuildSplitPlan(reinterpret_cast<const char*>(out_grad.data<T>()),
+                        piece_bytes,
+                        outer,
+                        pieces)
+      .Execute();
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(concat,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ConcatKernel,
+                    bool,
+                    uint8_t,
+                    int8_t,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(concat_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ConcatGradKernel,
+                    bool,
+                    uint8_t,
+                    int8_t,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
@@ -0,0 +1,150 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace custom_kernel {
+namespace funcs {
+
+// A list of (src, dst, bytes) runs. concat/split/stack/unstack all reduce to
+// moving, for each index of the collapsed dims before the axis, one
+// contiguous block per piece; the plan records those blocks once and then
+// executes them with a parallel memcpy.
+class CopyPlan {
+ public:
+  struct CopyRun {
+    const char* src;
+    char* dst;
+    size_t bytes;
+  };
+
+  // Runs larger than this are split so one big piece cannot serialize the
+  // copy behind a single thread.
+  static constexpr size_t kChunkBytes = 256 * 1024;
+  // Below this total the copy stays on the calling thread.
+  static constexpr size_t kParallelBytes = 1 << 20;
+
+  // Appends a run, merging it into the previous one when both source and
+  // destination continue exactly where the previous run ended.
+  void Add(const void* src, void* dst, size_t bytes) {
+    if (bytes == 0) return;
+    auto s = static_cast<const char*>(src);
+    auto d = static_cast<char*>(dst);
+    if (!runs_.empty()) {
+      CopyRun& last = runs_.back();
+      if (last.src + last.bytes == s && last.dst + last.bytes == d) {
+        last.bytes += bytes;
+        total_bytes_ += bytes;
+        return;
+      }
+    }
+    runs_.push_back({s, d, bytes});
+    total_bytes_ += bytes;
+  }
+
+  void Execute() const {
+    if (total_bytes_ < kParallelBytes) {
+      for (const auto& run : runs_) {
+        memcpy(run.dst, run.src, run.bytes);
+      }
+      return;
+    }
+    // A local copy, std::min binds by reference and would odr-use the
+    // member, which has no out-of-line definition under C++14.
+    const size_t chunk_bytes = kChunkBytes;
+    std::vector<CopyRun> chunks;
+    chunks.reserve(runs_.size() + total_bytes_ / chunk_bytes);
+    for (const auto& run : runs_) {
+      for (size_t off = 0; off < run.bytes; off += chunk_bytes) {
+        chunks.push_back({run.src + off,
+                          run.dst + off,
+                          std::min(chunk_bytes, run.bytes - off)});
+      }
+    }
+    const int64_t num_chunks = chunks.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 4)
+#endif
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      memcpy(chunks[i].dst, chunks[i].src, chunks[i].bytes);
+    }
+  }
+
+  size_t size() const { return runs_.size(); }
+  size_t total_bytes() const { return total_bytes_; }
+
+ private:
+  std::vector<CopyRun> runs_;
+  size_t total_bytes_ = 0;
+};
+
+// Collapses dims around axis into [outer, dims[axis] * inner].
+inline void SplitDimsAtAxis(const std::vector<int64_t>& dims,
+                            int axis,
+                            int64_t* outer,
+                            int64_t* inner) {
+  *outer = 1;
+  *inner = 1;
+  for (int i = 0; i < axis; ++i) *outer *= dims[i];
+  for (int i = axis; i < static_cast<int>(dims.size()); ++i) *inner *= dims[i];
+}
+
+// Builds the runs that concatenate pieces, each viewed as
+// [outer, piece_bytes[i]], along their rows into whole, viewed as
+// [outer, sum(piece_bytes)].
+inline CopyPlan BuildJoinPlan(const std::vector<const char*>& pieces,
+                              const std::vector<size_t>& piece_bytes,
+                              int64_t outer,
+                              char* whole) {
+  size_t row_bytes = 0;
+  for (auto b : piece_bytes) row_bytes += b;
+  CopyPlan plan;
+  for (int64_t o = 0; o < outer; ++o) {
+    char* dst = whole + o * row_bytes;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+      plan.Add(pieces[i] + o * piece_bytes[i], dst, piece_bytes[i]);
+      dst += piece_bytes[i];
+    }
+  }
+  return plan;
+}
+
+// The inverse of BuildJoinPlan. Null pieces are skipped, which lets grad
+// kernels leave out inputs that need no gradient.
+inline CopyPlan BuildSplitPlan(const char* whole,
+                               const std::vector<size_t>& piece_bytes,
+                               int64_t outer,
+                               const std::vector<char*>& pieces) {
+  size_t row_bytes = 0;
+  for (auto b : piece_bytes) row_bytes += b;
+  CopyPlan plan;
+  for (int64_t o = 0; o < outer; ++o) {
+    const char* src = whole + o * row_bytes;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+      if (pieces[i]) {
+        plan.Add(src, pieces[i] + o * piece_bytes[i], piece_bytes[i]);
+      }
+      src += piece_bytes[i];
+    }
+  }
+  return plan;
+}
+
+}  // namespace funcs
+}  // namespace custom_kernel
@@ -0,0 +1,185 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <utility>
+
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+constexpr int64_t kNoPadding = -1;
+// Rows gathered ahead of the one being copied. Tables are usually far larger
+// than the cache, so each row is a miss unless it was requested early.
+constexpr int64_t kPrefetchDistance = 8;
+
+template <typename IdT>
+void CheckIds(const IdT* ids, int64_t ids_numel, int64_t height) {
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    PD_CHECK(ids[i] >= 0 && ids[i] < height,
+             "Variable value (input) of OP(embedding) expected >= 0 and < %d, "
+             "but got %d. Please check input value.",
+             height,
+             ids[i]);
+  }
+}
+
+template <typename T, typename IdT>
+void EmbeddingLookup(const IdT* ids,
+                     int64_t ids_numel,
+                     const T* table,
+                     int64_t width,
+                     int64_t padding_idx,
+                     T* out) {
+  const size_t row_bytes = width * sizeof(T);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (ids_numel * width > (1 << 15))
+#endif
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (i + kPrefetchDistance < ids_numel) {
+      const T* next = table + ids[i + kPrefetchDistance] * width;
+      for (size_t off = 0; off < row_bytes; off += 64) {
+        __builtin_prefetch(reinterpret_cast<const char*>(next) + off, 0, 0);
+      }
+    }
+    if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+      memset(out + i * width, 0, row_bytes);
+    } else {
+      memcpy(out + i * width, table + ids[i] * width, row_bytes);
+    }
+  }
+}
+
+// Accumulates out_grad rows into weight_grad without atomics: (id, position)
+// pairs are sorted so every table row is owned by exactly one segment, and
+// segments are summed in parallel.
+template <typename T, typename IdT>
+void EmbeddingSegmentSum(const IdT* ids,
+                         int64_t ids_numel,
+                         const T* out_grad,
+                         int64_t width,
+                         int64_t padding_idx,
+                         T* weight_grad) {
+  std::vector<std::pair<IdT, int64_t>> order;
+  order.reserve(ids_numel);
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (padding_idx != kNoPadding && ids[i] == padding_idx) continue;
+    order.emplace_back(ids[i], i);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<int64_t> segment_begin;
+  for (int64_t i = 0; i < static_cast<int64_t>(order.size()); ++i) {
+    if (i == 0 || order[i].first != order[i - 1].first) {
+      segment_begin.push_back(i);
+    }
+  }
+  segment_begin.push_back(order.size());
+
+  const int64_t num_segments = segment_begin.size() - 1;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (num_segments > 64)
+#endif
+  for (int64_t s = 0; s < num_segments; ++s) {
+    T* dst = weight_grad + order[segment_begin[s]].first * width;
+    for (int64_t j = segment_begin[s]; j < segment_begin[s + 1]; ++j) {
+      const T* src = out_grad + order[j].second * width;
+      for (int64_t k = 0; k < width; ++k) {
+        dst[k] += src[k];
+      }
+    }
+  }
+}
+
+template <typename T>
+void EmbeddingKernel(const phi::Context& dev_ctx,
+                     const phi::DenseTensor& inputx,
+                     const phi::DenseTensor& weight,
+                     int64_t padding_idx,
+                     phi::DenseTensor* out) {
+  auto table_dims = weight.dims();
+  auto height = table_dims[0];
+  auto width = table_dims[1];
+  auto ids_numel = inputx.numel();
+
+  auto out_dims = inputx.dims();
+  out_dims.push_back(width);
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  auto table = weight.data<T>();
+
+  if (inputx.dtype() == phi::DataType::INT32) {
+    auto ids = inputx.data<int32_t>();
+    CheckIds(ids, ids_numel, height);
+    EmbeddingLookup(ids, ids_numel, table, width, padding_idx, out_data);
+  } else if (inputx.dtype() == phi::DataType::INT64) {
+    auto ids = inputx.data<int64_t>();
+    CheckIds(ids, ids_numel, height);
+    EmbeddingLookup(ids, ids_numel, table, width, padding_idx, out_data);
+  } else {
+    PD_CHECK(false,
+             "embedding ids only support int32 and int64, but got %s.",
+             phi::to_string(inputx.dtype()));
+  }
+}
+
+template <typename T>
+void EmbeddingGradKernel(const phi::Context& dev_ctx,
+                         const phi::DenseTensor& input,
+                         const phi::DenseTensor& weight,
+                         const phi::DenseTensor& out_grad,
+                         int64_t padding_idx,
+                         phi::DenseTensor* weight_grad) {
+  auto table_dims = weight.dims();
+  auto height = table_dims[0];
+  auto width = table_dims[1];
+  auto ids_numel = input.numel();
+
+  weight_grad->Resize(table_dims);
+  auto weight_grad_data = dev_ctx.template Alloc<T>(weight_grad);
+  memset(weight_grad_data, 0, weight_grad->numel() * sizeof(T));
+  auto out_grad_data = out_grad.data<T>();
+
+  if (input.dtype() == phi::DataType::INT32) {
+    auto ids = input.data<int32_t>();
+    CheckIds(ids, ids_numel, height);
+    EmbeddingSegmentSum(
+        ids, ids_numel, out_grad_data, width, padding_idx, weight_grad_data);
+  } else if (input.dtype() == phi::DataType::INT64) {
+    auto ids = input.data<int64_t>();
+    CheckIds(ids, ids_numel, height);
+    EmbeddingSegmentSum(
+        ids, ids_numel, out_grad_data, width, padding_idx, weight_grad_data);
+  } else {
+    PD_CHECK(false,
+             "embedding ids only support int32 and int64, but got %s.",
+             phi::to_string(input.dtype()));
+  }
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(embedding,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::EmbeddingKernel,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(embedding_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::EmbeddingGradKernel,
+                    float,
+                    double) {}
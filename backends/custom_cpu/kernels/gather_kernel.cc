@@ -0,0 +1,190 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/index_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void GatherKernel(const phi::Context& dev_ctx,
+                  const phi::DenseTensor& x,
+                  const phi::DenseTensor& index,
+                  const phi::Scalar& axis,
+                  phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  int axis_v = phi::funcs::CanonicalAxis(axis.to<int>(), rank);
+  auto rows = funcs::ReadIndex(index, x_dims[axis_v], false, "gather");
+
+  auto out_dims = x_dims;
+  out_dims[axis_v] = rows.size();
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  funcs::GatherRows(x.data<T>(),
+                    x_dims[axis_v],
+                    rows,
+                    funcs::Product(x_dims, 0, axis_v),
+                    funcs::Product(x_dims, axis_v + 1, rank),
+                    out_data);
+}
+
+template <typename T>
+void GatherGradKernel(const phi::Context& dev_ctx,
+                      const phi::DenseTensor& x,
+                      const phi::DenseTensor& index,
+                      const phi::DenseTensor& out_grad,
+                      const phi::Scalar& axis,
+                      bool overwrite,
+                      phi::DenseTensor* x_grad) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  int axis_v = phi::funcs::CanonicalAxis(axis.to<int>(), rank);
+  auto rows = funcs::ReadIndex(index, x_dims[axis_v], false, "gather_grad");
+
+  x_grad->Resize(x_dims);
+  auto x_grad_data = dev_ctx.template Alloc<T>(x_grad);
+  memset(x_grad_data, 0, x_grad->numel() * sizeof(T));
+  if (rows.empty()) return;
+
+  funcs::ScatterRows(out_grad.data<T>(),
+                     rows,
+                     funcs::Product(x_dims, 0, axis_v),
+                     x_dims[axis_v],
+                     funcs::Product(x_dims, axis_v + 1, rank),
+                     overwrite,
+                     false,
+                     x_grad_data);
+}
+
+// Flattens every index tuple of gather_nd into a row of x viewed as
+// [prod(x_dims[:k]), prod(x_dims[k:])].
+inline std::vector<int64_t> GatherNdRows(const phi::DenseTensor& index,
+                                         const std::vector<int64_t>& x_dims,
+                                         const std::string& op_name) {
+  auto index_dims = index.dims();
+  int64_t k = index_dims.back();
+  PD_CHECK(k <= static_cast<int64_t>(x_dims.size()),
+           "The last dimension of Index (%d) of %s must not exceed the rank "
+           "of X (%d).",
+           k,
+           op_name,
+           x_dims.size());
+  auto ids = funcs::CastIndex(index, op_name);
+  int64_t num_tuples = funcs::Product(index_dims, 0, index_dims.size() - 1);
+  std::vector<int64_t> rows(num_tuples, 0);
+  for (int64_t t = 0; t < num_tuples; ++t) {
+    int64_t row = 0;
+    for (int64_t j = 0; j < k; ++j) {
+      int64_t* id = &ids[t * k + j];
+      funcs::CheckIndex(id, t * k + j, x_dims[j], true, op_name);
+      row = row * x_dims[j] + *id;
+    }
+    rows[t] = row;
+  }
+  return rows;
+}
+
+template <typename T>
+void GatherNdKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& x,
+                    const phi::DenseTensor& index,
+                    phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  auto index_dims = index.dims();
+  int rank = x_dims.size();
+  int64_t k = index_dims.back();
+
+  auto out_dims = phi::slice_ddim(
+      index_dims, 0, static_cast<int>(index_dims.size()) - 1);
+  out_dims.insert(out_dims.end(), x_dims.begin() + k, x_dims.end());
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  auto rows = GatherNdRows(index, x_dims, "gather_nd");
+  funcs::GatherRows(x.data<T>(),
+                    funcs::Product(x_dims, 0, k),
+                    rows,
+                    1,
+                    funcs::Product(x_dims, k, rank),
+                    out_data);
+}
+
+template <typename T>
+void GatherNdGradKernel(const phi::Context& dev_ctx,
+                        const phi::DenseTensor& x,
+                        const phi::DenseTensor& index,
+                        const phi::DenseTensor& out_grad,
+                        phi::DenseTensor* x_grad) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  int64_t k = index.dims().back();
+
+  x_grad->Resize(x_dims);
+  auto x_grad_data = dev_ctx.template Alloc<T>(x_grad);
+  memset(x_grad_data, 0, x_grad->numel() * sizeof(T));
+
+  auto rows = GatherNdRows(index, x_dims, "gather_nd_grad");
+  if (rows.empty()) return;
+  funcs::ScatterRows(out_grad.data<T>(),
+                     rows,
+                     1,
+                     funcs::Product(x_dims, 0, k),
+                     funcs::Product(x_dims, k, rank),
+                     false,
+                     false,
+                     x_grad_data);
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(gather,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GatherKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(gather_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GatherGradKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(gather_nd,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GatherNdKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(gather_nd_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::GatherNdGradKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
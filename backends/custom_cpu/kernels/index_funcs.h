@@ -0,0 +1,209 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+namespace funcs {
+
+// Shared engine for the gather/scatter family. Every op is expressed as
+// copies of contiguous `slice` elements between a source viewed as
+// [outer, src_rows, slice] and a destination viewed as
+// [outer, dst_rows, slice]; the ops only differ in how the row indices are
+// produced.
+
+// Widens an int32/int64 index tensor to int64.
+inline std::vector<int64_t> CastIndex(const phi::DenseTensor& index,
+                                      const std::string& op_name) {
+  auto numel = index.numel();
+  std::vector<int64_t> ids(numel);
+  if (index.dtype() == phi::DataType::INT32) {
+    auto data = index.data<int32_t>();
+    std::copy(data, data + numel, ids.begin());
+  } else if (index.dtype() == phi::DataType::INT64) {
+    auto data = index.data<int64_t>();
+    std::copy(data, data + numel, ids.begin());
+  } else {
+    PD_CHECK(false,
+             "The index of %s only supports int32 and int64, but got %s.",
+             op_name,
+             phi::to_string(index.dtype()));
+  }
+  return ids;
+}
+
+inline void CheckIndex(int64_t* id,
+                       int64_t pos,
+                       int64_t upper_bound,
+                       bool allow_negative,
+                       const std::string& op_name) {
+  const int64_t lower_bound = allow_negative ? -upper_bound : 0;
+  PD_CHECK(*id >= lower_bound && *id < upper_bound,
+           "The index of %s is out of range, expected index in [%d, %d), "
+           "but got index[%d] = %d.",
+           op_name,
+           lower_bound,
+           upper_bound,
+           pos,
+           *id);
+  if (*id < 0) *id += upper_bound;
+}
+
+// Reads an index tensor into row ids in [0, upper_bound), reporting
+// out-of-range values. Negative ids are wrapped when allow_negative is set.
+inline std::vector<int64_t> ReadIndex(const phi::DenseTensor& index,
+                                      int64_t upper_bound,
+                                      bool allow_negative,
+                                      const std::string& op_name) {
+  auto ids = CastIndex(index, op_name);
+  for (int64_t i = 0; i < static_cast<int64_t>(ids.size()); ++i) {
+    CheckIndex(&ids[i], i, upper_bound, allow_negative, op_name);
+  }
+  return ids;
+}
+
+// dst[o][i] = src[o][rows[i]] for i in [0, rows.size()).
+template <typename T>
+void GatherRows(const T* src,
+                int64_t src_rows,
+                const std::vector<int64_t>& rows,
+                int64_t outer,
+                int64_t slice,
+                T* dst) {
+  const int64_t n = rows.size();
+  const size_t bytes = slice * sizeof(T);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (outer * n * slice > (1 << 15))
+#endif
+  for (int64_t j = 0; j < outer * n; ++j) {
+    const int64_t o = j / n;
+    const int64_t i = j - o * n;
+    memcpy(dst + j * slice, src + (o * src_rows + rows[i]) * slice, bytes);
+  }
+}
+
+// Groups positions by target row: segment s spans [begin(s), end(s)) of the
+// sorted order, every entry of which addresses row(s), in ascending position
+// order. Accumulation is therefore deterministic and every destination row
+// is written by exactly one thread.
+class RowSegments {
+ public:
+  explicit RowSegments(const std::vector<int64_t>& rows) {
+    order_.reserve(rows.size());
+    for (int64_t i = 0; i < static_cast<int64_t>(rows.size()); ++i) {
+      order_.emplace_back(rows[i], i);
+    }
+    std::sort(order_.begin(), order_.end());
+    for (int64_t i = 0; i < static_cast<int64_t>(order_.size()); ++i) {
+      if (i == 0 || order_[i].first != order_[i - 1].first) {
+        begin_.push_back(i);
+      }
+    }
+    begin_.push_back(order_.size());
+  }
+
+  int64_t size() const { return begin_.size() - 1; }
+  int64_t row(int64_t s) const { return order_[begin_[s]].first; }
+  int64_t begin(int64_t s) const { return begin_[s]; }
+  int64_t end(int64_t s) const { return begin_[s + 1]; }
+  int64_t position(int64_t j) const { return order_[j].second; }
+
+ private:
+  std::vector<std::pair<int64_t, int64_t>> order_;
+  std::vector<int64_t> begin_;
+};
+
+// dst[o][rows[i]] += src[o][i], or = when overwrite (the last duplicate
+// wins). Rows addressed by an accumulating scatter are reset first when
+// zero_first is set, matching the semantics of scatter(overwrite=False).
+template <typename T>
+void ScatterRows(const T* src,
+                 const std::vector<int64_t>& rows,
+                 int64_t outer,
+                 int64_t dst_rows,
+                 int64_t slice,
+                 bool overwrite,
+                 bool zero_first,
+                 T* dst) {
+  const int64_t n = rows.size();
+  RowSegments segments(rows);
+  const int64_t num_segments = segments.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (outer * num_segments > 64)
+#endif
+  for (int64_t j = 0; j < outer * num_segments; ++j) {
+    const int64_t o = j / num_segments;
+    const int64_t s = j - o * num_segments;
+    T* out = dst + (o * dst_rows + segments.row(s)) * slice;
+    const T* in = src + o * n * slice;
+    if (overwrite) {
+      const int64_t last = segments.position(segments.end(s) - 1);
+      memcpy(out, in + last * slice, slice * sizeof(T));
+      continue;
+    }
+    if (zero_first) {
+      memset(out, 0, slice * sizeof(T));
+    }
+    for (int64_t k = segments.begin(s); k < segments.end(s); ++k) {
+      const T* row = in + segments.position(k) * slice;
+      for (int64_t e = 0; e < slice; ++e) {
+        out[e] += row[e];
+      }
+    }
+  }
+}
+
+// Element-wise variant used by take_along_axis and index_sample, where each
+// output element carries its own index along the axis:
+// dst[o][i][e] = src[o][ids[o][i][e]][e].
+template <typename T>
+void GatherElements(const T* src,
+                    int64_t src_rows,
+                    const std::vector<int64_t>& ids,
+                    int64_t outer,
+                    int64_t rows,
+                    int64_t inner,
+                    T* dst) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (outer * rows * inner > \
+                                              (1 << 15))
+#endif
+  for (int64_t j = 0; j < outer * rows; ++j) {
+    const T* src_o = src + j / rows * src_rows * inner;
+    const int64_t base = j * inner;
+    for (int64_t e = 0; e < inner; ++e) {
+      dst[base + e] = src_o[ids[base + e] * inner + e];
+    }
+  }
+}
+
+inline int64_t Product(const std::vector<int64_t>& dims,
+                       int64_t begin,
+                       int64_t end) {
+  int64_t ret = 1;
+  for (int64_t i = begin; i < end; ++i) ret *= dims[i];
+  return ret;
+}
+
+}  // namespace funcs
+}  // namespace custom_kernel
@@ -0,0 +1,125 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/index_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void IndexSelectKernel(const phi::Context& dev_ctx,
+                       const phi::DenseTensor& x,
+                       const phi::DenseTensor& index,
+                       int dim,
+                       phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  dim = phi::funcs::CanonicalAxis(dim, rank);
+  auto rows = funcs::ReadIndex(index, x_dims[dim], true, "index_select");
+
+  auto out_dims = x_dims;
+  out_dims[dim] = rows.size();
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  funcs::GatherRows(x.data<T>(),
+                    x_dims[dim],
+                    rows,
+                    funcs::Product(x_dims, 0, dim),
+                    funcs::Product(x_dims, dim + 1, rank),
+                    out_data);
+}
+
+template <typename T>
+void IndexSelectGradKernel(const phi::Context& dev_ctx,
+                           const phi::DenseTensor& x,
+                           const phi::DenseTensor& index,
+                           const phi::DenseTensor& out_grad,
+                           int dim,
+                           phi::DenseTensor* x_grad) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  dim = phi::funcs::CanonicalAxis(dim, rank);
+  auto rows = funcs::ReadIndex(index, x_dims[dim], true, "index_select_grad");
+
+  x_grad->Resize(x_dims);
+  auto x_grad_data = dev_ctx.template Alloc<T>(x_grad);
+  memset(x_grad_data, 0, x_grad->numel() * sizeof(T));
+  if (rows.empty()) return;
+
+  funcs::ScatterRows(out_grad.data<T>(),
+                     rows,
+                     funcs::Product(x_dims, 0, dim),
+                     x_dims[dim],
+                     funcs::Product(x_dims, dim + 1, rank),
+                     false,
+                     false,
+                     x_grad_data);
+}
+
+// out[b][k] = x[b][index[b][k]], i.e. a per-row gather along the last axis.
+template <typename T>
+void IndexSampleKernel(const phi::Context& dev_ctx,
+                       const phi::DenseTensor& x,
+                       const phi::DenseTensor& index,
+                       phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  auto index_dims = index.dims();
+  PD_CHECK(x_dims.size() == 2 && index_dims.size() == 2,
+           "Inputs(X) and Inputs(Index) of index_sample must be 2-D.");
+  PD_CHECK(x_dims[0] == index_dims[0],
+           "The batch size of Inputs(X) (%d) and Inputs(Index) (%d) of "
+           "index_sample must be equal.",
+           x_dims[0],
+           index_dims[0]);
+  auto ids = funcs::ReadIndex(index, x_dims[1], false, "index_sample");
+
+  out->Resize(index_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  funcs::GatherElements(
+      x.data<T>(), x_dims[1], ids, x_dims[0], index_dims[1], 1, out_data);
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(index_select,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::IndexSelectKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(index_select_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::IndexSelectGradKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(index_sample,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::IndexSampleKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "kernels/phi_funcs.h"
+#include "kernels/quant_funcs.h"
 #include "paddle/phi/capi/all.h"
 
 namespace custom_kernel {
@@ -294,6 +295,182 @@ void MatmulKernel(const phi::Context& dev_ctx,
   }
 }
 
+// int8 x int8 -> int32. Batched inputs share the packed copy of the operand
+// that has no batch dimension.
+template <>
+void MatmulKernel<int8_t>(const phi::Context& dev_ctx,
+                          const phi::DenseTensor& x,
+                          const phi::DenseTensor& y,
+                          bool transpose_x,
+                          bool transpose_y,
+                          phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  auto y_dims = y.dims();
+  auto x_ndim = x_dims.size();
+  auto y_ndim = y_dims.size();
+  PD_CHECK(x_ndim >= 2 && y_ndim >= 2,
+           "int8 matmul requires 2-D or 3-D inputs, but received X'rank %d "
+           "and Y'rank %d.",
+           x_ndim,
+           y_ndim);
+  PD_CHECK(x_ndim <= 3 && y_ndim <= 3,
+           "int8 matmul requires 2-D or 3-D inputs, but received X'rank %d "
+           "and Y'rank %d.",
+           x_ndim,
+           y_ndim);
+
+  auto M = transpose_x ? x_dims[x_ndim - 1] : x_dims[x_ndim - 2];
+  auto K = transpose_x ? x_dims[x_ndim - 2] : x_dims[x_ndim - 1];
+  auto N = transpose_y ? y_dims[y_ndim - 2] : y_dims[y_ndim - 1];
+  auto y_k = transpose_y ? y_dims[y_ndim - 1] : y_dims[y_ndim - 2];
+  PD_CHECK(K == y_k,
+           "Input(Y) has error dim."
+           "Y'K must be equal to %d"
+           "But received Y'K is %d",
+           K,
+           y_k);
+  int64_t x_batch = x_ndim == 3 ? x_dims[0] : 1;
+  int64_t y_batch = y_ndim == 3 ? y_dims[0] : 1;
+  PD_CHECK(x_batch == y_batch || x_batch == 1 || y_batch == 1,
+           "Batch size of X (%d) and Y (%d) must match.",
+           x_batch,
+           y_batch);
+  int64_t batch = std::max(x_batch, y_batch);
+
+  if (batch == 1 && x_ndim == 2 && y_ndim == 2) {
+    out->Resize({M, N});
+  } else {
+    out->Resize({batch, M, N});
+  }
+  auto out_data = dev_ctx.template Alloc<int32_t>(out);
+  auto x_data = x.data<int8_t>();
+  auto y_data = y.data<int8_t>();
+
+  quant::PackedA packed_x;
+  quant::PackedB packed_y;
+  for (int64_t bs = 0; bs < batch; ++bs) {
+    if (bs == 0 || x_batch > 1) {
+      quant::PackA(transpose_x,
+                   M,
+                   K,
+                   x_data + (x_batch > 1 ? bs * M * K : 0),
+                   &packed_x);
+    }
+    if (bs == 0 || y_batch > 1) {
+      quant::PackB(transpose_y,
+                   K,
+                   N,
+                   y_data + (y_batch > 1 ? bs * K * N : 0),
+                   &packed_y);
+    }
+    quant::Int8Gemm(packed_x,
+                    packed_y,
+                    quant::StoreInt32{out_data + bs * M * N, N});
+  }
+}
+
+// int8 fully connected layer as emitted by the int8 quantization passes:
+// Input and W are quantized with scale_in and scale_weights (one value, or
+// one per output channel), Bias is float. The result is dequantized to
+// float when force_fp32_output is set and requantized with scale_out to int8
+// otherwise, both in the GEMM epilogue.
+template <typename T>
+void FCKernel(const phi::Context& dev_ctx,
+              const phi::DenseTensor& input,
+              const phi::DenseTensor& w,
+              const paddle::optional<phi::DenseTensor>& bias,
+              int in_num_col_dims,
+              const std::string& activation_type,
+              bool use_mkldnn,
+              bool padding_weights,
+              bool use_quantizer,
+              const std::string& mkldnn_data_type,
+              float scale_in,
+              const std::vector<float>& scale_weights,
+              float scale_out,
+              bool force_fp32_output,
+              phi::DenseTensor* out) {
+  PD_CHECK(!padding_weights, "int8 fc does not support padded weights.");
+  PD_CHECK(activation_type.empty() || activation_type == "relu",
+           "int8 fc only supports the relu activation, but received %s.",
+           activation_type.c_str());
+  auto in_dims = input.dims();
+  auto w_dims = w.dims();
+  PD_CHECK(w_dims.size() == 2, "The weight of fc must be 2-D.");
+  PD_CHECK(in_num_col_dims > 0 &&
+               in_num_col_dims < static_cast<int>(in_dims.size()),
+           "in_num_col_dims of fc must be in [1, %d), but received %d.",
+           in_dims.size(),
+           in_num_col_dims);
+  auto out_dims = phi::slice_ddim(in_dims, 0, in_num_col_dims);
+  auto M = phi::product(out_dims);
+  auto K = phi::product(in_dims) / M;
+  auto N = w_dims[1];
+  PD_CHECK(K == w_dims[0],
+           "The flattened input of fc has %d columns, but the weight has %d "
+           "rows.",
+           K,
+           w_dims[0]);
+  const bool per_channel = scale_weights.size() > 1;
+  PD_CHECK(!per_channel || static_cast<int64_t>(scale_weights.size()) == N,
+           "Scale_weights of fc must hold 1 or %d values, but holds %d.",
+           N,
+           scale_weights.size());
+  PD_CHECK(scale_in != 0.0f, "Scale_in of fc must not be 0.");
+
+  // acc * scale[n] brings the int32 dot products back to real values.
+  std::vector<float> scale(scale_weights.size());
+  for (size_t n = 0; n < scale.size(); ++n) {
+    PD_CHECK(scale_weights[n] != 0.0f, "Scale_weights of fc must not be 0.");
+    scale[n] = 1.0f / (scale_in * scale_weights[n]);
+  }
+  const float* bias_data = bias ? bias->data<float>() : nullptr;
+  out_dims.push_back(N);
+  out->Resize(out_dims);
+
+  quant::PackedA packed_input;
+  quant::PackedB packed_w;
+  quant::PackA(false, M, K, input.data<T>(), &packed_input);
+  quant::PackB(false, K, N, w.data<T>(), &packed_w);
+  if (force_fp32_output) {
+    auto out_data = dev_ctx.template Alloc<float>(out);
+    quant::Int8Gemm(packed_input,
+                    packed_w,
+                    quant::DequantizeEpilogue<float>{
+                        out_data, N, scale.data(), per_channel, bias_data});
+  } else {
+    std::vector<float> offset;
+    if (bias_data) {
+      offset.resize(N);
+      for (int64_t n = 0; n < N; ++n) offset[n] = bias_data[n] * scale_out;
+    }
+    for (auto& s : scale) s *= scale_out;
+    auto out_data = dev_ctx.template Alloc<int8_t>(out);
+    quant::Int8Gemm(packed_input,
+                    packed_w,
+                    quant::RequantizeEpilogue<int8_t>{
+                        out_data,
+                        N,
+                        scale.data(),
+                        per_channel,
+                        bias_data ? offset.data() : nullptr,
+                        0.0f});
+  }
+  if (activation_type == "relu") {
+    if (force_fp32_output) {
+      auto out_data = out->data<float>();
+      for (int64_t i = 0; i < M * N; ++i) {
+        out_data[i] = std::max(out_data[i], 0.0f);
+      }
+    } else {
+      auto out_data = out->data<int8_t>();
+      for (int64_t i = 0; i < M * N; ++i) {
+        out_data[i] = std::max<int8_t>(out_data[i], 0);
+      }
+    }
+  }
+}
+
 template <typename T>
 void MatmulGradKernel(const phi::Context& dev_ctx,
                       const phi::DenseTensor& x,
@@ -545,7 +722,17 @@ PD_BUILD_PHI_KERNEL(matmul,
                     custom_kernel::MatmulKernel,
                     phi::dtype::float16,
                     float,
-                    double) {}
+                    double,
+                    int8_t) {
+  if (kernel_key.dtype() == phi::DataType::INT8) {
+    kernel->OutputAt(0).SetDataType(phi::DataType::INT32);
+  }
+}
+
+PD_BUILD_PHI_KERNEL(
+    fc, custom_cpu, ALL_LAYOUT, custom_kernel::FCKernel, int8_t) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::UNDEFINED);
+}
 
 PD_BUILD_PHI_KERNEL(matmul_grad,
                     custom_cpu,
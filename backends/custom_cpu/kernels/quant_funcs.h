@@ -0,0 +1,344 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CUSTOM_CPU_VNNI_DISPATCH
+#define CUSTOM_CPU_VNNI_TARGET \
+  __attribute__((target("avx512f,avx512bw,avx512vnni")))
+#endif
+
+namespace custom_kernel {
+namespace quant {
+
+// Both packed operands are padded along K to this many bytes, so the dot
+// product loops never need a tail and the VNNI path can use full 512-bit
+// loads.
+constexpr int64_t kPackAlignK = 64;
+
+inline int64_t PaddedK(int64_t k) {
+  return (k + kPackAlignK - 1) / kPackAlignK * kPackAlignK;
+}
+
+// The VNNI kernels are compiled for that target whatever -march the plugin
+// is built with, and only run when the CPU reports AVX512-VNNI.
+inline bool HasVnni() {
+#ifdef CUSTOM_CPU_VNNI_DISPATCH
+  static const bool has_vnni = __builtin_cpu_supports("avx512vnni") &&
+                               __builtin_cpu_supports("avx512bw");
+  return has_vnni;
+#else
+  return false;
+#endif
+}
+
+template <typename T>
+inline T SaturateCast(float v) {
+  v = std::nearbyint(v);
+  v = std::min(v, static_cast<float>(std::numeric_limits<T>::max()));
+  v = std::max(v, static_cast<float>(std::numeric_limits<T>::lowest()));
+  return static_cast<T>(v);
+}
+
+// A (M x K, or K x M when trans_a) repacked row-major with padded K. The
+// VNNI instruction multiplies unsigned by signed bytes, so on that path the
+// rows are stored as a + 128 and the bias is removed with the column sums of
+// B (see PackedB::comp).
+struct PackedA {
+  int64_t rows = 0;
+  int64_t ld = 0;
+  bool vnni = false;
+  std::vector<uint8_t> data;
+};
+
+// B (K x N, or N x K when trans_b) repacked as N rows of padded K, so every
+// output element is one contiguous dot product.
+struct PackedB {
+  int64_t cols = 0;
+  int64_t ld = 0;
+  std::vector<int8_t> data;
+  // 128 * sum_k(B[k][n]), only needed to undo the unsigned shift of A.
+  std::vector<int32_t> comp;
+};
+
+inline void PackA(bool trans_a,
+                  int64_t M,
+                  int64_t K,
+                  const int8_t* a,
+                  PackedA* packed) {
+  packed->rows = M;
+  packed->ld = PaddedK(K);
+  packed->vnni = HasVnni();
+  const uint8_t shift = packed->vnni ? 128 : 0;
+  packed->data.assign(M * packed->ld, shift);
+  for (int64_t m = 0; m < M; ++m) {
+    auto* dst = packed->data.data() + m * packed->ld;
+    for (int64_t k = 0; k < K; ++k) {
+      int8_t v = trans_a ? a[k * M + m] : a[m * K + k];
+      dst[k] = static_cast<uint8_t>(v) + shift;
+    }
+  }
+}
+
+inline void PackB(bool trans_b,
+                  int64_t K,
+                  int64_t N,
+                  const int8_t* b,
+                  PackedB* packed) {
+  packed->cols = N;
+  packed->ld = PaddedK(K);
+  packed->data.assign(N * packed->ld, 0);
+  packed->comp.assign(N, 0);
+  for (int64_t n = 0; n < N; ++n) {
+    auto* dst = packed->data.data() + n * packed->ld;
+    int32_t sum = 0;
+    if (trans_b) {
+      std::memcpy(dst, b + n * K, K);
+      for (int64_t k = 0; k < K; ++k) sum += dst[k];
+    } else {
+      for (int64_t k = 0; k < K; ++k) {
+        dst[k] = b[k * N + n];
+        sum += dst[k];
+      }
+    }
+    packed->comp[n] = 128 * sum;
+  }
+}
+
+// Portable kernels: widening to int16 products keeps the inner loop in a
+// form compilers lower to pmaddwd/sdot.
+struct PortableDot {
+  static int32_t Dot(const uint8_t* a, const int8_t* b, int64_t k_padded) {
+    int32_t acc = 0;
+    for (int64_t k = 0; k < k_padded; ++k) {
+      acc += static_cast<int16_t>(static_cast<int8_t>(a[k])) *
+             static_cast<int16_t>(b[k]);
+    }
+    return acc;
+  }
+
+  static void DotRow4(const uint8_t* a,
+                      const int8_t* b,
+                      int64_t ld,
+                      int64_t k_padded,
+                      int32_t* acc) {
+    for (int j = 0; j < 4; ++j) acc[j] = Dot(a, b + j * ld, k_padded);
+  }
+};
+
+#ifdef CUSTOM_CPU_VNNI_DISPATCH
+struct VnniDot {
+  CUSTOM_CPU_VNNI_TARGET static int32_t Dot(const uint8_t* a,
+                                            const int8_t* b,
+                                            int64_t k_padded) {
+    __m512i c = _mm512_setzero_si512();
+    for (int64_t k = 0; k < k_padded; k += kPackAlignK) {
+      c = _mm512_dpbusd_epi32(
+          c, _mm512_loadu_si512(a + k), _mm512_loadu_si512(b + k));
+    }
+    return _mm512_reduce_add_epi32(c);
+  }
+
+  // Computes a row of A against four columns of B so each load of A is
+  // reused four times.
+  CUSTOM_CPU_VNNI_TARGET static void DotRow4(const uint8_t* a,
+                                             const int8_t* b,
+                                             int64_t ld,
+                                             int64_t k_padded,
+                                             int32_t* acc) {
+    __m512i c0 = _mm512_setzero_si512();
+    __m512i c1 = _mm512_setzero_si512();
+    __m512i c2 = _mm512_setzero_si512();
+    __m512i c3 = _mm512_setzero_si512();
+    for (int64_t k = 0; k < k_padded; k += kPackAlignK) {
+      __m512i va = _mm512_loadu_si512(a + k);
+      c0 = _mm512_dpbusd_epi32(c0, va, _mm512_loadu_si512(b + k));
+      c1 = _mm512_dpbusd_epi32(c1, va, _mm512_loadu_si512(b + ld + k));
+      c2 = _mm512_dpbusd_epi32(c2, va, _mm512_loadu_si512(b + 2 * ld + k));
+      c3 = _mm512_dpbusd_epi32(c3, va, _mm512_loadu_si512(b + 3 * ld + k));
+    }
+    acc[0] = _mm512_reduce_add_epi32(c0);
+    acc[1] = _mm512_reduce_add_epi32(c1);
+    acc[2] = _mm512_reduce_add_epi32(c2);
+    acc[3] = _mm512_reduce_add_epi32(c3);
+  }
+};
+#endif
+
+// Epilogues receive the exact int32 dot product for (m, n).
+
+struct StoreInt32 {
+  int32_t* out;
+  int64_t ldc;
+
+  void operator()(int64_t m, int64_t n, int32_t acc) const {
+    out[m * ldc + n] = acc;
+  }
+};
+
+// out = acc * scale[n] (+ bias[n]). scale holds one value when per_channel is
+// false.
+template <typename OutT>
+struct DequantizeEpilogue {
+  OutT* out;
+  int64_t ldc;
+  const float* scale;
+  bool per_channel;
+  const float* bias;
+
+  void operator()(int64_t m, int64_t n, int32_t acc) const {
+    float v = static_cast<float>(acc) * scale[per_channel ? n : 0];
+    if (bias) v += bias[n];
+    out[m * ldc + n] = static_cast<OutT>(v);
+  }
+};
+
+// out = saturate(round(acc * multiplier[n] (+ offset[n]) + shift)), which
+// moves acc to the scale of OutT in one step. multiplier holds one value when
+// per_channel is false.
+template <typename OutT>
+struct RequantizeEpilogue {
+  OutT* out;
+  int64_t ldc;
+  const float* multiplier;
+  bool per_channel;
+  const float* offset;
+  float shift;
+
+  void operator()(int64_t m, int64_t n, int32_t acc) const {
+    float v = static_cast<float>(acc) * multiplier[per_channel ? n : 0] + shift;
+    if (offset) v += offset[n];
+    out[m * ldc + n] = SaturateCast<OutT>(v);
+  }
+};
+
+template <typename Kernel, typename Epilogue>
+void Int8GemmRows(const PackedA& a,
+                  const PackedB& b,
+                  const Epilogue& epilogue) {
+  const int64_t M = a.rows;
+  const int64_t N = b.cols;
+  const int64_t kp = a.ld;
+  const int64_t n4 = N / 4 * 4;
+  const bool shifted = a.vnni;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (M * N * kp > (1 << 16))
+#endif
+  for (int64_t m = 0; m < M; ++m) {
+    const uint8_t* a_row = a.data.data() + m * kp;
+    int32_t acc[4];
+    for (int64_t n = 0; n < n4; n += 4) {
+      Kernel::DotRow4(a_row, b.data.data() + n * kp, kp, kp, acc);
+      for (int j = 0; j < 4; ++j) {
+        if (shifted) acc[j] -= b.comp[n + j];
+        epilogue(m, n + j, acc[j]);
+      }
+    }
+    for (int64_t n = n4; n < N; ++n) {
+      int32_t v = Kernel::Dot(a_row, b.data.data() + n * kp, kp);
+      if (shifted) v -= b.comp[n];
+      epilogue(m, n, v);
+    }
+  }
+}
+
+// C = A * B with int8 operands and exact int32 accumulation. Rows of C are
+// independent and distributed across threads. The kernel follows the way A
+// was packed.
+template <typename Epilogue>
+void Int8Gemm(const PackedA& a, const PackedB& b, const Epilogue& epilogue) {
+#ifdef CUSTOM_CPU_VNNI_DISPATCH
+  if (a.vnni) {
+    Int8GemmRows<VnniDot>(a, b, epilogue);
+    return;
+  }
+#endif
+  Int8GemmRows<PortableDot>(a, b, epilogue);
+}
+
+template <typename Epilogue>
+void Int8Gemm(bool trans_a,
+              bool trans_b,
+              int64_t M,
+              int64_t K,
+              int64_t N,
+              const int8_t* a,
+              const int8_t* b,
+              const Epilogue& epilogue) {
+  PackedA packed_a;
+  PackedB packed_b;
+  PackA(trans_a, M, K, a, &packed_a);
+  PackB(trans_b, K, N, b, &packed_b);
+  Int8Gemm(packed_a, packed_b, epilogue);
+}
+
+// q = saturate(round(x * scale + shift)). inner is the number of contiguous
+// elements sharing one channel; scale/shift hold one value per channel when
+// channels > 1.
+template <typename T, typename OutT>
+void Quantize(const T* x,
+              int64_t outer,
+              int64_t channels,
+              int64_t inner,
+              const float* scale,
+              float shift,
+              OutT* out) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (outer * channels * inner > \
+                                              (1 << 16))
+#endif
+  for (int64_t i = 0; i < outer * channels; ++i) {
+    const float s = scale[i % channels];
+    const T* src = x + i * inner;
+    OutT* dst = out + i * inner;
+    for (int64_t j = 0; j < inner; ++j) {
+      dst[j] = SaturateCast<OutT>(static_cast<float>(src[j]) * s + shift);
+    }
+  }
+}
+
+// x = (q - shift) / scale, the inverse of Quantize.
+template <typename InT, typename T>
+void Dequantize(const InT* q,
+                int64_t outer,
+                int64_t channels,
+                int64_t inner,
+                const float* scale,
+                float shift,
+                T* out) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (outer * channels * inner > \
+                                              (1 << 16))
+#endif
+  for (int64_t i = 0; i < outer * channels; ++i) {
+    const float inv = 1.0f / scale[i % channels];
+    const InT* src = q + i * inner;
+    T* dst = out + i * inner;
+    for (int64_t j = 0; j < inner; ++j) {
+      dst[j] = static_cast<T>((static_cast<float>(src[j]) - shift) * inv);
+    }
+  }
+}
+
+}  // namespace quant
+}  // namespace custom_kernel
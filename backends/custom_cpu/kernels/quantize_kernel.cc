@@ -0,0 +1,107 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/quant_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+// Follows the int8 inference ops: q = round(x * scale + shift), saturated to
+// int8, or to uint8 when the input is known to be non-negative or shifted.
+template <typename T>
+void QuantizeKernel(const phi::Context& dev_ctx,
+                    const phi::DenseTensor& x,
+                    bool is_negative_input,
+                    float scale,
+                    float shift,
+                    const std::string& output_format,
+                    bool bfloat16,
+                    phi::DenseTensor* out) {
+  PD_CHECK(scale != 0.0f, "Quantization scale must not be 0.");
+  PD_CHECK(!bfloat16, "bfloat16 quantization is not supported on custom_cpu.");
+  auto numel = x.numel();
+  out->Resize(x.dims());
+  if (is_negative_input && shift == 0.0f) {
+    auto out_data = dev_ctx.template Alloc<int8_t>(out);
+    quant::Quantize(x.data<T>(), 1, 1, numel, &scale, shift, out_data);
+  } else {
+    auto out_data = dev_ctx.template Alloc<uint8_t>(out);
+    quant::Quantize(x.data<T>(), 1, 1, numel, &scale, shift, out_data);
+  }
+}
+
+template <typename T>
+void DeQuantizeKernel(const phi::Context& dev_ctx,
+                      const phi::DenseTensor& x,
+                      float scale,
+                      float shift,
+                      phi::DenseTensor* out) {
+  PD_CHECK(scale != 0.0f, "Dequantization scale must not be 0.");
+  out->Resize(x.dims());
+  auto out_data = dev_ctx.template Alloc<float>(out);
+  quant::Dequantize(x.data<T>(), 1, 1, x.numel(), &scale, shift, out_data);
+}
+
+// Rescales quantized values without a round trip through float tensors:
+// out = round((x - shift_in) * scale_out / scale_in + shift_out).
+template <typename T>
+void ReQuantizeKernel(const phi::Context& dev_ctx,
+                      const phi::DenseTensor& x,
+                      float scale_in,
+                      float scale_out,
+                      float shift_in,
+                      float shift_out,
+                      phi::DenseTensor* out) {
+  PD_CHECK(scale_in != 0.0f, "Requantization Scale_in must not be 0.");
+  out->Resize(x.dims());
+  auto x_data = x.data<T>();
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  auto numel = x.numel();
+  const float multiplier = scale_out / scale_in;
+  const float shift = shift_out - shift_in * multiplier;
+  // The step the int8 GEMMs end with, applied to a single row.
+  const quant::RequantizeEpilogue<T> requantize{
+      out_data, 0, &multiplier, false, nullptr, shift};
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (numel > (1 << 16))
+#endif
+  for (int64_t i = 0; i < numel; ++i) {
+    requantize(0, i, x_data[i]);
+  }
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(quantize,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::QuantizeKernel,
+                    float) {}
+
+PD_BUILD_PHI_KERNEL(dequantize,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::DeQuantizeKernel,
+                    int8_t,
+                    uint8_t) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::FLOAT32);
+}
+
+PD_BUILD_PHI_KERNEL(requantize,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ReQuantizeKernel,
+                    int8_t,
+                    uint8_t) {}
@@ -0,0 +1,110 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/index_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void ScatterKernel(const phi::Context& dev_ctx,
+                   const phi::DenseTensor& x,
+                   const phi::DenseTensor& index,
+                   const phi::DenseTensor& updates,
+                   bool overwrite,
+                   phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  int rank = x_dims.size();
+  auto rows = funcs::ReadIndex(index, x_dims[0], false, "scatter");
+  auto slice = funcs::Product(x_dims, 1, rank);
+  PD_CHECK(updates.numel() == static_cast<int64_t>(rows.size()) * slice,
+           "The size of Updates (%d) of scatter must be equal to the size of "
+           "Index (%d) times the slice size of X (%d).",
+           updates.numel(),
+           rows.size(),
+           slice);
+
+  out->Resize(x_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  memcpy(out_data, x.data<T>(), x.numel() * sizeof(T));
+  if (rows.empty()) return;
+
+  funcs::ScatterRows(
+      updates.data<T>(), rows, 1, x_dims[0], slice, overwrite, true, out_data);
+}
+
+template <typename T>
+void ScatterGradKernel(const phi::Context& dev_ctx,
+                       const phi::DenseTensor& index,
+                       const phi::DenseTensor& updates,
+                       const phi::DenseTensor& out_grad,
+                       bool overwrite,
+                       phi::DenseTensor* x_grad,
+                       phi::DenseTensor* updates_grad) {
+  auto dims = out_grad.dims();
+  int rank = dims.size();
+  auto rows = funcs::ReadIndex(index, dims[0], false, "scatter_grad");
+  auto slice = funcs::Product(dims, 1, rank);
+  auto out_grad_data = out_grad.data<T>();
+
+  if (x_grad) {
+    // Every row that was scattered into no longer depends on X.
+    x_grad->Resize(dims);
+    auto x_grad_data = dev_ctx.template Alloc<T>(x_grad);
+    memcpy(x_grad_data, out_grad_data, out_grad.numel() * sizeof(T));
+    for (auto row : rows) {
+      memset(x_grad_data + row * slice, 0, slice * sizeof(T));
+    }
+  }
+
+  if (updates_grad) {
+    updates_grad->Resize(updates.dims());
+    auto updates_grad_data = dev_ctx.template Alloc<T>(updates_grad);
+    if (overwrite) {
+      // Only the last update of a duplicated row reached the output.
+      memset(updates_grad_data, 0, updates_grad->numel() * sizeof(T));
+      funcs::RowSegments segments(rows);
+      for (int64_t s = 0; s < segments.size(); ++s) {
+        auto pos = segments.position(segments.end(s) - 1);
+        memcpy(updates_grad_data + pos * slice,
+               out_grad_data + segments.row(s) * slice,
+               slice * sizeof(T));
+      }
+    } else {
+      funcs::GatherRows(
+          out_grad_data, dims[0], rows, 1, slice, updates_grad_data);
+    }
+  }
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(scatter,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ScatterKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
+
+PD_BUILD_PHI_KERNEL(scatter_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::ScatterGradKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
@@ -0,0 +1,121 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/copy_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void SplitWithSections(const phi::Context& dev_ctx,
+                       const phi::DenseTensor& x,
+                       std::vector<int64_t> sections,
+                       int axis,
+                       std::vector<phi::DenseTensor*> outs) {
+  auto x_dims = x.dims();
+  int64_t known = 0;
+  int unknown_idx = -1;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    if (sections[i] == -1) {
+      PD_CHECK(unknown_idx == -1,
+               "Only one dimension value of Attr(num_or_sections) in "
+               "SplitOp can be -1.");
+      unknown_idx = i;
+    } else {
+      known += sections[i];
+    }
+  }
+  if (unknown_idx != -1) {
+    sections[unknown_idx] = x_dims[axis] - known;
+  }
+
+  int64_t outer, inner;
+  funcs::SplitDimsAtAxis(x_dims, axis, &outer, &inner);
+  int64_t slice = inner / std::max<int64_t>(x_dims[axis], 1);
+
+  std::vector<char*> pieces;
+  std::vector<size_t> piece_bytes;
+  for (size_t i = 0; i < outs.size(); ++i) {
+    auto out_dims = x_dims;
+    out_dims[axis] = sections[i];
+    char* dst = nullptr;
+    if (outs[i]) {
+      outs[i]->Resize(out_dims);
+      dst = reinterpret_cast<char*>(dev_ctx.template Alloc<T>(outs[i]));
+    }
+    pieces.push_back(dst);
+    piece_bytes.push_back(sections[i] * slice * sizeof(T));
+  }
+  if (x.numel() == 0) return;
+  funcs::BuildSplitPlan(
+      reinterpret_cast<const char*>(x.data<T>()), piece_bytes, outer, pieces)
+      .Execute();
+}
+
+template <typename T>
+void SplitKernel(const phi::Context& dev_ctx,
+                 const phi::DenseTensor& x,
+                 const phi::IntArray& num_or_sections,
+                 const phi::Scalar& axis_scalar,
+                 std::vector<phi::DenseTensor*> outs) {
+  int axis =
+      phi::funcs::CanonicalAxis(axis_scalar.to<int>(), x.dims().size());
+  SplitWithSections<T>(dev_ctx, x, num_or_sections.GetData(), axis, outs);
+}
+
+template <typename T>
+void SplitWithNumKernel(const phi::Context& dev_ctx,
+                        const phi::DenseTensor& x,
+                        int num,
+                        const phi::Scalar& axis_scalar,
+                        std::vector<phi::DenseTensor*> outs) {
+  auto x_dims = x.dims();
+  int axis = phi::funcs::CanonicalAxis(axis_scalar.to<int>(), x_dims.size());
+  PD_CHECK(num > 0 && x_dims[axis] % num == 0,
+           "The input's size along the split dimension must be evenly "
+           "divisible by Attr(num_or_sections). But received Attr(num) = %d, "
+           "input(X)'s shape = [%s], Attr(dim) = %d.",
+           num,
+           phi::to_string(x_dims),
+           axis);
+  std::vector<int64_t> sections(num, x_dims[axis] / num);
+  SplitWithSections<T>(dev_ctx, x, sections, axis, outs);
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(split,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SplitKernel,
+                    bool,
+                    uint8_t,
+                    int8_t,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(split_with_num,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::SplitWithNumKernel,
+                    bool,
+                    uint8_t,
+                    int8_t,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
@@ -0,0 +1,138 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/copy_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void StackKernel(const phi::Context& dev_ctx,
+                 const std::vector<const phi::DenseTensor*>& x,
+                 int axis,
+                 phi::DenseTensor* out) {
+  PD_CHECK(!x.empty(), "The number of inputs of stack must be > 0.");
+  auto x_dims = x[0]->dims();
+  axis = phi::funcs::CanonicalAxis(axis, x_dims.size() + 1);
+
+  auto out_dims = x_dims;
+  out_dims.insert(out_dims.begin() + axis, x.size());
+  out->Resize(out_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  int64_t outer, inner;
+  funcs::SplitDimsAtAxis(x_dims, axis, &outer, &inner);
+  std::vector<const char*> pieces;
+  for (auto in : x) {
+    PD_CHECK(in->dims() == x_dims,
+             "All inputs of stack must have the same shape [%s], but got "
+             "[%s].",
+             phi::to_string(x_dims),
+             phi::to_string(in->dims()));
+    pieces.push_back(reinterpret_cast<const char*>(in->data<T>()));
+  }
+  std::vector<size_t> piece_bytes(x.size(), inner * sizeof(T));
+  funcs::BuildJoinPlan(
+      pieces, piece_bytes, outer, reinterpret_cast<char*>(out_data))
+      .Execute();
+}
+
+template <typename T>
+void UnStackKernel(const phi::Context& dev_ctx,
+                   const phi::DenseTensor& x,
+                   int axis,
+                   int num,
+                   std::vector<phi::DenseTensor*> outs) {
+  auto x_dims = x.dims();
+  axis = phi::funcs::CanonicalAxis(axis, x_dims.size());
+  auto out_dims = x_dims;
+  out_dims.erase(out_dims.begin() + axis);
+
+  int64_t outer, inner;
+  funcs::SplitDimsAtAxis(out_dims, axis, &outer, &inner);
+  std::vector<char*> pieces;
+  for (auto out : outs) {
+    char* dst = nullptr;
+    if (out) {
+      out->Resize(out_dims);
+      dst = reinterpret_cast<char*>(dev_ctx.template Alloc<T>(out));
+    }
+    pieces.push_back(dst);
+  }
+  if (x.numel() == 0) return;
+  std::vector<size_t> piece_bytes(outs.size(), inner * sizeof(T));
+  funcs::BuildSplitPlan(
+      reinterpret_cast<const char*>(x.data<T>()), piece_bytes, outer, pieces)
+      .Execute();
+}
+
+template <typename T>
+void StackGradKernel(const phi::Context& dev_ctx,
+                     const phi::DenseTensor& out_grad,
+                     int axis,
+                     std::vector<phi::DenseTensor*> x_grad) {
+  UnStackKernel<T>(dev_ctx, out_grad, axis, x_grad.size(), x_grad);
+}
+
+template <typename T>
+void UnStackGradKernel(const phi::Context& dev_ctx,
+                       const std::vector<const phi::DenseTensor*>& out_grad,
+                       int axis,
+                       phi::DenseTensor* x_grad) {
+  StackKernel<T>(dev_ctx, out_grad, axis, x_grad);
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(stack,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::StackKernel,
+                    bool,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(stack_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::StackGradKernel,
+                    bool,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(unstack,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::UnStackKernel,
+                    bool,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
+
+PD_BUILD_PHI_KERNEL(unstack_grad,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::UnStackGradKernel,
+                    bool,
+                    int32_t,
+                    int64_t,
+                    float,
+                    double) {}
@@ -0,0 +1,68 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/index_funcs.h"
+#include "paddle/phi/capi/all.h"
+#include "phi_funcs.h"
+
+namespace custom_kernel {
+
+template <typename T>
+void TakeAlongAxisKernel(const phi::Context& dev_ctx,
+                         const phi::DenseTensor& x,
+                         const phi::DenseTensor& index,
+                         int axis,
+                         phi::DenseTensor* out) {
+  auto x_dims = x.dims();
+  auto index_dims = index.dims();
+  int rank = x_dims.size();
+  PD_CHECK(index_dims.size() == rank,
+           "The rank of Index (%d) of take_along_axis must be equal to the "
+           "rank of Input (%d).",
+           index_dims.size(),
+           rank);
+  axis = phi::funcs::CanonicalAxis(axis, rank);
+  for (int i = 0; i < rank; ++i) {
+    PD_CHECK(i == axis || index_dims[i] == x_dims[i],
+             "Index and Input of take_along_axis must have the same size on "
+             "dimension %d except the axis, but got %d and %d.",
+             i,
+             index_dims[i],
+             x_dims[i]);
+  }
+  auto ids = funcs::ReadIndex(index, x_dims[axis], true, "take_along_axis");
+
+  out->Resize(index_dims);
+  auto out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  funcs::GatherElements(x.data<T>(),
+                        x_dims[axis],
+                        ids,
+                        funcs::Product(x_dims, 0, axis),
+                        index_dims[axis],
+                        funcs::Product(x_dims, axis + 1, rank),
+                        out_data);
+}
+
+}  // namespace custom_kernel
+
+PD_BUILD_PHI_KERNEL(take_along_axis,
+                    custom_cpu,
+                    ALL_LAYOUT,
+                    custom_kernel::TakeAlongAxisKernel,
+                    float,
+                    double,
+                    int32_t,
+                    int64_t) {}
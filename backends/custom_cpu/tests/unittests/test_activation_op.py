@@ -0,0 +1,301 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import math
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle
+
+paddle.enable_static()
+
+
+def get_places(self):
+    return [paddle.CustomPlace('custom_cpu', 0)]
+
+
+OpTest._get_places = get_places
+
+
+
+def gelu(x, approximate):
+    if approximate:
+        y = 0.5 * x * (1.0 + np.tanh(
+            np.sqrt(2 / np.pi) * (x + 0.044715 * np.power(x, 3))))
+    else:
+        erf = np.vectorize(math.erf)
+        y = 0.5 * x * (1 + erf(x / np.sqrt(2)))
+    return y.astype(x.dtype)
+
+
+class TestActivation(OpTest):
+    def setUp(self):
+        self.op_type = "exp"
+        self.init_dtype()
+        self.init_kernel_type()
+
+        np.random.seed(2049)
+        x = np.random.uniform(0.1, 1, [11, 17]).astype(self.dtype)
+        out = np.exp(x)
+
+        self.inputs = {'X': OpTest.np_dtype_to_fluid_dtype(x)}
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out')
+
+    def init_dtype(self):
+        self.dtype = np.float32
+
+    def init_kernel_type(self):
+        pass
+
+
+class TestActivationFP64(TestActivation):
+    def init_dtype(self):
+        self.dtype = np.float64
+
+
+class TestRelu(TestActivation):
+    def setUp(self):
+        self.op_type = "relu"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        # The same reason with TestAbs
+        x[np.abs(x) < 0.005] = 0.02
+        out = np.maximum(x, 0)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+
+
+class TestLeakyRelu(TestActivation):
+    def get_alpha(self):
+        return 0.02
+
+    def setUp(self):
+        self.op_type = "leaky_relu"
+        self.init_dtype()
+        alpha = self.get_alpha()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        # The same reason with TestAbs
+        x[np.abs(x) < 0.005] = 0.05
+        out = np.where(x > 0, x, alpha * x)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {'alpha': alpha}
+
+
+class TestLeakyReluAlpha(TestLeakyRelu):
+    def get_alpha(self):
+        return -2.0
+
+
+class TestSigmoid(TestActivation):
+    def setUp(self):
+        self.op_type = "sigmoid"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        out = 1 / (1 + np.exp(-x))
+
+        self.inputs = {'X': OpTest.np_dtype_to_fluid_dtype(x)}
+        self.outputs = {'Out': out}
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out', max_relative_error=0.01)
+
+
+class TestSigmoidLarge(TestSigmoid):
+    def setUp(self):
+        self.op_type = "sigmoid"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-100, 100, [4, 5000]).astype(self.dtype)
+        out = 1 / (1 + np.exp(-x.astype(np.float64)))
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out.astype(self.dtype)}
+
+    def test_check_grad(self):
+        pass
+
+
+class TestTanh(TestActivation):
+    def setUp(self):
+        self.op_type = "tanh"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        out = np.tanh(x)
+
+        self.inputs = {'X': OpTest.np_dtype_to_fluid_dtype(x)}
+        self.outputs = {'Out': out}
+
+
+class TestTanhLarge(TestActivation):
+    def setUp(self):
+        self.op_type = "tanh"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        # Covers both sides of the polynomial / exp split and saturation.
+        x = np.random.uniform(-20, 20, [4, 5000]).astype(self.dtype)
+        out = np.tanh(x.astype(np.float64)).astype(self.dtype)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+
+    def test_check_grad(self):
+        pass
+
+
+class TestSilu(TestActivation):
+    def setUp(self):
+        self.op_type = "silu"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        out = x / (np.exp(-x) + 1)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+
+
+class TestExpLarge(TestActivation):
+    def setUp(self):
+        self.op_type = "exp"
+        self.init_dtype()
+
+        np.random.seed(1024)
+        x = np.random.uniform(-80, 80, [4, 5000]).astype(self.dtype)
+        out = np.exp(x.astype(np.float64)).astype(self.dtype)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+
+    def test_check_grad(self):
+        pass
+
+
+class TestGeluApproximate(TestActivation):
+    def setUp(self):
+        self.op_type = "gelu"
+        self.init_dtype()
+        approximate = True
+
+        np.random.seed(1024)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        out = gelu(x, approximate)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {"approximate": approximate}
+
+
+class TestGelu(TestActivation):
+    def setUp(self):
+        self.op_type = "gelu"
+        self.init_dtype()
+        approximate = False
+
+        np.random.seed(2048)
+        x = np.random.uniform(-1, 1, [11, 17]).astype(self.dtype)
+        out = gelu(x, approximate)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {"approximate": approximate}
+
+
+class TestGeluLarge(TestActivation):
+    def setUp(self):
+        self.op_type = "gelu"
+        self.init_dtype()
+        approximate = False
+
+        np.random.seed(2048)
+        # Covers both the polynomial and the exp based branches of erf.
+        x = np.random.uniform(-8, 8, [4, 5000]).astype(self.dtype)
+        out = gelu(x.astype(np.float64), approximate).astype(self.dtype)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {"approximate": approximate}
+
+    def test_check_grad(self):
+        pass
+
+
+class TestGeluInf(TestActivation):
+    def setUp(self):
+        self.op_type = "gelu"
+        self.init_dtype()
+        approximate = False
+
+        # erf saturates past the end of its fit at |x| / sqrt(2) = 10, for
+        # huge finite inputs and at +-inf; gelu(-inf) is -inf * 0 = nan.
+        x = np.array(
+            [np.inf, -np.inf, 3.4e38, -3.4e38, 1e30, -1e30, 1e6, -1e6,
+             14.1, -14.1, 14.2, -14.2, 20, -20, 8, -8],
+            dtype=self.dtype).reshape([4, 4])
+        with np.errstate(invalid='ignore', over='ignore'):
+            out = gelu(x.astype(np.float64), approximate).astype(self.dtype)
+
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {"approximate": approximate}
+
+    def test_check_output(self):
+        self.check_output(equal_nan=True)
+
+    def test_check_grad(self):
+        pass
+
+
+def create_test_fp64_class(parent):
+    class TestActFP64(parent):
+        def init_dtype(self):
+            self.dtype = np.float64
+
+    cls_name = "{0}_{1}".format(parent.__name__, "FP64")
+    TestActFP64.__name__ = cls_name
+    globals()[cls_name] = TestActFP64
+
+
+create_test_fp64_class(TestRelu)
+create_test_fp64_class(TestLeakyRelu)
+create_test_fp64_class(TestSigmoid)
+create_test_fp64_class(TestTanh)
+create_test_fp64_class(TestSilu)
+create_test_fp64_class(TestGeluApproximate)
+create_test_fp64_class(TestGelu)
+create_test_fp64_class(TestGeluInf)
+
+if __name__ == "__main__":
+    unittest.main()
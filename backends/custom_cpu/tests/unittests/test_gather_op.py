@@ -0,0 +1,120 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle
+
+paddle.enable_static()
+
+
+def get_places(self):
+    return [paddle.CustomPlace('custom_cpu', 0)]
+
+
+OpTest._get_places = get_places
+
+
+class TestGatherOp(OpTest):
+    def setUp(self):
+        self.op_type = "gather"
+        self.python_api = paddle.gather
+        self.config()
+        xnp = np.random.random(self.x_shape).astype(self.x_type)
+        self.inputs = {
+            'X': xnp,
+            'Index': np.array(self.index).astype(self.index_type)
+        }
+        self.outputs = {'Out': self.inputs["X"][self.inputs["Index"]]}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out')
+
+    def config(self):
+        self.x_shape = (10, 20)
+        self.x_type = "float64"
+        self.index = [1, 3, 5]
+        self.index_type = "int32"
+
+
+class TestGatherOpRepeatedIndex(TestGatherOp):
+    def config(self):
+        self.x_shape = (100, )
+        self.x_type = "float64"
+        self.index = [1, 3, 5, 3, 1]
+        self.index_type = "int64"
+
+
+class TestGatherOpHighRank(TestGatherOp):
+    def config(self):
+        self.x_shape = (10, 3, 4, 5)
+        self.x_type = "float64"
+        self.index = [7, 0, 9]
+        self.index_type = "int64"
+
+
+class TestGatherOpWithAxis(OpTest):
+    def setUp(self):
+        self.op_type = "gather"
+        self.python_api = paddle.gather
+        x = np.random.random((3, 88, 3)).astype("float64")
+        index = np.array([2, 0, 87]).astype("int64")
+        self.inputs = {'X': x, 'Index': index}
+        self.attrs = {'axis': 1}
+        self.outputs = {'Out': np.take(x, index, axis=1)}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out')
+
+
+class TestGatherNdOp(OpTest):
+    def setUp(self):
+        self.op_type = "gather_nd"
+        self.python_api = paddle.gather_nd
+        x = np.random.random((5, 6, 7)).astype("float64")
+        index = np.array([[1, 2], [4, 0], [1, 2]]).astype("int32")
+        self.inputs = {'X': x, 'Index': index}
+        self.outputs = {'Out': x[tuple(index.T)]}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out')
+
+
+class TestGatherNdOpFullIndex(OpTest):
+    def setUp(self):
+        self.op_type = "gather_nd"
+        self.python_api = paddle.gather_nd
+        x = np.random.random((5, 6, 7)).astype("float64")
+        index = np.array([[[1, 2, 3]], [[4, 5, 6]]]).astype("int64")
+        self.inputs = {'X': x, 'Index': index}
+        self.outputs = {'Out': x[tuple(np.moveaxis(index, -1, 0))]}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
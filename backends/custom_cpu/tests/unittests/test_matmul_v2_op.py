@@ -270,6 +270,36 @@ class TestMatMul2Dx3D_TransXY(TestMatMulOp):
         self.trans_y = True
 
 
+class TestMatMulInt8Op(OpTest):
+    def config(self):
+        self.x_shape = (3, 17, 70)
+        self.y_shape = (70, 9)
+        self.trans_x = False
+        self.trans_y = False
+
+    def setUp(self):
+        self.config()
+        self.op_type = "matmul_v2"
+        x = np.random.randint(-128, 128, self.x_shape).astype("int8")
+        y = np.random.randint(-128, 128, self.y_shape).astype("int8")
+        result = reference_matmul(
+            x.astype("int32"), y.astype("int32"), self.trans_x, self.trans_y)
+        self.inputs = {'X': x, 'Y': y}
+        self.attrs = {'trans_x': self.trans_x, 'trans_y': self.trans_y}
+        self.outputs = {'Out': result.astype("int32")}
+
+    def test_check_output(self):
+        self.check_output(check_eager=False)
+
+
+class TestMatMulInt8Op_TransXY(TestMatMulInt8Op):
+    def config(self):
+        self.x_shape = (65, 4)
+        self.y_shape = (7, 65)
+        self.trans_x = True
+        self.trans_y = True
+
+
 if __name__ == "__main__":
     paddle.enable_static()
     unittest.main()
@@ -0,0 +1,174 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle
+
+paddle.enable_static()
+
+
+def get_places(self):
+    return [paddle.CustomPlace('custom_cpu', 0)]
+
+
+OpTest._get_places = get_places
+
+
+class TestQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = 'quantize'
+        self.set_attrs()
+        x = np.random.uniform(-1, 1, self.shape).astype('float32')
+        out = np.clip(np.round(x * self.scale + self.shift), -128, 127)
+        self.inputs = {'Input': x}
+        self.attrs = {
+            'Scale': self.scale,
+            'Shift': self.shift,
+            'is_negative_input': True,
+        }
+        self.outputs = {'Output': out.astype('int8')}
+
+    def set_attrs(self):
+        self.shape = (4, 8, 16)
+        self.scale = 127.0
+        self.shift = 0.0
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestQuantizeOpSaturate(TestQuantizeOp):
+    def set_attrs(self):
+        self.shape = (2, 100)
+        self.scale = 300.0
+        self.shift = 0.0
+
+
+class TestQuantizeOpUnsigned(OpTest):
+    def setUp(self):
+        self.op_type = 'quantize'
+        self.scale = 255.0
+        x = np.random.uniform(0, 1.2, (4, 8, 16)).astype('float32')
+        out = np.clip(np.round(x * self.scale), 0, 255)
+        self.inputs = {'Input': x}
+        self.attrs = {
+            'Scale': self.scale,
+            'Shift': 0.0,
+            'is_negative_input': False,
+        }
+        self.outputs = {'Output': out.astype('uint8')}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDeQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = 'dequantize'
+        self.scale = 63.5
+        self.shift = 0.0
+        x = np.random.randint(-128, 128, (4, 8, 16)).astype('int8')
+        out = (x.astype('float32') - self.shift) / self.scale
+        self.inputs = {'Input': x}
+        self.attrs = {'Scale': self.scale, 'Shift': self.shift}
+        self.outputs = {'Output': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestReQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = 'requantize'
+        self.scale_in = 127.0
+        self.scale_out = 100.0
+        x = np.random.randint(-128, 128, (8, 32)).astype('int8')
+        out = np.clip(np.round(x * self.scale_out / self.scale_in), -128, 127)
+        self.inputs = {'Input': x}
+        self.attrs = {
+            'Scale_in': self.scale_in,
+            'Scale_out': self.scale_out,
+            'Shift_in': 0.0,
+            'Shift_out': 0.0,
+        }
+        self.outputs = {'Output': out.astype('int8')}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestInt8FcOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fc'
+        self.set_attrs()
+        x = np.random.randint(-128, 128, (2, 3, 40)).astype('int8')
+        w = np.random.randint(-128, 128, (40, 6)).astype('int8')
+        bias = np.random.uniform(-1, 1, (6,)).astype('float32')
+        acc = x.reshape(6, 40).astype('int64') @ w.astype('int64')
+        scale_weights = np.array(self.scale_weights, dtype='float32')
+        out = acc / (self.scale_in * scale_weights) + bias
+        if self.relu:
+            out = np.maximum(out, 0)
+        out = out.reshape(2, 3, 6).astype('float32')
+        if not self.force_fp32_output:
+            out = np.clip(np.round(out * self.scale_out), -128, 127)
+            out = out.astype('int8')
+        self.inputs = {'Input': x, 'W': w, 'Bias': bias}
+        self.attrs = {
+            'in_num_col_dims': 2,
+            'activation_type': 'relu' if self.relu else '',
+            'use_quantizer': True,
+            'Scale_in': self.scale_in,
+            'Scale_weights': self.scale_weights,
+            'Scale_out': self.scale_out,
+            'force_fp32_output': self.force_fp32_output,
+        }
+        self.outputs = {'Out': out}
+
+    def set_attrs(self):
+        self.scale_in = 100.0
+        self.scale_weights = [50.0, 80.0, 100.0, 120.0, 60.0, 90.0]
+        self.scale_out = 0.5
+        self.force_fp32_output = True
+        self.relu = False
+
+    def test_check_output(self):
+        # Rounding of the requantized outputs may differ by one step.
+        self.check_output(atol=1e-3 if self.force_fp32_output else 1)
+
+
+class TestInt8FcOpPerTensor(TestInt8FcOp):
+    def set_attrs(self):
+        self.scale_in = 100.0
+        self.scale_weights = [80.0]
+        self.scale_out = 0.5
+        self.force_fp32_output = True
+        self.relu = False
+
+
+class TestInt8FcOpRequantize(TestInt8FcOp):
+    def set_attrs(self):
+        self.scale_in = 100.0
+        self.scale_weights = [50.0, 80.0, 100.0, 120.0, 60.0, 90.0]
+        self.scale_out = 0.5
+        self.force_fp32_output = False
+        self.relu = True
+
+
+if __name__ == '__main__':
+    unittest.main()
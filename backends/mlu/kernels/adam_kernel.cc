@@ -17,8 +17,12 @@
 
 namespace custom_kernel {
 
+// Runs ApplyAdam for one parameter. beta1, beta2 and epsilon are device
+// tensors shared by all parameters. Nothing is read back to the host: when
+// skip_update is a device tensor the update goes to copies and Select keeps
+// either them or the inputs.
 template <typename T, typename Context>
-void AdamKernel(const Context& dev_ctx,
+void AdamUpdate(const Context& dev_ctx,
                 const phi::DenseTensor& param,
                 const phi::DenseTensor& grad,
                 const phi::DenseTensor& learning_rate,
@@ -26,57 +30,23 @@ void AdamKernel(const Context& dev_ctx,
                 const phi::DenseTensor& moment2,
                 const phi::DenseTensor& beta1_pow_in,
                 const phi::DenseTensor& beta2_pow_in,
-                const paddle::optional<phi::DenseTensor>& master_param,
-                const paddle::optional<phi::DenseTensor>& skip_update,
-                const phi::Scalar& beta1_in,
-                const phi::Scalar& beta2_in,
-                const phi::Scalar& epsilon_in,
-                bool lazy_mode,
-                int64_t min_row_size_to_use_multithread,
-                bool multi_precision,
+                const phi::DenseTensor& beta1_tensor,
+                const phi::DenseTensor& beta2_tensor,
+                const phi::DenseTensor& epsilon_tensor,
+                const phi::DenseTensor* skip_update,
                 bool use_global_beta_pow,
                 phi::DenseTensor* param_out,
                 phi::DenseTensor* moment1_out,
                 phi::DenseTensor* moment2_out,
                 phi::DenseTensor* beta1_pow_out,
-                phi::DenseTensor* beta2_pow_out,
-                phi::DenseTensor* master_param_out) {
-  bool skip_update_ = false;
-  if (skip_update.is_initialized()) {
-    PADDLE_ENFORCE_EQ(skip_update->numel(),
-                      1,
-                      phi::errors::InvalidArgument(
-                          "Input(SkipUpdate) size must be 1, but get %d",
-                          skip_update->numel()));
-    std::vector<bool> skip_update_vec;
-    TensorToVector(
-        dev_ctx, *skip_update, dev_ctx, &skip_update_vec);
-    dev_ctx.Wait();
-    skip_update_ = skip_update_vec[0];
-  }
-  
-  
-  // skip_update_=true, just copy input to output asynchronously on the device,
-  // and TensorCopy will call mutable_data
-  if (skip_update_) {
-    VLOG(4) << "Adam skip update";
-    TensorCopy(dev_ctx, param, false, param_out);
-    TensorCopy(dev_ctx, moment1, false, moment1_out);
-    TensorCopy(dev_ctx, moment2, false, moment2_out);
-    TensorCopy(dev_ctx, beta1_pow_in, false, beta1_pow_out);
-    TensorCopy(dev_ctx, beta2_pow_in, false, beta2_pow_out);
-    return;
-  }
+                phi::DenseTensor* beta2_pow_out) {
+  const phi::DenseTensor* beta1_pow = &beta1_pow_in;
+  const phi::DenseTensor* beta2_pow = &beta2_pow_in;
 
-  phi::DenseTensor* beta1_pow = const_cast<phi::DenseTensor*>(&beta1_pow_in);
-  phi::DenseTensor* beta2_pow = const_cast<phi::DenseTensor*>(&beta2_pow_in);
-
-  VLOG(4) << "use_global_beta_pow:" << use_global_beta_pow;
-  
   *param_out = param;
   *moment1_out = moment1;
   *moment2_out = moment2;
-  
+
   phi::DenseTensor beta1_pow_tmp;
   phi::DenseTensor beta2_pow_tmp;
   if (beta1_pow->place().GetType() == phi::AllocationType::CPU) {
@@ -93,78 +63,115 @@ void AdamKernel(const Context& dev_ctx,
     FillMLUTensorWithHostValue(dev_ctx, beta2, &beta2_pow_tmp);
     beta2_pow = &beta2_pow_tmp;
   }
-  
+
   VLOG(3) << "beta1_pow->numel() : " << beta1_pow->numel()
           << "beta2_pow->numel() : " << beta2_pow->numel();
   VLOG(3) << "param.numel(): " << param.numel();
-  
+
   PADDLE_ENFORCE_EQ(beta1_pow_out->numel(),
                     1,
                     phi::errors::InvalidArgument(
                         "beta1 pow output size should be 1, but received "
                         "value is:%d.",
                         beta1_pow_out->numel()));
-  
+
   PADDLE_ENFORCE_EQ(beta2_pow_out->numel(),
                     1,
                     phi::errors::InvalidArgument(
                         "beta2 pow output size should be 1, but received "
                         "value is:%d.",
                         beta2_pow_out->numel()));
-  
-  const phi::DenseTensor* beta1_tensor = nullptr;
-  const phi::DenseTensor* beta2_tensor = nullptr;
-  const phi::DenseTensor* epsilon_tensor = nullptr;
-  
-  phi::DenseTensor beta1_tmp;
-  phi::DenseTensor beta2_tmp;
-  phi::DenseTensor epsilon_tmp;
-  phi::DenseTensorMeta meta = {phi::DataType::FLOAT32, {1}};
-  beta1_tmp.set_meta(meta);
-  beta2_tmp.set_meta(meta);
-  epsilon_tmp.set_meta(meta);
 
-  T beta1 = beta1_in.to<T>();
-  dev_ctx.template Alloc<T>(&beta1_tmp);
-  FillMLUTensorWithHostValue<T>(dev_ctx, beta1, &beta1_tmp);
-  beta1_tensor = &beta1_tmp;
-
-  T beta2 = beta2_in.to<T>();
-  dev_ctx.template Alloc<T>(&beta2_tmp);
-  FillMLUTensorWithHostValue<T>(dev_ctx, beta2, &beta2_tmp);
-  beta2_tensor = &beta2_tmp;
+  // ApplyAdam updates param and moments in place. The outputs share the
+  // holders of the inputs, so with skip_update the update runs on copies in
+  // buffers of their own and Select still sees the unchanged inputs.
+  phi::DenseTensor param_next = *param_out;
+  phi::DenseTensor moment1_next = *moment1_out;
+  phi::DenseTensor moment2_next = *moment2_out;
+  if (skip_update) {
+    param_next = phi::DenseTensor();
+    moment1_next = phi::DenseTensor();
+    moment2_next = phi::DenseTensor();
+    param_next.Resize(param.dims());
+    moment1_next.Resize(moment1.dims());
+    moment2_next.Resize(moment2.dims());
+    dev_ctx.template Alloc<T>(&param_next);
+    dev_ctx.template Alloc<T>(&moment1_next);
+    dev_ctx.template Alloc<T>(&moment2_next);
+    TensorCopy(dev_ctx, param, false, &param_next);
+    TensorCopy(dev_ctx, moment1, false, &moment1_next);
+    TensorCopy(dev_ctx, moment2, false, &moment2_next);
+  }
 
-  T epsilon = epsilon_in.to<T>();
-  dev_ctx.template Alloc<T>(&epsilon_tmp);
-  FillMLUTensorWithHostValue<T>(dev_ctx, epsilon, &epsilon_tmp);
-  epsilon_tensor = &epsilon_tmp;
-  
   MLUCnnlTensorDesc param_desc(param);
   MLUCnnlTensorDesc mom1_desc(moment1);
   MLUCnnlTensorDesc mom2_desc(moment2);
   MLUCnnlTensorDesc grad_desc(grad);
   MLUCnnl::ApplyAdam(dev_ctx,
                      param_desc.get(),
-                     GetBasePtr(param_out),
+                     GetBasePtr(&param_next),
                      mom1_desc.get(),
-                     GetBasePtr(moment1_out),
+                     GetBasePtr(&moment1_next),
                      mom2_desc.get(),
-                     GetBasePtr(moment2_out),
+                     GetBasePtr(&moment2_next),
                      grad_desc.get(),
                      GetBasePtr(&grad),
                      GetBasePtr(&learning_rate),
-                     GetBasePtr(beta1_tensor),
-                     GetBasePtr(beta2_tensor),
+                     GetBasePtr(&beta1_tensor),
+                     GetBasePtr(&beta2_tensor),
                      GetBasePtr(beta1_pow),
                      GetBasePtr(beta2_pow),
-                     GetBasePtr(epsilon_tensor),
+                     GetBasePtr(&epsilon_tensor),
                      /*use_nesterov*/ false);
-  
+
+  MLUCnnlTensorDesc skip_desc;
+  if (skip_update) {
+    skip_desc = MLUCnnlTensorDesc(*skip_update);
+    MLUCnnl::Select(dev_ctx,
+                    skip_desc.get(),
+                    GetBasePtr(skip_update),
+                    param_desc.get(),
+                    GetBasePtr(&param),
+                    param_desc.get(),
+                    GetBasePtr(&param_next),
+                    param_desc.get(),
+                    GetBasePtr(param_out));
+    MLUCnnl::Select(dev_ctx,
+                    skip_desc.get(),
+                    GetBasePtr(skip_update),
+                    mom1_desc.get(),
+                    GetBasePtr(&moment1),
+                    mom1_desc.get(),
+                    GetBasePtr(&moment1_next),
+                    mom1_desc.get(),
+                    GetBasePtr(moment1_out));
+    MLUCnnl::Select(dev_ctx,
+                    skip_desc.get(),
+                    GetBasePtr(skip_update),
+                    mom2_desc.get(),
+                    GetBasePtr(&moment2),
+                    mom2_desc.get(),
+                    GetBasePtr(&moment2_next),
+                    mom2_desc.get(),
+                    GetBasePtr(moment2_out));
+  }
+
   if (!use_global_beta_pow) {
     dev_ctx.template Alloc<T>(beta1_pow_out);
     dev_ctx.template Alloc<T>(beta2_pow_out);
-  
-    MLUCnnlTensorDesc beta1_desc(*beta1_tensor);
+
+    phi::DenseTensor beta1_pow_next = *beta1_pow_out;
+    phi::DenseTensor beta2_pow_next = *beta2_pow_out;
+    if (skip_update) {
+      beta1_pow_next = phi::DenseTensor();
+      beta2_pow_next = phi::DenseTensor();
+      beta1_pow_next.Resize({1});
+      beta2_pow_next.Resize({1});
+      dev_ctx.template Alloc<T>(&beta1_pow_next);
+      dev_ctx.template Alloc<T>(&beta2_pow_next);
+    }
+
+    MLUCnnlTensorDesc beta1_desc(beta1_tensor);
     MLUCnnlOpTensorDesc mul_op_desc(
         CNNL_OP_TENSOR_MUL, ToCnnlDataType<T>(), CNNL_NOT_PROPAGATE_NAN);
 
@@ -173,9 +180,9 @@ void AdamKernel(const Context& dev_ctx,
                       beta1_desc.get(),
                       GetBasePtr(beta1_pow),
                       beta1_desc.get(),
-                      GetBasePtr(beta1_tensor),
+                      GetBasePtr(&beta1_tensor),
                       beta1_desc.get(),
-                      GetBasePtr(beta1_pow_out),
+                      GetBasePtr(&beta1_pow_next),
                       ToCnnlDataType<T>());
 
     MLUCnnl::OpTensor(dev_ctx,
@@ -183,11 +190,134 @@ void AdamKernel(const Context& dev_ctx,
                       beta1_desc.get(),
                       GetBasePtr(beta2_pow),
                       beta1_desc.get(),
-                      GetBasePtr(beta2_tensor),
+                      GetBasePtr(&beta2_tensor),
                       beta1_desc.get(),
-                      GetBasePtr(beta2_pow_out),
+                      GetBasePtr(&beta2_pow_next),
                       ToCnnlDataType<T>());
+
+    if (skip_update) {
+      MLUCnnl::Select(dev_ctx,
+                      skip_desc.get(),
+                      GetBasePtr(skip_update),
+                      beta1_desc.get(),
+                      GetBasePtr(beta1_pow),
+                      beta1_desc.get(),
+                      GetBasePtr(&beta1_pow_next),
+                      beta1_desc.get(),
+                      GetBasePtr(beta1_pow_out));
+      MLUCnnl::Select(dev_ctx,
+                      skip_desc.get(),
+                      GetBasePtr(skip_update),
+                      beta1_desc.get(),
+                      GetBasePtr(beta2_pow),
+                      beta1_desc.get(),
+                      GetBasePtr(&beta2_pow_next),
+                      beta1_desc.get(),
+                      GetBasePtr(beta2_pow_out));
+    }
+  }
+}
+
+// Returns the skip_update flag when it is known on the host, and sets
+// *device_flag instead when it lives on the device.
+inline bool HostSkipUpdate(
+    const paddle::optional<phi::DenseTensor>& skip_update,
+    const phi::DenseTensor** device_flag) {
+  *device_flag = nullptr;
+  if (!skip_update.is_initialized()) {
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(skip_update->numel(),
+                    1,
+                    phi::errors::InvalidArgument(
+                        "Input(SkipUpdate) size must be 1, but get %d",
+                        skip_update->numel()));
+  if (skip_update->place().GetType() == phi::AllocationType::CPU) {
+    return skip_update->data<bool>()[0];
+  }
+  *device_flag = skip_update.get_ptr();
+  return false;
+}
+
+template <typename T, typename Context>
+void AdamKernel(const Context& dev_ctx,
+                const phi::DenseTensor& param,
+                const phi::DenseTensor& grad,
+                const phi::DenseTensor& learning_rate,
+                const phi::DenseTensor& moment1,
+                const phi::DenseTensor& moment2,
+                const phi::DenseTensor& beta1_pow_in,
+                const phi::DenseTensor& beta2_pow_in,
+                const paddle::optional<phi::DenseTensor>& master_param,
+                const paddle::optional<phi::DenseTensor>& skip_update,
+                const phi::Scalar& beta1_in,
+                const phi::Scalar& beta2_in,
+                const phi::Scalar& epsilon_in,
+                bool lazy_mode,
+                int64_t min_row_size_to_use_multithread,
+                bool multi_precision,
+                bool use_global_beta_pow,
+                phi::DenseTensor* param_out,
+                phi::DenseTensor* moment1_out,
+                phi::DenseTensor* moment2_out,
+                phi::DenseTensor* beta1_pow_out,
+                phi::DenseTensor* beta2_pow_out,
+                phi::DenseTensor* master_param_out) {
+  const phi::DenseTensor* skip_flag = nullptr;
+  bool skip_update_ = HostSkipUpdate(skip_update, &skip_flag);
+
+  // skip_update_=true, just copy input to output asynchronously on the device,
+  // and TensorCopy will call mutable_data
+  if (skip_update_) {
+    VLOG(4) << "Adam skip update";
+    TensorCopy(dev_ctx, param, false, param_out);
+    TensorCopy(dev_ctx, moment1, false, moment1_out);
+    TensorCopy(dev_ctx, moment2, false, moment2_out);
+    TensorCopy(dev_ctx, beta1_pow_in, false, beta1_pow_out);
+    TensorCopy(dev_ctx, beta2_pow_in, false, beta2_pow_out);
+    return;
   }
+
+  VLOG(4) << "use_global_beta_pow:" << use_global_beta_pow;
+
+  phi::DenseTensor beta1_tmp;
+  phi::DenseTensor beta2_tmp;
+  phi::DenseTensor epsilon_tmp;
+  phi::DenseTensorMeta meta = {phi::DataType::FLOAT32, {1}};
+  beta1_tmp.set_meta(meta);
+  beta2_tmp.set_meta(meta);
+  epsilon_tmp.set_meta(meta);
+
+  T beta1 = beta1_in.to<T>();
+  dev_ctx.template Alloc<T>(&beta1_tmp);
+  FillMLUTensorWithHostValue<T>(dev_ctx, beta1, &beta1_tmp);
+
+  T beta2 = beta2_in.to<T>();
+  dev_ctx.template Alloc<T>(&beta2_tmp);
+  FillMLUTensorWithHostValue<T>(dev_ctx, beta2, &beta2_tmp);
+
+  T epsilon = epsilon_in.to<T>();
+  dev_ctx.template Alloc<T>(&epsilon_tmp);
+  FillMLUTensorWithHostValue<T>(dev_ctx, epsilon, &epsilon_tmp);
+
+  AdamUpdate<T, Context>(dev_ctx,
+                         param,
+                         grad,
+                         learning_rate,
+                         moment1,
+                         moment2,
+                         beta1_pow_in,
+                         beta2_pow_in,
+                         beta1_tmp,
+                         beta2_tmp,
+                         epsilon_tmp,
+                         skip_flag,
+                         use_global_beta_pow,
+                         param_out,
+                         moment1_out,
+                         moment2_out,
+                         beta1_pow_out,
+                         beta2_pow_out);
 }
 
 template <typename T, typename Context>
@@ -217,19 +347,8 @@ void AdamWKernel(const Context& dev_ctx,
                  phi::DenseTensor* beta1_pow_out,
                  phi::DenseTensor* beta2_pow_out,
                  phi::DenseTensor* master_param_outs) {
-  bool skip_update_ = false;
-  if (skip_update.is_initialized()) {
-    PADDLE_ENFORCE_EQ(skip_update->numel(),
-                      1,
-                      phi::errors::InvalidArgument(
-                          "Input(SkipUpdate) size must be 1, but get %d",
-                          skip_update->numel()));
-    std::vector<bool> skip_update_vec;
-    TensorToVector(
-        dev_ctx, *skip_update, dev_ctx, &skip_update_vec);
-    dev_ctx.Wait();
-    skip_update_ = skip_update_vec[0];
-  }
+  const phi::DenseTensor* skip_flag = nullptr;
+  bool skip_update_ = HostSkipUpdate(skip_update, &skip_flag);
 
   VLOG(3) << "Skip update" << skip_update_ << ", With decay: " << with_decay;
 
@@ -239,7 +358,30 @@ void AdamWKernel(const Context& dev_ctx,
           "Master Param is not supported on MLU"));
     } else {
       // update param with decay coeff: mul(-1 * lr, coeff * param) + param
+      // With a device skip_update the lr is replaced by 0 on skip, so param
+      // stays unchanged.
+      const phi::DenseTensor* lr = &learning_rate;
+      phi::DenseTensor lr_tmp;
       MLUCnnlTensorDesc lr_desc(learning_rate);
+      if (skip_flag) {
+        phi::DenseTensor zero;
+        zero.Resize(learning_rate.dims());
+        dev_ctx.template Alloc<T>(&zero);
+        FillMLUTensorWithHostValue<T>(dev_ctx, static_cast<T>(0), &zero);
+        lr_tmp.Resize(learning_rate.dims());
+        dev_ctx.template Alloc<T>(&lr_tmp);
+        MLUCnnlTensorDesc skip_desc(*skip_flag);
+        MLUCnnl::Select(dev_ctx,
+                        skip_desc.get(),
+                        GetBasePtr(skip_flag),
+                        lr_desc.get(),
+                        GetBasePtr(&zero),
+                        lr_desc.get(),
+                        GetBasePtr(&learning_rate),
+                        lr_desc.get(),
+                        GetBasePtr(&lr_tmp));
+        lr = &lr_tmp;
+      }
       MLUCnnlTensorDesc param_desc(param);
       MLUCnnlOpTensorDesc mul_op_desc(
           CNNL_OP_TENSOR_MUL, ToCnnlDataType<T>(), CNNL_NOT_PROPAGATE_NAN);
@@ -247,7 +389,7 @@ void AdamWKernel(const Context& dev_ctx,
       MLUCnnl::OpTensor(dev_ctx,
                         mul_op_desc.get(),
                         lr_desc.get(),
-                        GetBasePtr(&learning_rate),
+                        GetBasePtr(lr),
                         param_desc.get(),
                         GetBasePtr(&param),
                         param_desc.get(),
@@ -388,91 +530,24 @@ void MergedAdamKernel(
 
   for (size_t idx = 0; idx < param_num; idx++) {
     VLOG(4) << "[MergedAdam] loop: " << idx;
-    *param_out[idx] = *param[idx];
-    *moment1_out[idx] = *moment1[idx];
-    *moment2_out[idx] = *moment2[idx];
-    
-    phi::DenseTensor* beta1_pow_tensor = const_cast<phi::DenseTensor*>(beta1_pow[idx]);
-    phi::DenseTensor* beta2_pow_tensor = const_cast<phi::DenseTensor*>(beta2_pow[idx]);
-    phi::DenseTensor beta1_pow_tmp;
-    phi::DenseTensor beta2_pow_tmp;
-    if (beta1_pow_tensor->place().GetType() == phi::AllocationType::CPU) {
-      T beta1_pow_ = *beta1_pow_tensor->data<T>();
-      dev_ctx.template Alloc<T>(&beta1_pow_tmp);
-      FillMLUTensorWithHostValue(dev_ctx, beta1_pow_, &beta1_pow_tmp);
-      beta1_pow_tensor = &beta1_pow_tmp;
-    }
-    if (beta2_pow_tensor->place().GetType() == phi::AllocationType::CPU) {
-      T beta2_pow_ = *beta1_pow_tensor->data<T>();
-      dev_ctx.template Alloc<T>(&beta2_pow_tmp);
-      FillMLUTensorWithHostValue(dev_ctx, beta2_pow_, &beta2_pow_tmp);
-      beta1_pow_tensor = &beta2_pow_tmp;
-    }
-
-    VLOG(3) << "beta1_pow_tensor.numel() : " << beta1_pow_tensor->numel()
-            << "beta2_pow_tensor.numel() : " << beta2_pow_tensor->numel();
-    VLOG(3) << "param.numel(): " << param[idx]->numel();
-    PADDLE_ENFORCE_EQ(beta1_pow_out[idx]->numel(),
-                    1,
-                    phi::errors::InvalidArgument(
-                        "beta1 pow output size should be 1, but received "
-                        "value is:%d.",
-                        beta1_pow_out[idx]->numel()));
-
-    PADDLE_ENFORCE_EQ(beta2_pow_out[idx]->numel(),
-                    1,
-                    phi::errors::InvalidArgument(
-                        "beta2 pow output size should be 1, but received "
-                        "value is:%d.",
-                        beta2_pow_out[idx]->numel()));
-    MLUCnnlTensorDesc param_desc(*param[idx]);
-    MLUCnnlTensorDesc mom1_desc(*moment1[idx]);
-    MLUCnnlTensorDesc mom2_desc(*moment2[idx]);
-    MLUCnnlTensorDesc grad_desc(*grad[idx]);
-    MLUCnnl::ApplyAdam(dev_ctx,
-                       param_desc.get(),
-                       GetBasePtr(param_out[idx]),
-                       mom1_desc.get(),
-                       GetBasePtr(moment1_out[idx]),
-                       mom2_desc.get(),
-                       GetBasePtr(moment2_out[idx]),
-                       grad_desc.get(),
-                       GetBasePtr(grad[idx]),
-                       GetBasePtr(learning_rate[idx]),
-                       GetBasePtr(beta1_tensor),
-                       GetBasePtr(beta2_tensor),
-                       GetBasePtr(beta1_pow_tensor),
-                       GetBasePtr(beta2_pow_tensor),
-                       GetBasePtr(epsilon_tensor),
-                       /*use_nesterov*/ false);
-    if (!use_global_beta_pow) {
-      dev_ctx.template Alloc<T>(beta1_pow_out[idx]);
-      dev_ctx.template Alloc<T>(beta2_pow_out[idx]);
-  
-      MLUCnnlTensorDesc beta1_desc(*beta1_tensor);
-      MLUCnnlOpTensorDesc mul_op_desc(
-          CNNL_OP_TENSOR_MUL, ToCnnlDataType<T>(), CNNL_NOT_PROPAGATE_NAN);
-  
-      MLUCnnl::OpTensor(dev_ctx,
-                        mul_op_desc.get(),
-                        beta1_desc.get(),
-                        GetBasePtr(beta1_pow_tensor),
-                        beta1_desc.get(),
-                        GetBasePtr(beta1_tensor),
-                        beta1_desc.get(),
-                        GetBasePtr(beta1_pow_out[idx]),
-                        ToCnnlDataType<T>());
-  
-      MLUCnnl::OpTensor(dev_ctx,
-                        mul_op_desc.get(),
-                        beta1_desc.get(),
-                        GetBasePtr(beta2_pow_tensor),
-                        beta1_desc.get(),
-                        GetBasePtr(beta2_tensor),
-                        beta1_desc.get(),
-                        GetBasePtr(beta2_pow_out[idx]),
-                        ToCnnlDataType<T>());
-    }
+    AdamUpdate<T, Context>(dev_ctx,
+                           *param[idx],
+                           *grad[idx],
+                           *learning_rate[idx],
+                           *moment1[idx],
+                           *moment2[idx],
+                           *beta1_pow[idx],
+                           *beta2_pow[idx],
+                           *beta1_tensor,
+                           *beta2_tensor,
+                           *epsilon_tensor,
+                           nullptr,
+                           use_global_beta_pow,
+                           param_out[idx],
+                           moment1_out[idx],
+                           moment2_out[idx],
+                           beta1_pow_out[idx],
+                           beta2_pow_out[idx]);
   }
 }
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "kernels/funcs/mlu_baseop.h"
 #include "kernels/funcs/mlu_funcs.h"
+#include "kernels/funcs/reduce_op.h"
 
 namespace custom_kernel {
 
@@ -26,59 +27,54 @@ void CheckFiniteAndUnscale(const Context& dev_ctx,
   using MPDType = typename MPTypeTrait<T>::Type;
   dev_ctx.template Alloc<bool>(found_inf);
 
+  // One NaN/Inf flag per input, folded into found_inf by a single reduction
+  // at the end instead of one logical_or per input.
+  Tensor flags;
+  if (xs.size() > 1) {
+    flags.Resize({static_cast<int64_t>(xs.size())});
+    dev_ctx.template Alloc<bool>(&flags);
+  } else {
+    flags = *found_inf;
+  }
+
+  // The scale is inverted once and every input is multiplied by it, as the
+  // GPU kernel does.
+  Tensor inverse_scale;
+  inverse_scale.Resize(t_scale.dims());
+  dev_ctx.template Alloc<MPDType>(&inverse_scale);
   MLUCnnlTensorDesc scale_desc(t_scale);
-  MLUCnnlTensorDesc found_inf_desc(
-      *found_inf, CNNL_LAYOUT_ARRAY, ToCnnlDataType<bool>());
+  MLUCnnl::Reciprocal(dev_ctx,
+                      scale_desc.get(),
+                      GetBasePtr(&t_scale),
+                      scale_desc.get(),
+                      GetBasePtr(&inverse_scale));
+  MLUCnnlOpTensorDesc mul_desc(
+      CNNL_OP_TENSOR_MUL, ToCnnlDataType<MPDType>(), CNNL_NOT_PROPAGATE_NAN);
 
   for (size_t i = 0; i < xs.size(); ++i) {
     const auto* x = xs[i];
     auto* out = outs[i];
     dev_ctx.template Alloc<T>(out);
 
-    // check is_finite or is_nan
-    Tensor is_finite;
-    if (i != 0) {
-      is_finite.Resize(phi::make_ddim({1}));
-      dev_ctx.template Alloc<bool>(&is_finite);
-    } else {
-      is_finite = *found_inf;
-    }
-
     MLUCnnlTensorDesc x_desc(*x);
     MLUCnnlTensorDesc out_desc(*out);
 
-    MLUCnnl::IsNanInf(
-        dev_ctx, x_desc.get(), GetBasePtr(x), GetBasePtr(&is_finite));
-
-    // save is_finite by logical_and op after checking every input
-    if (i != 0) {
-      MLUCnnlTensorDesc is_finite_desc(
-          is_finite, CNNL_LAYOUT_ARRAY, ToCnnlDataType<bool>());
-      MLUCnnl::Logic(dev_ctx,
-                     CNNL_LOGIC_OP_OR,
-                     found_inf_desc.get(),
-                     GetBasePtr(found_inf),
-                     is_finite_desc.get(),
-                     GetBasePtr(&is_finite),
-                     found_inf_desc.get(),
-                     GetBasePtr(found_inf));
-    }
+    MLUCnnl::IsNanInf(dev_ctx,
+                      x_desc.get(),
+                      GetBasePtr(x),
+                      static_cast<bool*>(GetBasePtr(&flags)) + i);
 
     // The normal logic is :
     // out = in, if found_inf = true
     // out = in/scale, if found_inf = false
     // But when found_inf is true, the data of Out should not be used.
     // So, on MLU, we always compute out with in/scale.
-    Tensor float_x;
-    Tensor float_out;
     if (std::is_same<T, phi::dtype::float16>::value) {
+      Tensor float_x;
       float_x.Resize(x->dims());
-      float_out.Resize(out->dims());
       dev_ctx.template Alloc<MPDType>(&float_x);
-      dev_ctx.template Alloc<MPDType>(&float_out);
 
       MLUCnnlTensorDesc float_x_desc(float_x);
-      MLUCnnlTensorDesc float_out_desc(float_out);
       auto cast_fp16_type =
           GetCastDataType(DataType::FLOAT16, DataType::FLOAT32);
       MLUCnnl::Cast(dev_ctx,
@@ -88,34 +84,66 @@ void CheckFiniteAndUnscale(const Context& dev_ctx,
                     float_x_desc.get(),
                     GetBasePtr(&float_x));
 
-      MLUCnnl::Div(dev_ctx,
-                   CNNL_COMPUTATION_HIGH_PRECISION,
-                   float_x_desc.get(),
-                   GetBasePtr(&float_x),
-                   scale_desc.get(),
-                   GetBasePtr(&t_scale),
-                   float_out_desc.get(),
-                   GetBasePtr(&float_out));
+      MLUCnnl::OpTensor(dev_ctx,
+                        mul_desc.get(),
+                        float_x_desc.get(),
+                        GetBasePtr(&float_x),
+                        scale_desc.get(),
+                        GetBasePtr(&inverse_scale),
+                        float_x_desc.get(),
+                        GetBasePtr(&float_x),
+                        ToCnnlDataType<MPDType>());
 
       auto cast_fp32_type =
           GetCastDataType(DataType::FLOAT32, DataType::FLOAT16);
       MLUCnnl::Cast(dev_ctx,
                     cast_fp32_type,
-                    float_out_desc.get(),
-                    GetBasePtr(&float_out),
+                    float_x_desc.get(),
+                    GetBasePtr(&float_x),
                     out_desc.get(),
                     GetBasePtr(out));
     } else {
-      MLUCnnl::Div(dev_ctx,
-                   CNNL_COMPUTATION_HIGH_PRECISION,
-                   x_desc.get(),
-                   GetBasePtr(x),
-                   scale_desc.get(),
-                   GetBasePtr(&t_scale),
-                   out_desc.get(),
-                   GetBasePtr(out));
+      MLUCnnl::OpTensor(dev_ctx,
+                        mul_desc.get(),
+                        x_desc.get(),
+                        GetBasePtr(x),
+                        scale_desc.get(),
+                        GetBasePtr(&inverse_scale),
+                        out_desc.get(),
+                        GetBasePtr(out),
+                        ToCnnlDataType<MPDType>());
     }
   }
+
+  if (xs.size() > 1) {
+    Tensor flags_int32, found_inf_int32;
+    flags_int32.Resize(flags.dims());
+    dev_ctx.template Alloc<int32_t>(&flags_int32);
+    MLUCnnlTensorDesc flags_desc(flags);
+    MLUCnnlTensorDesc flags_int32_desc(flags_int32);
+    MLUCnnl::Cast(dev_ctx,
+                  GetCastDataType(DataType::BOOL, DataType::INT32),
+                  flags_desc.get(),
+                  GetBasePtr(&flags),
+                  flags_int32_desc.get(),
+                  GetBasePtr(&flags_int32));
+    found_inf_int32.Resize(found_inf->dims());
+    MLUReduceOp<int32_t, Context>(dev_ctx,
+                                  flags_int32,
+                                  {},
+                                  false, /* keep_dim */
+                                  true,  /* reduce_all */
+                                  "reduce_max",
+                                  &found_inf_int32);
+    MLUCnnlTensorDesc found_inf_int32_desc(found_inf_int32);
+    MLUCnnlTensorDesc found_inf_desc(*found_inf);
+    MLUCnnl::Cast(dev_ctx,
+                  GetCastDataType(DataType::INT32, DataType::BOOL),
+                  found_inf_int32_desc.get(),
+                  GetBasePtr(&found_inf_int32),
+                  found_inf_desc.get(),
+                  GetBasePtr(found_inf));
+  }
 }
 }  // namespace custom_kernel
 
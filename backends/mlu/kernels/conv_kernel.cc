@@ -71,11 +71,7 @@ void Conv2dKernel(const Context& dev_ctx,
 
   // transpose filter from MCHW to MHWC
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
   MLUCnnlTensorDesc input_desc(
@@ -231,11 +227,7 @@ void Conv2dGradKernel(const Context& dev_ctx,
 
     // transpose filter from MCHW to MHWC
     Tensor trans_filter;
-    TransposeFromMLUTensor<T>(dev_ctx,
-                              perm_to_nhwc,
-                              &filter,
-                              &trans_filter,
-                              true /*need_reshape_or_alloc*/);
+    TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
     cnnlDataType_t tensor_dtype = ToCnnlDataType<T>();
     cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
@@ -330,11 +322,7 @@ void DepthwiseConv2dKernel(const Context& dev_ctx,
 
   // transpose filter from MCHW to MHWC
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
   MLUCnnlTensorDesc input_desc(
@@ -496,11 +484,7 @@ void DepthwiseConv2dGradKernel(const Context& dev_ctx,
 
     // transpose filter from MCHW to MHWC
     Tensor trans_filter;
-    TransposeFromMLUTensor<T>(dev_ctx,
-                              perm_to_nhwc,
-                              &filter,
-                              &trans_filter,
-                              true /*need_reshape_or_alloc*/);
+    TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
     cnnlDataType_t tensor_dtype = ToCnnlDataType<T>();
     cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
@@ -74,11 +74,7 @@ void Conv2dTransposeKernel(const Context& dev_ctx,
 
   // transpose filter from MCHW to MHWC
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   // construct MLU attr
   cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
@@ -176,11 +172,7 @@ void Conv2dTransposeGradKernel(const Context& dev_ctx,
 
   // transpose filter from MCHW to MHWC
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   // MLU descs
   cnnlTensorLayout_t data_layout_mlu = CNNL_LAYOUT_NHWC;
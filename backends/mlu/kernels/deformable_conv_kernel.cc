@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "kernels/funcs/mlu_baseop.h"
+#include "kernels/funcs/conv_utils.h"
 
 namespace custom_kernel {
 
@@ -70,11 +70,7 @@ void DeformableConvKernel(const Context& dev_ctx,
                             true /*need_reshape_or_alloc*/);
 
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   Tensor tmp_output;
   auto output_dims = out->dims();
@@ -201,11 +197,7 @@ void DeformableConvGradKernel(const Context& dev_ctx,
                             true /*need_reshape_or_alloc*/);
 
   Tensor trans_filter;
-  TransposeFromMLUTensor<T>(dev_ctx,
-                            perm_to_nhwc,
-                            &filter,
-                            &trans_filter,
-                            true /*need_reshape_or_alloc*/);
+  TransposeFilterToNHWC<T>(dev_ctx, filter, &trans_filter);
 
   cnnlTensorLayout_t data_layout = CNNL_LAYOUT_NHWC;
   MLUCnnlTensorDesc output_grad_desc(trans_output_grad,
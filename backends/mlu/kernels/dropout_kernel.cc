@@ -36,15 +36,6 @@ void DropoutRawKernel(const Context& dev_ctx,
   MLUCnnlTensorDesc out_desc(*out);
   if (!is_test) {
     // exec dropout op for training only.
-    int seed_data = 0;
-    if (seed_tensor) {
-      std::vector<int> seed_vec;
-      TensorToVector(dev_ctx, seed_tensor.get(), dev_ctx, &seed_vec);
-      seed_data = seed_vec[0];
-    } else {
-      seed_data = fix_seed ? seed : 0;
-    }
-
     dev_ctx.template Alloc<uint8_t>(mask);
     MLUCnnlTensorDesc mask_desc(*mask);
     // Special case when dropout_prob is 1.0
@@ -63,9 +54,16 @@ void DropoutRawKernel(const Context& dev_ctx,
       return;
     }
 
-    // create mlu random generator
-    const int device_id = dev_ctx.GetPlace().GetDeviceId();
-    auto mlu_gen_random = GetMLURandomGenerator(dev_ctx, device_id, seed_data);
+    // The seed only matters when the generator of this stream is created,
+    // later calls neither read seed_tensor back nor wait for the queue.
+    auto mlu_gen_random = GetMLURandomGenerator(dev_ctx, [&]() {
+      if (!seed_tensor) return fix_seed ? seed : 0;
+      if (seed_tensor->place().GetType() == phi::AllocationType::CPU) {
+        return seed_tensor->data<int>()[0];
+      }
+      TensorReadback<int> seed_data(dev_ctx, seed_tensor.get());
+      return seed_data.Wait()[0];
+    });
 
     const float prob = is_upscale ? dropout_prob : 0.0f;
     MLUCnnl::FusedDropout(dev_ctx,
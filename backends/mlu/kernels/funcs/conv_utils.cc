@@ -0,0 +1,100 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/funcs/conv_utils.h"
+
+// Bytes of channels-last filters the conv kernels may keep for reuse. Opt-in
+// and for dynamic graph mode only: the cache notices filter updates by their
+// inplace version, which static graph mode does not bump, so a static
+// program would keep convolving with the filters of its first step. 0, the
+// default, disables it.
+ENV_uint64(mlu_conv_filter_cache_max_bytes, 0);
+
+namespace custom_kernel {
+
+namespace {
+
+uint32_t InplaceVersionOf(const phi::DenseTensor& tensor) {
+  return const_cast<phi::DenseTensor&>(tensor)
+      .InplaceVersionCounter()
+      .CurrentVersion();
+}
+
+}  // namespace
+
+FilterLayoutCache& FilterLayoutCache::Instance() {
+  // Leaked on purpose, the cached tensors must not be freed after the
+  // allocator they came from is gone.
+  static auto* cache = new FilterLayoutCache();
+  return *cache;
+}
+
+bool FilterLayoutCache::Lookup(const phi::DenseTensor& filter,
+                               phi::DenseTensor* transposed) {
+  if (FLAGS_mlu_conv_filter_cache_max_bytes == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(filter.data());
+  if (iter == entries_.end()) {
+    return false;
+  }
+  auto& entry = iter->second;
+  auto holder = entry.holder.lock();
+  if (!holder || holder != filter.Holder() ||
+      entry.version != InplaceVersionOf(filter) ||
+      entry.dtype != filter.dtype() || entry.dims != filter.dims()) {
+    Erase(iter);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+  *transposed = entry.transposed;
+  return true;
+}
+
+void FilterLayoutCache::Insert(const phi::DenseTensor& filter,
+                               const phi::DenseTensor& transposed) {
+  const size_t bytes = transposed.numel() * phi::SizeOf(transposed.dtype());
+  if (bytes > FLAGS_mlu_conv_filter_cache_max_bytes) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  const void* key = filter.data();
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    Erase(iter);
+  }
+  lru_.push_front(key);
+  entries_.emplace(key,
+                   Entry{filter.Holder(),
+                         InplaceVersionOf(filter),
+                         filter.dtype(),
+                         filter.dims(),
+                         transposed,
+                         bytes,
+                         lru_.begin()});
+  cached_bytes_ += bytes;
+  while (cached_bytes_ > FLAGS_mlu_conv_filter_cache_max_bytes) {
+    Erase(entries_.find(lru_.back()));
+  }
+}
+
+void FilterLayoutCache::Erase(
+    std::unordered_map<const void*, Entry>::iterator iter) {
+  cached_bytes_ -= iter->second.bytes;
+  lru_.erase(iter->second.lru_pos);
+  entries_.erase(iter);
+}
+
+}  // namespace custom_kernel
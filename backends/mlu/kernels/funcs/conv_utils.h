@@ -14,6 +14,11 @@
 
 #pragma once
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include "kernels/funcs/mlu_baseop.h"
 
 template <typename T = int>
@@ -67,3 +72,67 @@ inline void UpdatePaddingAndDilation(std::vector<T>* paddings,
     }
   }
 }
+
+namespace custom_kernel {
+
+// Channels-last copies of convolution filters, keyed by the filter buffer.
+// CNNL wants filters in NHWC while Paddle keeps them in NCHW even when the
+// activations are channels last, so without the cache every conv transposes
+// its (usually persistable) filter on every call. An entry is valid while
+// the filter allocation is alive and the filter has not been written in
+// place since, the cache therefore relies on in-place writes bumping the
+// tensor's inplace version. Only dynamic graph mode does that: optimizer
+// updates in a static program leave the version alone, and the cache would
+// hand out stale filters. It is opt-in through
+// FLAGS_mlu_conv_filter_cache_max_bytes and must only be set for dygraph
+// training or for inference with fixed weights.
+class FilterLayoutCache {
+ public:
+  static FilterLayoutCache& Instance();
+
+  bool Lookup(const phi::DenseTensor& filter, phi::DenseTensor* transposed);
+
+  // Records that transposed holds filter in channels-last order.
+  void Insert(const phi::DenseTensor& filter,
+              const phi::DenseTensor& transposed);
+
+ private:
+  struct Entry {
+    std::weak_ptr<phi::Allocation> holder;
+    uint32_t version;
+    phi::DataType dtype;
+    phi::DDim dims;
+    phi::DenseTensor transposed;
+    size_t bytes;
+    std::list<const void*>::iterator lru_pos;
+  };
+
+  void Erase(std::unordered_map<const void*, Entry>::iterator iter);
+
+  std::mutex mutex_;
+  std::unordered_map<const void*, Entry> entries_;
+  std::list<const void*> lru_;
+  size_t cached_bytes_ = 0;
+};
+
+// Transposes an [M, C, H, W] filter to [M, H, W, C], reusing the copy of an
+// earlier call when the filter has not changed since. trans_filter may share
+// its buffer with that copy and must not be written.
+template <typename T>
+inline void TransposeFilterToNHWC(const Context& dev_ctx,
+                                  const phi::DenseTensor& filter,
+                                  phi::DenseTensor* trans_filter) {
+  auto& cache = FilterLayoutCache::Instance();
+  if (cache.Lookup(filter, trans_filter)) {
+    return;
+  }
+  const std::vector<int> perm_to_nhwc = {0, 2, 3, 1};
+  TransposeFromMLUTensor<T>(dev_ctx,
+                            perm_to_nhwc,
+                            &filter,
+                            trans_filter,
+                            true /*need_reshape_or_alloc*/);
+  cache.Insert(filter, *trans_filter);
+}
+
+}  // namespace custom_kernel
@@ -117,13 +117,51 @@ inline void GetReduceAxesAndDstDims(const int axis,
   }
 }
 
+// Drops the dims every operand has as 1 and merges neighbouring dims along
+// which x and y are each either fully present or broadcast, so that the
+// descriptors handed to cnnl are of the lowest rank describing the same
+// broadcast. Always leaves at least one dim.
+inline void CoalesceBroadcastDims(std::vector<int>* x_dims,
+                                  std::vector<int>* y_dims,
+                                  std::vector<int>* out_dims) {
+  std::vector<int> x, y, out;
+  for (size_t i = 0; i < out_dims->size(); ++i) {
+    const int x_dim = (*x_dims)[i];
+    const int y_dim = (*y_dims)[i];
+    const int out_dim = (*out_dims)[i];
+    if (out_dim == 1) continue;
+    if (!out.empty() && (x.back() == out.back()) == (x_dim == out_dim) &&
+        (y.back() == out.back()) == (y_dim == out_dim)) {
+      x.back() *= x_dim;
+      y.back() *= y_dim;
+      out.back() *= out_dim;
+    } else {
+      x.push_back(x_dim);
+      y.push_back(y_dim);
+      out.push_back(out_dim);
+    }
+  }
+  if (out.empty()) {
+    x.push_back(1);
+    y.push_back(1);
+    out.push_back(1);
+  }
+  x_dims->swap(x);
+  y_dims->swap(y);
+  out_dims->swap(out);
+}
+
+// out = op(alpha1 * x, alpha2 * y), the scaling is folded into the one
+// cnnlOpTensor launch.
 template <typename T>
 void MLUOpTensorKernel(const Context& dev_ctx,
                        const phi::DenseTensor& x,
                        const phi::DenseTensor& y,
                        int axis,
                        const cnnlOpTensorDesc_t op_tensor_type,
-                       phi::DenseTensor* out) {
+                       phi::DenseTensor* out,
+                       const float alpha1 = 1.0f,
+                       const float alpha2 = 1.0f) {
   PADDLE_ENFORCE_EQ((op_tensor_type == CNNL_OP_TENSOR_ADD) ||
                         (op_tensor_type == CNNL_OP_TENSOR_SUB) ||
                         (op_tensor_type == CNNL_OP_TENSOR_MUL),
@@ -147,10 +185,14 @@ void MLUOpTensorKernel(const Context& dev_ctx,
                          out_dims_array.data(),
                          max_dim,
                          axis);
-
-  MLUCnnlTensorDesc x_desc(max_dim, x_dims_array.data(), ToCnnlDataType<T>());
-  MLUCnnlTensorDesc y_desc(max_dim, y_dims_array.data(), ToCnnlDataType<T>());
-  MLUCnnlTensorDesc out_desc(*out);
+  if (out->numel() == 0) return;
+  CoalesceBroadcastDims(&x_dims_array, &y_dims_array, &out_dims_array);
+
+  const int rank = out_dims_array.size();
+  MLUCnnlTensorDesc x_desc(rank, x_dims_array.data(), ToCnnlDataType<T>());
+  MLUCnnlTensorDesc y_desc(rank, y_dims_array.data(), ToCnnlDataType<T>());
+  MLUCnnlTensorDesc out_desc(
+      rank, out_dims_array.data(), ToCnnlDataType<T>());
   MLUCnnlOpTensorDesc op_tensor_desc(
       op_tensor_type, ToCnnlDataType<T>(), CNNL_NOT_PROPAGATE_NAN);
 
@@ -162,7 +204,9 @@ void MLUOpTensorKernel(const Context& dev_ctx,
                     GetBasePtr(&y),
                     out_desc.get(),
                     GetBasePtr(out),
-                    ToCnnlDataType<T>());
+                    ToCnnlDataType<T>(),
+                    alpha1,
+                    alpha2);
 }
 
 // ------------------ BinaryOp -----------------
@@ -256,10 +300,14 @@ void MLUBinaryOp(const Context& dev_ctx,
                          out_dims_array.data(),
                          max_dim,
                          axis);
-
-  MLUCnnlTensorDesc x_desc(max_dim, x_dims_array.data(), ToCnnlDataType<T>());
-  MLUCnnlTensorDesc y_desc(max_dim, y_dims_array.data(), ToCnnlDataType<T>());
-  MLUCnnlTensorDesc out_desc(*out, CNNL_LAYOUT_ARRAY, ToCnnlDataType<T>());
+  if (out->numel() == 0) return;
+  CoalesceBroadcastDims(&x_dims_array, &y_dims_array, &out_dims_array);
+
+  const int rank = out_dims_array.size();
+  MLUCnnlTensorDesc x_desc(rank, x_dims_array.data(), ToCnnlDataType<T>());
+  MLUCnnlTensorDesc y_desc(rank, y_dims_array.data(), ToCnnlDataType<T>());
+  MLUCnnlTensorDesc out_desc(
+      rank, out_dims_array.data(), ToCnnlDataType<T>());
 
   cnnlComputationPreference_t prefer_type = CNNL_COMPUTATION_HIGH_PRECISION;
   MLUBinary<Functor>(dev_ctx,
@@ -14,6 +14,10 @@
 
 #include "kernels/funcs/mlu_baseop.h"
 
+#include <algorithm>
+
+#include "kernels/funcs/mlu_desc_cache.h"
+
 namespace custom_kernel {
 
 cnnlCastDataType_t GetCastDataType(const DataType& src_type,
@@ -41,70 +45,297 @@ bool MLUSupportsCast(const DataType& src_type, const DataType& dst_type) {
   return false;
 }
 
-const std::shared_ptr<MLUCnnlRandomGeneratorDesc>& GetMLURandomGenerator(
-    const Context& ctx, const int64_t device_id, const int seed) {
-  static uint32_t num_mlu_devices = -1;
-  static std::once_flag num_devices_init_flag;
-  static std::deque<std::once_flag> mlu_device_flags;
-  static std::vector<std::shared_ptr<MLUCnnlRandomGeneratorDesc>>
-      mlu_rand_generators;
+std::shared_ptr<MLUCnnlRandomGeneratorDesc> GetMLURandomGenerator(
+    const Context& ctx, const std::function<int()>& seed) {
+  auto mlu_stream = reinterpret_cast<mluStream_t>(ctx.stream());
+  auto& generator = mlu_stream->random_generator;
+  if (!generator) {
+    const int initial_seed = seed();
+    generator = std::make_shared<MLUCnnlRandomGeneratorDesc>(ctx, initial_seed);
+    VLOG(4) << "stream: " << ctx.stream() << ", initial seed: " << initial_seed;
+  }
+  return std::static_pointer_cast<MLUCnnlRandomGeneratorDesc>(generator);
+}
+
+namespace {
+
+// Cached descriptors no holder references, per descriptor type and thread.
+constexpr size_t kDescCacheCapacity = 1024;
+
+// Everything a tensor descriptor is built from. The position and scale are
+// only set if has_position and has_scale, the on-chip data type only if it
+// is not negative. Layouts and data types are stored as plain integers so
+// CNNL and MLU-OPS descriptors share the key type.
+struct TensorDescParams {
+  int layout;
+  int dtype;
+  std::vector<int> dims;
+  bool has_position = false;
+  int position = 0;
+  bool has_scale = false;
+  float scale = 1.0f;
+  int onchip_dtype = -1;
+
+  bool operator==(const TensorDescParams& rhs) const {
+    return layout == rhs.layout && dtype == rhs.dtype && dims == rhs.dims &&
+           has_position == rhs.has_position && position == rhs.position &&
+           has_scale == rhs.has_scale && scale == rhs.scale &&
+           onchip_dtype == rhs.onchip_dtype;
+  }
+};
 
-  std::call_once(num_devices_init_flag, []() {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnrtGetDeviceCount(&num_mlu_devices));
-    mlu_device_flags.resize(num_mlu_devices);
-    mlu_rand_generators.resize(num_mlu_devices);
-  });
-  if (device_id < 0) {
-    PADDLE_THROW(
-        phi::errors::InvalidArgument("mlu device id shoule be greater than 0"));
+struct TensorDescParamsHash {
+  size_t operator()(const TensorDescParams& params) const {
+    size_t seed = 0;
+    auto combine = [&seed](size_t value) {
+      seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(params.layout);
+    combine(params.dtype);
+    for (auto dim : params.dims) {
+      combine(dim);
+    }
+    combine(params.position);
+    combine(params.onchip_dtype);
+    return seed;
   }
+};
 
-  std::call_once(mlu_device_flags[device_id], [&]() {
-    mlu_rand_generators[device_id].reset(
-        new MLUCnnlRandomGeneratorDesc(ctx, seed));
-    VLOG(4) << "device_id: " << device_id << ", initial seed: " << seed;
-  });
-  return mlu_rand_generators[device_id];
+std::vector<int> NarrowDims(const int tensor_dim, const int64_t dim_sizes[]) {
+  std::vector<int> dim_sizes_int32(tensor_dim);
+  std::transform(dim_sizes,
+                 dim_sizes + tensor_dim,
+                 dim_sizes_int32.begin(),
+                 &CheckedNarrowing<int64_t, int>);
+  return dim_sizes_int32;
 }
 
-class MLUCnnlTensorDescPool {
+std::vector<int> TensorDims(const Tensor& tensor) {
+  auto dims = phi::vectorize<int>(tensor.dims());
+  if (dims.empty()) {
+    // Scalars are described as tensors of shape [1].
+    dims.push_back(1);
+  }
+  return dims;
+}
+
+using CnnlTensorDescCache = MLUDescCache<cnnlTensorDescriptor_t,
+                                         TensorDescParams,
+                                         TensorDescParamsHash>;
+
+CnnlTensorDescCache& GetCnnlTensorDescCache() {
+  thread_local CnnlTensorDescCache cache(
+      [](cnnlTensorDescriptor_t desc) { cnnlDestroyTensorDescriptor(desc); },
+      kDescCacheCapacity);
+  return cache;
+}
+
+cnnlTensorDescriptor_t AcquireCnnlTensorDesc(const TensorDescParams& params) {
+  return GetCnnlTensorDescCache().Acquire(
+      params, [](const TensorDescParams& params) {
+        cnnlTensorDescriptor_t desc;
+        PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateTensorDescriptor(&desc));
+        PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(
+            desc,
+            static_cast<cnnlTensorLayout_t>(params.layout),
+            static_cast<cnnlDataType_t>(params.dtype),
+            params.dims.size(),
+            params.dims.data()));
+        if (params.has_scale) {
+          PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorPositionAndScale(
+              desc, params.position, params.scale));
+        } else if (params.has_position) {
+          PADDLE_ENFORCE_MLU_SUCCESS(
+              cnnlSetTensorDescriptorPosition(desc, params.position));
+        }
+        if (params.onchip_dtype >= 0) {
+          PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorOnchipDataType(
+              desc, static_cast<cnnlDataType_t>(params.onchip_dtype)));
+        }
+        return desc;
+      });
+}
+
+void ReleaseCnnlTensorDesc(cnnlTensorDescriptor_t desc) {
+  if (desc) {
+    GetCnnlTensorDescCache().Release(desc);
+  }
+}
+
+// Cached descriptors are shared, so a wrapper that needs a tensor
+// descriptor with another on-chip data type, position or scale than the one
+// it was given uses a variant acquired under its own key instead of
+// modifying the shared one. Descriptors that do not come from the cache are
+// modified in place as before.
+class CnnlTensorDescVariant {
  public:
-  cnnlTensorDescriptor_t Pop() {
-    cnnlTensorDescriptor_t raw_desc;
-    if (q_.try_dequeue(raw_desc)) {
-      return raw_desc;
-    } else {
-      cnnlCreateTensorDescriptor(&raw_desc);
-      return raw_desc;
+  explicit CnnlTensorDescVariant(cnnlTensorDescriptor_t desc)
+      : desc_(desc),
+        cached_(GetCnnlTensorDescCache().GetKey(desc, &params_)) {}
+
+  CnnlTensorDescVariant(const CnnlTensorDescVariant&) = delete;
+  CnnlTensorDescVariant& operator=(const CnnlTensorDescVariant&) = delete;
+
+  ~CnnlTensorDescVariant() {
+    if (variant_) {
+      ReleaseCnnlTensorDesc(desc_);
     }
   }
 
-  void Recycle(cnnlTensorDescriptor_t desc) {
-    cnnlResetTensorDescriptor(desc);
-    q_.enqueue(desc);
+  void SetOnchipDataType(cnnlDataType_t dtype) {
+    if (!cached_) {
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnnlSetTensorDescriptorOnchipDataType(desc_, dtype));
+      return;
+    }
+    params_.onchip_dtype = dtype;
+    Reacquire();
   }
 
-  ~MLUCnnlTensorDescPool() {
-    auto size = q_.size_approx();
-    if (size > 0) {
-      std::vector<cnnlTensorDescriptor_t> vec(size);
-      q_.try_dequeue_bulk(vec.data(), size);
-      for (auto desc : vec) {
-        cnnlDestroyTensorDescriptor(desc);
-      }
+  void SetPositionAndScale(int position, float scale) {
+    if (!cached_) {
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnnlSetTensorDescriptorPositionAndScale(desc_, position, scale));
+      return;
     }
+    params_.has_position = true;
+    params_.position = position;
+    params_.has_scale = true;
+    params_.scale = scale;
+    Reacquire();
   }
 
+  operator cnnlTensorDescriptor_t() const { return desc_; }
+
  private:
-  moodycamel::ConcurrentQueue<cnnlTensorDescriptor_t> q_;
+  void Reacquire() {
+    auto desc = AcquireCnnlTensorDesc(params_);
+    if (variant_) {
+      ReleaseCnnlTensorDesc(desc_);
+    }
+    desc_ = desc;
+    variant_ = true;
+  }
+
+  cnnlTensorDescriptor_t desc_;
+  TensorDescParams params_;
+  bool cached_;
+  bool variant_ = false;
 };
 
-static MLUCnnlTensorDescPool g_cnnl_tensor_desc_pool;
+using MLUOpTensorDescCache = MLUDescCache<mluOpTensorDescriptor_t,
+                                          TensorDescParams,
+                                          TensorDescParamsHash>;
+
+MLUOpTensorDescCache& GetMLUOpTensorDescCache() {
+  thread_local MLUOpTensorDescCache cache(
+      [](mluOpTensorDescriptor_t desc) { mluOpDestroyTensorDescriptor(desc); },
+      kDescCacheCapacity);
+  return cache;
+}
+
+mluOpTensorDescriptor_t AcquireMLUOpTensorDesc(
+    const TensorDescParams& params) {
+  return GetMLUOpTensorDescCache().Acquire(
+      params, [](const TensorDescParams& params) {
+        mluOpTensorDescriptor_t desc;
+        PADDLE_ENFORCE_MLU_SUCCESS(mluOpCreateTensorDescriptor(&desc));
+        PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(
+            desc,
+            static_cast<mluOpTensorLayout_t>(params.layout),
+            static_cast<mluOpDataType_t>(params.dtype),
+            params.dims.size(),
+            params.dims.data()));
+        if (params.has_scale) {
+          PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptorPositionAndScale(
+              desc, params.position, params.scale));
+        } else if (params.has_position) {
+          PADDLE_ENFORCE_MLU_SUCCESS(
+              mluOpSetTensorDescriptorPosition(desc, params.position));
+        }
+        return desc;
+      });
+}
+
+void ReleaseMLUOpTensorDesc(mluOpTensorDescriptor_t desc) {
+  if (desc) {
+    GetMLUOpTensorDescCache().Release(desc);
+  }
+}
+
+// Op descriptors are keyed by the raw bytes of their parameters.
+template <typename Handle>
+using OpDescCache = MLUDescCache<Handle, std::string>;
 
-MLUCnnlTensorDesc& MLUCnnlTensorDesc::operator=(MLUCnnlTensorDesc&& rhs) {
-  if (raw_tensor_desc) {
-    g_cnnl_tensor_desc_pool.Recycle(raw_tensor_desc);
+template <typename Handle>
+OpDescCache<Handle>& GetOpDescCache(void (*destroy)(Handle)) {
+  thread_local OpDescCache<Handle> cache(destroy, kDescCacheCapacity);
+  return cache;
+}
+
+template <typename Handle, typename Create>
+Handle AcquireOpDesc(void (*destroy)(Handle),
+                     const MLUDescKey& key,
+                     Create&& create) {
+  return GetOpDescCache<Handle>(destroy).Acquire(
+      key.str(), [&create](const std::string&) { return create(); });
+}
+
+template <typename Handle>
+void ReleaseOpDesc(void (*destroy)(Handle), Handle desc) {
+  if (desc) {
+    GetOpDescCache<Handle>(destroy).Release(desc);
   }
+}
+
+void DestroyActivationDesc(cnnlActivationDescriptor_t desc) {
+  cnnlDestroyActivationDescriptor(desc);
+}
+
+void DestroyPoolingDesc(cnnlPoolingDescriptor_t desc) {
+  cnnlDestroyPoolingDescriptor(desc);
+}
+
+void DestroyReduceDesc(cnnlReduceDescriptor_t desc) {
+  cnnlDestroyReduceDescriptor(desc);
+}
+
+void DestroyOpTensorDesc(cnnlOpTensorDescriptor_t desc) {
+  cnnlDestroyOpTensorDescriptor(desc);
+}
+
+void DestroyConvolutionDesc(cnnlConvolutionDescriptor_t desc) {
+  cnnlDestroyConvolutionDescriptor(desc);
+}
+
+cnnlConvolutionDescriptor_t AcquireConvolutionDesc(
+    const int dims,
+    const int pad[],
+    const int stride[],
+    const int dilation[],
+    const int group_count,
+    const cnnlDataType_t tensor_dtype) {
+  const int spatial_dims = dims - 2;
+  MLUDescKey key;
+  key.Append(dims)
+      .Append(pad, spatial_dims * 2)
+      .Append(stride, spatial_dims)
+      .Append(dilation, spatial_dims)
+      .Append(group_count)
+      .Append(tensor_dtype);
+  return AcquireOpDesc(DestroyConvolutionDesc, key, [&]() {
+    cnnlConvolutionDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateConvolutionDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetConvolutionDescriptor(
+        desc, dims, pad, stride, dilation, group_count, tensor_dtype));
+    return desc;
+  });
+}
+
+}  // namespace
+
+MLUCnnlTensorDesc& MLUCnnlTensorDesc::operator=(MLUCnnlTensorDesc&& rhs) {
+  ReleaseCnnlTensorDesc(raw_tensor_desc);
   raw_tensor_desc = rhs.raw_tensor_desc;
   rhs.raw_tensor_desc = nullptr;
   return *this;
@@ -112,107 +343,63 @@ MLUCnnlTensorDesc& MLUCnnlTensorDesc::operator=(MLUCnnlTensorDesc&& rhs) {
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int dim_sizes[],
-                                     const cnnlDataType_t tensor_dtype) {
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(
-      raw_tensor_desc, CNNL_LAYOUT_ARRAY, tensor_dtype, tensor_dim, dim_sizes));
-}
+                                     const cnnlDataType_t tensor_dtype)
+    : MLUCnnlTensorDesc(
+          tensor_dim, dim_sizes, tensor_dtype, CNNL_LAYOUT_ARRAY) {}
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int dim_sizes[],
                                      const cnnlDataType_t tensor_dtype,
                                      const cnnlTensorLayout_t layout) {
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(
-      raw_tensor_desc, layout, tensor_dtype, tensor_dim, dim_sizes));
+  TensorDescParams params{layout,
+                          tensor_dtype,
+                          std::vector<int>(dim_sizes, dim_sizes + tensor_dim)};
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int dim_sizes[],
                                      const cnnlDataType_t tensor_dtype,
-                                     int position)
-    : MLUCnnlTensorDesc(tensor_dim, dim_sizes, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorPosition(raw_tensor_desc, position));
+                                     int position) {
+  TensorDescParams params{CNNL_LAYOUT_ARRAY,
+                          tensor_dtype,
+                          std::vector<int>(dim_sizes, dim_sizes + tensor_dim)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int64_t dim_sizes[],
-                                     const cnnlDataType_t tensor_dtype) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(raw_tensor_desc,
-                                                     CNNL_LAYOUT_ARRAY,
-                                                     tensor_dtype,
-                                                     tensor_dim,
-                                                     dim_sizes_int32.data()));
-}
+                                     const cnnlDataType_t tensor_dtype)
+    : MLUCnnlTensorDesc(
+          tensor_dim, dim_sizes, tensor_dtype, CNNL_LAYOUT_ARRAY) {}
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int64_t dim_sizes[],
                                      const cnnlDataType_t tensor_dtype,
                                      const cnnlTensorLayout_t layout) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(raw_tensor_desc,
-                                                     layout,
-                                                     tensor_dtype,
-                                                     tensor_dim,
-                                                     dim_sizes_int32.data()));
+  TensorDescParams params{
+      layout, tensor_dtype, NarrowDims(tensor_dim, dim_sizes)};
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const int tensor_dim,
                                      const int64_t dim_sizes[],
                                      const cnnlDataType_t tensor_dtype,
                                      int position) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(raw_tensor_desc,
-                                                     CNNL_LAYOUT_ARRAY,
-                                                     tensor_dtype,
-                                                     tensor_dim,
-                                                     dim_sizes_int32.data()));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorPosition(raw_tensor_desc, position));
+  TensorDescParams params{
+      CNNL_LAYOUT_ARRAY, tensor_dtype, NarrowDims(tensor_dim, dim_sizes)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const Tensor& tensor,
                                      const cnnlTensorLayout_t layout,
                                      const cnnlDataType_t tensor_dtype) {
-  auto dims = phi::vectorize<int>(tensor.dims());
-  int tensor_dim = dims.size();
-  raw_tensor_desc = g_cnnl_tensor_desc_pool.Pop();
-  if (tensor_dim == 0) {
-    int scalar_dims[1] = {1};
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptor(
-        raw_tensor_desc, layout, tensor_dtype, 1, scalar_dims));
-  } else {
-    std::vector<int> tensor_dim_sizes_int(dims.begin(), dims.end());
-    PADDLE_ENFORCE_MLU_SUCCESS(
-        cnnlSetTensorDescriptor(raw_tensor_desc,
-                                layout,
-                                tensor_dtype,
-                                tensor_dim,
-                                tensor_dim_sizes_int.data()));
-  }
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const Tensor& tensor)
@@ -222,66 +409,32 @@ MLUCnnlTensorDesc::MLUCnnlTensorDesc(const Tensor& tensor)
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const Tensor& tensor,
                                      cnnlTensorLayout_t layout,
                                      const cnnlDataType_t tensor_dtype,
-                                     int position)
-    : MLUCnnlTensorDesc(tensor, layout, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorPosition(raw_tensor_desc, position));
+                                     int position) {
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::MLUCnnlTensorDesc(const Tensor& tensor,
                                      cnnlTensorLayout_t layout,
                                      const cnnlDataType_t tensor_dtype,
                                      int position,
-                                     float scale)
-    : MLUCnnlTensorDesc(tensor, layout, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorPositionAndScale(
-      raw_tensor_desc, position, scale));
+                                     float scale) {
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  params.has_position = true;
+  params.position = position;
+  params.has_scale = true;
+  params.scale = scale;
+  raw_tensor_desc = AcquireCnnlTensorDesc(params);
 }
 
 MLUCnnlTensorDesc::~MLUCnnlTensorDesc() {
-  if (raw_tensor_desc) {
-    g_cnnl_tensor_desc_pool.Recycle(raw_tensor_desc);
-  }
+  ReleaseCnnlTensorDesc(raw_tensor_desc);
 }
 
-class MLUOpTensorDescPool {
- public:
-  mluOpTensorDescriptor_t Pop() {
-    mluOpTensorDescriptor_t raw_desc;
-    if (q_.try_dequeue(raw_desc)) {
-      return raw_desc;
-    } else {
-      mluOpCreateTensorDescriptor(&raw_desc);
-      return raw_desc;
-    }
-  }
-
-  void Recycle(mluOpTensorDescriptor_t desc) {
-    mluOpResetTensorDescriptor(desc);
-    q_.enqueue(desc);
-  }
-
-  ~MLUOpTensorDescPool() {
-    auto size = q_.size_approx();
-    if (size > 0) {
-      std::vector<mluOpTensorDescriptor_t> vec(size);
-      q_.try_dequeue_bulk(vec.data(), size);
-      for (auto desc : vec) {
-        mluOpDestroyTensorDescriptor(desc);
-      }
-    }
-  }
-
- private:
-  moodycamel::ConcurrentQueue<mluOpTensorDescriptor_t> q_;
-};
-
-static MLUOpTensorDescPool g_mluop_tensor_desc_pool;
-
 MLUOpTensorDesc& MLUOpTensorDesc::operator=(MLUOpTensorDesc&& rhs) {
-  if (raw_tensor_desc) {
-    g_mluop_tensor_desc_pool.Recycle(raw_tensor_desc);
-  }
+  ReleaseMLUOpTensorDesc(raw_tensor_desc);
   raw_tensor_desc = rhs.raw_tensor_desc;
   rhs.raw_tensor_desc = nullptr;
   return *this;
@@ -289,110 +442,63 @@ MLUOpTensorDesc& MLUOpTensorDesc::operator=(MLUOpTensorDesc&& rhs) {
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int dim_sizes[],
-                                 const mluOpDataType_t tensor_dtype) {
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(raw_tensor_desc,
-                                                      MLUOP_LAYOUT_ARRAY,
-                                                      tensor_dtype,
-                                                      tensor_dim,
-                                                      dim_sizes));
-}
+                                 const mluOpDataType_t tensor_dtype)
+    : MLUOpTensorDesc(
+          tensor_dim, dim_sizes, tensor_dtype, MLUOP_LAYOUT_ARRAY) {}
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int dim_sizes[],
                                  const mluOpDataType_t tensor_dtype,
                                  const mluOpTensorLayout_t layout) {
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(
-      raw_tensor_desc, layout, tensor_dtype, tensor_dim, dim_sizes));
+  TensorDescParams params{layout,
+                          tensor_dtype,
+                          std::vector<int>(dim_sizes, dim_sizes + tensor_dim)};
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int dim_sizes[],
                                  const mluOpDataType_t tensor_dtype,
-                                 int position)
-    : MLUOpTensorDesc(tensor_dim, dim_sizes, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      mluOpSetTensorDescriptorPosition(raw_tensor_desc, position));
+                                 int position) {
+  TensorDescParams params{MLUOP_LAYOUT_ARRAY,
+                          tensor_dtype,
+                          std::vector<int>(dim_sizes, dim_sizes + tensor_dim)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int64_t dim_sizes[],
-                                 const mluOpDataType_t tensor_dtype) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(raw_tensor_desc,
-                                                      MLUOP_LAYOUT_ARRAY,
-                                                      tensor_dtype,
-                                                      tensor_dim,
-                                                      dim_sizes_int32.data()));
-}
+                                 const mluOpDataType_t tensor_dtype)
+    : MLUOpTensorDesc(
+          tensor_dim, dim_sizes, tensor_dtype, MLUOP_LAYOUT_ARRAY) {}
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int64_t dim_sizes[],
                                  const mluOpDataType_t tensor_dtype,
                                  const mluOpTensorLayout_t layout) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(raw_tensor_desc,
-                                                      layout,
-                                                      tensor_dtype,
-                                                      tensor_dim,
-                                                      dim_sizes_int32.data()));
+  TensorDescParams params{
+      layout, tensor_dtype, NarrowDims(tensor_dim, dim_sizes)};
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const int tensor_dim,
                                  const int64_t dim_sizes[],
                                  const mluOpDataType_t tensor_dtype,
                                  int position) {
-  std::vector<int> dim_sizes_int32(tensor_dim);
-  std::vector<int64_t>::const_iterator int64_cbegin(dim_sizes);
-  std::vector<int64_t>::const_iterator int64_cend(dim_sizes + tensor_dim);
-  std::transform(int64_cbegin,
-                 int64_cend,
-                 dim_sizes_int32.begin(),
-                 &CheckedNarrowing<int64_t, int>);
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(raw_tensor_desc,
-                                                      MLUOP_LAYOUT_ARRAY,
-                                                      tensor_dtype,
-                                                      tensor_dim,
-                                                      dim_sizes_int32.data()));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      mluOpSetTensorDescriptorPosition(raw_tensor_desc, position));
+  TensorDescParams params{
+      MLUOP_LAYOUT_ARRAY, tensor_dtype, NarrowDims(tensor_dim, dim_sizes)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const Tensor& tensor,
                                  const mluOpTensorLayout_t layout,
                                  const mluOpDataType_t tensor_dtype) {
-  auto dims = phi::vectorize<int>(tensor.dims());
-  int tensor_dim = dims.size();
-  raw_tensor_desc = g_mluop_tensor_desc_pool.Pop();
-  if (tensor_dim == 0) {
-    int scalar_dims[1] = {1};
-    PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptor(
-        raw_tensor_desc, layout, tensor_dtype, 1, scalar_dims));
-  } else {
-    std::vector<int> tensor_dim_sizes_int(dims.begin(), dims.end());
-    PADDLE_ENFORCE_MLU_SUCCESS(
-        mluOpSetTensorDescriptor(raw_tensor_desc,
-                                 layout,
-                                 tensor_dtype,
-                                 tensor_dim,
-                                 tensor_dim_sizes_int.data()));
-  }
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const Tensor& tensor)
@@ -402,42 +508,37 @@ MLUOpTensorDesc::MLUOpTensorDesc(const Tensor& tensor)
 MLUOpTensorDesc::MLUOpTensorDesc(const Tensor& tensor,
                                  mluOpTensorLayout_t layout,
                                  const mluOpDataType_t tensor_dtype,
-                                 int position)
-    : MLUOpTensorDesc(tensor, layout, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      mluOpSetTensorDescriptorPosition(raw_tensor_desc, position));
+                                 int position) {
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  params.has_position = true;
+  params.position = position;
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::MLUOpTensorDesc(const Tensor& tensor,
                                  mluOpTensorLayout_t layout,
                                  const mluOpDataType_t tensor_dtype,
                                  int position,
-                                 float scale)
-    : MLUOpTensorDesc(tensor, layout, tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(mluOpSetTensorDescriptorPositionAndScale(
-      raw_tensor_desc, position, scale));
+                                 float scale) {
+  TensorDescParams params{layout, tensor_dtype, TensorDims(tensor)};
+  params.has_position = true;
+  params.position = position;
+  params.has_scale = true;
+  params.scale = scale;
+  raw_tensor_desc = AcquireMLUOpTensorDesc(params);
 }
 
 MLUOpTensorDesc::~MLUOpTensorDesc() {
-  if (raw_tensor_desc) {
-    g_mluop_tensor_desc_pool.Recycle(raw_tensor_desc);
-  }
+  ReleaseMLUOpTensorDesc(raw_tensor_desc);
 }
 
 MLUCnnlActivationDesc::MLUCnnlActivationDesc(
-    const cnnlActivationMode_t act_mode, const float ceof) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateActivationDescriptor(&active_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetActivationDescriptor_v5(active_desc_,
-                                     act_mode,
-                                     CNNL_ACTIVATION_HIGH_PRECISION,
-                                     CNNL_NOT_PROPAGATE_NAN,
-                                     ceof,
-                                     1.0f /*sliced_dim*/,
-                                     1.67326319217681884765625 /*selu_alpha*/,
-                                     1.05070102214813232421875 /*selu_lambda*/,
-                                     false /*is_elu_mode*/));
-}
+    const cnnlActivationMode_t act_mode, const float ceof)
+    : MLUCnnlActivationDesc(act_mode,
+                            ceof,
+                            1.0f /*sliced_dim*/,
+                            1.67326319217681884765625 /*selu_alpha*/,
+                            1.05070102214813232421875 /*selu_lambda*/) {}
 
 MLUCnnlActivationDesc::MLUCnnlActivationDesc(
     const cnnlActivationMode_t act_mode,
@@ -445,17 +546,27 @@ MLUCnnlActivationDesc::MLUCnnlActivationDesc(
     const float sliced_dim,
     const float selu_alpha,
     const float selu_lambda) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateActivationDescriptor(&active_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetActivationDescriptor_v5(active_desc_,
-                                     act_mode,
-                                     CNNL_ACTIVATION_HIGH_PRECISION,
-                                     CNNL_NOT_PROPAGATE_NAN,
-                                     ceof,
-                                     sliced_dim,
-                                     selu_alpha,
-                                     selu_lambda,
-                                     false /*is_elu_mode*/));
+  MLUDescKey key;
+  key.Append(act_mode)
+      .Append(ceof)
+      .Append(sliced_dim)
+      .Append(selu_alpha)
+      .Append(selu_lambda);
+  active_desc_ = AcquireOpDesc(DestroyActivationDesc, key, [&]() {
+    cnnlActivationDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateActivationDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(
+        cnnlSetActivationDescriptor_v5(desc,
+                                       act_mode,
+                                       CNNL_ACTIVATION_HIGH_PRECISION,
+                                       CNNL_NOT_PROPAGATE_NAN,
+                                       ceof,
+                                       sliced_dim,
+                                       selu_alpha,
+                                       selu_lambda,
+                                       false /*is_elu_mode*/));
+    return desc;
+  });
 }
 
 const cnnlActivationDescriptor_t MLUCnnlActivationDesc::get() const {
@@ -463,9 +574,7 @@ const cnnlActivationDescriptor_t MLUCnnlActivationDesc::get() const {
 }
 
 MLUCnnlActivationDesc::~MLUCnnlActivationDesc() {
-  if (active_desc_) {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroyActivationDescriptor(active_desc_));
-  }
+  ReleaseOpDesc(DestroyActivationDesc, active_desc_);
 }
 
 MLUCnnlPoolingDesc::MLUCnnlPoolingDesc(
@@ -482,21 +591,40 @@ MLUCnnlPoolingDesc::MLUCnnlPoolingDesc(
     int row_dilation,
     int col_dilation,
     bool ceil_mode) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreatePoolingDescriptor(&pooling_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetPooling2dDescriptor_v2(pooling_desc_,
-                                                           mode,
-                                                           maxpooling_nan_opt,
-                                                           window_rows,
-                                                           window_cols,
-                                                           pad_up,
-                                                           pad_down,
-                                                           pad_left,
-                                                           pad_right,
-                                                           row_stride,
-                                                           col_stride,
-                                                           row_dilation,
-                                                           col_dilation,
-                                                           ceil_mode));
+  MLUDescKey key;
+  key.Append('2')
+      .Append(mode)
+      .Append(maxpooling_nan_opt)
+      .Append(window_rows)
+      .Append(window_cols)
+      .Append(pad_up)
+      .Append(pad_down)
+      .Append(pad_left)
+      .Append(pad_right)
+      .Append(row_stride)
+      .Append(col_stride)
+      .Append(row_dilation)
+      .Append(col_dilation)
+      .Append(ceil_mode);
+  pooling_desc_ = AcquireOpDesc(DestroyPoolingDesc, key, [&]() {
+    cnnlPoolingDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreatePoolingDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetPooling2dDescriptor_v2(desc,
+                                                             mode,
+                                                             maxpooling_nan_opt,
+                                                             window_rows,
+                                                             window_cols,
+                                                             pad_up,
+                                                             pad_down,
+                                                             pad_left,
+                                                             pad_right,
+                                                             row_stride,
+                                                             col_stride,
+                                                             row_dilation,
+                                                             col_dilation,
+                                                             ceil_mode));
+    return desc;
+  });
 }
 
 MLUCnnlPoolingDesc::MLUCnnlPoolingDesc(
@@ -506,14 +634,26 @@ MLUCnnlPoolingDesc::MLUCnnlPoolingDesc(
     const std::vector<int>& window,
     const std::vector<int>& padding,
     const std::vector<int>& stride) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreatePoolingDescriptor(&pooling_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetPoolingNdDescriptor(pooling_desc_,
-                                                        mode,
-                                                        maxpooling_nan_opt,
-                                                        tensor_rank,
-                                                        window.data(),
-                                                        padding.data(),
-                                                        stride.data()));
+  MLUDescKey key;
+  key.Append('n')
+      .Append(tensor_rank)
+      .Append(mode)
+      .Append(maxpooling_nan_opt)
+      .Append(window.data(), window.size())
+      .Append(padding.data(), padding.size())
+      .Append(stride.data(), stride.size());
+  pooling_desc_ = AcquireOpDesc(DestroyPoolingDesc, key, [&]() {
+    cnnlPoolingDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreatePoolingDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetPoolingNdDescriptor(desc,
+                                                          mode,
+                                                          maxpooling_nan_opt,
+                                                          tensor_rank,
+                                                          window.data(),
+                                                          padding.data(),
+                                                          stride.data()));
+    return desc;
+  });
 }
 
 const cnnlPoolingDescriptor_t MLUCnnlPoolingDesc::get() const {
@@ -521,9 +661,7 @@ const cnnlPoolingDescriptor_t MLUCnnlPoolingDesc::get() const {
 }
 
 MLUCnnlPoolingDesc::~MLUCnnlPoolingDesc() {
-  if (pooling_desc_) {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroyPoolingDescriptor(pooling_desc_));
-  }
+  ReleaseOpDesc(DestroyPoolingDesc, pooling_desc_);
 }
 
 MLUCnnlRandomGeneratorDesc::MLUCnnlRandomGeneratorDesc(const Context& ctx,
@@ -584,17 +722,28 @@ MLUCnnlReduceDesc::MLUCnnlReduceDesc(const std::vector<int>& axis_vec,
                                      const cnnlNanPropagation_t nan_propagation,
                                      const cnnlReduceIndices_t reduce_indices,
                                      const cnnlIndicesType_t indices_type) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateReduceDescriptor(&reduction_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetReduceDescriptor_v2(reduction_desc_,
-                                 const_cast<int*>(axis_vec.data()),
-                                 axis_vec.size(),
-                                 reduce_op,
-                                 data_type,
-                                 nan_propagation,
-                                 reduce_indices,
-                                 indices_type,
-                                 0 /*exponent*/));
+  MLUDescKey key;
+  key.Append(axis_vec.data(), axis_vec.size())
+      .Append(reduce_op)
+      .Append(data_type)
+      .Append(nan_propagation)
+      .Append(reduce_indices)
+      .Append(indices_type);
+  reduction_desc_ = AcquireOpDesc(DestroyReduceDesc, key, [&]() {
+    cnnlReduceDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateReduceDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(
+        cnnlSetReduceDescriptor_v2(desc,
+                                   const_cast<int*>(axis_vec.data()),
+                                   axis_vec.size(),
+                                   reduce_op,
+                                   data_type,
+                                   nan_propagation,
+                                   reduce_indices,
+                                   indices_type,
+                                   0 /*exponent*/));
+    return desc;
+  });
 }
 
 const cnnlReduceDescriptor_t MLUCnnlReduceDesc::get() const {
@@ -602,18 +751,24 @@ const cnnlReduceDescriptor_t MLUCnnlReduceDesc::get() const {
 }
 
 MLUCnnlReduceDesc::~MLUCnnlReduceDesc() {
-  if (reduction_desc_) {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroyReduceDescriptor(reduction_desc_));
-  }
+  ReleaseOpDesc(DestroyReduceDesc, reduction_desc_);
 }
 
 MLUCnnlOpTensorDesc::MLUCnnlOpTensorDesc(
     cnnlOpTensorDesc_t op_tensor_op,
     cnnlDataType_t op_tensor_comp_type,
     cnnlNanPropagation_t op_tensor_nan_opt) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateOpTensorDescriptor(&op_tensor_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetOpTensorDescriptor(
-      op_tensor_desc_, op_tensor_op, op_tensor_comp_type, op_tensor_nan_opt));
+  MLUDescKey key;
+  key.Append(op_tensor_op)
+      .Append(op_tensor_comp_type)
+      .Append(op_tensor_nan_opt);
+  op_tensor_desc_ = AcquireOpDesc(DestroyOpTensorDesc, key, [&]() {
+    cnnlOpTensorDescriptor_t desc;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateOpTensorDescriptor(&desc));
+    PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetOpTensorDescriptor(
+        desc, op_tensor_op, op_tensor_comp_type, op_tensor_nan_opt));
+    return desc;
+  });
 }
 
 const cnnlOpTensorDescriptor_t MLUCnnlOpTensorDesc::get() const {
@@ -621,9 +776,7 @@ const cnnlOpTensorDescriptor_t MLUCnnlOpTensorDesc::get() const {
 }
 
 MLUCnnlOpTensorDesc::~MLUCnnlOpTensorDesc() {
-  if (op_tensor_desc_) {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroyOpTensorDescriptor(op_tensor_desc_));
-  }
+  ReleaseOpDesc(DestroyOpTensorDesc, op_tensor_desc_);
 }
 
 MLUCnnlConvolutionDesc::MLUCnnlConvolutionDesc(
@@ -633,9 +786,8 @@ MLUCnnlConvolutionDesc::MLUCnnlConvolutionDesc(
     const int dilation[],
     const int group_count,
     const cnnlDataType_t tensor_dtype) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateConvolutionDescriptor(&conv_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetConvolutionDescriptor(
-      conv_desc_, dims, pad, stride, dilation, group_count, tensor_dtype));
+  conv_desc_ = AcquireConvolutionDesc(
+      dims, pad, stride, dilation, group_count, tensor_dtype);
 }
 
 MLUCnnlConvolutionDesc::MLUCnnlConvolutionDesc(
@@ -669,14 +821,12 @@ MLUCnnlConvolutionDesc::MLUCnnlConvolutionDesc(
                  int64_dilation_cend,
                  dilation_int32.begin(),
                  &CheckedNarrowing<int64_t, int>);
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlCreateConvolutionDescriptor(&conv_desc_));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetConvolutionDescriptor(conv_desc_,
-                                                          dims,
-                                                          pad_int32.data(),
-                                                          stride_int32.data(),
-                                                          dilation_int32.data(),
-                                                          group_count,
-                                                          tensor_dtype));
+  conv_desc_ = AcquireConvolutionDesc(dims,
+                                      pad_int32.data(),
+                                      stride_int32.data(),
+                                      dilation_int32.data(),
+                                      group_count,
+                                      tensor_dtype);
 }
 
 const cnnlConvolutionDescriptor_t MLUCnnlConvolutionDesc::get() const {
@@ -684,9 +834,7 @@ const cnnlConvolutionDescriptor_t MLUCnnlConvolutionDesc::get() const {
 }
 
 MLUCnnlConvolutionDesc::~MLUCnnlConvolutionDesc() {
-  if (conv_desc_) {
-    PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroyConvolutionDescriptor(conv_desc_));
-  }
+  ReleaseOpDesc(DestroyConvolutionDesc, conv_desc_);
 }
 
 MLUCnnlBatchSpaceDesc::MLUCnnlBatchSpaceDesc(uint32_t block_shape[],
@@ -939,9 +1087,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetConcatWorkspaceSize(handle, pack_num, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlConcat(handle,
                                         pack_num,
@@ -968,9 +1114,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetDivWorkspaceSize(
       handle, in0_desc, in1_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDiv_v2(handle,
                                         prefer,
@@ -1023,9 +1167,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetLrnWorkspaceSize(
       handle, input_quant_desc, output_desc, local_size, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   const cnnlLrnMode_t mode = CNNL_LRN_CROSS_CHANNEL;
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlLrn(handle,
@@ -1059,9 +1201,7 @@ MLURNNDesc::~MLURNNDesc() {
       cnnlGetQuantizeParamWorkspaceSize(handle, input_desc, &workspace_size));
 
   // use ctx allocate interface for profiling purpose
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   const cnnlQuantizeMode_t mode =
       compute_scale ? CNNL_QUANTIZE_POSITION_SCALE : CNNL_QUANTIZE_POSITION;
@@ -1534,9 +1674,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBatchMatMulBCastWorkspaceSize(
       handle, in0_desc, in1_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBatchMatMulBCast(handle,
                                                   transpose_a,
@@ -1587,9 +1725,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetOpTensorWorkspaceSize(
       handle, a_desc, b_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlOpTensor(handle,
                                           op_tensor_desc,
@@ -1617,9 +1753,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetAxWorkspaceSize(handle, alpha_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlAx_v2(handle,
                                        alpha_desc,
@@ -1705,9 +1839,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                             indices_output_desc,
                                                             &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlTopKTensor_v3(handle,
                                                input_desc,
@@ -1753,9 +1885,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetSplitWorkspaceSize(handle, split_num, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlSplit(handle,
                                        split_num,
@@ -1868,9 +1998,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetLogicOpWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlLogicOp(handle,
                                          log_method,
@@ -1899,9 +2027,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetSelectV2WorkspaceSize(
       handle, condition_desc, then_desc, else_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlSelectV2(handle,
                                           condition_desc,
@@ -1942,9 +2068,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBatch2spaceWorkspaceSize(
       handle, input_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBatch2space(handle,
                                              input_desc,
@@ -2080,9 +2204,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetPoolingWorkspaceSize(
       handle, pool_mode, output_w, output_h, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlPoolingForward_v2(handle,
                                                    pooling_desc,
@@ -2134,9 +2256,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetPoolingWorkspaceSize(
       handle, pool_mode, output_shape[2], output_shape[1], &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlPoolingForward(handle,
                                                 pooling_desc,
@@ -2186,9 +2306,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetUnsortedSegmentSumWorkspaceSize(
       handle, data_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlUnsortedSegmentSum(handle,
                                                     data_desc,
@@ -2274,9 +2392,7 @@ MLURNNDesc::~MLURNNDesc() {
                                              algo,
                                              &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlConvolutionForward(handle,
                                                     conv_desc,
@@ -2348,12 +2464,10 @@ MLURNNDesc::~MLURNNDesc() {
 
   size_t workspace_size = 0;
   void* workspace_ptr = nullptr;
-  Tensor workspace;
   if (need_workspace) {
     PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetReduceOpWorkspaceSize(
         handle, input_desc, output_desc, reduction_desc, &workspace_size));
-    workspace.Resize({static_cast<int64_t>(workspace_size)});
-    workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+    workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
   }
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlReduce(handle,
@@ -2383,9 +2497,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetFloorDivWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlFloorDiv_v2(handle,
                                              prefer,
@@ -2411,9 +2523,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetFloorModWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlFloorMod(handle,
                                           input1_desc,
@@ -2438,9 +2548,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetMaximumWorkspaceSize(handle, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlMaximum(handle,
                                          input1_desc,
@@ -2465,9 +2573,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetMinimumWorkspaceSize(handle, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlMinimum(handle,
                                          input1_desc,
@@ -2493,9 +2599,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetPowWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlPow(handle,
                                      prefer,
@@ -2522,9 +2626,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetPowRWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlPowR_v2(handle,
                                          prefer,
@@ -2551,9 +2653,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetDivNoNanWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDivNoNan_v2(handle,
                                              prefer,
@@ -2580,9 +2680,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetSquaredDifferenceWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlSquaredDifference(handle,
                                                    input1_desc,
@@ -2846,9 +2944,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetDynamicStitchWorkspaceSize(handle, size, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDynamicStitch(handle,
                                                indices_desc,
@@ -3106,9 +3202,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetNmsWorkspaceSize_v2(handle, confidence_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlNms_v2(handle,
                                         nms_desc,
@@ -3154,9 +3248,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetSpace2batchWorkspaceSize(
       handle, input_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   cnnlSpaceBatchParam_t param = {static_cast<uint32_t>(block_shape[0]),
                                  static_cast<uint32_t>(block_shape[1])};
@@ -3328,9 +3420,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetLayerNormOpWorkspaceSize(handle, axis, x_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlLayerNormForward(handle,
                                                   x_desc,
@@ -3399,9 +3489,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetQuantizeParamWorkspaceSize(handle, input_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlQuantizeParam(handle,
                                                mode,
@@ -3415,32 +3503,33 @@ MLURNNDesc::~MLURNNDesc() {
                                                offset));
 }
 
-/* static */ void MLUCnnl::Conv2D(const Context& ctx,
-                                  const cnnlConvolutionDescriptor_t conv_desc,
-                                  const cnnlDataType_t tensor_dtype,
-                                  const cnnlDataType_t dt_onchip,
-                                  const void* input_position,
-                                  const void* input_scale,
-                                  const void* input_offset,
-                                  const void* filter_position,
-                                  const void* filter_scale,
-                                  const void* filter_offset,
-                                  const cnnlTensorDescriptor_t input_desc,
-                                  const void* input,
-                                  const cnnlTensorDescriptor_t filter_desc,
-                                  const void* filter,
-                                  const cnnlTensorDescriptor_t bias_desc,
-                                  const void* bias,
-                                  const cnnlTensorDescriptor_t output_desc,
-                                  void* output) {
+/* static */ void MLUCnnl::Conv2D(
+    const Context& ctx,
+    const cnnlConvolutionDescriptor_t conv_desc,
+    const cnnlDataType_t tensor_dtype,
+    const cnnlDataType_t dt_onchip,
+    const void* input_position,
+    const void* input_scale,
+    const void* input_offset,
+    const void* filter_position,
+    const void* filter_scale,
+    const void* filter_offset,
+    const cnnlTensorDescriptor_t shared_input_desc,
+    const void* input,
+    const cnnlTensorDescriptor_t shared_filter_desc,
+    const void* filter,
+    const cnnlTensorDescriptor_t bias_desc,
+    const void* bias,
+    const cnnlTensorDescriptor_t shared_output_desc,
+    void* output) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(input_desc, dt_onchip));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(filter_desc, dt_onchip));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(output_desc, tensor_dtype));
+  CnnlTensorDescVariant input_desc(shared_input_desc);
+  input_desc.SetOnchipDataType(dt_onchip);
+  CnnlTensorDescVariant filter_desc(shared_filter_desc);
+  filter_desc.SetOnchipDataType(dt_onchip);
+  CnnlTensorDescVariant output_desc(shared_output_desc);
+  output_desc.SetOnchipDataType(tensor_dtype);
 
   cnnlConvolutionForwardAlgo_t algo;
   const cnnlConvolutionFwdPreference_t preference =
@@ -3464,9 +3553,7 @@ MLURNNDesc::~MLURNNDesc() {
                                              algo,
                                              &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlQuantizeConvolutionForward(handle,
                                                             conv_desc,
@@ -3509,24 +3596,22 @@ MLURNNDesc::~MLURNNDesc() {
     const void* mean_ptr,
     const cnnlTensorDescriptor_t variance_desc,
     const void* variance_ptr,
-    const cnnlTensorDescriptor_t input_desc,
+    const cnnlTensorDescriptor_t shared_input_desc,
     const void* input,
-    const cnnlTensorDescriptor_t filter_desc,
+    const cnnlTensorDescriptor_t shared_filter_desc,
     const void* filter,
-    const cnnlTensorDescriptor_t output_desc,
+    const cnnlTensorDescriptor_t shared_output_desc,
     void* output) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(input_desc, CNNL_DTYPE_INT16));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(filter_desc, CNNL_DTYPE_INT16));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(output_desc, tensor_dtype));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorPositionAndScale(
-      input_desc, input_position, input_scale));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorPositionAndScale(
-      filter_desc, filter_position, filter_scale));
+  CnnlTensorDescVariant input_desc(shared_input_desc);
+  input_desc.SetOnchipDataType(CNNL_DTYPE_INT16);
+  CnnlTensorDescVariant filter_desc(shared_filter_desc);
+  filter_desc.SetOnchipDataType(CNNL_DTYPE_INT16);
+  CnnlTensorDescVariant output_desc(shared_output_desc);
+  output_desc.SetOnchipDataType(tensor_dtype);
+  input_desc.SetPositionAndScale(input_position, input_scale);
+  filter_desc.SetPositionAndScale(filter_position, filter_scale);
 
   cnnlFusedOpsPlan_t fusion_plan = nullptr;
   cnnlActivationDescriptor_t active_desc = nullptr;
@@ -3606,9 +3691,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlMakeFusedOpsPlan(handle, fusion_plan, cparam_pack, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   if (workspace_size > 0) {
     PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetFusedOpsVariantParamPackAttribute(
@@ -3670,9 +3753,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                   algo,
                                                   &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlConvolutionBackwardData(handle,
                                                          nullptr /*alpha*/,
@@ -3700,18 +3781,18 @@ MLURNNDesc::~MLURNNDesc() {
     const void* out_backprop_position,
     const void* out_backprop_scale,
     const void* out_backprop_offset,
-    const cnnlTensorDescriptor_t filter_desc,
+    const cnnlTensorDescriptor_t shared_filter_desc,
     const void* filter,
-    const cnnlTensorDescriptor_t out_backprop_desc,
+    const cnnlTensorDescriptor_t shared_out_backprop_desc,
     const void* out_backprop,
     const cnnlTensorDescriptor_t in_backprop_desc,
     void* in_backprop) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(filter_desc, dt_onchip));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(out_backprop_desc, dt_onchip));
+  CnnlTensorDescVariant filter_desc(shared_filter_desc);
+  filter_desc.SetOnchipDataType(dt_onchip);
+  CnnlTensorDescVariant out_backprop_desc(shared_out_backprop_desc);
+  out_backprop_desc.SetOnchipDataType(dt_onchip);
 
   cnnlConvolutionBwdDataAlgo_t algo;
   const cnnlConvolutionBwdDataPreference_t preference =
@@ -3735,9 +3816,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                   algo,
                                                   &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlQuantizeConvolutionBackwardData(handle,
@@ -3794,9 +3873,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                     algo,
                                                     &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlConvolutionBackwardFilter(handle,
                                                            nullptr /*alpha*/,
@@ -3824,20 +3901,20 @@ MLURNNDesc::~MLURNNDesc() {
     const void* out_backprop_position,
     const void* out_backprop_scale,
     const void* out_backprop_offset,
-    const cnnlTensorDescriptor_t input_desc,
+    const cnnlTensorDescriptor_t shared_input_desc,
     const void* input,
-    const cnnlTensorDescriptor_t out_backprop_desc,
+    const cnnlTensorDescriptor_t shared_out_backprop_desc,
     const void* out_backprop,
-    const cnnlTensorDescriptor_t filter_backprop_desc,
+    const cnnlTensorDescriptor_t shared_filter_backprop_desc,
     void* filter_backprop) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(input_desc, dt_onchip));
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnnlSetTensorDescriptorOnchipDataType(out_backprop_desc, dt_onchip));
-  PADDLE_ENFORCE_MLU_SUCCESS(cnnlSetTensorDescriptorOnchipDataType(
-      filter_backprop_desc, tensor_dtype));
+  CnnlTensorDescVariant input_desc(shared_input_desc);
+  input_desc.SetOnchipDataType(dt_onchip);
+  CnnlTensorDescVariant out_backprop_desc(shared_out_backprop_desc);
+  out_backprop_desc.SetOnchipDataType(dt_onchip);
+  CnnlTensorDescVariant filter_backprop_desc(shared_filter_backprop_desc);
+  filter_backprop_desc.SetOnchipDataType(tensor_dtype);
 
   cnnlConvolutionBwdFilterAlgo_t algo;
   const cnnlConvolutionBwdFilterPreference_t preference =
@@ -3861,9 +3938,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                     algo,
                                                     &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlQuantizeConvolutionBackwardFilter(handle,
@@ -3914,9 +3989,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                             output_desc,
                                                             &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDCNForward(handle,
                                             dcn_desc,
@@ -3971,9 +4044,7 @@ MLURNNDesc::~MLURNNDesc() {
                                           grad_mask_desc,
                                           &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDCNBackwardData(handle,
                                                  dcn_desc,
@@ -4026,9 +4097,7 @@ MLURNNDesc::~MLURNNDesc() {
                                             grad_bias_desc,
                                             &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDCNBackwardWeight(handle,
                                                    dcn_desc,
@@ -4052,26 +4121,29 @@ MLURNNDesc::~MLURNNDesc() {
     const Context& ctx,
     const bool transpose_a,
     const bool transpose_b,
-    const cnnlTensorDescriptor_t a_desc,
+    const cnnlTensorDescriptor_t shared_a_desc,
     const void* a,
     const void* a_position,
     const void* a_scale,
     const void* a_offset,
-    const cnnlTensorDescriptor_t b_desc,
+    const cnnlTensorDescriptor_t shared_b_desc,
     const void* b,
     const void* b_position,
     const void* b_scale,
     const void* b_offset,
     const cnnlDataType_t quant_type,
     const cnnlDataType_t data_type,
-    const cnnlTensorDescriptor_t output_desc,
+    const cnnlTensorDescriptor_t shared_output_desc,
     void* output) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
   // Set onchip data type
-  cnnlSetTensorDescriptorOnchipDataType(a_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(b_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(output_desc, data_type);
+  CnnlTensorDescVariant a_desc(shared_a_desc);
+  a_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant b_desc(shared_b_desc);
+  b_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant output_desc(shared_output_desc);
+  output_desc.SetOnchipDataType(data_type);
 
   // Create and set matmul descriptor
   cnnlMatMulDescriptor_t matmul_desc;
@@ -4097,9 +4169,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetQuantizeMatMulWorkspaceSize(
       handle, matmul_desc, a_desc, b_desc, output_desc, algo, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   // Compute
   float alpha = 1.0;
@@ -4133,26 +4203,29 @@ MLURNNDesc::~MLURNNDesc() {
     const Context& ctx,
     const bool adj_x,
     const bool adj_y,
-    const cnnlTensorDescriptor_t in0_desc,
+    const cnnlTensorDescriptor_t shared_in0_desc,
     const void* in0,
     const void* in0_position,
     const void* in0_scale,
     const void* in0_offset,
-    const cnnlTensorDescriptor_t in1_desc,
+    const cnnlTensorDescriptor_t shared_in1_desc,
     const void* in1,
     const void* in1_position,
     const void* in1_scale,
     const void* in1_offset,
     const cnnlDataType_t quant_type,
     const cnnlDataType_t data_type,
-    const cnnlTensorDescriptor_t output_desc,
+    const cnnlTensorDescriptor_t shared_output_desc,
     void* output) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
   // Set onchip data type
-  cnnlSetTensorDescriptorOnchipDataType(in0_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(in1_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(output_desc, data_type);
+  CnnlTensorDescVariant in0_desc(shared_in0_desc);
+  in0_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant in1_desc(shared_in1_desc);
+  in1_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant output_desc(shared_output_desc);
+  output_desc.SetOnchipDataType(data_type);
 
   // Create and set batch matmul descriptor
   cnnlBatchMatMulDescriptor_t bmm_desc;
@@ -4184,9 +4257,7 @@ MLURNNDesc::~MLURNNDesc() {
                                               algo,
                                               &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   // Compute
   float alpha = 1.0;
@@ -4221,26 +4292,29 @@ MLURNNDesc::~MLURNNDesc() {
     const Context& ctx,
     const bool adj_x,
     const bool adj_y,
-    const cnnlTensorDescriptor_t in0_desc,
+    const cnnlTensorDescriptor_t shared_in0_desc,
     const void* in0,
     const void* in0_position,
     const void* in0_scale,
     const void* in0_offset,
-    const cnnlTensorDescriptor_t in1_desc,
+    const cnnlTensorDescriptor_t shared_in1_desc,
     const void* in1,
     const void* in1_position,
     const void* in1_scale,
     const void* in1_offset,
     const cnnlDataType_t quant_type,
     const cnnlDataType_t data_type,
-    const cnnlTensorDescriptor_t output_desc,
+    const cnnlTensorDescriptor_t shared_output_desc,
     void* output) {
   cnnlHandle_t handle = GetHandleFromCTX(ctx);
 
   // Set onchip data type
-  cnnlSetTensorDescriptorOnchipDataType(in0_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(in1_desc, quant_type);
-  cnnlSetTensorDescriptorOnchipDataType(output_desc, data_type);
+  CnnlTensorDescVariant in0_desc(shared_in0_desc);
+  in0_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant in1_desc(shared_in1_desc);
+  in1_desc.SetOnchipDataType(quant_type);
+  CnnlTensorDescVariant output_desc(shared_output_desc);
+  output_desc.SetOnchipDataType(data_type);
 
   // Create and set batch matmul descriptor
   cnnlBatchMatMulBCastDescriptor_t bmm_bcast_desc;
@@ -4287,9 +4361,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                    algo,
                                                    &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   // Compute
   float alpha = 1.0;
@@ -4337,9 +4409,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetTransposeWorkspaceSize(
       handle, input_desc, perm_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlTranspose_v2(handle,
                                               perm_desc,
@@ -4403,9 +4473,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetWhereWorkspaceSize(handle, num_true_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlWhere_v2(handle,
                                           x_desc,
@@ -4478,9 +4546,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBitComputeWorkspaceSize(
       handle, input1_desc, input2_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBitCompute_v2(handle,
                                                optype,
@@ -4507,9 +4573,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(
       cnnlGetQRWorkspaceSize(handle, a_desc, some, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlQR(handle,
                                     a_desc,
@@ -4550,9 +4614,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBceLossWorkspaceSize(
       handle, input_desc, weight_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBceLoss(handle,
                                          input_desc,
@@ -4587,9 +4649,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBceLossBackwardWorkspaceSize(
       handle, target_desc, weight_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBceLossBackward(handle,
                                                  grad_desc,
@@ -4623,9 +4683,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetSmoothL1LossForwardWorkspaceSize(
       handle, x_desc, algorithm, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlSmoothL1LossForward_v2(handle,
                                                         x_desc,
@@ -4658,9 +4716,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetSmoothL1LossBackwardWorkspaceSize(
       handle, x_desc, algorithm, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlSmoothL1LossBackward_v2(handle,
                                                          x_desc,
@@ -4736,9 +4792,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetEmbeddingBackwardWorkspaceSize(
       handle, diff_desc, output_desc, scale_grad_by_freq, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlEmbeddingBackward(handle,
                                                    padding_idx,
@@ -4783,9 +4837,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetRNNTempSizes(
       handle, rnn_desc, x_desc, &workspace_size, &reservespace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlRNNForwardTraining(handle,
                                                     rnn_desc,
@@ -4844,9 +4896,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetRNNTempSizes(
       handle, rnn_desc, x_desc, &workspace_size, &reservespace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlRNNBackwardData(handle,
                                                  rnn_desc,
@@ -4910,9 +4960,7 @@ MLURNNDesc::~MLURNNDesc() {
                                                         output_desc,
                                                         &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlMasked_v4(handle,
                                            masked_mode,
@@ -4949,9 +4997,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBceWithLogitsWorkspaceSize(
       handle, input_desc, weight_desc, pos_weight_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   const cnnlComputationPreference_t prefer = CNNL_COMPUTATION_HIGH_PRECISION;
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBceWithLogits_v2(handle,
@@ -4992,9 +5038,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetBceWithLogitsBackwardWorkspaceSize(
       handle, target_desc, weight_desc, pos_weight_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlBceWithLogitsBackward(handle,
                                                        grad_desc,
@@ -5099,9 +5143,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGetGridSampleForwardWorkspaceSize(
       handle, input_desc, grid_desc, output_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlGridSampleForward(handle,
                                                    grid_sample_desc,
@@ -5410,9 +5452,7 @@ MLURNNDesc::~MLURNNDesc() {
   PADDLE_ENFORCE_MLU_SUCCESS(mluOpGetGenerateProposalsV2WorkspaceSize(
       handle, scores_desc, &workspace_size));
 
-  Tensor workspace;
-  workspace.Resize({static_cast<int64_t>(workspace_size)});
-  void* workspace_ptr = ctx.Alloc(&workspace, DataType::INT8, workspace_size);
+  void* workspace_ptr = GetWorkspaceFromCTX(ctx, workspace_size);
 
   PADDLE_ENFORCE_MLU_SUCCESS(mluOpGenerateProposalsV2(handle,
                                                       pre_nms_top_n,
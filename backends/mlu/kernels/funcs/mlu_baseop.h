@@ -16,6 +16,7 @@
 #include <concurrentqueue.h>
 
 #include <deque>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -176,6 +177,12 @@ inline static mluOpHandle_t GetMLUOpHandleFromCTX(const Context& dev_ctx) {
   return GetOpHandle(dev_ctx.stream());
 }
 
+// Workspace of a single cnnl or mluOp call, valid until the next call on the
+// same stream asks for one. See MLUWorkspaceArena.
+inline static void* GetWorkspaceFromCTX(const Context& dev_ctx, size_t size) {
+  return GetWorkspace(dev_ctx.stream(), size);
+}
+
 // Converts (via narrowing) a type T value to a type U, and checks that the
 // value has no value change due to the conversion.
 template <typename WideT, typename NarrowT>
@@ -472,8 +479,14 @@ class MLUCnnlRandomGeneratorDesc {
   cnnlRandGenerator_t mlu_generator = nullptr;
 };
 
-const std::shared_ptr<MLUCnnlRandomGeneratorDesc>& GetMLURandomGenerator(
-    const Context& ctx, const int64_t device_id, const int seed);
+// Returns the generator of the random kernels issued on ctx's stream, one
+// per stream so that streams never race on its state. It is kept on the
+// runtime's CustomMLUStream and destroyed with it. The MTGP32 state lives
+// on the device and the kernels drawing from it advance it themselves, so
+// using the generator never reads back to the host. seed is only called to
+// create the generator on first use.
+std::shared_ptr<MLUCnnlRandomGeneratorDesc> GetMLURandomGenerator(
+    const Context& ctx, const std::function<int()>& seed);
 
 class MLUCnnlReduceDesc {
  public:
@@ -0,0 +1,151 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace custom_kernel {
+
+// A reference-counted cache of CNNL and MLU-OPS descriptors keyed by the
+// parameters they were created with. Instances are meant to be thread_local,
+// so the cache takes no lock and a descriptor must be released on the thread
+// that acquired it, which holds for the descriptor classes of mlu_baseop.h as
+// they never outlive a kernel call.
+//
+// Acquire returns the cached descriptor for a key, creating it on a miss, and
+// every Acquire has to be paired with a Release. Descriptors nobody holds
+// stay cached on an LRU list; at most `capacity` of them are kept and the
+// least recently released ones are destroyed first. Descriptors are shared
+// by every holder of the same key, so they must not be modified.
+//
+// Handle is a raw descriptor type such as cnnlTensorDescriptor_t. The cache
+// does not depend on CNNL itself and can be exercised with any pointer type.
+template <typename Handle, typename Key, typename Hash = std::hash<Key>>
+class MLUDescCache {
+ public:
+  using Destroyer = void (*)(Handle);
+
+  MLUDescCache(Destroyer destroy, size_t capacity)
+      : destroy_(destroy), capacity_(capacity) {}
+
+  MLUDescCache(const MLUDescCache&) = delete;
+  MLUDescCache& operator=(const MLUDescCache&) = delete;
+
+  ~MLUDescCache() {
+    for (auto& pair : entries_) {
+      destroy_(pair.first);
+    }
+  }
+
+  template <typename Create>
+  Handle Acquire(const Key& key, Create&& create) {
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      auto& entry = entries_.at(iter->second);
+      if (entry.refs++ == 0) {
+        idle_.erase(entry.idle_pos);
+      }
+      ++hits_;
+      return iter->second;
+    }
+    Handle handle = create(key);
+    index_.emplace(key, handle);
+    entries_.emplace(handle, Entry{key, 1, idle_.end()});
+    ++misses_;
+    return handle;
+  }
+
+  // Returns false if handle was not acquired from this cache.
+  bool Release(Handle handle) {
+    auto iter = entries_.find(handle);
+    if (iter == entries_.end()) {
+      return false;
+    }
+    auto& entry = iter->second;
+    if (--entry.refs == 0) {
+      idle_.push_front(handle);
+      entry.idle_pos = idle_.begin();
+      while (idle_.size() > capacity_) {
+        Evict(idle_.back());
+      }
+    }
+    return true;
+  }
+
+  // Copies the key handle was created with, returns false if handle was not
+  // acquired from this cache.
+  bool GetKey(Handle handle, Key* key) const {
+    auto iter = entries_.find(handle);
+    if (iter == entries_.end()) {
+      return false;
+    }
+    *key = iter->second.key;
+    return true;
+  }
+
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+
+ private:
+  struct Entry {
+    Key key;
+    size_t refs;
+    typename std::list<Handle>::iterator idle_pos;
+  };
+
+  void Evict(Handle handle) {
+    auto iter = entries_.find(handle);
+    index_.erase(iter->second.key);
+    idle_.erase(iter->second.idle_pos);
+    entries_.erase(iter);
+    destroy_(handle);
+  }
+
+  Destroyer destroy_;
+  size_t capacity_;
+  std::unordered_map<Key, Handle, Hash> index_;
+  std::unordered_map<Handle, Entry> entries_;
+  std::list<Handle> idle_;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+};
+
+// Builds a cache key from the raw bytes of descriptor parameters.
+class MLUDescKey {
+ public:
+  template <typename T>
+  MLUDescKey& Append(const T& value) {
+    key_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    return *this;
+  }
+
+  template <typename T>
+  MLUDescKey& Append(const T* values, size_t size) {
+    Append(size);
+    key_.append(reinterpret_cast<const char*>(values), sizeof(T) * size);
+    return *this;
+  }
+
+  const std::string& str() const { return key_; }
+
+ private:
+  std::string key_;
+};
+
+}  // namespace custom_kernel
@@ -262,6 +262,39 @@ inline void TensorToVector<bool>(const phi::CustomContext& ctx,
   delete[] array;
 }
 
+/**
+ * Reads src back in the order of dev_ctx's queue, without the dev_ctx.Wait()
+ * TensorToVector needs. Start it as soon as src is produced and call Wait
+ * where the values are actually used, work issued in between overlaps with
+ * the copy.
+ */
+template <typename T>
+class TensorReadback {
+ public:
+  TensorReadback(const phi::CustomContext& dev_ctx, const phi::DenseTensor& src)
+      : numel_(DeviceNumel(src)),
+        readback_(dev_ctx.stream(), src.data<T>(), numel_ * sizeof(T)) {}
+
+  const T* Wait() { return static_cast<const T*>(readback_.Wait()); }
+
+  std::vector<T> ToVector() {
+    const T* data = Wait();
+    return std::vector<T>(data, data + numel_);
+  }
+
+ private:
+  static int64_t DeviceNumel(const phi::DenseTensor& src) {
+    if (src.place().GetType() != phi::AllocationType::CUSTOM) {
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "TensorReadback on %s is not supported.", src.place()));
+    }
+    return src.numel();
+  }
+
+  int64_t numel_;
+  MLUReadback readback_;
+};
+
 static inline int CanonicalAxis(const int axis, const int rank) {
   if (axis < 0) {
     return axis + rank;
@@ -106,12 +106,8 @@ void GenerateProposalsV2Kernel(const Context& dev_ctx,
                              GetBasePtr(&rpn_roi_num_tmp),
                              GetBasePtr(&rpn_rois_batch_size));
 
-  dev_ctx.Wait();
-  std::vector<int> rpn_rois_batch_size_cpu;
-  TensorToVector<int>(
-      dev_ctx, rpn_rois_batch_size, dev_ctx, &rpn_rois_batch_size_cpu);
-
-  int roi_num_final = rpn_rois_batch_size_cpu[0];
+  TensorReadback<int> rpn_rois_batch_size_cpu(dev_ctx, rpn_rois_batch_size);
+  int roi_num_final = rpn_rois_batch_size_cpu.Wait()[0];
   rpn_rois->Resize({roi_num_final, 4});
   rpn_roi_probs->Resize({roi_num_final, 1});
 }
@@ -95,15 +95,10 @@ void MaskedSelectGradKernel(const Context& dev_ctx,
                                 true,  /* reduce_all */
                                 reduce_name,
                                 &mask_valid_num_tensor);
-
-  dev_ctx.Wait();
-  TensorToVector<int32_t>(
-      dev_ctx, mask_valid_num_tensor, dev_ctx, &mask_valid_num_vec);
-
-  VLOG(3) << "[MaskedSelectGradKernel] valid mask num "
-          << mask_valid_num_vec[0];
-  VLOG(3) << "[MaskedSelectGradKernel] numel of mask_tensor "
-          << mask_tensor.numel();
+  // The count is first needed to size the indices, the TopK in between runs
+  // while it is read back.
+  TensorReadback<int32_t> mask_valid_num_readback(dev_ctx,
+                                                  mask_valid_num_tensor);
 
   // get mask indice
   Tensor topk_v2_out, mask_indices;
@@ -130,6 +125,12 @@ void MaskedSelectGradKernel(const Context& dev_ctx,
                 mask_indices_desc.get(),
                 GetBasePtr(&mask_indices));
 
+  mask_valid_num_vec = mask_valid_num_readback.ToVector();
+  VLOG(3) << "[MaskedSelectGradKernel] valid mask num "
+          << mask_valid_num_vec[0];
+  VLOG(3) << "[MaskedSelectGradKernel] numel of mask_tensor "
+          << mask_tensor.numel();
+
   // copy out valid mask indices
   Tensor valid_mask_indices;
   valid_mask_indices.Resize({mask_valid_num_vec[0]});
@@ -158,7 +159,6 @@ void MaskedSelectGradKernel(const Context& dev_ctx,
                  GetBasePtr(&out_grad_tmp_out),
                  GetBasePtr(&out_grad),
                  mask_valid_num_vec[0] * sizeof(T));
-  dev_ctx.Wait();
 
   Tensor indices_int32_tmp;
   indices_int32_tmp = valid_mask_indices;
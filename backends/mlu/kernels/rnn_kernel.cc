@@ -83,12 +83,11 @@ void RnnKernel(const Context& dev_ctx,
       seq_len, batch_size, direction_num * hidden_size};
   int proj_size = hidden_size;
 
-  std::vector<int> seq_len_vec(batch_size, seq_len);
-  if (sequence_length.is_initialized()) {  // set seq_len if no padding,
-                                           // otherwise seq_len for
-                                           // each element.
-    custom_kernel::TensorToVector(
-        dev_ctx, *sequence_length, dev_ctx, &seq_len_vec);
+  // seq_len if no padding, otherwise seq_len for each element. The lengths
+  // are read back while the host checks and sets up the rest.
+  std::unique_ptr<TensorReadback<int>> seq_len_readback;
+  if (sequence_length.is_initialized()) {
+    seq_len_readback.reset(new TensorReadback<int>(dev_ctx, *sequence_length));
   }
   cnnlDirectionMode_t direction =
       is_bidirec ? CNNL_RNN_BIDIRECTIONAL : CNNL_RNN_UNIDIRECTIONAL;
@@ -134,6 +133,10 @@ void RnnKernel(const Context& dev_ctx,
   dev_ctx.template Alloc<T>(last_h);  // -> hy in cnnl
   dev_ctx.template Alloc<T>(last_c);  // -> cy in cnnl
 
+  std::vector<int> seq_len_vec(batch_size, seq_len);
+  if (seq_len_readback) {
+    seq_len_vec = seq_len_readback->ToVector();
+  }
   MLUSeqDataDesc input_seq_data_desc(CNNL_SEQDATA_TNC,
                                      ToCnnlDataType(x.dtype()),
                                      in_out_dim_num,
@@ -274,8 +277,8 @@ void RnnKernel(const Context& dev_ctx,
       }
     }
 
+    // The copy is staged, h_masked_tensor may go before it is done.
     TensorCopy(dev_ctx, h_masked_tensor, false, &masked_tensor);
-    dev_ctx.Wait();
 
     FillMLUTensorWithHostValue(dev_ctx, off_value, &on_value_tensor);
     MLUCnnlTensorDesc on_value_desc(on_value_tensor);
@@ -349,6 +352,13 @@ void RnnGradKernel(const Context& dev_ctx,
   int out_dim_arr[in_out_dim_num] = {
       seq_len, batch_size, direction_num * hidden_size};
   int proj_size = hidden_size;
+
+  // Read the lengths back ahead of the fills below, so that waiting for them
+  // does not wait for the fills too.
+  std::unique_ptr<TensorReadback<int>> seq_len_readback;
+  if (sequence_length.is_initialized()) {
+    seq_len_readback.reset(new TensorReadback<int>(dev_ctx, *sequence_length));
+  }
   PADDLE_ENFORCE_EQ(
       num_layers,
       1,
@@ -415,9 +425,8 @@ void RnnGradKernel(const Context& dev_ctx,
   }
 
   std::vector<int> seq_len_vec(batch_size, seq_len);
-  if (sequence_length.is_initialized()) {
-    custom_kernel::TensorToVector(
-        dev_ctx, *sequence_length, dev_ctx, &seq_len_vec);
+  if (seq_len_readback) {
+    seq_len_vec = seq_len_readback->ToVector();
   }
   cnnlDirectionMode_t direction =
       is_bidirec ? CNNL_RNN_BIDIRECTIONAL : CNNL_RNN_UNIDIRECTIONAL;
@@ -480,7 +489,6 @@ void RnnGradKernel(const Context& dev_ctx,
   AsyncMemCpyD2D(nullptr, stream, w_h_ptr, w_h.first, w_h.second);
   AsyncMemCpyD2D(nullptr, stream, b_x_ptr, b_x.first, b_x.second);
   AsyncMemCpyD2D(nullptr, stream, b_h_ptr, b_h.first, b_h.second);
-  dev_ctx.Wait();
 
   if (is_bidirec) {
     auto bw_x = parameter_lists[0][4];
@@ -502,7 +510,6 @@ void RnnGradKernel(const Context& dev_ctx,
     AsyncMemCpyD2D(nullptr, stream, bb_x_ptr, bb_x.first, bb_x.second);
     AsyncMemCpyD2D(nullptr, stream, bb_h_ptr, bb_h.first, bb_h.second);
   }
-  dev_ctx.Wait();
 
   PADDLE_ENFORCE_EQ(weightspace_size,
                     actual_total_w_size,
@@ -555,7 +562,6 @@ void RnnGradKernel(const Context& dev_ctx,
   AsyncMemCpyD2D(nullptr, stream, dw_h.first, dw_h_ptr, dw_h.second);
   AsyncMemCpyD2D(nullptr, stream, db_x.first, db_x_ptr, db_x.second);
   AsyncMemCpyD2D(nullptr, stream, db_h.first, db_h_ptr, db_h.second);
-  dev_ctx.Wait();
 
   if (is_bidirec) {
     auto dbw_x = parameter_lists_grad[0][4];
@@ -579,7 +585,6 @@ void RnnGradKernel(const Context& dev_ctx,
     AsyncMemCpyD2D(nullptr, stream, dbb_x.first, dbb_x_ptr, dbb_x.second);
     AsyncMemCpyD2D(nullptr, stream, dbb_h.first, dbb_h_ptr, dbb_h.second);
   }
-  dev_ctx.Wait();
 
   PADDLE_ENFORCE_EQ(weightspace_size,
                     dactual_total_w_size,
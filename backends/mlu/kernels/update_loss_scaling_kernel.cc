@@ -0,0 +1,243 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/funcs/mlu_baseop.h"
+#include "kernels/funcs/mlu_funcs.h"
+
+namespace custom_kernel {
+
+// out = cond ? x : y, cond is broadcast over x and y.
+template <typename Context>
+void SelectOnDevice(const Context& dev_ctx,
+                    const phi::DenseTensor& cond,
+                    const phi::DenseTensor& x,
+                    const phi::DenseTensor& y,
+                    phi::DenseTensor* out) {
+  MLUCnnlTensorDesc cond_desc(cond);
+  MLUCnnlTensorDesc x_desc(x);
+  MLUCnnlTensorDesc y_desc(y);
+  MLUCnnlTensorDesc out_desc(*out);
+  MLUCnnl::Select(dev_ctx,
+                  cond_desc.get(),
+                  GetBasePtr(&cond),
+                  x_desc.get(),
+                  GetBasePtr(&x),
+                  y_desc.get(),
+                  GetBasePtr(&y),
+                  out_desc.get(),
+                  GetBasePtr(out));
+}
+
+template <typename T, typename Context>
+phi::DenseTensor ScalarOnDevice(const Context& dev_ctx, T value) {
+  phi::DenseTensor out;
+  out.Resize({1});
+  dev_ctx.template Alloc<T>(&out);
+  FillMLUTensorWithHostValue<T>(dev_ctx, value, &out);
+  return out;
+}
+
+// Follows the GPU kernel: on an overflow step the good counter is reset and
+// after decr_every_n_nan_or_inf of them the scale shrinks (not below 1),
+// otherwise after incr_every_n_steps clean steps it grows (unless that
+// overflows). Every branch is taken with Select on device, so neither
+// found_inf nor the counters are read back.
+template <typename MPDType, typename Context>
+void UpdateOnDevice(const Context& dev_ctx,
+                    const phi::DenseTensor& found_inf,
+                    const phi::DenseTensor& pre_loss_scaling,
+                    const phi::DenseTensor& good_in,
+                    const phi::DenseTensor& bad_in,
+                    int incr_every_n_steps,
+                    int decr_every_n_nan_or_inf,
+                    float incr_ratio,
+                    float decr_ratio,
+                    phi::DenseTensor* updated_loss_scaling,
+                    phi::DenseTensor* good_out,
+                    phi::DenseTensor* bad_out) {
+  auto zero = ScalarOnDevice<int>(dev_ctx, 0);
+  auto one = ScalarOnDevice<int>(dev_ctx, 1);
+  auto incr_steps = ScalarOnDevice<int>(dev_ctx, incr_every_n_steps);
+  auto decr_steps = ScalarOnDevice<int>(dev_ctx, decr_every_n_nan_or_inf);
+
+  phi::DenseTensor good_next, bad_next, incr_hit, decr_hit;
+  good_next.Resize({1});
+  bad_next.Resize({1});
+  incr_hit.Resize({1});
+  decr_hit.Resize({1});
+  dev_ctx.template Alloc<int>(&good_next);
+  dev_ctx.template Alloc<int>(&bad_next);
+  dev_ctx.template Alloc<bool>(&incr_hit);
+  dev_ctx.template Alloc<bool>(&decr_hit);
+
+  MLUCnnlTensorDesc count_desc(good_in);
+  MLUCnnlTensorDesc hit_desc(incr_hit);
+  MLUCnnlOpTensorDesc add_desc(
+      CNNL_OP_TENSOR_ADD, ToCnnlDataType<int>(), CNNL_NOT_PROPAGATE_NAN);
+  MLUCnnl::OpTensor(dev_ctx,
+                    add_desc.get(),
+                    count_desc.get(),
+                    GetBasePtr(&good_in),
+                    count_desc.get(),
+                    GetBasePtr(&one),
+                    count_desc.get(),
+                    GetBasePtr(&good_next),
+                    ToCnnlDataType<int>());
+  MLUCnnl::OpTensor(dev_ctx,
+                    add_desc.get(),
+                    count_desc.get(),
+                    GetBasePtr(&bad_in),
+                    count_desc.get(),
+                    GetBasePtr(&one),
+                    count_desc.get(),
+                    GetBasePtr(&bad_next),
+                    ToCnnlDataType<int>());
+  MLUCnnl::Logic(dev_ctx,
+                 CNNL_LOGIC_OP_GE,
+                 count_desc.get(),
+                 GetBasePtr(&good_next),
+                 count_desc.get(),
+                 GetBasePtr(&incr_steps),
+                 hit_desc.get(),
+                 GetBasePtr(&incr_hit));
+  MLUCnnl::Logic(dev_ctx,
+                 CNNL_LOGIC_OP_GE,
+                 count_desc.get(),
+                 GetBasePtr(&bad_next),
+                 count_desc.get(),
+                 GetBasePtr(&decr_steps),
+                 hit_desc.get(),
+                 GetBasePtr(&decr_hit));
+
+  // A counter that reached its threshold starts over.
+  SelectOnDevice(dev_ctx, incr_hit, zero, good_next, &good_next);
+  SelectOnDevice(dev_ctx, decr_hit, zero, bad_next, &bad_next);
+  SelectOnDevice(dev_ctx, found_inf, zero, good_next, good_out);
+  SelectOnDevice(dev_ctx, found_inf, bad_next, zero, bad_out);
+
+  phi::DenseTensor grown, shrunk, grown_inf;
+  grown.Resize({1});
+  shrunk.Resize({1});
+  grown_inf.Resize({1});
+  dev_ctx.template Alloc<MPDType>(&grown);
+  dev_ctx.template Alloc<MPDType>(&shrunk);
+  dev_ctx.template Alloc<bool>(&grown_inf);
+
+  MLUCnnlTensorDesc scale_desc(pre_loss_scaling);
+  const MPDType incr = static_cast<MPDType>(incr_ratio);
+  const MPDType decr = static_cast<MPDType>(decr_ratio);
+  const MPDType no_shift = static_cast<MPDType>(0);
+  MLUCnnl::Transform(dev_ctx,
+                     &incr,
+                     &no_shift,
+                     scale_desc.get(),
+                     GetBasePtr(&pre_loss_scaling),
+                     scale_desc.get(),
+                     GetBasePtr(&grown));
+  MLUCnnl::Transform(dev_ctx,
+                     &decr,
+                     &no_shift,
+                     scale_desc.get(),
+                     GetBasePtr(&pre_loss_scaling),
+                     scale_desc.get(),
+                     GetBasePtr(&shrunk));
+
+  // A grown scale that overflowed keeps the previous one, a shrunk one
+  // stays at least 1.
+  MLUCnnl::IsNanInf(dev_ctx,
+                    scale_desc.get(),
+                    GetBasePtr(&grown),
+                    GetBasePtr(&grown_inf));
+  SelectOnDevice(dev_ctx, grown_inf, pre_loss_scaling, grown, &grown);
+  auto min_scale = ScalarOnDevice<MPDType>(dev_ctx, static_cast<MPDType>(1));
+  MLUCnnl::Maximum(dev_ctx,
+                   scale_desc.get(),
+                   GetBasePtr(&shrunk),
+                   scale_desc.get(),
+                   GetBasePtr(&min_scale),
+                   scale_desc.get(),
+                   GetBasePtr(&shrunk));
+
+  SelectOnDevice(dev_ctx, incr_hit, grown, pre_loss_scaling, &grown);
+  SelectOnDevice(dev_ctx, decr_hit, shrunk, pre_loss_scaling, &shrunk);
+  SelectOnDevice(dev_ctx, found_inf, shrunk, grown, updated_loss_scaling);
+}
+
+template <typename T, typename Context>
+void UpdateLossScalingKernel(const Context& dev_ctx,
+                             const std::vector<const phi::DenseTensor*>& xs,
+                             const phi::DenseTensor& found_inf,
+                             const phi::DenseTensor& prev_loss_scaling,
+                             const phi::DenseTensor& in_good_steps,
+                             const phi::DenseTensor& in_bad_steps,
+                             int incr_every_n_steps,
+                             int decr_every_n_nan_or_inf,
+                             float incr_ratio,
+                             float decr_ratio,
+                             const phi::Scalar& stop_update,
+                             std::vector<phi::DenseTensor*> outs,
+                             phi::DenseTensor* loss_scaling,
+                             phi::DenseTensor* out_good_steps,
+                             phi::DenseTensor* out_bad_steps) {
+  using MPDType = typename MPTypeTrait<T>::Type;
+  PADDLE_ENFORCE_EQ(
+      found_inf.numel(),
+      1,
+      phi::errors::InvalidArgument("FoundInfinite must has only one element."));
+
+  // Zero the gradients of an overflow step, found_inf is broadcast over each
+  // of them instead of being read back to pick a branch.
+  if (!xs.empty()) {
+    auto zero = ScalarOnDevice<T>(dev_ctx, static_cast<T>(0));
+    for (size_t i = 0; i < xs.size(); ++i) {
+      dev_ctx.template Alloc<T>(outs[i]);
+      SelectOnDevice(dev_ctx, found_inf, zero, *xs[i], outs[i]);
+    }
+  }
+
+  if (stop_update.to<bool>()) {
+    return;
+  }
+
+  dev_ctx.template Alloc<MPDType>(loss_scaling);
+  dev_ctx.template Alloc<int>(out_good_steps);
+  dev_ctx.template Alloc<int>(out_bad_steps);
+  UpdateOnDevice<MPDType>(dev_ctx,
+                          found_inf,
+                          prev_loss_scaling,
+                          in_good_steps,
+                          in_bad_steps,
+                          incr_every_n_steps,
+                          decr_every_n_nan_or_inf,
+                          incr_ratio,
+                          decr_ratio,
+                          loss_scaling,
+                          out_good_steps,
+                          out_bad_steps);
+}
+
+}  // namespace custom_kernel
+
+PD_REGISTER_PLUGIN_KERNEL(update_loss_scaling,
+                          CustomMLU,
+                          ALL_LAYOUT,
+                          custom_kernel::UpdateLossScalingKernel,
+                          float,
+                          phi::dtype::float16) {
+  if (kernel_key.dtype() == phi::DataType::FLOAT16) {
+    kernel->OutputAt(1).SetDataType(phi::DataType::FLOAT32);
+  }
+  kernel->OutputAt(2).SetDataType(phi::DataType::INT32);
+  kernel->OutputAt(3).SetDataType(phi::DataType::INT32);
+}
@@ -0,0 +1,328 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "runtime/process_cnpapi_data.h"
+
+#include <cxxabi.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "runtime/runtime.h"
+
+namespace {
+
+using paddle::platform::DeviceTraceEvent;
+using paddle::platform::RuntimeTraceEvent;
+using paddle::platform::TracerEventType;
+
+// Size of the buffers handed to CNPAPI for activity records.
+constexpr size_t kActivityBufferSize = 1 << 23;
+
+constexpr cnpapiActivityType kActivityTypes[] = {
+    CNPAPI_ACTIVITY_TYPE_KERNEL,
+    CNPAPI_ACTIVITY_TYPE_MEMCPY,
+    CNPAPI_ACTIVITY_TYPE_MEMCPY_PTOP,
+    CNPAPI_ACTIVITY_TYPE_MEMSET,
+    CNPAPI_ACTIVITY_TYPE_CNDRV_API,
+    CNPAPI_ACTIVITY_TYPE_CNRT_API,
+    CNPAPI_ACTIVITY_TYPE_CNCL_API,
+};
+
+uint64_t HostTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string Demangle(const char *name) {
+  if (name == nullptr) {
+    return "unknown";
+  }
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status != 0) {
+    return name;
+  }
+  std::string result(demangled);
+  free(demangled);
+  return result;
+}
+
+const char *MemcpyKind(cnpapiActivityMemcpyType kind) {
+  switch (kind) {
+    case CNPAPI_ACTIVITY_MEMCPY_TYPE_HTOD:
+      return "MEMCPY_HtoD";
+    case CNPAPI_ACTIVITY_MEMCPY_TYPE_DTOH:
+      return "MEMCPY_DtoH";
+    case CNPAPI_ACTIVITY_MEMCPY_TYPE_DTOD:
+      return "MEMCPY_DtoD";
+    case CNPAPI_ACTIVITY_MEMCPY_TYPE_HTOH:
+      return "MEMCPY_HtoH";
+    case CNPAPI_ACTIVITY_MEMCPY_TYPE_PTOP:
+      return "MEMCPY_PtoP";
+    default:
+      return "MEMCPY";
+  }
+}
+
+std::string ApiName(cnpapi_CallbackDomain domain, cnpapi_CallbackId cbid) {
+  const char *name = nullptr;
+  if (cnpapiGetCallbackName(domain, cbid, &name) == CNPAPI_SUCCESS &&
+      name != nullptr) {
+    return name;
+  }
+  return "cbid_" + std::to_string(cbid);
+}
+
+template <typename Record>
+DeviceTraceEvent MakeDeviceEvent(const Record *record,
+                                 TracerEventType type,
+                                 uint64_t time_gap) {
+  DeviceTraceEvent event;
+  event.type = type;
+  event.start_ns = record->start + time_gap;
+  event.end_ns = record->end + time_gap;
+  event.device_id = record->device_id;
+  event.context_id = record->context_id;
+  event.stream_id = record->queue_id;
+  event.correlation_id = record->correlation_id;
+  return event;
+}
+
+void AddKernelRecord(const cnpapiActivityKernel *kernel,
+                     uint64_t start_ns,
+                     uint64_t time_gap,
+                     CnpapiTraceEvents *events) {
+  if (kernel->start + time_gap < start_ns) {
+    return;
+  }
+  auto event = MakeDeviceEvent(kernel, TracerEventType::Kernel, time_gap);
+  event.name = Demangle(kernel->name);
+  event.kernel_info = {};
+  event.kernel_info.block_x = kernel->dimx;
+  event.kernel_info.block_y = kernel->dimy;
+  event.kernel_info.block_z = kernel->dimz;
+  // MLU kernels have no grid, the field carries the kernel type (block or
+  // union task) instead.
+  event.kernel_info.grid_x = kernel->kernel_type;
+  event.kernel_info.grid_y = 0;
+  event.kernel_info.grid_z = 0;
+  events->device_events.push_back(std::move(event));
+}
+
+template <typename Record>
+void AddMemcpyRecord(const Record *memcpy,
+                     uint64_t start_ns,
+                     uint64_t time_gap,
+                     CnpapiTraceEvents *events) {
+  if (memcpy->start + time_gap < start_ns) {
+    return;
+  }
+  auto event = MakeDeviceEvent(memcpy, TracerEventType::Memcpy, time_gap);
+  event.name = MemcpyKind(memcpy->copy_type);
+  event.memcpy_info = {};
+  event.memcpy_info.num_bytes = memcpy->bytes;
+  snprintf(event.memcpy_info.copy_kind,
+           paddle::platform::kMemKindMaxLen,
+           "%s",
+           MemcpyKind(memcpy->copy_type));
+  events->device_events.push_back(std::move(event));
+}
+
+void AddMemsetRecord(const cnpapiActivityMemset *memset,
+                     uint64_t start_ns,
+                     uint64_t time_gap,
+                     CnpapiTraceEvents *events) {
+  if (memset->start + time_gap < start_ns) {
+    return;
+  }
+  auto event = MakeDeviceEvent(memset, TracerEventType::Memset, time_gap);
+  event.name = "MEMSET";
+  event.memset_info = {};
+  event.memset_info.num_bytes = memset->bytes;
+  event.memset_info.value = memset->value;
+  events->device_events.push_back(std::move(event));
+}
+
+void AddApiRecord(const cnpapiActivityAPI *api,
+                  cnpapi_CallbackDomain domain,
+                  TracerEventType type,
+                  uint64_t start_ns,
+                  uint64_t time_gap,
+                  CnpapiTraceEvents *events) {
+  if (api->start + time_gap < start_ns) {
+    return;
+  }
+  RuntimeTraceEvent event;
+  event.name = ApiName(domain, api->cbid);
+  event.type = type;
+  event.start_ns = api->start + time_gap;
+  event.end_ns = api->end + time_gap;
+  event.process_id = api->process_id;
+  event.thread_id = api->thread_id;
+  event.correlation_id = api->correlation_id;
+  event.callback_id = api->cbid;
+  events->runtime_events.push_back(std::move(event));
+}
+
+}  // namespace
+
+void ProcessCnpapiActivityRecord(const cnpapiActivity *record,
+                                 uint64_t start_ns,
+                                 uint64_t time_gap,
+                                 CnpapiTraceEvents *events) {
+  switch (record->type) {
+    case CNPAPI_ACTIVITY_TYPE_KERNEL:
+      AddKernelRecord(reinterpret_cast<const cnpapiActivityKernel *>(record),
+                      start_ns,
+                      time_gap,
+                      events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_MEMCPY:
+      AddMemcpyRecord(reinterpret_cast<const cnpapiActivityMemcpy *>(record),
+                      start_ns,
+                      time_gap,
+                      events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_MEMCPY_PTOP:
+      AddMemcpyRecord(
+          reinterpret_cast<const cnpapiActivityMemcpyPtoP *>(record),
+          start_ns,
+          time_gap,
+          events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_MEMSET:
+      AddMemsetRecord(reinterpret_cast<const cnpapiActivityMemset *>(record),
+                      start_ns,
+                      time_gap,
+                      events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_CNDRV_API:
+      AddApiRecord(reinterpret_cast<const cnpapiActivityAPI *>(record),
+                   CNPAPI_CB_DOMAIN_CNDRV_API,
+                   TracerEventType::MluRuntime,
+                   start_ns,
+                   time_gap,
+                   events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_CNRT_API:
+      AddApiRecord(reinterpret_cast<const cnpapiActivityAPI *>(record),
+                   CNPAPI_CB_DOMAIN_CNRT_API,
+                   TracerEventType::MluRuntime,
+                   start_ns,
+                   time_gap,
+                   events);
+      break;
+    case CNPAPI_ACTIVITY_TYPE_CNCL_API:
+      AddApiRecord(reinterpret_cast<const cnpapiActivityAPI *>(record),
+                   CNPAPI_CB_DOMAIN_CNCL_API,
+                   TracerEventType::Communication,
+                   start_ns,
+                   time_gap,
+                   events);
+      break;
+    default:
+      break;
+  }
+}
+
+size_t ProcessCnpapiActivityBuffer(uint64_t *buffer,
+                                   size_t valid_size,
+                                   uint64_t start_ns,
+                                   uint64_t time_gap,
+                                   CnpapiTraceEvents *events) {
+  size_t count = 0;
+  cnpapiActivity *record = nullptr;
+  while (true) {
+    auto status = cnpapiActivityGetNextRecord(buffer, valid_size, &record);
+    if (status == CNPAPI_ERROR_MAX_LIMIT_REACHED ||
+        status == CNPAPI_ERROR_INSUFFICIENT_MEMORY) {
+      // No more records in the buffer.
+      break;
+    }
+    PADDLE_ENFORCE_MLU_SUCCESS(status);
+    ProcessCnpapiActivityRecord(record, start_ns, time_gap, events);
+    ++count;
+  }
+  return count;
+}
+
+CnpapiTracer &CnpapiTracer::Instance() {
+  static auto *tracer = new CnpapiTracer();
+  return *tracer;
+}
+
+CnpapiTracer::CnpapiTracer() {
+  PADDLE_ENFORCE_MLU_SUCCESS(cnpapiInit());
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnpapiActivityRegisterCallbacks(RequestBuffer, CompleteBuffer));
+  time_gap_ = HostTimeNs() - cnpapiGetTimestamp();
+}
+
+void CnpapiTracer::RequestBuffer(uint64_t **buffer,
+                                 size_t *size,
+                                 size_t *max_num_records) {
+  *buffer = new uint64_t[kActivityBufferSize / sizeof(uint64_t)];
+  *size = kActivityBufferSize;
+  *max_num_records = 0;
+}
+
+// The size of the buffer is always kActivityBufferSize, only the records in
+// the first valid_size bytes are needed.
+void CnpapiTracer::CompleteBuffer(uint64_t *buffer,
+                                  size_t /*size*/,
+                                  size_t valid_size) {
+  auto &tracer = Instance();
+  std::lock_guard<std::mutex> lock(tracer.mutex_);
+  tracer.buffers_.emplace_back(buffer, valid_size);
+}
+
+void CnpapiTracer::Prepare() {
+  if (enabled_) {
+    return;
+  }
+  for (auto type : kActivityTypes) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnpapiActivityEnable(type));
+  }
+  enabled_ = true;
+}
+
+void CnpapiTracer::Stop() {
+  if (!enabled_) {
+    return;
+  }
+  // Hands every buffer with records to CompleteBuffer.
+  PADDLE_ENFORCE_MLU_SUCCESS(cnpapiActivityFlushAll());
+  for (auto type : kActivityTypes) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnpapiActivityDisable(type));
+  }
+  enabled_ = false;
+}
+
+void CnpapiTracer::Collect(uint64_t start_ns, CnpapiTraceEvents *events) {
+  std::vector<std::pair<uint64_t *, size_t>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers.swap(buffers_);
+  }
+  for (auto &buffer : buffers) {
+    ProcessCnpapiActivityBuffer(
+        buffer.first, buffer.second, start_ns, time_gap_, events);
+    delete[] buffer.first;
+  }
+}
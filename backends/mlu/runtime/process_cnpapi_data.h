@@ -0,0 +1,84 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <cnpapi.h>
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/platform/profiler/trace_event.h"
+
+// Trace events converted from CNPAPI activity records, in record order.
+struct CnpapiTraceEvents {
+  std::vector<paddle::platform::RuntimeTraceEvent> runtime_events;
+  std::vector<paddle::platform::DeviceTraceEvent> device_events;
+};
+
+// Converts one activity record to a trace event. CNPAPI timestamps are moved
+// to the host clock by adding time_gap, records that started before start_ns
+// and records of other types than kernels, memcpys, memsets and CNDRV, CNRT
+// and CNCL API calls are skipped. Events keep the correlation id of their
+// record, which links the API call on the host to the device activity it
+// launched.
+void ProcessCnpapiActivityRecord(const cnpapiActivity *record,
+                                 uint64_t start_ns,
+                                 uint64_t time_gap,
+                                 CnpapiTraceEvents *events);
+
+// Converts every record of an activity buffer as handed out by CNPAPI and
+// returns the number of records read. Only the buffer and its valid size are
+// needed, so recorded buffers can be replayed outside of a profiling run.
+size_t ProcessCnpapiActivityBuffer(uint64_t *buffer,
+                                   size_t valid_size,
+                                   uint64_t start_ns,
+                                   uint64_t time_gap,
+                                   CnpapiTraceEvents *events);
+
+// Collects CNPAPI activity records between Prepare and Stop. CNPAPI requests
+// buffers from and hands completed ones back to the tracer on threads of its
+// own, Collect converts the completed buffers and frees them.
+class CnpapiTracer {
+ public:
+  static CnpapiTracer &Instance();
+
+  void Prepare();
+
+  void Stop();
+
+  void Collect(uint64_t start_ns, CnpapiTraceEvents *events);
+
+  // Offset from the CNPAPI clock to the host clock.
+  uint64_t time_gap() const { return time_gap_; }
+
+ private:
+  CnpapiTracer();
+
+  static void RequestBuffer(uint64_t **buffer,
+                            size_t *size,
+                            size_t *max_num_records);
+
+  static void CompleteBuffer(uint64_t *buffer,
+                             size_t /*size*/,
+                             size_t valid_size);
+
+  uint64_t time_gap_;
+  bool enabled_ = false;
+  std::mutex mutex_;
+  std::vector<std::pair<uint64_t *, size_t>> buffers_;
+};
@@ -14,14 +14,22 @@
 
 #include "runtime/runtime.h"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "glog/logging.h"
+#include "runtime/process_cnpapi_data.h"
+#include "runtime/xccl_schedule.h"
 
 namespace {
 
@@ -31,6 +39,307 @@ inline size_t get_devices_count() {
   return static_cast<size_t>(count);
 }
 
+// Staging buffers for AsyncMemCpyH2D. CNRT only copies asynchronously from
+// pinned memory, a pageable source makes cnrtMemcpyAsync wait for the copy
+// and the caller's buffer has to outlive it. Pageable sources are therefore
+// first copied into pinned buffers that are handed back once the queue has
+// consumed them.
+//
+// Buffers come in power-of-two size classes and are recycled through free
+// lists, and so are the notifiers that guard them, so the steady state does
+// no cnrtHostMalloc/cnrtNotifierCreate at all. Pending buffers sit in one
+// FIFO per queue: work on a queue completes in submission order, so
+// reclaiming only ever polls the oldest entry of each queue.
+//
+// Copies larger than kChunkBytes go through two chunk sized buffers in
+// turn, the host copy of one chunk overlapping the DMA of the previous one.
+//
+// MLUReadback borrows its D2H landing buffers from the same free lists, and
+// so do peer copies between cards without a direct path.
+class PinnedStagingPool {
+ public:
+  static constexpr size_t kMinClassBytes = 4096;
+  static constexpr size_t kNumClasses = 12;  // 4 KiB .. 8 MiB
+  static constexpr size_t kChunkBytes = 4 << 20;
+  static constexpr size_t kMaxPooledBytes = 256 << 20;
+
+  static PinnedStagingPool &Instance() {
+    static auto *pool = new PinnedStagingPool();
+    return *pool;
+  }
+
+  // Copies size bytes of src into staging buffers and enqueues their H2D
+  // copies on queue.
+  void StageAndCopy(void *dst,
+                    const void *src,
+                    size_t size,
+                    cnrtQueue_t queue) {
+    int device;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtGetDevice(&device));
+    const size_t chunk = size < kChunkBytes ? size : kChunkBytes;
+    Pending slots[2];
+    const size_t num_slots = size > chunk ? 2 : 1;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      Reclaim();
+      for (size_t i = 0; i < num_slots; ++i) {
+        slots[i] = {Acquire(chunk), AcquireNotifier(device), device};
+      }
+    }
+    for (size_t offset = 0, i = 0; offset < size; offset += chunk, ++i) {
+      auto &slot = slots[i % num_slots];
+      if (i >= num_slots) {
+        // The DMA of the chunk before the previous one still reads the
+        // buffer.
+        PADDLE_ENFORCE_MLU_SUCCESS(cnrtWaitNotifier(slot.notifier));
+      }
+      const size_t bytes = std::min(chunk, size - offset);
+      memcpy(slot.block.data, static_cast<const char *>(src) + offset, bytes);
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnrtMemcpyAsync(static_cast<char *>(dst) + offset,
+                          slot.block.data,
+                          bytes,
+                          queue,
+                          cnrtMemcpyHostToDev));
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtPlaceNotifier(slot.notifier, queue));
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (size_t i = 0; i < num_slots; ++i) {
+      pending_[queue].push_back(slots[i]);
+    }
+  }
+
+  // Waits for the buffers pending on queue and recycles them, called before
+  // the queue is destroyed.
+  void Forget(cnrtQueue_t queue) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = pending_.find(queue);
+    if (it == pending_.end()) return;
+    for (auto &entry : it->second) {
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtWaitNotifier(entry.notifier));
+      Release(entry);
+    }
+    pending_.erase(it);
+  }
+
+  // Hands out a buffer of at least size bytes and a notifier for a D2H
+  // copy, both go back through ReleaseReadback once the copy is done.
+  void AcquireReadback(size_t size,
+                       int device,
+                       void **data,
+                       size_t *cls,
+                       cnrtNotifier_t *notifier) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Reclaim();
+    Block block = Acquire(size);
+    *data = block.data;
+    *cls = block.cls;
+    *notifier = AcquireNotifier(device);
+  }
+
+  void ReleaseReadback(void *data,
+                       size_t cls,
+                       cnrtNotifier_t notifier,
+                       int device) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Release({{data, cls}, notifier, device});
+  }
+
+  // Copies size bytes between two cards that cannot reach each other
+  // directly through a staging buffer of at most kChunkBytes, each half of
+  // every chunk issued on the card owning the memory. The calling card is
+  // current again when it returns, also when a copy throws.
+  void Bounce(int dst_device,
+              void *dst,
+              int src_device,
+              const void *src,
+              size_t size) {
+    const size_t chunk = size < kChunkBytes ? size : kChunkBytes;
+    BounceScope scope(this, chunk);
+    for (size_t offset = 0; offset < size; offset += chunk) {
+      const size_t bytes = std::min(chunk, size - offset);
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtSetDevice(src_device));
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnrtMemcpy(scope.block.data,
+                     const_cast<char *>(static_cast<const char *>(src)) +
+                         offset,
+                     bytes,
+                     cnrtMemcpyDevToHost));
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtSetDevice(dst_device));
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpy(static_cast<char *>(dst) + offset,
+                                            scope.block.data,
+                                            bytes,
+                                            cnrtMemcpyHostToDev));
+    }
+  }
+
+ private:
+  struct Block {
+    void *data;
+    size_t cls;  // kNumClasses for oversized, unpooled buffers
+  };
+
+  struct Pending {
+    Block block;
+    cnrtNotifier_t notifier;
+    int device;
+  };
+
+  // The staging block and the current card of a Bounce, given back and
+  // restored however the copy ends.
+  struct BounceScope {
+    BounceScope(PinnedStagingPool *pool, size_t size) : pool(pool) {
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtGetDevice(&device));
+      std::lock_guard<std::mutex> lock(pool->mtx_);
+      pool->Reclaim();
+      block = pool->Acquire(size);
+    }
+
+    ~BounceScope() {
+      cnrtSetDevice(device);
+      std::lock_guard<std::mutex> lock(pool->mtx_);
+      pool->ReleaseBlock(block);
+    }
+
+    PinnedStagingPool *pool;
+    int device;
+    Block block;
+  };
+
+  static size_t SizeClass(size_t size) {
+    size_t cls = 0;
+    size_t bytes = kMinClassBytes;
+    while (bytes < size && cls < kNumClasses) {
+      bytes <<= 1;
+      ++cls;
+    }
+    return cls;
+  }
+
+  static size_t ClassBytes(size_t cls) { return kMinClassBytes << cls; }
+
+  Block Acquire(size_t size) {
+    const size_t cls = SizeClass(size);
+    if (cls < kNumClasses && !free_blocks_[cls].empty()) {
+      Block block = free_blocks_[cls].back();
+      free_blocks_[cls].pop_back();
+      pooled_bytes_ -= ClassBytes(cls);
+      return block;
+    }
+    Block block{nullptr, cls};
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtHostMalloc(
+        &block.data, cls < kNumClasses ? ClassBytes(cls) : size));
+    return block;
+  }
+
+  cnrtNotifier_t AcquireNotifier(int device) {
+    auto &notifiers = free_notifiers_[device];
+    if (notifiers.empty()) {
+      cnrtNotifier_t notifier;
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtNotifierCreate(&notifier));
+      return notifier;
+    }
+    cnrtNotifier_t notifier = notifiers.back();
+    notifiers.pop_back();
+    return notifier;
+  }
+
+  void ReleaseBlock(const Block &block) {
+    if (block.cls < kNumClasses &&
+        pooled_bytes_ + ClassBytes(block.cls) <= kMaxPooledBytes) {
+      free_blocks_[block.cls].push_back(block);
+      pooled_bytes_ += ClassBytes(block.cls);
+    } else {
+      PADDLE_ENFORCE_MLU_SUCCESS(cnrtFreeHost(block.data));
+    }
+  }
+
+  void Release(const Pending &entry) {
+    ReleaseBlock(entry.block);
+    free_notifiers_[entry.device].push_back(entry.notifier);
+  }
+
+  void Reclaim() {
+    for (auto &queue : pending_) {
+      auto &entries = queue.second;
+      while (!entries.empty() &&
+             cnrtQueryNotifier(entries.front().notifier) == cnrtSuccess) {
+        Release(entries.front());
+        entries.pop_front();
+      }
+    }
+  }
+
+  std::mutex mtx_;
+  std::vector<Block> free_blocks_[kNumClasses];
+  size_t pooled_bytes_ = 0;
+  std::unordered_map<int, std::vector<cnrtNotifier_t>> free_notifiers_;
+  std::unordered_map<cnrtQueue_t, std::deque<Pending>> pending_;
+};
+
+// Host memory handed out by HostAllocate is already pinned, H2D copies from
+// it can skip the staging buffers.
+class PinnedRanges {
+ public:
+  static PinnedRanges &Instance() {
+    static PinnedRanges ins;
+    return ins;
+  }
+
+  void Add(void *ptr, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranges_[reinterpret_cast<uintptr_t>(ptr)] = size;
+  }
+
+  void Remove(void *ptr) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranges_.erase(reinterpret_cast<uintptr_t>(ptr));
+  }
+
+  bool Contains(const void *ptr, size_t size) {
+    const auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = ranges_.upper_bound(addr);
+    if (it == ranges_.begin()) return false;
+    --it;
+    return addr + size <= it->first + it->second;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::map<uintptr_t, size_t> ranges_;
+};
+
+// Whether one card can copy to another directly, probed once per ordered
+// pair of cards. A failing probe counts as no access, the copy then goes
+// through host memory instead.
+class PeerAccess {
+ public:
+  static PeerAccess &Instance() {
+    static auto *ins = new PeerAccess();
+    return *ins;
+  }
+
+  bool CanAccess(int device, int peer) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto key = std::make_pair(device, peer);
+    auto it = probed_.find(key);
+    if (it != probed_.end()) return it->second;
+    unsigned int can_access = 0;
+    bool ok = cnrtGetPeerAccessibility(&can_access, device, peer) ==
+                  cnrtSuccess &&
+              can_access != 0;
+    VLOG(3) << "MLU peer access from " << device << " to " << peer << ": "
+            << ok;
+    probed_[key] = ok;
+    return ok;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::map<std::pair<int, int>, bool> probed_;
+};
+
 }  // namespace
 
 // Device
@@ -101,11 +410,17 @@ C_Status AsyncMemCpyH2D(const C_Device device,
                         void *dst,
                         const void *src,
                         size_t size) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyAsync(dst,
-                                             const_cast<void *>(src),
-                                             size,
-                                             GetQueue(stream),
-                                             cnrtMemcpyHostToDev));
+  if (size == 0) return C_SUCCESS;
+  if (PinnedRanges::Instance().Contains(src, size)) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyAsync(dst,
+                                               const_cast<void *>(src),
+                                               size,
+                                               GetQueue(stream),
+                                               cnrtMemcpyHostToDev));
+    return C_SUCCESS;
+  }
+  PinnedStagingPool::Instance().StageAndCopy(
+      dst, src, size, GetQueue(stream));
   return C_SUCCESS;
 }
 
@@ -137,6 +452,87 @@ C_Status AsyncMemCpyD2H(const C_Device device,
   return C_SUCCESS;
 }
 
+C_Status MemCpyP2P(const C_Device dst_device,
+                   const C_Device src_device,
+                   void *dst,
+                   const void *src,
+                   size_t size) {
+  if (size == 0) return C_SUCCESS;
+  if (dst_device->id == src_device->id) {
+    return MemCpyD2D(dst_device, dst, src, size);
+  }
+  if (PeerAccess::Instance().CanAccess(src_device->id, dst_device->id)) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyPeer(dst,
+                                              dst_device->id,
+                                              const_cast<void *>(src),
+                                              src_device->id,
+                                              size));
+    return C_SUCCESS;
+  }
+  PinnedStagingPool::Instance().Bounce(
+      dst_device->id, dst, src_device->id, src, size);
+  return C_SUCCESS;
+}
+
+C_Status AsyncMemCpyP2P(const C_Device dst_device,
+                        const C_Device src_device,
+                        C_Stream stream,
+                        void *dst,
+                        const void *src,
+                        size_t size) {
+  if (size == 0) return C_SUCCESS;
+  if (dst_device->id == src_device->id) {
+    return AsyncMemCpyD2D(dst_device, stream, dst, src, size);
+  }
+  if (PeerAccess::Instance().CanAccess(src_device->id, dst_device->id)) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyPeerAsync(dst,
+                                                   dst_device->id,
+                                                   const_cast<void *>(src),
+                                                   src_device->id,
+                                                   size,
+                                                   GetQueue(stream)));
+    return C_SUCCESS;
+  }
+  // The host bounce is synchronous, so the work producing src has to be
+  // done first.
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(GetQueue(stream)));
+  PinnedStagingPool::Instance().Bounce(
+      dst_device->id, dst, src_device->id, src, size);
+  return C_SUCCESS;
+}
+
+MLUReadback::MLUReadback(void *stream, const void *src, size_t size) {
+  if (size == 0) {
+    done_ = true;
+    return;
+  }
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtGetDevice(&device_));
+  PinnedStagingPool::Instance().AcquireReadback(
+      size, device_, &data_, &cls_, &notifier_);
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyAsync(data_,
+                                             const_cast<void *>(src),
+                                             size,
+                                             GetQueue(stream),
+                                             cnrtMemcpyDevToHost));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtPlaceNotifier(notifier_, GetQueue(stream)));
+}
+
+MLUReadback::~MLUReadback() {
+  if (data_ == nullptr) return;
+  // The copy may still write the buffer if nobody waited for it.
+  Wait();
+  PinnedStagingPool::Instance().ReleaseReadback(
+      data_, cls_, notifier_, device_);
+}
+
+const void *MLUReadback::Wait() {
+  if (!done_) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtWaitNotifier(notifier_));
+    done_ = true;
+  }
+  return data_;
+}
+
 C_Status Allocate(const C_Device device, void **ptr, size_t size) {
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtSetDevice(device->id));
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtMalloc(ptr, size));
@@ -152,10 +548,12 @@ C_Status Deallocate(const C_Device device, void *ptr, size_t size) {
 C_Status HostAllocate(const C_Device device, void **ptr, size_t size) {
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtSetDevice(device->id));
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtHostMalloc(ptr, size));
+  PinnedRanges::Instance().Add(*ptr, size);
   return C_SUCCESS;
 }
 
 C_Status HostDeallocate(const C_Device device, void *ptr, size_t size) {
+  PinnedRanges::Instance().Remove(ptr);
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtFreeHost(ptr));
   return C_SUCCESS;
 }
@@ -177,6 +575,55 @@ C_Status ExtraPaddingSize(const C_Device device, size_t *size) {
   return C_SUCCESS;
 }
 
+// Workspace
+void *MLUWorkspaceArena::Borrow(cnrtQueue_t queue, size_t size) {
+  interval_peak_ = std::max(interval_peak_, size);
+  stats_.high_water = std::max(stats_.high_water, size);
+  if (size <= stats_.capacity) {
+    return size == 0 ? nullptr : ptr_;
+  }
+  // Calls already issued may still use the old buffer. Growing by at least
+  // half of the capacity keeps these synchronizations rare.
+  size_t capacity = std::max(size, stats_.capacity + stats_.capacity / 2);
+  capacity = (capacity + (1UL << 20) - 1) & ~((1UL << 20) - 1);
+  if (ptr_) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(queue));
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtFree(ptr_));
+    ptr_ = nullptr;
+    stats_.capacity = 0;
+  }
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMalloc(&ptr_, capacity));
+  stats_.capacity = capacity;
+  ++stats_.grows;
+  VLOG(4) << "Workspace of queue " << queue << " grows to " << capacity
+          << " bytes for a " << size << " bytes request.";
+  return ptr_;
+}
+
+void MLUWorkspaceArena::OnSync() {
+  if (++interval_syncs_ < kShrinkInterval) {
+    return;
+  }
+  if (ptr_ && interval_peak_ < stats_.capacity / 2) {
+    VLOG(4) << "Workspace shrinks from " << stats_.capacity
+            << " bytes, the last " << interval_syncs_
+            << " synchronizations used at most " << interval_peak_
+            << " bytes.";
+    Release();
+    ++stats_.shrinks;
+  }
+  interval_peak_ = 0;
+  interval_syncs_ = 0;
+}
+
+void MLUWorkspaceArena::Release() {
+  if (ptr_) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtFree(ptr_));
+    ptr_ = nullptr;
+  }
+  stats_.capacity = 0;
+}
+
 // Stream
 C_Status CreateStream(const C_Device device, C_Stream *stream) {
   mluStream_t mlu_stream = new CustomMLUStream();
@@ -202,18 +649,28 @@ C_Status CreateStream(const C_Device device, C_Stream *stream) {
 }
 
 C_Status DestroyStream(const C_Device device, C_Stream stream) {
+  mluStream_t mlu_stream = reinterpret_cast<mluStream_t>(stream);
+  const auto &stats = mlu_stream->workspace.stats();
+  VLOG(1) << "Workspace of queue " << mlu_stream->queue << ": high water "
+          << stats.high_water << " bytes, " << stats.grows << " grows, "
+          << stats.shrinks << " shrinks.";
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(GetQueue(stream)));
+  PinnedStagingPool::Instance().Forget(GetQueue(stream));
+  mlu_stream->workspace.Release();
+  mlu_stream->random_generator.reset();
+
   PADDLE_ENFORCE_MLU_SUCCESS(cnnlDestroy(GetHandle(stream)));
   PADDLE_ENFORCE_MLU_SUCCESS(mluOpDestroy(GetOpHandle(stream)));
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueDestroy(GetQueue(stream)));
 
-  mluStream_t mlu_stream = reinterpret_cast<mluStream_t>(stream);
-  delete[] mlu_stream;
+  delete mlu_stream;
 
   return C_SUCCESS;
 }
 
 C_Status SyncStream(const C_Device device, C_Stream stream) {
   PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(GetQueue(stream)));
+  reinterpret_cast<mluStream_t>(stream)->workspace.OnSync();
   return C_SUCCESS;
 }
 
@@ -294,6 +751,439 @@ cnclReduceOp_t PDReduceOpToCnclReduceOp(C_CCLReduceOp op) {
   }
 }
 
+// Collectives that only move data do not depend on the element type, data
+// types CNCL lacks are moved as bytes.
+void GetMovedCnclType(C_DataType type,
+                      size_t count,
+                      cnclDataType_t *cncl_type,
+                      size_t *cncl_count) {
+  if (GetXcclWireType(type, C_CCLReduceOp::SUM) == XcclWireType::kNative) {
+    *cncl_type = PDDataTypeToCnclDataType(type);
+    *cncl_count = count;
+  } else {
+    *cncl_type = cnclInt8;
+    *cncl_count = count * CDataTypeSize(type);
+  }
+}
+
+// All-reduces of at least this size are split into intra-node and
+// inter-node steps on communicators that span several nodes, smaller ones
+// are bound by latency and stay flat.
+constexpr size_t kXcclHierarchicalMinBytes = 1 << 20;
+
+// Upper bound of the all-reduces fused in a group.
+constexpr size_t kXcclFusionBucketBytes = 32 << 20;
+
+// What the runtime knows about a communicator created by XcclCommInitRank.
+// Communicators spanning several nodes with more than one rank each also get
+// an intra-node and an inter-node communicator for hierarchical
+// all-reduces.
+struct CnclCommInfo {
+  size_t rank = 0;
+  size_t nranks = 1;
+  XcclTopology topology;
+  cnclComm_t intra = nullptr;
+  cnclComm_t inter = nullptr;
+};
+
+class CnclComms {
+ public:
+  static CnclComms &Instance() {
+    static CnclComms ins;
+    return ins;
+  }
+
+  void Add(C_CCLComm comm, const CnclCommInfo &info) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    infos_[comm] = info;
+  }
+
+  bool Remove(C_CCLComm comm, CnclCommInfo *info) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = infos_.find(comm);
+    if (it == infos_.end()) return false;
+    *info = it->second;
+    infos_.erase(it);
+    return true;
+  }
+
+  CnclCommInfo Get(C_CCLComm comm) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = infos_.find(comm);
+    return it == infos_.end() ? CnclCommInfo() : it->second;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::unordered_map<C_CCLComm, CnclCommInfo> infos_;
+};
+
+uint64_t GetHostId() {
+  char hostname[256] = {0};
+  gethostname(hostname, sizeof(hostname) - 1);
+  return std::hash<std::string>()(hostname);
+}
+
+// Gathers size bytes from every rank of comm into records, in rank order.
+void AllGatherRecords(cnclComm_t comm,
+                      void *mine,
+                      size_t size,
+                      size_t nranks,
+                      void *records) {
+  cnrtQueue_t queue;
+  void *send_buf;
+  void *recv_buf;
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueCreate(&queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMalloc(&send_buf, size));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMalloc(&recv_buf, size * nranks));
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnrtMemcpy(send_buf, mine, size, cnrtMemcpyHostToDev));
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnclAllGather(send_buf, recv_buf, size, cnclInt8, comm, queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnrtMemcpy(records, recv_buf, size * nranks, cnrtMemcpyDevToHost));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtFree(send_buf));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtFree(recv_buf));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueDestroy(queue));
+}
+
+// Exchanges the host of every rank over the new communicator and, if the
+// ranks span several nodes, creates the intra-node and inter-node
+// communicators. Their clique ids are generated by the roots of the
+// sub-communicators only and exchanged in a second round, which single node
+// communicators skip. Every rank of the communicator takes part, just like
+// in XcclCommInitRank.
+void InitCnclTopology(cnclComm_t comm, int dev_id, CnclCommInfo *info) {
+  uint64_t host_id = GetHostId();
+  std::vector<uint64_t> host_ids(info->nranks);
+  AllGatherRecords(
+      comm, &host_id, sizeof(host_id), info->nranks, host_ids.data());
+
+  auto &topology = info->topology;
+  topology = BuildXcclTopology(info->rank, host_ids);
+  VLOG(1) << "CNCL rank " << info->rank << " of " << info->nranks
+          << " is local rank " << topology.local_rank << " of "
+          << topology.local_size << " on node " << topology.node << " of "
+          << topology.nodes;
+  if (!topology.Hierarchical()) return;
+
+  struct CliqueIds {
+    cnclCliqueId intra_id;
+    cnclCliqueId inter_id;
+  };
+  CliqueIds mine;
+  std::memset(&mine, 0, sizeof(mine));
+  if (topology.intra_root == info->rank) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnclGetCliqueId(&mine.intra_id));
+  }
+  if (topology.inter_root == info->rank) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnclGetCliqueId(&mine.inter_id));
+  }
+  std::vector<CliqueIds> ids(info->nranks);
+  AllGatherRecords(comm, &mine, sizeof(mine), info->nranks, ids.data());
+
+  int dev_list[] = {dev_id};
+  int intra_rank[] = {static_cast<int>(topology.local_rank)};
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnclInitComms(&info->intra,
+                    1,
+                    dev_list,
+                    intra_rank,
+                    topology.local_size,
+                    &ids[topology.intra_root].intra_id));
+  int inter_rank[] = {static_cast<int>(topology.node)};
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnclInitComms(&info->inter,
+                    1,
+                    dev_list,
+                    inter_rank,
+                    topology.nodes,
+                    &ids[topology.inter_root].inter_id));
+}
+
+void IssueAllReduce(const void *send_buf,
+                    void *recv_buf,
+                    size_t count,
+                    C_DataType data_type,
+                    C_CCLReduceOp op,
+                    C_CCLComm comm,
+                    C_Stream stream) {
+  auto info = CnclComms::Instance().Get(comm);
+  auto dtype = PDDataTypeToCnclDataType(data_type);
+  auto reduce_op = PDReduceOpToCnclReduceOp(op);
+  auto queue = GetQueue(stream);
+  const auto &topology = info.topology;
+  if (!topology.Hierarchical() ||
+      count * CDataTypeSize(data_type) < kXcclHierarchicalMinBytes ||
+      count % topology.local_size != 0) {
+    PADDLE_ENFORCE_MLU_SUCCESS(cnclAllReduce(send_buf,
+                                             recv_buf,
+                                             count,
+                                             dtype,
+                                             reduce_op,
+                                             reinterpret_cast<cnclComm_t>(comm),
+                                             queue));
+    return;
+  }
+  // Each rank of a node reduces its shard across the node, then across the
+  // nodes, and the node gathers the shards back. Only 1 / local_size of the
+  // data crosses the slower links between nodes.
+  const size_t shard = count / topology.local_size;
+  auto *shard_buf = static_cast<uint8_t *>(recv_buf) +
+                    topology.local_rank * shard * CDataTypeSize(data_type);
+  PADDLE_ENFORCE_MLU_SUCCESS(cnclReduceScatter(
+      send_buf, shard_buf, shard, dtype, reduce_op, info.intra, queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnclAllReduce(
+      shard_buf, shard_buf, shard, dtype, reduce_op, info.inter, queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(
+      cnclAllGather(shard_buf, recv_buf, shard, dtype, info.intra, queue));
+}
+
+// All-reduces packed into the workspace of their stream and reduced with a
+// single all-reduce. The packed length is padded to a multiple of the ranks
+// per node so that hierarchical all-reduces can shard it.
+void IssueFusedAllReduce(const std::vector<XcclTask> &tasks) {
+  const auto &first = tasks[0];
+  const size_t elem = CDataTypeSize(first.data_type);
+  auto queue = GetQueue(first.stream);
+  auto info = CnclComms::Instance().Get(first.comm);
+
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  for (const auto &task : tasks) {
+    offsets.push_back(total);
+    total += XcclFusionAlignment(task.Bytes());
+  }
+  size_t count = total / elem;
+  count = (count + info.topology.local_size - 1) /
+          info.topology.local_size * info.topology.local_size;
+  auto *buffer =
+      static_cast<uint8_t *>(GetWorkspace(first.stream, count * elem));
+  // Keep the alignment and local_size padding finite, it is reduced along
+  // with the data.
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemsetAsync(buffer, 0, count * elem, queue));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (tasks[i].count == 0) continue;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyAsync(buffer + offsets[i],
+                                               tasks[i].send_buf,
+                                               tasks[i].Bytes(),
+                                               queue,
+                                               cnrtMemcpyDevToDev));
+  }
+  IssueAllReduce(buffer,
+                 buffer,
+                 count,
+                 first.data_type,
+                 first.op,
+                 first.comm,
+                 first.stream);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (tasks[i].count == 0) continue;
+    PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpyAsync(tasks[i].recv_buf,
+                                               buffer + offsets[i],
+                                               tasks[i].Bytes(),
+                                               queue,
+                                               cnrtMemcpyDevToDev));
+  }
+}
+
+// Reductions of data types CNCL lacks. The input is read back to the host,
+// converted to the wire type, all-reduced on the device and converted back,
+// so the call waits for the stream. Reduce and reduce-scatter keep only the
+// part of the result they return.
+C_Status IssueWireReduction(const XcclTask &task) {
+  auto wire = GetXcclWireType(task.data_type, task.op);
+  auto info = CnclComms::Instance().Get(task.comm);
+  if (wire == XcclWireType::kUnsupported ||
+      (wire == XcclWireType::kInt32Limbs &&
+       info.nranks > kXcclMaxLimbRanks)) {
+    LOG(ERROR) << "Reduceop " << task.op << " of datatype " << task.data_type
+               << " over " << info.nranks
+               << " ranks in cncl is not supported.";
+    return C_FAILED;
+  }
+  const size_t elem = CDataTypeSize(task.data_type);
+  const size_t count = task.kind == XcclTask::kReduceScatter
+                           ? task.count * info.nranks
+                           : task.count;
+  const size_t wire_count = XcclWireCount(wire, count);
+  // Both wire types have 4 byte elements.
+  const size_t wire_bytes = wire_count * 4;
+  auto queue = GetQueue(task.stream);
+
+  std::vector<uint8_t> host(count * elem);
+  std::vector<uint8_t> wire_host(wire_bytes);
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpy(
+      host.data(), task.send_buf, host.size(), cnrtMemcpyDevToHost));
+  EncodeXcclWire(wire, host.data(), count, wire_host.data());
+  void *wire_buf = GetWorkspace(task.stream, wire_bytes);
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpy(
+      wire_buf, wire_host.data(), wire_bytes, cnrtMemcpyHostToDev));
+  IssueAllReduce(wire_buf,
+                 wire_buf,
+                 wire_count,
+                 wire == XcclWireType::kFloat32 ? C_DataType::FLOAT32
+                                                : C_DataType::INT32,
+                 task.op,
+                 task.comm,
+                 task.stream);
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtQueueSync(queue));
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpy(
+      wire_host.data(), wire_buf, wire_bytes, cnrtMemcpyDevToHost));
+  DecodeXcclWire(wire, wire_host.data(), count, host.data());
+
+  if (task.kind == XcclTask::kReduce && info.rank != task.peer) {
+    return C_SUCCESS;
+  }
+  size_t offset = 0;
+  size_t bytes = host.size();
+  if (task.kind == XcclTask::kReduceScatter) {
+    bytes = task.count * elem;
+    offset = info.rank * bytes;
+  }
+  PADDLE_ENFORCE_MLU_SUCCESS(cnrtMemcpy(
+      task.recv_buf, host.data() + offset, bytes, cnrtMemcpyHostToDev));
+  return C_SUCCESS;
+}
+
+C_Status IssueXcclTask(const XcclTask &task) {
+  auto comm = reinterpret_cast<cnclComm_t>(task.comm);
+  auto queue = GetQueue(task.stream);
+  const bool native =
+      GetXcclWireType(task.data_type, task.op) == XcclWireType::kNative;
+  cnclDataType_t moved_type;
+  size_t moved_count;
+  GetMovedCnclType(task.data_type, task.count, &moved_type, &moved_count);
+  switch (task.kind) {
+    case XcclTask::kAllReduce: {
+      if (!native) return IssueWireReduction(task);
+      auto topology = CnclComms::Instance().Get(task.comm).topology;
+      if (topology.Hierarchical() &&
+          task.Bytes() >= kXcclHierarchicalMinBytes &&
+          task.count % topology.local_size != 0) {
+        // Padded in the workspace to be split across the node.
+        IssueFusedAllReduce({task});
+        break;
+      }
+      IssueAllReduce(task.send_buf,
+                     task.recv_buf,
+                     task.count,
+                     task.data_type,
+                     task.op,
+                     task.comm,
+                     task.stream);
+      break;
+    }
+    case XcclTask::kReduce:
+      if (!native) return IssueWireReduction(task);
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnclReduce(task.send_buf,
+                     task.recv_buf,
+                     task.count,
+                     PDDataTypeToCnclDataType(task.data_type),
+                     PDReduceOpToCnclReduceOp(task.op),
+                     task.peer,
+                     comm,
+                     queue));
+      break;
+    case XcclTask::kReduceScatter:
+      if (!native) return IssueWireReduction(task);
+      PADDLE_ENFORCE_MLU_SUCCESS(
+          cnclReduceScatter(task.send_buf,
+                            task.recv_buf,
+                            task.count,
+                            PDDataTypeToCnclDataType(task.data_type),
+                            PDReduceOpToCnclReduceOp(task.op),
+                            comm,
+                            queue));
+      break;
+    case XcclTask::kBroadcast:
+      PADDLE_ENFORCE_MLU_SUCCESS(cnclBroadcast(task.send_buf,
+                                               task.recv_buf,
+                                               moved_count,
+                                               moved_type,
+                                               task.peer,
+                                               comm,
+                                               queue));
+      break;
+    case XcclTask::kAllGather:
+      PADDLE_ENFORCE_MLU_SUCCESS(cnclAllGather(
+          task.send_buf, task.recv_buf, moved_count, moved_type, comm, queue));
+      break;
+    case XcclTask::kSend:
+      PADDLE_ENFORCE_MLU_SUCCESS(cnclSend(
+          task.send_buf, moved_count, moved_type, task.peer, comm, queue));
+      break;
+    case XcclTask::kRecv:
+      PADDLE_ENFORCE_MLU_SUCCESS(cnclRecv(
+          task.recv_buf, moved_count, moved_type, task.peer, comm, queue));
+      break;
+  }
+  return C_SUCCESS;
+}
+
+// Collectives issued between XcclGroupStart and XcclGroupEnd on a thread.
+// They are queued and the outermost XcclGroupEnd issues them in the order
+// of ScheduleXcclGroup, all-reduces of CNCL data types fused into buckets
+// of at most kXcclFusionBucketBytes.
+class XcclGroup {
+ public:
+  static XcclGroup &Current() {
+    thread_local XcclGroup group;
+    return group;
+  }
+
+  bool Active() const { return depth_ > 0; }
+
+  void Start() { ++depth_; }
+
+  void Add(const XcclTask &task) { tasks_.push_back(task); }
+
+  C_Status End() {
+    if (depth_ == 0) {
+      LOG(ERROR) << "xccl_group_end is called without xccl_group_start.";
+      return C_FAILED;
+    }
+    if (--depth_ > 0) return C_SUCCESS;
+
+    std::vector<XcclTask> tasks;
+    tasks.swap(tasks_);
+    auto units = ScheduleXcclGroup(
+        tasks,
+        kXcclFusionBucketBytes,
+        [](const XcclTask &task) {
+          return task.op != C_CCLReduceOp::AVG &&
+                 GetXcclWireType(task.data_type, task.op) ==
+                     XcclWireType::kNative;
+        },
+        [](C_CCLComm comm) { return CnclComms::Instance().Get(comm).rank; });
+    for (const auto &unit : units) {
+      if (unit.size() > 1) {
+        IssueFusedAllReduce(unit);
+        continue;
+      }
+      C_Status ret = IssueXcclTask(unit[0]);
+      if (ret != C_SUCCESS) return ret;
+    }
+    return C_SUCCESS;
+  }
+
+ private:
+  int depth_ = 0;
+  std::vector<XcclTask> tasks_;
+};
+
+C_Status SubmitXcclTask(const XcclTask &task) {
+  auto &group = XcclGroup::Current();
+  if (group.Active()) {
+    group.Add(task);
+    return C_SUCCESS;
+  }
+  return IssueXcclTask(task);
+}
+
 }  // namespace
 
 C_Status XcclGetUniqueIdSize(size_t *size) {
@@ -326,10 +1216,22 @@ C_Status XcclCommInitRank(size_t nranks,
                     rank_list,
                     nranks,
                     reinterpret_cast<cnclCliqueId *>(unique_id->data)));
+  CnclCommInfo info;
+  info.rank = rank;
+  info.nranks = nranks;
+  if (nranks > 1) {
+    InitCnclTopology(reinterpret_cast<cnclComm_t>(*comm), dev_id, &info);
+  }
+  CnclComms::Instance().Add(*comm, info);
   return C_SUCCESS;
 }
 
 C_Status XcclDestroyComm(C_CCLComm comm) {
+  CnclCommInfo info;
+  if (CnclComms::Instance().Remove(comm, &info)) {
+    if (info.intra) PADDLE_ENFORCE_MLU_SUCCESS(cnclFreeComm(info.intra));
+    if (info.inter) PADDLE_ENFORCE_MLU_SUCCESS(cnclFreeComm(info.inter));
+  }
   PADDLE_ENFORCE_MLU_SUCCESS(cnclFreeComm(reinterpret_cast<cnclComm_t>(comm)));
   return C_SUCCESS;
 }
@@ -341,14 +1243,15 @@ C_Status XcclAllReduce(void *send_buf,
                        C_CCLReduceOp op,
                        C_CCLComm comm,
                        C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclAllReduce(send_buf,
-                                           recv_buf,
-                                           count,
-                                           PDDataTypeToCnclDataType(data_type),
-                                           PDReduceOpToCnclReduceOp(op),
-                                           reinterpret_cast<cnclComm_t>(comm),
-                                           GetQueue(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kAllReduce,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclBroadcast(void *buf,
@@ -357,14 +1260,15 @@ C_Status XcclBroadcast(void *buf,
                        size_t root,
                        C_CCLComm comm,
                        C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclBroadcast(buf,
-                                           buf,
-                                           count,
-                                           PDDataTypeToCnclDataType(data_type),
-                                           root,
-                                           reinterpret_cast<cnclComm_t>(comm),
-                                           GetQueue(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kBroadcast,
+                         buf,
+                         buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         root,
+                         comm,
+                         stream});
 }
 
 C_Status XcclReduce(void *send_buf,
@@ -375,16 +1279,15 @@ C_Status XcclReduce(void *send_buf,
                     size_t root,
                     C_CCLComm comm,
                     C_Stream stream) {
-  LOG(ERROR) << "xccl_reduce is not supported  on mlu device.";
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclReduce(send_buf,
-                                        recv_buf,
-                                        count,
-                                        PDDataTypeToCnclDataType(data_type),
-                                        PDReduceOpToCnclReduceOp(op),
-                                        root,
-                                        reinterpret_cast<cnclComm_t>(comm),
-                                        GetQueue(stream)));
-  return C_ERROR;
+  return SubmitXcclTask({XcclTask::kReduce,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         root,
+                         comm,
+                         stream});
 }
 
 C_Status XcclAllGather(void *send_buf,
@@ -393,13 +1296,15 @@ C_Status XcclAllGather(void *send_buf,
                        C_DataType data_type,
                        C_CCLComm comm,
                        C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclAllGather(send_buf,
-                                           recv_buf,
-                                           count,
-                                           PDDataTypeToCnclDataType(data_type),
-                                           reinterpret_cast<cnclComm_t>(comm),
-                                           GetQueue(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kAllGather,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclReduceScatter(void *send_buf,
@@ -409,26 +1314,23 @@ C_Status XcclReduceScatter(void *send_buf,
                            C_CCLReduceOp op,
                            C_CCLComm comm,
                            C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(
-      cnclReduceScatter(send_buf,
-                        recv_buf,
-                        count,
-                        PDDataTypeToCnclDataType(data_type),
-                        PDReduceOpToCnclReduceOp(op),
-                        reinterpret_cast<cnclComm_t>(comm),
-                        GetQueue(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kReduceScatter,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclGroupStart() {
-  LOG(ERROR) << "xccl_group_start is not supported on mlu device.";
-  return C_ERROR;
+  XcclGroup::Current().Start();
+  return C_SUCCESS;
 }
 
-C_Status XcclGroupEnd() {
-  LOG(ERROR) << "xccl_group_end is not supported on mlu device.";
-  return C_ERROR;
-}
+C_Status XcclGroupEnd() { return XcclGroup::Current().End(); }
 
 C_Status XcclSend(void *send_buf,
                   size_t count,
@@ -436,13 +1338,15 @@ C_Status XcclSend(void *send_buf,
                   size_t dest_rank,
                   C_CCLComm comm,
                   C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclSend(send_buf,
-                                      count,
-                                      PDDataTypeToCnclDataType(data_type),
-                                      dest_rank,
-                                      reinterpret_cast<cnclComm_t>(comm),
-                                      GetQueue(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kSend,
+                         send_buf,
+                         nullptr,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         dest_rank,
+                         comm,
+                         stream});
 }
 
 C_Status XcclRecv(void *recv_buf,
@@ -451,12 +1355,55 @@ C_Status XcclRecv(void *recv_buf,
                   size_t src_rank,
                   C_CCLComm comm,
                   C_Stream stream) {
-  PADDLE_ENFORCE_MLU_SUCCESS(cnclRecv(recv_buf,
-                                      count,
-                                      PDDataTypeToCnclDataType(data_type),
-                                      src_rank,
-                                      reinterpret_cast<cnclComm_t>(comm),
-                                      GetQueue(stream)));
+  return SubmitXcclTask({XcclTask::kRecv,
+                         nullptr,
+                         recv_buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         src_rank,
+                         comm,
+                         stream});
+}
+
+// Profiler
+C_Status ProfilerInitialize(C_Profiler prof, void **user_data) {
+  // Registers the activity buffer callbacks with CNPAPI.
+  CnpapiTracer::Instance();
+  return C_SUCCESS;
+}
+
+C_Status ProfilerFinalize(C_Profiler prof, void *user_data) {
+  CnpapiTracer::Instance().Stop();
+  return C_SUCCESS;
+}
+
+C_Status ProfilerPrepare(C_Profiler prof, void *user_data) {
+  CnpapiTracer::Instance().Prepare();
+  return C_SUCCESS;
+}
+
+C_Status ProfilerStart(C_Profiler prof, void *user_data) { return C_SUCCESS; }
+
+C_Status ProfilerStop(C_Profiler prof, void *user_data) {
+  CnpapiTracer::Instance().Stop();
+  return C_SUCCESS;
+}
+
+C_Status ProfilerCollectData(C_Profiler prof,
+                             uint64_t start_ns,
+                             void *user_data) {
+  CnpapiTraceEvents events;
+  CnpapiTracer::Instance().Collect(start_ns, &events);
+  for (auto &event : events.runtime_events) {
+    profiler_add_runtime_trace_event(prof, &event);
+  }
+  for (auto &event : events.device_events) {
+    profiler_add_device_trace_event(prof, &event);
+  }
+  VLOG(4) << "Collected " << events.runtime_events.size()
+          << " runtime and " << events.device_events.size()
+          << " device trace events from CNPAPI";
   return C_SUCCESS;
 }
 
@@ -482,11 +1429,11 @@ void InitPlugin(CustomRuntimeParams *params) {
   params->interface->memory_copy_h2d = MemCpyH2D;
   params->interface->memory_copy_d2d = MemCpyD2D;
   params->interface->memory_copy_d2h = MemCpyD2H;
-  params->interface->memory_copy_p2p = nullptr;
+  params->interface->memory_copy_p2p = MemCpyP2P;
   params->interface->async_memory_copy_h2d = AsyncMemCpyH2D;
   params->interface->async_memory_copy_d2d = AsyncMemCpyD2D;
   params->interface->async_memory_copy_d2h = AsyncMemCpyD2H;
-  params->interface->async_memory_copy_p2p = nullptr;
+  params->interface->async_memory_copy_p2p = AsyncMemCpyP2P;
   params->interface->device_memory_allocate = Allocate;
   params->interface->device_memory_deallocate = Deallocate;
   params->interface->host_memory_allocate = HostAllocate;
@@ -522,4 +1469,12 @@ void InitPlugin(CustomRuntimeParams *params) {
   params->interface->xccl_group_end = XcclGroupEnd;
   params->interface->xccl_send = XcclSend;
   params->interface->xccl_recv = XcclRecv;
+
+  // profiler
+  params->interface->profiler_collect_trace_data = ProfilerCollectData;
+  params->interface->profiler_initialize = ProfilerInitialize;
+  params->interface->profiler_finalize = ProfilerFinalize;
+  params->interface->profiler_start_tracing = ProfilerStart;
+  params->interface->profiler_stop_tracing = ProfilerStop;
+  params->interface->profiler_prepare_tracing = ProfilerPrepare;
 }
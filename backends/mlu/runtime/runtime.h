@@ -20,9 +20,23 @@
 #include <cnpapi.h>
 #include <cnrt.h>
 
+#include <cstdlib>
+#include <memory>
+#include <string>
+
 #include "glog/logging.h"
 #include "paddle/phi/extension.h"
 
+#define ENV_Cat(x, y) x##y
+#define ENV_Str(x) #x
+#define ENV_Call(x, y) x(y)
+#define ENV_DEFINE(type, name, value, parser)                        \
+  type FLAGS_##name =                                                \
+      getenv(ENV_Call(ENV_Str, ENV_Cat(FLAGS_, name)))               \
+          ? parser(getenv(ENV_Call(ENV_Str, ENV_Cat(FLAGS_, name)))) \
+          : value
+#define ENV_uint64(x, value) ENV_DEFINE(uint64_t, x, value, std::stoul)
+
 template <typename T>
 struct CustomMLUStatusType {};
 
@@ -37,6 +51,7 @@ DEFINE_CUSTOM_MLU_STATUS_TYPE(cnrtRet_t, cnrtSuccess);
 DEFINE_CUSTOM_MLU_STATUS_TYPE(cnnlStatus_t, CNNL_STATUS_SUCCESS);
 DEFINE_CUSTOM_MLU_STATUS_TYPE(mluOpStatus_t, MLUOP_STATUS_SUCCESS);
 DEFINE_CUSTOM_MLU_STATUS_TYPE(cnclResult_t, CNCL_RET_SUCCESS);
+DEFINE_CUSTOM_MLU_STATUS_TYPE(cnpapiResult, CNPAPI_SUCCESS);
 
 /*************** CNRT ERROR ***************/
 inline bool is_error(cnrtRet_t e) { return e != cnrtSuccess; }
@@ -79,6 +94,18 @@ inline std::string build_mlu_error_msg(cnclResult_t e) {
   return sout.str();
 }
 
+/*************** CNPAPI ERROR ***************/
+inline bool is_error(cnpapiResult e) { return e != CNPAPI_SUCCESS; }
+
+inline std::string build_mlu_error_msg(cnpapiResult e) {
+  const char *str = nullptr;
+  cnpapiGetResultString(e, &str);
+  std::ostringstream sout;
+  sout << "MLU CNPAPI error(" << e << "), " << (str ? str : "unknown")
+       << ". ";
+  return sout.str();
+}
+
 #define PADDLE_ENFORCE_MLU_SUCCESS(COND)                    \
   do {                                                      \
     auto __cond__ = (COND);                                 \
@@ -91,10 +118,54 @@ inline std::string build_mlu_error_msg(cnclResult_t e) {
     }                                                       \
   } while (0)
 
+// Scratch memory for the cnnl and mluOp calls issued on one queue. A queue
+// runs its calls in issue order, so a call may reuse the buffer of the
+// previous one as soon as that one has been issued: the memory returned by
+// Borrow stays valid until the next Borrow on the same stream, and only a
+// call that needs more than the current capacity allocates. A stream must
+// be driven by one host thread at a time.
+//
+// The buffer only grows while in use. Every kShrinkInterval synchronizations
+// of the queue it is freed if the calls of that interval used less than half
+// of it, the next call then allocates what it actually needs.
+class MLUWorkspaceArena {
+ public:
+  struct Stats {
+    size_t capacity = 0;
+    // The largest workspace ever borrowed.
+    size_t high_water = 0;
+    size_t grows = 0;
+    size_t shrinks = 0;
+  };
+
+  static constexpr size_t kShrinkInterval = 64;
+
+  void *Borrow(cnrtQueue_t queue, size_t size);
+
+  // Called with the queue idle.
+  void OnSync();
+
+  // Frees the buffer, the queue must be idle.
+  void Release();
+
+  const Stats &stats() const { return stats_; }
+
+ private:
+  void *ptr_ = nullptr;
+  size_t interval_peak_ = 0;
+  size_t interval_syncs_ = 0;
+  Stats stats_;
+};
+
 struct CustomMLUStream {
   cnnlHandle_t handle;
   mluOpHandle_t op_handle;
   cnrtQueue_t queue;
+  MLUWorkspaceArena workspace;
+  // Generator of the random kernels issued on the stream, created by the
+  // kernels on first use (see GetMLURandomGenerator) and dropped with the
+  // stream.
+  std::shared_ptr<void> random_generator;
 };
 typedef CustomMLUStream *mluStream_t;
 
@@ -119,6 +190,34 @@ inline cnrtQueue_t GetQueue(void *stream) {
   return reinterpret_cast<mluStream_t>(stream)->queue;
 }
 
+inline void *GetWorkspace(void *stream, size_t size) {
+  auto mlu_stream = reinterpret_cast<mluStream_t>(stream);
+  return mlu_stream->workspace.Borrow(mlu_stream->queue, size);
+}
+
+// A device to host copy enqueued on a stream behind the work already issued
+// to it, into a pinned buffer of the runtime. The host keeps issuing work
+// while the copy is in flight, Wait blocks until this copy (and so the work
+// before it) is done rather than until the whole queue drains.
+class MLUReadback {
+ public:
+  MLUReadback(void *stream, const void *src, size_t size);
+  ~MLUReadback();
+
+  MLUReadback(const MLUReadback &) = delete;
+  MLUReadback &operator=(const MLUReadback &) = delete;
+
+  // Returns the host copy, valid for the lifetime of this object.
+  const void *Wait();
+
+ private:
+  void *data_ = nullptr;
+  size_t cls_ = 0;
+  cnrtNotifier_t notifier_ = nullptr;
+  int device_ = 0;
+  bool done_ = false;
+};
+
 C_Status MemCpyH2D(const C_Device device,
                    void *dst,
                    const void *src,
@@ -146,3 +245,14 @@ C_Status AsyncMemCpyD2H(const C_Device device,
                         void *dst,
                         const void *src,
                         size_t size);
+C_Status MemCpyP2P(const C_Device dst_device,
+                   const C_Device src_device,
+                   void *dst,
+                   const void *src,
+                   size_t size);
+C_Status AsyncMemCpyP2P(const C_Device dst_device,
+                        const C_Device src_device,
+                        C_Stream stream,
+                        void *dst,
+                        const void *src,
+                        size_t size);
@@ -0,0 +1,250 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "runtime/xccl_schedule.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+size_t CDataTypeSize(C_DataType dtype) {
+  switch (dtype) {
+    case C_DataType::BOOL:
+    case C_DataType::UINT8:
+    case C_DataType::INT8:
+      return 1;
+    case C_DataType::INT16:
+    case C_DataType::FLOAT16:
+    case C_DataType::BFLOAT16:
+      return 2;
+    case C_DataType::INT32:
+    case C_DataType::FLOAT32:
+      return 4;
+    case C_DataType::INT64:
+    case C_DataType::FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+size_t XcclTask::Bytes() const { return count * CDataTypeSize(data_type); }
+
+size_t XcclFusionAlignment(size_t bytes) {
+  constexpr size_t kAlignment = 128;
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+namespace {
+
+std::vector<XcclTask> OrderPointToPoint(
+    std::vector<XcclTask> tasks,
+    const std::function<size_t(C_CCLComm)> &rank_of) {
+  std::vector<C_CCLComm> comms;
+  for (const auto &task : tasks) {
+    if (std::find(comms.begin(), comms.end(), task.comm) == comms.end()) {
+      comms.push_back(task.comm);
+    }
+  }
+  auto order = [&](const XcclTask &task) {
+    bool send_first = rank_of(task.comm) < task.peer;
+    bool is_send = task.kind == XcclTask::kSend;
+    size_t comm_index =
+        std::find(comms.begin(), comms.end(), task.comm) - comms.begin();
+    return std::make_tuple(comm_index, task.peer, is_send != send_first);
+  };
+  std::stable_sort(
+      tasks.begin(), tasks.end(), [&](const XcclTask &a, const XcclTask &b) {
+        return order(a) < order(b);
+      });
+  return tasks;
+}
+
+}  // namespace
+
+std::vector<std::vector<XcclTask>> ScheduleXcclGroup(
+    const std::vector<XcclTask> &tasks,
+    size_t bucket_bytes,
+    const std::function<bool(const XcclTask &)> &fusible,
+    const std::function<size_t(C_CCLComm)> &rank_of) {
+  std::vector<std::vector<XcclTask>> units;
+  std::vector<size_t> unit_bytes;
+  std::vector<XcclTask> p2p;
+  std::map<std::tuple<C_CCLComm, C_Stream, int, int>, size_t> open_buckets;
+  for (const auto &task : tasks) {
+    if (task.kind == XcclTask::kSend || task.kind == XcclTask::kRecv) {
+      p2p.push_back(task);
+      continue;
+    }
+    const size_t bytes = XcclFusionAlignment(task.Bytes());
+    if (task.kind != XcclTask::kAllReduce || !fusible(task) ||
+        bytes > bucket_bytes) {
+      units.push_back({task});
+      unit_bytes.push_back(0);
+      continue;
+    }
+    auto key = std::make_tuple(task.comm,
+                               task.stream,
+                               static_cast<int>(task.data_type),
+                               static_cast<int>(task.op));
+    auto it = open_buckets.find(key);
+    if (it != open_buckets.end() &&
+        unit_bytes[it->second] + bytes <= bucket_bytes) {
+      units[it->second].push_back(task);
+      unit_bytes[it->second] += bytes;
+      continue;
+    }
+    open_buckets[key] = units.size();
+    units.push_back({task});
+    unit_bytes.push_back(bytes);
+  }
+  for (auto &task : OrderPointToPoint(std::move(p2p), rank_of)) {
+    units.push_back({task});
+  }
+  return units;
+}
+
+XcclTopology BuildXcclTopology(size_t rank,
+                               const std::vector<uint64_t> &host_ids) {
+  XcclTopology topology;
+  // Nodes in the order of their lowest rank.
+  std::vector<uint64_t> nodes;
+  std::vector<size_t> node_sizes;
+  std::vector<size_t> local_ranks(host_ids.size());
+  for (size_t i = 0; i < host_ids.size(); ++i) {
+    auto it = std::find(nodes.begin(), nodes.end(), host_ids[i]);
+    size_t node = it - nodes.begin();
+    if (it == nodes.end()) {
+      nodes.push_back(host_ids[i]);
+      node_sizes.push_back(0);
+    }
+    local_ranks[i] = node_sizes[node]++;
+    if (i == rank) {
+      topology.node = node;
+      topology.local_rank = local_ranks[i];
+    }
+  }
+  topology.nodes = nodes.size();
+  topology.local_size = node_sizes[topology.node];
+  topology.uniform = std::all_of(
+      node_sizes.begin(), node_sizes.end(), [&](size_t size) {
+        return size == node_sizes[0];
+      });
+  topology.intra_root = std::find(host_ids.begin(),
+                                  host_ids.end(),
+                                  host_ids[rank]) -
+                        host_ids.begin();
+  topology.inter_root = std::find(local_ranks.begin(),
+                                  local_ranks.end(),
+                                  topology.local_rank) -
+                        local_ranks.begin();
+  return topology;
+}
+
+XcclWireType GetXcclWireType(C_DataType dtype, C_CCLReduceOp op) {
+  switch (dtype) {
+    case C_DataType::FLOAT32:
+    case C_DataType::FLOAT16:
+    case C_DataType::INT32:
+    case C_DataType::INT16:
+    case C_DataType::INT8:
+    case C_DataType::UINT8:
+      return XcclWireType::kNative;
+    case C_DataType::BFLOAT16:
+      return op == C_CCLReduceOp::AVG ? XcclWireType::kUnsupported
+                                      : XcclWireType::kFloat32;
+    case C_DataType::INT64:
+      return op == C_CCLReduceOp::SUM ? XcclWireType::kInt32Limbs
+                                      : XcclWireType::kUnsupported;
+    default:
+      return XcclWireType::kUnsupported;
+  }
+}
+
+size_t XcclWireCount(XcclWireType wire, size_t count) {
+  return wire == XcclWireType::kInt32Limbs ? count * 3 : count;
+}
+
+namespace {
+
+constexpr int kLimbBits = 21;
+constexpr uint64_t kLimbMask = (uint64_t(1) << kLimbBits) - 1;
+
+float BFloat16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+uint16_t FloatToBFloat16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    return 0x7fc0;  // NaN
+  }
+  // Round to nearest even.
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+}  // namespace
+
+void EncodeXcclWire(XcclWireType wire,
+                    const void *src,
+                    size_t count,
+                    void *wire_buf) {
+  if (wire == XcclWireType::kFloat32) {
+    auto in = static_cast<const uint16_t *>(src);
+    auto out = static_cast<float *>(wire_buf);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = BFloat16ToFloat(in[i]);
+    }
+  } else if (wire == XcclWireType::kInt32Limbs) {
+    auto in = static_cast<const int64_t *>(src);
+    auto out = static_cast<int32_t *>(wire_buf);
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t bits = static_cast<uint64_t>(in[i]);
+      out[i] = static_cast<int32_t>(bits & kLimbMask);
+      out[count + i] = static_cast<int32_t>((bits >> kLimbBits) & kLimbMask);
+      out[2 * count + i] = static_cast<int32_t>(in[i] >> (2 * kLimbBits));
+    }
+  }
+}
+
+void DecodeXcclWire(XcclWireType wire,
+                    const void *wire_buf,
+                    size_t count,
+                    void *dst) {
+  if (wire == XcclWireType::kFloat32) {
+    auto in = static_cast<const float *>(wire_buf);
+    auto out = static_cast<uint16_t *>(dst);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = FloatToBFloat16(in[i]);
+    }
+  } else if (wire == XcclWireType::kInt32Limbs) {
+    auto in = static_cast<const int32_t *>(wire_buf);
+    auto out = static_cast<int64_t *>(dst);
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t sum = static_cast<uint64_t>(static_cast<int64_t>(in[i]));
+      sum += static_cast<uint64_t>(static_cast<int64_t>(in[count + i]))
+             << kLimbBits;
+      sum += static_cast<uint64_t>(static_cast<int64_t>(in[2 * count + i]))
+             << (2 * kLimbBits);
+      out[i] = static_cast<int64_t>(sum);
+    }
+  }
+}
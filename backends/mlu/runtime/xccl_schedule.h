@@ -0,0 +1,130 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "paddle/phi/extension.h"
+
+// Scheduling of the collectives the runtime hands to CNCL. Nothing in here
+// calls CNCL, so the decisions are checked by tests/runtime without any
+// device.
+
+struct XcclTask {
+  enum Kind {
+    kAllReduce,
+    kReduce,
+    kBroadcast,
+    kAllGather,
+    kReduceScatter,
+    kSend,
+    kRecv,
+  };
+
+  Kind kind;
+  void *send_buf;
+  void *recv_buf;
+  size_t count;
+  C_DataType data_type;
+  C_CCLReduceOp op;
+  size_t peer;  // root of broadcast and reduce, peer of send and recv
+  C_CCLComm comm;
+  C_Stream stream;
+
+  size_t Bytes() const;
+};
+
+size_t CDataTypeSize(C_DataType dtype);
+
+// Offset granularity of the members of a fused all-reduce.
+size_t XcclFusionAlignment(size_t bytes);
+
+// Orders the collectives queued between XcclGroupStart and XcclGroupEnd into
+// units that are issued one after another, each either a single task or a
+// bucket of all-reduces reduced with one CNCL call:
+// - All-reduces for which fusible returns true and that share communicator,
+//   stream, data type and reduce op are packed into buckets of at most
+//   bucket_bytes, a bucket takes the place of its first member. 0 disables
+//   fusion.
+// - Other collectives keep their order.
+// - Sends and recvs follow, ordered by communicator and peer rank. With each
+//   peer the lower rank sends first and the higher rank receives first, so
+//   the blocking pairs of all ranks line up.
+// The same group issued on every rank yields the same units, which is what
+// keeps the collectives matched across ranks.
+std::vector<std::vector<XcclTask>> ScheduleXcclGroup(
+    const std::vector<XcclTask> &tasks,
+    size_t bucket_bytes,
+    const std::function<bool(const XcclTask &)> &fusible,
+    const std::function<size_t(C_CCLComm)> &rank_of);
+
+// Placement of a rank among the nodes of a communicator, derived from one
+// host id per rank. Nodes are numbered by their lowest rank, so every rank
+// derives the same numbering.
+struct XcclTopology {
+  size_t local_rank = 0;
+  size_t local_size = 1;
+  size_t node = 0;
+  size_t nodes = 1;
+  // Lowest rank on the node of this rank.
+  size_t intra_root = 0;
+  // Lowest rank with the local rank of this rank.
+  size_t inter_root = 0;
+  // Whether every node holds the same number of ranks.
+  bool uniform = true;
+
+  // All-reduces are split into an intra-node reduce-scatter, an inter-node
+  // all-reduce of each shard and an intra-node all-gather only if there is
+  // more than one node and more than one rank per node.
+  bool Hierarchical() const { return nodes > 1 && local_size > 1 && uniform; }
+};
+
+XcclTopology BuildXcclTopology(size_t rank,
+                               const std::vector<uint64_t> &host_ids);
+
+// CNCL has no 64-bit integer or bfloat16 reductions. Such reductions are
+// issued on a wire buffer of a type CNCL does support and converted on the
+// host:
+// - bfloat16 travels as float32, which holds every bfloat16 value exactly.
+// - int64 sums travel as three planes of int32 limbs of 21, 21 and 22 bits
+//   (the top one signed), whose sums over up to kXcclMaxLimbRanks ranks
+//   cannot overflow. Recombining them wraps like an int64 sum.
+constexpr size_t kXcclMaxLimbRanks = 1 << 9;
+
+enum class XcclWireType {
+  kNative,
+  kFloat32,
+  kInt32Limbs,
+  kUnsupported,
+};
+
+XcclWireType GetXcclWireType(C_DataType dtype, C_CCLReduceOp op);
+
+// Number of wire elements for count elements.
+size_t XcclWireCount(XcclWireType wire, size_t count);
+
+void EncodeXcclWire(XcclWireType wire,
+                    const void *src,
+                    size_t count,
+                    void *wire_buf);
+
+void DecodeXcclWire(XcclWireType wire,
+                    const void *wire_buf,
+                    size_t count,
+                    void *dst);
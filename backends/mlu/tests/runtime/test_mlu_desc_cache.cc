@@ -0,0 +1,142 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/funcs/mlu_desc_cache.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Stands in for a raw descriptor type.
+struct FakeDesc {
+  std::string params;
+};
+
+std::vector<std::string> &Destroyed() {
+  static std::vector<std::string> destroyed;
+  return destroyed;
+}
+
+void DestroyFakeDesc(FakeDesc *desc) {
+  Destroyed().push_back(desc->params);
+  delete desc;
+}
+
+using FakeDescCache = custom_kernel::MLUDescCache<FakeDesc *, std::string>;
+
+FakeDesc *Acquire(FakeDescCache *cache, const std::string &key) {
+  return cache->Acquire(
+      key, [](const std::string &params) { return new FakeDesc{params}; });
+}
+
+class MLUDescCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override { Destroyed().clear(); }
+};
+
+}  // namespace
+
+TEST_F(MLUDescCacheTest, ReusesDescriptorsOfTheSameKey) {
+  FakeDescCache cache(DestroyFakeDesc, 4);
+  FakeDesc *a = Acquire(&cache, "a");
+  FakeDesc *b = Acquire(&cache, "b");
+  EXPECT_NE(a, b);
+  // Held and idle descriptors are both handed out again.
+  EXPECT_EQ(Acquire(&cache, "a"), a);
+  EXPECT_TRUE(cache.Release(a));
+  EXPECT_TRUE(cache.Release(a));
+  EXPECT_EQ(Acquire(&cache, "a"), a);
+  EXPECT_EQ(cache.hits(), 2u);
+  EXPECT_EQ(cache.misses(), 2u);
+
+  std::string key;
+  ASSERT_TRUE(cache.GetKey(b, &key));
+  EXPECT_EQ(key, "b");
+  EXPECT_TRUE(Destroyed().empty());
+}
+
+TEST_F(MLUDescCacheTest, EvictsLeastRecentlyReleasedIdleDescriptors) {
+  FakeDescCache cache(DestroyFakeDesc, 2);
+  FakeDesc *a = Acquire(&cache, "a");
+  FakeDesc *b = Acquire(&cache, "b");
+  FakeDesc *c = Acquire(&cache, "c");
+  FakeDesc *d = Acquire(&cache, "d");
+  // Held descriptors are never evicted, whatever the capacity.
+  EXPECT_TRUE(Destroyed().empty());
+
+  cache.Release(b);
+  cache.Release(a);
+  cache.Release(c);
+  ASSERT_EQ(Destroyed().size(), 1u);
+  EXPECT_EQ(Destroyed()[0], "b");
+
+  // Acquiring a takes it off the idle list, so c is now the oldest.
+  EXPECT_EQ(Acquire(&cache, "a"), a);
+  cache.Release(d);
+  cache.Release(a);
+  ASSERT_EQ(Destroyed().size(), 2u);
+  EXPECT_EQ(Destroyed()[1], "c");
+
+  // An evicted key is created again on the next Acquire.
+  FakeDesc *b2 = Acquire(&cache, "b");
+  std::string key;
+  ASSERT_TRUE(cache.GetKey(b2, &key));
+  EXPECT_EQ(key, "b");
+  EXPECT_EQ(cache.misses(), 5u);
+  cache.Release(b2);
+}
+
+TEST_F(MLUDescCacheTest, DestroysCachedDescriptorsWithTheCache) {
+  {
+    FakeDescCache cache(DestroyFakeDesc, 4);
+    FakeDesc *a = Acquire(&cache, "a");
+    Acquire(&cache, "b");
+    cache.Release(a);
+  }
+  EXPECT_EQ(Destroyed().size(), 2u);
+}
+
+TEST_F(MLUDescCacheTest, ReleaseOnAnotherThreadIsRejected) {
+  // Each thread has a cache of its own, as in mlu_baseop.cc.
+  auto thread_cache = []() -> FakeDescCache & {
+    thread_local FakeDescCache cache(DestroyFakeDesc, 4);
+    return cache;
+  };
+  FakeDesc *a = Acquire(&thread_cache(), "a");
+
+  bool released = true;
+  FakeDesc *other = nullptr;
+  std::thread([&] {
+    released = thread_cache().Release(a);
+    other = Acquire(&thread_cache(), "a");
+    thread_cache().Release(other);
+  }).join();
+  // The other thread neither released nor destroyed the descriptor, and
+  // created its own for the same key.
+  EXPECT_FALSE(released);
+  EXPECT_NE(other, a);
+  ASSERT_EQ(Destroyed().size(), 1u);
+  EXPECT_EQ(Destroyed()[0], "a");
+
+  // The owning thread still holds a and releases it normally.
+  std::string key;
+  ASSERT_TRUE(thread_cache().GetKey(a, &key));
+  EXPECT_TRUE(thread_cache().Release(a));
+  EXPECT_EQ(Acquire(&thread_cache(), "a"), a);
+  EXPECT_TRUE(thread_cache().Release(a));
+}
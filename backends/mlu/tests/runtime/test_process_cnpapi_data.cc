@@ -0,0 +1,185 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/process_cnpapi_data.h"
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using paddle::platform::TracerEventType;
+
+// Records are stamped on the CNPAPI clock, which runs kTimeGap behind the
+// host clock; profiling started at kStartNs on the host clock.
+constexpr uint64_t kTimeGap = 1000000;
+constexpr uint64_t kStartNs = kTimeGap + 500;
+
+template <typename Record>
+void Process(const Record &record, CnpapiTraceEvents *events) {
+  ProcessCnpapiActivityRecord(reinterpret_cast<const cnpapiActivity *>(&record),
+                              kStartNs,
+                              kTimeGap,
+                              events);
+}
+
+cnpapiActivityKernel MakeKernel(uint64_t start, const char *name) {
+  cnpapiActivityKernel kernel;
+  memset(&kernel, 0, sizeof(kernel));
+  kernel.type = CNPAPI_ACTIVITY_TYPE_KERNEL;
+  kernel.start = start;
+  kernel.end = start + 40;
+  kernel.name = name;
+  kernel.dimx = 4;
+  kernel.dimy = 1;
+  kernel.dimz = 1;
+  kernel.kernel_type = 8;
+  kernel.device_id = 1;
+  kernel.context_id = 2;
+  kernel.queue_id = 3;
+  kernel.correlation_id = 17;
+  return kernel;
+}
+
+cnpapiActivityAPI MakeApi(cnpapiActivityType type, uint64_t start) {
+  cnpapiActivityAPI api;
+  memset(&api, 0, sizeof(api));
+  api.type = type;
+  api.start = start;
+  api.end = start + 10;
+  api.process_id = 100;
+  api.thread_id = 101;
+  api.correlation_id = 17;
+  return api;
+}
+
+}  // namespace
+
+TEST(ProcessCnpapiActivityRecord, Kernel) {
+  CnpapiTraceEvents events;
+  Process(MakeKernel(600, "_Z9AddKernelPfi"), &events);
+  ASSERT_EQ(events.device_events.size(), 1u);
+  EXPECT_TRUE(events.runtime_events.empty());
+  const auto &event = events.device_events[0];
+  EXPECT_EQ(event.type, TracerEventType::Kernel);
+  EXPECT_EQ(event.name, "AddKernel(float*, int)");
+  EXPECT_EQ(event.start_ns, 600 + kTimeGap);
+  EXPECT_EQ(event.end_ns, 640 + kTimeGap);
+  EXPECT_EQ(event.device_id, 1u);
+  EXPECT_EQ(event.context_id, 2u);
+  EXPECT_EQ(event.stream_id, 3u);
+  EXPECT_EQ(event.correlation_id, 17u);
+  EXPECT_EQ(event.kernel_info.block_x, 4u);
+  EXPECT_EQ(event.kernel_info.grid_x, 8u);
+}
+
+TEST(ProcessCnpapiActivityRecord, KernelNamesThatDoNotDemangle) {
+  CnpapiTraceEvents events;
+  Process(MakeKernel(600, "plain_kernel"), &events);
+  Process(MakeKernel(600, nullptr), &events);
+  ASSERT_EQ(events.device_events.size(), 2u);
+  EXPECT_EQ(events.device_events[0].name, "plain_kernel");
+  EXPECT_EQ(events.device_events[1].name, "unknown");
+}
+
+TEST(ProcessCnpapiActivityRecord, MemcpyAndMemset) {
+  cnpapiActivityMemcpy memcpy_record;
+  memset(&memcpy_record, 0, sizeof(memcpy_record));
+  memcpy_record.type = CNPAPI_ACTIVITY_TYPE_MEMCPY;
+  memcpy_record.copy_type = CNPAPI_ACTIVITY_MEMCPY_TYPE_DTOH;
+  memcpy_record.bytes = 4096;
+  memcpy_record.start = 700;
+  memcpy_record.end = 800;
+
+  cnpapiActivityMemcpyPtoP peer_record;
+  memset(&peer_record, 0, sizeof(peer_record));
+  peer_record.type = CNPAPI_ACTIVITY_TYPE_MEMCPY_PTOP;
+  peer_record.copy_type = CNPAPI_ACTIVITY_MEMCPY_TYPE_PTOP;
+  peer_record.bytes = 64;
+  peer_record.start = 900;
+  peer_record.end = 950;
+
+  cnpapiActivityMemset memset_record;
+  memset(&memset_record, 0, sizeof(memset_record));
+  memset_record.type = CNPAPI_ACTIVITY_TYPE_MEMSET;
+  memset_record.bytes = 256;
+  memset_record.value = 7;
+  memset_record.start = 1000;
+  memset_record.end = 1001;
+
+  CnpapiTraceEvents events;
+  Process(memcpy_record, &events);
+  Process(peer_record, &events);
+  Process(memset_record, &events);
+  ASSERT_EQ(events.device_events.size(), 3u);
+
+  const auto &copy = events.device_events[0];
+  EXPECT_EQ(copy.type, TracerEventType::Memcpy);
+  EXPECT_EQ(copy.name, "MEMCPY_DtoH");
+  EXPECT_STREQ(copy.memcpy_info.copy_kind, "MEMCPY_DtoH");
+  EXPECT_EQ(copy.memcpy_info.num_bytes, 4096u);
+  EXPECT_EQ(copy.start_ns, 700 + kTimeGap);
+  EXPECT_EQ(copy.end_ns, 800 + kTimeGap);
+
+  const auto &peer = events.device_events[1];
+  EXPECT_EQ(peer.type, TracerEventType::Memcpy);
+  EXPECT_EQ(peer.name, "MEMCPY_PtoP");
+  EXPECT_EQ(peer.memcpy_info.num_bytes, 64u);
+  EXPECT_EQ(peer.start_ns, 900 + kTimeGap);
+
+  const auto &set = events.device_events[2];
+  EXPECT_EQ(set.type, TracerEventType::Memset);
+  EXPECT_EQ(set.name, "MEMSET");
+  EXPECT_EQ(set.memset_info.num_bytes, 256u);
+  EXPECT_EQ(set.memset_info.value, 7u);
+  EXPECT_EQ(set.start_ns, 1000 + kTimeGap);
+}
+
+TEST(ProcessCnpapiActivityRecord, ApiCalls) {
+  CnpapiTraceEvents events;
+  auto cnrt = MakeApi(CNPAPI_ACTIVITY_TYPE_CNRT_API, 550);
+  auto cndrv = MakeApi(CNPAPI_ACTIVITY_TYPE_CNDRV_API, 560);
+  auto cncl = MakeApi(CNPAPI_ACTIVITY_TYPE_CNCL_API, 570);
+  Process(cnrt, &events);
+  Process(cndrv, &events);
+  Process(cncl, &events);
+  EXPECT_TRUE(events.device_events.empty());
+  ASSERT_EQ(events.runtime_events.size(), 3u);
+  EXPECT_EQ(events.runtime_events[0].type, TracerEventType::MluRuntime);
+  EXPECT_EQ(events.runtime_events[1].type, TracerEventType::MluRuntime);
+  EXPECT_EQ(events.runtime_events[2].type, TracerEventType::Communication);
+  for (const auto &event : events.runtime_events) {
+    EXPECT_FALSE(event.name.empty());
+    EXPECT_EQ(event.end_ns - event.start_ns, 10u);
+    EXPECT_EQ(event.process_id, 100u);
+    EXPECT_EQ(event.thread_id, 101u);
+    EXPECT_EQ(event.correlation_id, 17u);
+  }
+  EXPECT_EQ(events.runtime_events[0].start_ns, 550 + kTimeGap);
+  EXPECT_EQ(events.runtime_events[2].start_ns, 570 + kTimeGap);
+}
+
+TEST(ProcessCnpapiActivityRecord, SkipsRecordsBeforeStart) {
+  CnpapiTraceEvents events;
+  // Starts at kStartNs - 1 on the host clock once the gap is added.
+  Process(MakeKernel(499, "early"), &events);
+  Process(MakeApi(CNPAPI_ACTIVITY_TYPE_CNRT_API, 499), &events);
+  Process(MakeKernel(500, "first"), &events);
+  ASSERT_EQ(events.device_events.size(), 1u);
+  EXPECT_EQ(events.device_events[0].name, "first");
+  EXPECT_EQ(events.device_events[0].start_ns, kStartNs);
+  EXPECT_TRUE(events.runtime_events.empty());
+}
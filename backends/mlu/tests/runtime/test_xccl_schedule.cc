@@ -0,0 +1,208 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/xccl_schedule.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+C_CCLComm FakeComm(uintptr_t id) { return reinterpret_cast<C_CCLComm>(id); }
+
+C_Stream FakeStream(uintptr_t id) { return reinterpret_cast<C_Stream>(id); }
+
+XcclTask MakeTask(XcclTask::Kind kind,
+                  size_t count,
+                  C_DataType data_type = C_DataType::FLOAT32,
+                  size_t peer = 0,
+                  C_CCLComm comm = FakeComm(1)) {
+  XcclTask task;
+  task.kind = kind;
+  task.send_buf = nullptr;
+  task.recv_buf = nullptr;
+  task.count = count;
+  task.data_type = data_type;
+  task.op = C_CCLReduceOp::SUM;
+  task.peer = peer;
+  task.comm = comm;
+  task.stream = FakeStream(1);
+  return task;
+}
+
+std::vector<std::vector<XcclTask>> Schedule(const std::vector<XcclTask> &tasks,
+                                            size_t bucket_bytes,
+                                            size_t rank = 0) {
+  return ScheduleXcclGroup(
+      tasks,
+      bucket_bytes,
+      [](const XcclTask &) { return true; },
+      [rank](C_CCLComm) { return rank; });
+}
+
+}  // namespace
+
+TEST(ScheduleXcclGroup, FusesMatchingAllReduces) {
+  std::vector<XcclTask> tasks = {
+      MakeTask(XcclTask::kAllReduce, 32),
+      MakeTask(XcclTask::kAllReduce, 64, C_DataType::FLOAT16),
+      MakeTask(XcclTask::kAllReduce, 32),
+  };
+  auto units = Schedule(tasks, 1 << 20);
+  ASSERT_EQ(units.size(), 2u);
+  ASSERT_EQ(units[0].size(), 2u);
+  EXPECT_EQ(units[0][0].count, 32u);
+  EXPECT_EQ(units[0][1].count, 32u);
+  ASSERT_EQ(units[1].size(), 1u);
+  EXPECT_EQ(units[1][0].data_type, C_DataType::FLOAT16);
+}
+
+TEST(ScheduleXcclGroup, RespectsBucketBytes) {
+  // Every member takes one aligned slot of 128 bytes.
+  std::vector<XcclTask> tasks(5, MakeTask(XcclTask::kAllReduce, 8));
+  auto units = Schedule(tasks, 256);
+  ASSERT_EQ(units.size(), 3u);
+  EXPECT_EQ(units[0].size(), 2u);
+  EXPECT_EQ(units[1].size(), 2u);
+  EXPECT_EQ(units[2].size(), 1u);
+}
+
+TEST(ScheduleXcclGroup, ZeroBucketBytesDisablesFusion) {
+  std::vector<XcclTask> tasks(3, MakeTask(XcclTask::kAllReduce, 8));
+  auto units = Schedule(tasks, 0);
+  ASSERT_EQ(units.size(), 3u);
+  for (const auto &unit : units) EXPECT_EQ(unit.size(), 1u);
+}
+
+TEST(ScheduleXcclGroup, KeepsCollectiveOrderAndMovesPointToPointLast) {
+  std::vector<XcclTask> tasks = {
+      MakeTask(XcclTask::kSend, 8, C_DataType::FLOAT32, 1),
+      MakeTask(XcclTask::kBroadcast, 8),
+      MakeTask(XcclTask::kAllReduce, 8),
+      MakeTask(XcclTask::kAllGather, 8),
+  };
+  auto units = Schedule(tasks, 0);
+  ASSERT_EQ(units.size(), 4u);
+  EXPECT_EQ(units[0][0].kind, XcclTask::kBroadcast);
+  EXPECT_EQ(units[1][0].kind, XcclTask::kAllReduce);
+  EXPECT_EQ(units[2][0].kind, XcclTask::kAllGather);
+  EXPECT_EQ(units[3][0].kind, XcclTask::kSend);
+}
+
+TEST(ScheduleXcclGroup, PairsSendsAndRecvsAcrossRanks) {
+  // Rank 0 and rank 1 exchange with each other, queued in the same order.
+  std::vector<XcclTask> rank0 = {
+      MakeTask(XcclTask::kRecv, 8, C_DataType::FLOAT32, 1),
+      MakeTask(XcclTask::kSend, 8, C_DataType::FLOAT32, 1),
+  };
+  std::vector<XcclTask> rank1 = {
+      MakeTask(XcclTask::kRecv, 8, C_DataType::FLOAT32, 0),
+      MakeTask(XcclTask::kSend, 8, C_DataType::FLOAT32, 0),
+  };
+  auto units0 = Schedule(rank0, 0, 0);
+  auto units1 = Schedule(rank1, 0, 1);
+  ASSERT_EQ(units0.size(), 2u);
+  ASSERT_EQ(units1.size(), 2u);
+  // The lower rank sends first, the higher rank receives first.
+  EXPECT_EQ(units0[0][0].kind, XcclTask::kSend);
+  EXPECT_EQ(units1[0][0].kind, XcclTask::kRecv);
+  EXPECT_EQ(units0[1][0].kind, XcclTask::kRecv);
+  EXPECT_EQ(units1[1][0].kind, XcclTask::kSend);
+}
+
+TEST(BuildXcclTopology, SingleNode) {
+  std::vector<uint64_t> host_ids = {7, 7, 7, 7};
+  auto topology = BuildXcclTopology(2, host_ids);
+  EXPECT_EQ(topology.local_rank, 2u);
+  EXPECT_EQ(topology.local_size, 4u);
+  EXPECT_EQ(topology.node, 0u);
+  EXPECT_EQ(topology.nodes, 1u);
+  EXPECT_EQ(topology.intra_root, 0u);
+  EXPECT_EQ(topology.inter_root, 2u);
+  EXPECT_FALSE(topology.Hierarchical());
+}
+
+TEST(BuildXcclTopology, InterleavedNodes) {
+  // Ranks 0 and 2 run on host 5, ranks 1 and 3 on host 9.
+  std::vector<uint64_t> host_ids = {5, 9, 5, 9};
+  std::vector<XcclTopology> topologies;
+  for (size_t rank = 0; rank < host_ids.size(); ++rank) {
+    topologies.push_back(BuildXcclTopology(rank, host_ids));
+  }
+  for (const auto &topology : topologies) {
+    EXPECT_EQ(topology.nodes, 2u);
+    EXPECT_EQ(topology.local_size, 2u);
+    EXPECT_TRUE(topology.Hierarchical());
+  }
+  EXPECT_EQ(topologies[3].node, 1u);
+  EXPECT_EQ(topologies[3].local_rank, 1u);
+  EXPECT_EQ(topologies[3].intra_root, 1u);
+  EXPECT_EQ(topologies[3].inter_root, 2u);
+  EXPECT_EQ(topologies[2].node, 0u);
+  EXPECT_EQ(topologies[2].local_rank, 1u);
+  EXPECT_EQ(topologies[2].intra_root, 0u);
+  EXPECT_EQ(topologies[2].inter_root, 2u);
+}
+
+TEST(BuildXcclTopology, UnevenNodesAreNotHierarchical) {
+  std::vector<uint64_t> host_ids = {1, 1, 1, 2, 2};
+  auto topology = BuildXcclTopology(4, host_ids);
+  EXPECT_EQ(topology.nodes, 2u);
+  EXPECT_EQ(topology.local_size, 2u);
+  EXPECT_FALSE(topology.uniform);
+  EXPECT_FALSE(topology.Hierarchical());
+}
+
+TEST(XcclWire, Int64SumsSurviveLimbs) {
+  std::vector<int64_t> values = {0, 1, -1, INT64_MAX, INT64_MIN, 123456789};
+  auto wire = GetXcclWireType(C_DataType::INT64, C_CCLReduceOp::SUM);
+  ASSERT_EQ(wire, XcclWireType::kInt32Limbs);
+  const size_t count = values.size();
+  std::vector<int32_t> encoded(XcclWireCount(wire, count));
+  EncodeXcclWire(wire, values.data(), count, encoded.data());
+  // Sum the limbs of three ranks holding the same values.
+  std::vector<int32_t> sum(encoded.size());
+  for (size_t i = 0; i < encoded.size(); ++i) sum[i] = 3 * encoded[i];
+  std::vector<int64_t> decoded(count);
+  DecodeXcclWire(wire, sum.data(), count, decoded.data());
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t expected = 3 * static_cast<uint64_t>(values[i]);
+    EXPECT_EQ(decoded[i], static_cast<int64_t>(expected));
+  }
+}
+
+TEST(XcclWire, BFloat16RoundTrips) {
+  // 1.0, -2.5 and the largest finite bfloat16.
+  std::vector<uint16_t> values = {0x3f80, 0xc020, 0x7f7f};
+  auto wire = GetXcclWireType(C_DataType::BFLOAT16, C_CCLReduceOp::MAX);
+  ASSERT_EQ(wire, XcclWireType::kFloat32);
+  std::vector<float> encoded(XcclWireCount(wire, values.size()));
+  EncodeXcclWire(wire, values.data(), values.size(), encoded.data());
+  EXPECT_EQ(encoded[0], 1.0f);
+  EXPECT_EQ(encoded[1], -2.5f);
+  std::vector<uint16_t> decoded(values.size());
+  DecodeXcclWire(wire, encoded.data(), values.size(), decoded.data());
+  EXPECT_EQ(decoded, values);
+}
+
+TEST(XcclWire, UnsupportedReductions) {
+  EXPECT_EQ(GetXcclWireType(C_DataType::INT64, C_CCLReduceOp::MAX),
+            XcclWireType::kUnsupported);
+  EXPECT_EQ(GetXcclWireType(C_DataType::BFLOAT16, C_CCLReduceOp::AVG),
+            XcclWireType::kUnsupported);
+  EXPECT_EQ(GetXcclWireType(C_DataType::FLOAT32, C_CCLReduceOp::AVG),
+            XcclWireType::kNative);
+}
@@ -215,6 +215,74 @@ class TestAdamOpWithSkipUpdate(OpTest):
         self.check_output_with_place(self.place, atol=1e-5)
 
 
+class TestAdamOpWithDeviceSkipUpdate(unittest.TestCase):
+
+    # SkipUpdate computed on the device reaches the kernel as a device
+    # tensor, params and moments must come out unchanged all the same.
+    def test_skip_update_on_device(self):
+        paddle.enable_static()
+        place = paddle.CustomPlace('CustomMLU', 0)
+        shape = (102, 105)
+        param = np.random.uniform(-1, 1, shape).astype("float32")
+        grad = np.random.uniform(-1, 1, shape).astype("float32")
+        moment1 = np.random.uniform(-1, 1, shape).astype("float32")
+        moment2 = np.random.random(shape).astype("float32")
+        beta1 = 0.78
+        beta2 = 0.836
+        feed = {
+            'param': param,
+            'grad': grad,
+            'moment1': moment1,
+            'moment2': moment2,
+            'lr': np.array([0.004]).astype("float32"),
+            'beta1_pow': np.array([beta1**10]).astype("float32"),
+            'beta2_pow': np.array([beta2**10]).astype("float32"),
+        }
+
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            block = main.global_block()
+            variables = {
+                name: paddle.static.data(name=name,
+                                         shape=value.shape,
+                                         dtype=value.dtype)
+                for name, value in feed.items()
+            }
+            skip = paddle.full([1], True, 'bool')
+            block.append_op(type='adam',
+                            inputs={
+                                'Param': variables['param'],
+                                'Grad': variables['grad'],
+                                'LearningRate': variables['lr'],
+                                'Moment1': variables['moment1'],
+                                'Moment2': variables['moment2'],
+                                'Beta1Pow': variables['beta1_pow'],
+                                'Beta2Pow': variables['beta2_pow'],
+                                'SkipUpdate': skip,
+                            },
+                            outputs={
+                                'ParamOut': variables['param'],
+                                'Moment1Out': variables['moment1'],
+                                'Moment2Out': variables['moment2'],
+                                'Beta1PowOut': variables['beta1_pow'],
+                                'Beta2PowOut': variables['beta2_pow'],
+                            },
+                            attrs={
+                                'beta1': beta1,
+                                'beta2': beta2,
+                                'epsilon': 1e-4,
+                            })
+
+        exe = fluid.Executor(place)
+        names = ['param', 'moment1', 'moment2', 'beta1_pow', 'beta2_pow']
+        outs = exe.run(main,
+                       feed=feed,
+                       fetch_list=[variables[name] for name in names])
+        for name, out in zip(names, outs):
+            np.testing.assert_array_equal(out, feed[name], err_msg=name)
+
+
 class TestAdamOpWithGlobalBetaPow(OpTest):
 
     def setUp(self):
@@ -70,6 +70,23 @@ class TestScaleOpScaleVariable(OpTest):
         self.check_output_with_place(self.place)
 
 
+class TestScaleOpBiasBeforeScale(OpTest):
+
+    def setUp(self):
+        self.op_type = "scale"
+        self.place = paddle.CustomPlace('CustomMLU', 0)
+        self.__class__.use_custom_device = True
+        self.dtype = np.float32
+        self.inputs = {'X': np.random.random((10, 10)).astype(self.dtype)}
+        self.attrs = {'scale': -2.3, 'bias': 1.5, 'bias_after_scale': False}
+        self.outputs = {
+            'Out': (self.inputs['X'] + self.dtype(1.5)) * self.dtype(-2.3)
+        }
+
+    def test_check_output(self):
+        self.check_output_with_place(self.place)
+
+
 class TestScaleOpSelectedRows(unittest.TestCase):
 
     def init_dtype_type(self):
@@ -0,0 +1,156 @@
+#  Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+from tests.op_test import OpTest
+
+import numpy as np
+import paddle
+
+paddle.enable_static()
+SEED = 2022
+
+
+class TestUpdateLossScalingOp(OpTest):
+    def setUp(self):
+        self.set_mlu()
+        self.op_type = "update_loss_scaling"
+        self.init()
+        self.init_test_case()
+
+    def set_mlu(self):
+        self.__class__.use_custom_device = True
+        self.place = paddle.CustomPlace('CustomMLU', 0)
+
+    def init(self):
+        self.incr_ratio = 2.0
+        self.decr_ratio = 0.8
+        self.dtype = np.float32
+        self.prev_loss_scaling = np.array([2048]).astype(np.float32)
+        self.num_good_steps = np.array([999], dtype=np.int32)
+        self.num_bad_steps = np.array([1], dtype=np.int32)
+        self.zero_steps = np.array([0], dtype=np.int32)
+        self.attrs = {
+            'incr_every_n_steps': 1000,
+            'decr_every_n_nan_or_inf': 2,
+            'incr_ratio': self.incr_ratio,
+            'decr_ratio': self.decr_ratio,
+        }
+
+    def init_test_case(self):
+        found_inf = np.array([False], dtype=np.bool_)
+        x = np.random.random((1024, 1024)).astype(self.dtype)
+
+        self.inputs = {
+            'X': [('x0', x)],
+            'FoundInfinite': found_inf,
+            'PrevLossScaling': self.prev_loss_scaling,
+            'InGoodSteps': self.num_good_steps,
+            'InBadSteps': self.num_bad_steps
+        }
+
+        self.outputs = {
+            'Out': [('out0', x)],
+            'LossScaling': self.prev_loss_scaling * self.incr_ratio,
+            'OutGoodSteps': self.zero_steps,
+            'OutBadSteps': self.zero_steps
+        }
+
+    def test_check_output(self):
+        self.check_output_with_place(self.place, check_dygraph=False)
+
+
+class TestUpdateLossScalingOpGoodStep(TestUpdateLossScalingOp):
+    def init_test_case(self):
+        found_inf = np.array([False], dtype=np.bool_)
+        x = np.random.random((1024, 1024)).astype(self.dtype)
+        num_good_steps = np.array([10], dtype=np.int32)
+
+        self.inputs = {
+            'X': [('x0', x)],
+            'FoundInfinite': found_inf,
+            'PrevLossScaling': self.prev_loss_scaling,
+            'InGoodSteps': num_good_steps,
+            'InBadSteps': self.num_bad_steps
+        }
+
+        self.outputs = {
+            'Out': [('out0', x)],
+            'LossScaling': self.prev_loss_scaling,
+            'OutGoodSteps': num_good_steps + 1,
+            'OutBadSteps': self.zero_steps
+        }
+
+
+class TestUpdateLossScalingOpBad(TestUpdateLossScalingOp):
+    def init_test_case(self):
+        found_inf = np.array([True], dtype=np.bool_)
+        x = np.random.random((1024, 1024)).astype(self.dtype)
+        i = np.random.randint(0, 1024, 1)
+        j = np.random.randint(0, 1024, 1)
+        x[i[0]][j[0]] = np.inf
+
+        self.inputs = {
+            'X': [('x0', x)],
+            'FoundInfinite': found_inf,
+            'PrevLossScaling': self.prev_loss_scaling,
+            'InGoodSteps': self.num_good_steps,
+            'InBadSteps': self.num_bad_steps
+        }
+
+        self.outputs = {
+            'Out': [('out0', np.zeros_like(x))],
+            'LossScaling': self.prev_loss_scaling * self.decr_ratio,
+            'OutGoodSteps': self.zero_steps,
+            'OutBadSteps': self.zero_steps
+        }
+
+
+class TestUpdateLossScalingOpFirstBadStep(TestUpdateLossScalingOp):
+    def init_test_case(self):
+        found_inf = np.array([True], dtype=np.bool_)
+        x = np.random.random((1024, 1024)).astype(self.dtype)
+        x[0][0] = np.nan
+        num_bad_steps = np.array([0], dtype=np.int32)
+
+        self.inputs = {
+            'X': [('x0', x)],
+            'FoundInfinite': found_inf,
+            'PrevLossScaling': self.prev_loss_scaling,
+            'InGoodSteps': self.num_good_steps,
+            'InBadSteps': num_bad_steps
+        }
+
+        self.outputs = {
+            'Out': [('out0', np.zeros_like(x))],
+            'LossScaling': self.prev_loss_scaling,
+            'OutGoodSteps': self.zero_steps,
+            'OutBadSteps': num_bad_steps + 1
+        }
+
+
+class TestUpdateLossScalingOpMinScale(TestUpdateLossScalingOpBad):
+    def init(self):
+        super(TestUpdateLossScalingOpMinScale, self).init()
+        self.prev_loss_scaling = np.array([1]).astype(np.float32)
+
+    def init_test_case(self):
+        super(TestUpdateLossScalingOpMinScale, self).init_test_case()
+        self.outputs['LossScaling'] = self.prev_loss_scaling
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -17,8 +17,13 @@
 
 namespace custom_kernel {
 
+// Runs ApplyAdamD for one parameter. beta1, beta2 and epsilon are device
+// tensors shared by all parameters. Nothing is read back to the host: when
+// skip_update is a device tensor the update goes to copies and SelectV2
+// keeps either them or the inputs, param_in being the value kept on skip.
 template <typename T, typename Context>
-void AdamKernel(const Context& dev_ctx,
+void AdamUpdate(const Context& dev_ctx,
+                const phi::DenseTensor& param_in,
                 const phi::DenseTensor& param,
                 const phi::DenseTensor& grad,
                 const phi::DenseTensor& learning_rate,
@@ -26,150 +31,230 @@ void AdamKernel(const Context& dev_ctx,
                 const phi::DenseTensor& moment2,
                 const phi::DenseTensor& beta1_pow_in,
                 const phi::DenseTensor& beta2_pow_in,
-                const paddle::optional<phi::DenseTensor>& master_param,
-                const paddle::optional<phi::DenseTensor>& skip_update,
-                const phi::Scalar& beta1_in,
-                const phi::Scalar& beta2_in,
-                const phi::Scalar& epsilon_in,
-                bool lazy_mode,
-                int64_t min_row_size_to_use_multithread,
-                bool multi_precision,
+                const phi::DenseTensor& beta1_tensor,
+                const phi::DenseTensor& beta2_tensor,
+                const phi::DenseTensor& epsilon_tensor,
+                const phi::DenseTensor* skip_update,
                 bool use_global_beta_pow,
                 phi::DenseTensor* param_out,
                 phi::DenseTensor* moment1_out,
                 phi::DenseTensor* moment2_out,
                 phi::DenseTensor* beta1_pow_out,
-                phi::DenseTensor* beta2_pow_out,
-                phi::DenseTensor* master_param_out) {
-  bool skip_update_ = false;
-  if (skip_update.is_initialized()) {
-    PADDLE_ENFORCE_EQ(skip_update->numel(),
-                      1,
-                      phi::errors::InvalidArgument(
-                          "Input(SkipUpdate) size must be 1, but get %d",
-                          skip_update->numel()));
-    std::vector<bool> skip_update_vec;
-    custom_kernel::TensorToVector(
-        dev_ctx, *skip_update, dev_ctx, &skip_update_vec);
-    skip_update_ = skip_update_vec[0];
-  }
-
-  // skip_update=true, just copy input to output, and TensorCopy will call
-  // mutable_data
-  if (skip_update_) {
-    VLOG(4) << "Adam skip update";
-    TensorCopy(dev_ctx, param, false, param_out);
-    TensorCopy(dev_ctx, moment1, false, moment1_out);
-    TensorCopy(dev_ctx, moment2, false, moment2_out);
-    TensorCopy(dev_ctx, beta1_pow_in, false, beta1_pow_out);
-    TensorCopy(dev_ctx, beta2_pow_in, false, beta2_pow_out);
-    return;
-  }
-
-  phi::DenseTensor* beta1_pow = const_cast<phi::DenseTensor*>(&beta1_pow_in);
-  phi::DenseTensor* beta2_pow = const_cast<phi::DenseTensor*>(&beta2_pow_in);
-
-  VLOG(4) << "use_global_beta_pow:" << use_global_beta_pow;
-
-  dev_ctx.template Alloc<T>(param_out);
-  dev_ctx.template Alloc<T>(moment1_out);
-  dev_ctx.template Alloc<T>(moment2_out);
+                phi::DenseTensor* beta2_pow_out) {
+  auto stream = dev_ctx.stream();
 
   // NOTE(zhiqiu): beta1_pow and beta2_pow may on CPU and not transform
-  // place.
+  // place. The copies are staged, so they need no wait.
+  const phi::DenseTensor* beta1_pow = &beta1_pow_in;
+  const phi::DenseTensor* beta2_pow = &beta2_pow_in;
   phi::DenseTensor beta1_pow_tmp;
   phi::DenseTensor beta2_pow_tmp;
   if (beta1_pow->place().GetType() == phi::AllocationType::CPU) {
-    T beta1 = *beta1_pow->data<T>();
-    beta1_pow_tmp.Resize({1});
-    dev_ctx.template Alloc<T>(&beta1_pow_tmp);
-    FillNpuTensorWithConstant<T>(&beta1_pow_tmp, dev_ctx, beta1);
+    TensorCopy(dev_ctx, *beta1_pow, false, &beta1_pow_tmp);
     beta1_pow = &beta1_pow_tmp;
   }
   if (beta2_pow->place().GetType() == phi::AllocationType::CPU) {
-    T beta2 = *beta2_pow->data<T>();
-    beta2_pow_tmp.Resize({1});
-    dev_ctx.template Alloc<T>(&beta2_pow_tmp);
-    FillNpuTensorWithConstant<T>(&beta2_pow_tmp, dev_ctx, beta2);
+    TensorCopy(dev_ctx, *beta2_pow, false, &beta2_pow_tmp);
     beta2_pow = &beta2_pow_tmp;
   }
 
-  const phi::DenseTensor* beta1_tensor = nullptr;
-  const phi::DenseTensor* beta2_tensor = nullptr;
-  const phi::DenseTensor* epsilon_tensor = nullptr;
-
-  phi::DenseTensor beta1_tmp;
-  phi::DenseTensor beta2_tmp;
-  phi::DenseTensor epsilon_tmp;
-  phi::DenseTensorMeta meta = {phi::DataType::FLOAT32, {1}};
-  beta1_tmp.set_meta(meta);
-  beta2_tmp.set_meta(meta);
-  epsilon_tmp.set_meta(meta);
-
-  T beta1 = beta1_in.to<T>();
-  dev_ctx.template Alloc<T>(&beta1_tmp);
-  FillNpuTensorWithConstant<T>(&beta1_tmp, dev_ctx, beta1);
-  beta1_tensor = &beta1_tmp;
-
-  T beta2 = beta2_in.to<T>();
-  dev_ctx.template Alloc<T>(&beta2_tmp);
-  FillNpuTensorWithConstant<T>(&beta2_tmp, dev_ctx, beta2);
-  beta2_tensor = &beta2_tmp;
-
-  T epsilon = epsilon_in.to<T>();
-  dev_ctx.template Alloc<T>(&epsilon_tmp);
-  FillNpuTensorWithConstant<T>(&epsilon_tmp, dev_ctx, epsilon);
-  epsilon_tensor = &epsilon_tmp;
-
   VLOG(3) << "beta1_pow.numel() : " << beta1_pow->numel()
           << "beta2_pow.numel() : " << beta2_pow->numel();
   VLOG(3) << "param.numel(): " << param.numel();
 
-  auto stream = dev_ctx.stream();
+  dev_ctx.template Alloc<T>(param_out);
+  dev_ctx.template Alloc<T>(moment1_out);
+  dev_ctx.template Alloc<T>(moment2_out);
+
+  // ApplyAdamD updates its inputs in place.
+  phi::DenseTensor param_tmp;
+  phi::DenseTensor moment1_tmp;
+  phi::DenseTensor moment2_tmp;
+  if (skip_update) {
+    TensorCopy(dev_ctx, param, false, &param_tmp);
+    TensorCopy(dev_ctx, moment1, false, &moment1_tmp);
+    TensorCopy(dev_ctx, moment2, false, &moment2_tmp);
+  } else {
+    param_tmp = param;
+    moment1_tmp = moment1;
+    moment2_tmp = moment2;
+  }
+
   const auto& runner = NpuOpRunner("ApplyAdamD",
                                    {
-                                       param,
-                                       moment1,
-                                       moment2,
+                                       param_tmp,
+                                       moment1_tmp,
+                                       moment2_tmp,
                                        *beta1_pow,
                                        *beta2_pow,
                                        learning_rate,
-                                       *beta1_tensor,
-                                       *beta2_tensor,
-                                       *epsilon_tensor,
+                                       beta1_tensor,
+                                       beta2_tensor,
+                                       epsilon_tensor,
                                        grad,
                                    },
                                    {
-                                       *param_out,
-                                       *moment1_out,
-                                       *moment2_out,
+                                       param_tmp,
+                                       moment1_tmp,
+                                       moment2_tmp,
                                    },
                                    {});
   runner.Run(stream);
 
-  // NOTE(zhiqiu): ApplyAdamD updates params inplace, so
-  // if param and param_out is not same, we need to do copy.
-  if (param_out->data<T>() != param.data<T>()) {
-    TensorCopy(dev_ctx, param, false, param_out);
-  }
-  if (moment1_out->data<T>() != moment1.data<T>()) {
-    TensorCopy(dev_ctx, moment1, false, moment1_out);
-  }
-  if (moment2_out->data<T>() != moment2.data<T>()) {
-    TensorCopy(dev_ctx, moment2, false, moment2_out);
+  if (skip_update) {
+    const auto& runner_p = NpuOpRunner(
+        "SelectV2", {*skip_update, param_in, param_tmp}, {*param_out}, {});
+    runner_p.Run(stream);
+    const auto& runner_m1 = NpuOpRunner(
+        "SelectV2", {*skip_update, moment1, moment1_tmp}, {*moment1_out}, {});
+    runner_m1.Run(stream);
+    const auto& runner_m2 = NpuOpRunner(
+        "SelectV2", {*skip_update, moment2, moment2_tmp}, {*moment2_out}, {});
+    runner_m2.Run(stream);
+  } else {
+    // NOTE(zhiqiu): ApplyAdamD updates params inplace, so
+    // if param and param_out is not same, we need to do copy.
+    if (param_out->data<T>() != param.data<T>()) {
+      TensorCopy(dev_ctx, param, false, param_out);
+    }
+    if (moment1_out->data<T>() != moment1.data<T>()) {
+      TensorCopy(dev_ctx, moment1, false, moment1_out);
+    }
+    if (moment2_out->data<T>() != moment2.data<T>()) {
+      TensorCopy(dev_ctx, moment2, false, moment2_out);
+    }
   }
+
   if (!use_global_beta_pow) {
     dev_ctx.template Alloc<T>(beta1_pow_out);
     dev_ctx.template Alloc<T>(beta2_pow_out);
+    phi::DenseTensor beta1_pow_next;
+    phi::DenseTensor beta2_pow_next;
+    if (skip_update) {
+      beta1_pow_next.Resize(beta1_pow_out->dims());
+      beta2_pow_next.Resize(beta2_pow_out->dims());
+      dev_ctx.template Alloc<T>(&beta1_pow_next);
+      dev_ctx.template Alloc<T>(&beta2_pow_next);
+    } else {
+      beta1_pow_next = *beta1_pow_out;
+      beta2_pow_next = *beta2_pow_out;
+    }
     const auto& runner_m1 =
-        NpuOpRunner("Mul", {*beta1_pow, *beta1_tensor}, {*beta1_pow_out}, {});
+        NpuOpRunner("Mul", {*beta1_pow, beta1_tensor}, {beta1_pow_next}, {});
     runner_m1.Run(stream);
     const auto& runner_m2 =
-        NpuOpRunner("Mul", {*beta2_pow, *beta2_tensor}, {*beta2_pow_out}, {});
+        NpuOpRunner("Mul", {*beta2_pow, beta2_tensor}, {beta2_pow_next}, {});
     runner_m2.Run(stream);
+    if (skip_update) {
+      const auto& runner_s1 =
+          NpuOpRunner("SelectV2",
+                      {*skip_update, *beta1_pow, beta1_pow_next},
+                      {*beta1_pow_out},
+                      {});
+      runner_s1.Run(stream);
+      const auto& runner_s2 =
+          NpuOpRunner("SelectV2",
+                      {*skip_update, *beta2_pow, beta2_pow_next},
+                      {*beta2_pow_out},
+                      {});
+      runner_s2.Run(stream);
+    }
   }
 }
 
+// Returns the skip_update flag when it is known on the host, and sets
+// *device_flag instead when it lives on the device.
+inline bool HostSkipUpdate(
+    const paddle::optional<phi::DenseTensor>& skip_update,
+    const phi::DenseTensor** device_flag) {
+  *device_flag = nullptr;
+  if (!skip_update.is_initialized()) {
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(skip_update->numel(),
+                    1,
+                    phi::errors::InvalidArgument(
+                        "Input(SkipUpdate) size must be 1, but get %d",
+                        skip_update->numel()));
+  if (skip_update->place().GetType() == phi::AllocationType::CPU) {
+    return skip_update->data<bool>()[0];
+  }
+  *device_flag = skip_update.get_ptr();
+  return false;
+}
+
+template <typename T, typename Context>
+void AdamKernel(const Context& dev_ctx,
+                const phi::DenseTensor& param,
+                const phi::DenseTensor& grad,
+                const phi::DenseTensor& learning_rate,
+                const phi::DenseTensor& moment1,
+                const phi::DenseTensor& moment2,
+                const phi::DenseTensor& beta1_pow_in,
+                const phi::DenseTensor& beta2_pow_in,
+                const paddle::optional<phi::DenseTensor>& master_param,
+                const paddle::optional<phi::DenseTensor>& skip_update,
+                const phi::Scalar& beta1_in,
+                const phi::Scalar& beta2_in,
+                const phi::Scalar& epsilon_in,
+                bool lazy_mode,
+                int64_t min_row_size_to_use_multithread,
+                bool multi_precision,
+                bool use_global_beta_pow,
+                phi::DenseTensor* param_out,
+                phi::DenseTensor* moment1_out,
+                phi::DenseTensor* moment2_out,
+                phi::DenseTensor* beta1_pow_out,
+                phi::DenseTensor* beta2_pow_out,
+                phi::DenseTensor* master_param_out) {
+  const phi::DenseTensor* skip_flag = nullptr;
+  bool skip_update_ = HostSkipUpdate(skip_update, &skip_flag);
+
+  // skip_update=true, just copy input to output, and TensorCopy will call
+  // mutable_data
+  if (skip_update_) {
+    VLOG(4) << "Adam skip update";
+    TensorCopy(dev_ctx, param, false, param_out);
+    TensorCopy(dev_ctx, moment1, false, moment1_out);
+    TensorCopy(dev_ctx, moment2, false, moment2_out);
+    TensorCopy(dev_ctx, beta1_pow_in, false, beta1_pow_out);
+    TensorCopy(dev_ctx, beta2_pow_in, false, beta2_pow_out);
+    return;
+  }
+
+  VLOG(4) << "use_global_beta_pow:" << use_global_beta_pow;
+
+  phi::DenseTensor beta1_tensor;
+  phi::DenseTensor beta2_tensor;
+  phi::DenseTensor epsilon_tensor;
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{beta1_in.to<T>()}, &beta1_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{beta2_in.to<T>()}, &beta2_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{epsilon_in.to<T>()}, &epsilon_tensor);
+
+  AdamUpdate<T, Context>(dev_ctx,
+                         param,
+                         param,
+                         grad,
+                         learning_rate,
+                         moment1,
+                         moment2,
+                         beta1_pow_in,
+                         beta2_pow_in,
+                         beta1_tensor,
+                         beta2_tensor,
+                         epsilon_tensor,
+                         skip_flag,
+                         use_global_beta_pow,
+                         param_out,
+                         moment1_out,
+                         moment2_out,
+                         beta1_pow_out,
+                         beta2_pow_out);
+}
+
 template <typename T, typename Context>
 void AdamwKernel(const Context& dev_ctx,
                  const phi::DenseTensor& param,
@@ -197,18 +282,8 @@ void AdamwKernel(const Context& dev_ctx,
                  phi::DenseTensor* beta1_pow_out,
                  phi::DenseTensor* beta2_pow_out,
                  phi::DenseTensor* master_param_outs) {
-  bool skip_update_ = false;
-  if (skip_update.is_initialized()) {
-    PADDLE_ENFORCE_EQ(skip_update->numel(),
-                      1,
-                      phi::errors::InvalidArgument(
-                          "Input(SkipUpdate) size must be 1, but get %d",
-                          skip_update->numel()));
-    std::vector<bool> skip_update_vec;
-    custom_kernel::TensorToVector(
-        dev_ctx, *skip_update, dev_ctx, &skip_update_vec);
-    skip_update_ = skip_update_vec[0];
-  }
+  const phi::DenseTensor* skip_flag = nullptr;
+  bool skip_update_ = HostSkipUpdate(skip_update, &skip_flag);
 
   VLOG(3) << "Skip update" << skip_update_;
 
@@ -217,15 +292,13 @@ void AdamwKernel(const Context& dev_ctx,
     phi::DenseTensor decay;
     phi::DenseTensor tmp;
     phi::DenseTensorMeta meta = {phi::DataType::FLOAT32, {1}};
-    one.set_meta(meta);
     decay.set_meta(meta);
     tmp.set_meta(meta);
 
     dev_ctx.template Alloc<float>(&tmp);
-    dev_ctx.template Alloc<float>(&one);
     dev_ctx.template Alloc<float>(&decay);
 
-    FillNpuTensorWithConstant<float>(&one, dev_ctx, 1.0f);
+    ConstantTensorFromVector(dev_ctx, std::vector<float>{1.0f}, &one);
     NPUAttributeMap attr_input = {{"value", coeff}};
 
     auto stream = dev_ctx.stream();
@@ -237,6 +310,14 @@ void AdamwKernel(const Context& dev_ctx,
     const auto& runner2 = NpuOpRunner("Sub", {one, tmp}, {decay}, {});
     runner2.Run(stream);
 
+    // With a device skip_update the decay becomes 1 on skip, so the
+    // in-place decay below leaves param unchanged.
+    if (skip_flag) {
+      const auto& runner3 =
+          NpuOpRunner("SelectV2", {*skip_flag, one, decay}, {decay}, {});
+      runner3.Run(stream);
+    }
+
     // Master Parma is not supported on npu
     if (master_param.is_initialized()) {
       PADDLE_THROW(
@@ -275,6 +356,87 @@ void AdamwKernel(const Context& dev_ctx,
                                         master_param_outs);
 }
 
+template <typename T, typename Context>
+void MergedAdamKernel(
+    const Context& dev_ctx,
+    const std::vector<const phi::DenseTensor*>& param,
+    const std::vector<const phi::DenseTensor*>& grad,
+    const std::vector<const phi::DenseTensor*>& learning_rate,
+    const std::vector<const phi::DenseTensor*>& moment1,
+    const std::vector<const phi::DenseTensor*>& moment2,
+    const std::vector<const phi::DenseTensor*>& beta1_pow,
+    const std::vector<const phi::DenseTensor*>& beta2_pow,
+    const paddle::optional<std::vector<const phi::DenseTensor*>>& master_param,
+    const phi::Scalar& beta1,
+    const phi::Scalar& beta2,
+    const phi::Scalar& epsilon,
+    bool multi_precision,
+    bool use_global_beta_pow,
+    std::vector<phi::DenseTensor*> param_out,
+    std::vector<phi::DenseTensor*> moment1_out,
+    std::vector<phi::DenseTensor*> moment2_out,
+    std::vector<phi::DenseTensor*> beta1_pow_out,
+    std::vector<phi::DenseTensor*> beta2_pow_out,
+    std::vector<phi::DenseTensor*> master_param_out) {
+  size_t param_num = param.size();
+  for (auto size : {grad.size(),
+                    learning_rate.size(),
+                    moment1.size(),
+                    moment2.size(),
+                    beta1_pow.size(),
+                    beta2_pow.size()}) {
+    PADDLE_ENFORCE_EQ(
+        size,
+        param_num,
+        phi::errors::InvalidArgument(
+            "The size of every input of merged_adam must be equal to the "
+            "size of Input(param) %d, but got %d.",
+            param_num,
+            size));
+  }
+  // Master Parma is not supported on npu
+  if (multi_precision) {
+    PADDLE_THROW(
+        phi::errors::Unimplemented("Master Parma is not supported on npu"));
+  }
+  VLOG(4) << "use_global_beta_pow:" << use_global_beta_pow;
+
+  // The scalars are shared by all parameters and come from the constant
+  // cache, so the whole update is enqueued without a host round trip.
+  phi::DenseTensor beta1_tensor;
+  phi::DenseTensor beta2_tensor;
+  phi::DenseTensor epsilon_tensor;
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{beta1.to<T>()}, &beta1_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{beta2.to<T>()}, &beta2_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, std::vector<T>{epsilon.to<T>()}, &epsilon_tensor);
+
+  for (size_t idx = 0; idx < param_num; idx++) {
+    VLOG(4) << "[MergedAdam] loop: " << idx;
+    AdamUpdate<T, Context>(dev_ctx,
+                           *param[idx],
+                           *param[idx],
+                           *grad[idx],
+                           *learning_rate[idx],
+                           *moment1[idx],
+                           *moment2[idx],
+                           *beta1_pow[idx],
+                           *beta2_pow[idx],
+                           beta1_tensor,
+                           beta2_tensor,
+                           epsilon_tensor,
+                           nullptr,
+                           use_global_beta_pow,
+                           param_out[idx],
+                           moment1_out[idx],
+                           moment2_out[idx],
+                           beta1_pow_out[idx],
+                           beta2_pow_out[idx]);
+  }
+}
+
 }  // namespace custom_kernel
 
 PD_REGISTER_PLUGIN_KERNEL(adam,
@@ -302,3 +464,15 @@ PD_REGISTER_PLUGIN_KERNEL(adamw,
   kernel->InputAt(6).SetBackend(phi::Backend::ALL_BACKEND);
   kernel->InputAt(8).SetBackend(phi::Backend::ALL_BACKEND);
 }
+
+PD_REGISTER_PLUGIN_KERNEL(merged_adam,
+                          npu,
+                          ALL_LAYOUT,
+                          custom_kernel::MergedAdamKernel,
+                          phi::dtype::float16,
+                          float,
+                          double) {
+  // Skip beta1_pow, beta2_pow data transform
+  kernel->InputAt(5).SetBackend(phi::Backend::ALL_BACKEND);
+  kernel->InputAt(6).SetBackend(phi::Backend::ALL_BACKEND);
+}
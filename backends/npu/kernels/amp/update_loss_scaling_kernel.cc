@@ -39,6 +39,7 @@ void Update(const Context& ctx,
                      0,
                      good_out_tensor->numel() * sizeof(int),
                      stream);
+    InvalidateCachedValues(*good_out_tensor);
 
     // bad_out_data = bad_in_data + 1
     phi::DenseTensor factor_tensor;
@@ -94,6 +95,7 @@ void Update(const Context& ctx,
                        0,
                        bad_out_tensor->numel() * sizeof(int),
                        stream);
+      InvalidateCachedValues(*bad_out_tensor);
     }
   } else {
     // bad_out_data = 0
@@ -103,6 +105,7 @@ void Update(const Context& ctx,
                      0,
                      bad_out_tensor->numel() * sizeof(int),
                      stream);
+    InvalidateCachedValues(*bad_out_tensor);
 
     // good_out_data = good_in_data + 1
     phi::DenseTensor factor_tensor;
@@ -145,6 +148,7 @@ void Update(const Context& ctx,
                        0,
                        good_out_tensor->numel() * sizeof(int),
                        stream);
+      InvalidateCachedValues(*good_out_tensor);
     }
   }
 }
@@ -219,6 +223,7 @@ class LazyZerosNPU {
         auto size = out->numel() * paddle::experimental::SizeOf(out->dtype());
         aclrtMemcpyAsync(
             dst_ptr, size, zero_ptr, size, ACL_MEMCPY_DEVICE_TO_DEVICE, stream);
+        InvalidateCachedValues(*out);
       }
     }
   }
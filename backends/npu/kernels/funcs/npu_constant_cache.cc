@@ -0,0 +1,109 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/funcs/npu_constant_cache.h"
+
+#include <cstring>
+
+#include "kernels/funcs/npu_enforce.h"
+#include "runtime/runtime.h"
+
+// Upper bound of the bytes held by the constant cache and of a single
+// cached constant, larger constants are rebuilt on every use.
+ENV_uint64(npu_constant_cache_max_bytes, 16UL << 20);
+ENV_uint64(npu_constant_cache_max_entry_bytes, 64UL << 10);
+
+namespace custom_kernel {
+
+NpuConstantCache &NpuConstantCache::Instance() {
+  // Leaked on purpose, device memory must not be freed from a static
+  // destructor that may run after the runtime has been finalized.
+  static auto *cache = new NpuConstantCache();
+  return *cache;
+}
+
+phi::DenseTensor NpuConstantCache::Get(const phi::CustomContext &dev_ctx,
+                                       const void *data,
+                                       int64_t numel,
+                                       phi::DataType dtype,
+                                       bool on_host) {
+  size_t bytes = numel * phi::SizeOf(dtype);
+  if (bytes == 0 || bytes > FLAGS_npu_constant_cache_max_entry_bytes) {
+    return Build(dev_ctx, data, numel, dtype, on_host);
+  }
+
+  int device_id = on_host ? -1 : dev_ctx.GetPlace().GetDeviceId();
+  std::string key;
+  key.reserve(sizeof(device_id) + sizeof(dtype) + bytes);
+  key.append(reinterpret_cast<const char *>(&device_id), sizeof(device_id));
+  key.append(reinterpret_cast<const char *>(&dtype), sizeof(dtype));
+  key.append(static_cast<const char *>(data), bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, iter->second.lru_pos);
+      return iter->second.tensor;
+    }
+  }
+
+  // Built without holding the lock, a concurrent miss on the same key only
+  // costs an extra upload.
+  auto tensor = Build(dev_ctx, data, numel, dtype, on_host);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    return iter->second.tensor;
+  }
+  lru_.push_front(key);
+  entries_.emplace(std::move(key), Entry{tensor, bytes, lru_.begin()});
+  cached_bytes_ += bytes;
+  while (cached_bytes_ > FLAGS_npu_constant_cache_max_bytes) {
+    auto victim = entries_.find(lru_.back());
+    cached_bytes_ -= victim->second.bytes;
+    entries_.erase(victim);
+    lru_.pop_back();
+  }
+  return tensor;
+}
+
+phi::DenseTensor NpuConstantCache::Build(const phi::CustomContext &dev_ctx,
+                                         const void *data,
+                                         int64_t numel,
+                                         phi::DataType dtype,
+                                         bool on_host) {
+  phi::DenseTensor tensor;
+  tensor.Resize({numel});
+  size_t bytes = numel * phi::SizeOf(dtype);
+  if (on_host) {
+    void *ptr = dev_ctx.HostAlloc(&tensor, dtype);
+    if (bytes > 0) {
+      std::memcpy(ptr, data, bytes);
+    }
+    return tensor;
+  }
+  void *ptr = dev_ctx.Alloc(&tensor, dtype);
+  if (bytes > 0) {
+    AsyncMemCpyH2D(
+        nullptr, static_cast<C_Stream>(dev_ctx.stream()), ptr, data, bytes);
+    // A cached constant may be read from any stream of the device, so the
+    // upload has to be complete before the tensor is handed out.
+    dev_ctx.Wait();
+  }
+  return tensor;
+}
+
+}  // namespace custom_kernel
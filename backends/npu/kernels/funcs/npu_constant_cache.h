@@ -0,0 +1,65 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "paddle/phi/extension.h"
+
+namespace custom_kernel {
+
+// Small read-only tensors built from host values (axes, shapes, perms, ...)
+// are looked up here by content instead of being allocated and uploaded for
+// every op. Entries live either in host memory, for inputs passed with
+// aclSetTensorConst, or on a device, and are evicted in LRU order once the
+// cached bytes exceed FLAGS_npu_constant_cache_max_bytes.
+//
+// Tensors returned by Get share their memory with the cache and with every
+// other user of the same constant, so they must never be written to.
+class NpuConstantCache {
+ public:
+  static NpuConstantCache &Instance();
+
+  phi::DenseTensor Get(const phi::CustomContext &dev_ctx,
+                       const void *data,
+                       int64_t numel,
+                       phi::DataType dtype,
+                       bool on_host);
+
+ private:
+  struct Entry {
+    phi::DenseTensor tensor;
+    size_t bytes;
+    std::list<std::string>::iterator lru_pos;
+  };
+
+  NpuConstantCache() = default;
+
+  phi::DenseTensor Build(const phi::CustomContext &dev_ctx,
+                         const void *data,
+                         int64_t numel,
+                         phi::DataType dtype,
+                         bool on_host);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<std::string> lru_;
+  size_t cached_bytes_ = 0;
+};
+
+}  // namespace custom_kernel
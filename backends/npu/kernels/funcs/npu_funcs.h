@@ -16,7 +16,9 @@ limitations under the License. */
 
 #include <memory>
 
+#include "kernels/funcs/npu_constant_cache.h"
 #include "kernels/funcs/npu_enforce.h"
+#include "kernels/funcs/npu_host_mirror.h"
 #include "kernels/funcs/npu_op_runner.h"
 #include "runtime/runtime.h"
 
@@ -90,20 +92,26 @@ inline void TensorCopy(const Context& dev_ctx,
   if (src_place.GetType() == phi::AllocationType::CPU &&
       dst_place_.GetType() == phi::AllocationType::CUSTOM) {
     AsyncMemCpyH2D(nullptr, stream, dst_ptr, src_ptr, size);
+    NpuHostMirror::Instance().Record(*dst, src_ptr);
     if (blocking) {
       dev_ctx.Wait();
     }
   } else if (src_place.GetType() == phi::AllocationType::CUSTOM &&
              dst_place_.GetType() == phi::AllocationType::CPU) {
+    if (NpuHostMirror::Instance().Lookup(src, dst_ptr)) {
+      return;
+    }
     AsyncMemCpyD2H(nullptr, stream, dst_ptr, src_ptr, size);
     if (blocking) {
       dev_ctx.Wait();
+      NpuHostMirror::Instance().Record(src, dst_ptr);
     }
   } else if (src_place.GetType() == phi::AllocationType::CUSTOM &&
              dst_place_.GetType() == phi::AllocationType::CUSTOM) {
     if (src_place.GetDeviceType() == dst_place_.GetDeviceType()) {
       if (src_place.GetDeviceId() == dst_place_.GetDeviceId()) {
         AsyncMemCpyD2D(nullptr, stream, dst_ptr, src_ptr, size);
+        NpuHostMirror::Instance().Propagate(src, *dst);
         if (blocking) {
           dev_ctx.Wait();
         }
@@ -142,6 +150,7 @@ inline void TensorFromVector(const phi::CustomContext& ctx,
                    dst_ptr,
                    src_ptr,
                    size);
+    NpuHostMirror::Instance().Record(*dst, src_ptr);
     dev_ctx.Wait();
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
@@ -175,6 +184,7 @@ inline void TensorFromVector<bool>(const phi::CustomContext& ctx,
                    dst_ptr,
                    src_ptr,
                    size);
+    NpuHostMirror::Instance().Record(*dst, src_ptr);
     dev_ctx.Wait();
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
@@ -206,6 +216,7 @@ inline void TensorFromVector(const phi::CustomContext& ctx,
   } else if (dst_place.GetType() == phi::AllocationType::CUSTOM) {
     AsyncMemCpyH2D(
         nullptr, static_cast<C_Stream>(ctx.stream()), dst_ptr, src_ptr, size);
+    NpuHostMirror::Instance().Record(*dst, src_ptr);
     ctx.Wait();
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
@@ -223,6 +234,34 @@ inline void TensorFromVector<bool>(const phi::CustomContext& ctx,
       "TensorFromVector on %s is not supported.", dst_place));
 }
 
+/**
+ * CPU -> NPU, or CPU -> CPU when on_host is set, for small read-only tensors
+ * such as axes, shapes and perms. The result comes from NpuConstantCache and
+ * is shared with other ops, it must not be used as an output.
+ */
+template <typename T>
+inline void ConstantTensorFromVector(const phi::CustomContext& dev_ctx,
+                                     const std::vector<T>& src,
+                                     phi::DenseTensor* dst,
+                                     bool on_host = false) {
+  *dst = NpuConstantCache::Instance().Get(
+      dev_ctx,
+      src.data(),
+      src.size(),
+      paddle::experimental::CppTypeToDataType<T>::Type(),
+      on_host);
+}
+
+template <>
+inline void ConstantTensorFromVector<bool>(const phi::CustomContext& dev_ctx,
+                                           const std::vector<bool>& src,
+                                           phi::DenseTensor* dst,
+                                           bool on_host) {
+  std::vector<uint8_t> array(src.begin(), src.end());
+  *dst = NpuConstantCache::Instance().Get(
+      dev_ctx, array.data(), array.size(), phi::DataType::BOOL, on_host);
+}
+
 template <typename T>
 void TensorFromArray(const phi::CustomContext& ctx,
                      const T* src,
@@ -241,7 +280,7 @@ void TensorFromArray(const phi::CustomContext& ctx,
                    dst_ptr,
                    src_ptr,
                    size);
-
+    NpuHostMirror::Instance().Record(*dst, src_ptr);
     dev_ctx.Wait();
   } else {  // NOLINT
     PADDLE_THROW(phi::errors::Unimplemented(
@@ -266,9 +305,13 @@ inline void TensorToVector(const phi::CustomContext& ctx,
   auto src_place = src.place();
 
   if (src_place.GetType() == phi::AllocationType::CUSTOM) {
+    if (NpuHostMirror::Instance().Lookup(src, dst_ptr)) {
+      return;
+    }
     AsyncMemCpyD2H(
         nullptr, static_cast<C_Stream>(ctx.stream()), dst_ptr, src_ptr, size);
     ctx.Wait();
+    NpuHostMirror::Instance().Record(src, dst_ptr);
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
         "TensorToVector on %s is not supported.", src_place));
@@ -292,8 +335,11 @@ inline void TensorToVector<bool>(const phi::CustomContext& ctx,
 
   auto src_place = src.place();
   if (src_place.GetType() == phi::AllocationType::CUSTOM) {
-    AsyncMemCpyD2H(nullptr, stream, dst_ptr, src_ptr, size);
-    ctx.Wait();
+    if (!NpuHostMirror::Instance().Lookup(src, dst_ptr)) {
+      AsyncMemCpyD2H(nullptr, stream, dst_ptr, src_ptr, size);
+      ctx.Wait();
+      NpuHostMirror::Instance().Record(src, dst_ptr);
+    }
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
         "TensorToVector on %s is not supported.", src_place));
@@ -502,18 +548,14 @@ template <typename T>
 inline std::vector<T> get_new_data_from_tensor(
     const phi::CustomContext& dev_ctx,
     const phi::DenseTensor* new_data_tensor) {
-  std::vector<T> vec_new_data;
   auto place = new_data_tensor->place();
-  phi::DenseTensor cpu_starts_tensor;
-  cpu_starts_tensor.Resize(new_data_tensor->dims());
-  T* new_data = dev_ctx.template HostAlloc<T>(&cpu_starts_tensor);
   if (place.GetType() == phi::AllocationType::CUSTOM) {
-    TensorCopy(
-        dev_ctx, *new_data_tensor, true, &cpu_starts_tensor, phi::CPUPlace());
-    new_data = cpu_starts_tensor.data<T>();
+    std::vector<T> vec_new_data;
+    TensorToVector(dev_ctx, *new_data_tensor, dev_ctx, &vec_new_data);
+    return vec_new_data;
   }
-  vec_new_data = std::vector<T>(new_data, new_data + cpu_starts_tensor.numel());
-  return vec_new_data;
+  const T* new_data = new_data_tensor->data<T>();
+  return std::vector<T>(new_data, new_data + new_data_tensor->numel());
 }
 
 }  // namespace custom_kernel
@@ -0,0 +1,115 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// A thread-safe, reference-counted cache of ACL handles (tensor descriptors,
+// op attributes, ...) keyed by the configuration they were created with.
+//
+// Acquire returns the cached handle for a key, creating it on a miss, and
+// every Acquire has to be paired with a Release. Handles that are no longer
+// referenced stay cached on an LRU list; at most `capacity` of them are kept
+// and the least recently released ones are destroyed first. Handles in use
+// are never destroyed, so callers must not modify a handle they got here.
+template <typename Handle, typename Key, typename Hash = std::hash<Key>>
+class NpuHandleCache {
+ public:
+  using Destroyer = void (*)(const Handle *);
+
+  NpuHandleCache(Destroyer destroy, size_t capacity)
+      : destroy_(destroy), capacity_(capacity) {}
+
+  NpuHandleCache(const NpuHandleCache &) = delete;
+  NpuHandleCache &operator=(const NpuHandleCache &) = delete;
+
+  ~NpuHandleCache() {
+    for (auto &pair : entries_) {
+      destroy_(pair.first);
+    }
+  }
+
+  template <typename Create>
+  Handle *Acquire(const Key &key, Create &&create) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      auto &entry = entries_.at(iter->second);
+      if (entry.refs++ == 0) {
+        idle_.erase(entry.idle_pos);
+      }
+      return iter->second;
+    }
+    Handle *handle = create();
+    index_.emplace(key, handle);
+    entries_.emplace(handle, Entry{key, 1, idle_.end()});
+    return handle;
+  }
+
+  // Returns false if handle was not acquired from this cache.
+  bool Release(const Handle *handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(const_cast<Handle *>(handle));
+    if (iter == entries_.end()) {
+      return false;
+    }
+    auto &entry = iter->second;
+    if (--entry.refs == 0) {
+      idle_.push_front(iter->first);
+      entry.idle_pos = idle_.begin();
+      while (idle_.size() > capacity_) {
+        Evict(idle_.back());
+      }
+    }
+    return true;
+  }
+
+  // Copies the key handle was created with, returns false if handle was not
+  // acquired from this cache.
+  bool GetKey(const Handle *handle, Key *key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(const_cast<Handle *>(handle));
+    if (iter == entries_.end()) {
+      return false;
+    }
+    *key = iter->second.key;
+    return true;
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    size_t refs;
+    typename std::list<Handle *>::iterator idle_pos;
+  };
+
+  void Evict(Handle *handle) {
+    auto iter = entries_.find(handle);
+    index_.erase(iter->second.key);
+    idle_.erase(iter->second.idle_pos);
+    entries_.erase(iter);
+    destroy_(handle);
+  }
+
+  Destroyer destroy_;
+  size_t capacity_;
+  std::mutex mutex_;
+  std::unordered_map<Key, Handle *, Hash> index_;
+  std::unordered_map<Handle *, Entry> entries_;
+  std::list<Handle *> idle_;
+};
@@ -0,0 +1,159 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kernels/funcs/npu_host_mirror.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kernels/funcs/npu_enforce.h"
+#include "runtime/runtime.h"
+
+// Largest tensor, in bytes, that is mirrored on the host, 0 disables the
+// mirror. The number of mirrored tensors is bounded by
+// FLAGS_npu_host_mirror_capacity.
+ENV_uint64(npu_host_mirror_max_bytes, 256);
+ENV_uint64(npu_host_mirror_capacity, 4096);
+
+namespace custom_kernel {
+
+namespace {
+
+uint32_t InplaceVersionOf(const phi::DenseTensor &tensor) {
+  return const_cast<phi::DenseTensor &>(tensor)
+      .InplaceVersionCounter()
+      .CurrentVersion();
+}
+
+size_t BytesOf(const phi::DenseTensor &tensor) {
+  return tensor.numel() * phi::SizeOf(tensor.dtype());
+}
+
+bool Mirrorable(const phi::DenseTensor &tensor) {
+  size_t bytes = BytesOf(tensor);
+  return bytes > 0 && bytes <= FLAGS_npu_host_mirror_max_bytes &&
+         tensor.place().GetType() == phi::AllocationType::CUSTOM &&
+         tensor.Holder() != nullptr;
+}
+
+}  // namespace
+
+NpuHostMirror &NpuHostMirror::Instance() {
+  // Leaked on purpose, like the other caches of device tensors.
+  static auto *mirror = new NpuHostMirror();
+  return *mirror;
+}
+
+bool NpuHostMirror::Valid(const Entry &entry,
+                          const phi::DenseTensor &tensor) const {
+  auto holder = entry.holder.lock();
+  return holder && holder == tensor.Holder() &&
+         entry.version == InplaceVersionOf(tensor) &&
+         entry.dtype == tensor.dtype() && entry.numel == tensor.numel();
+}
+
+void NpuHostMirror::Record(const phi::DenseTensor &tensor,
+                           const void *host_data) {
+  if (!Mirrorable(tensor)) {
+    Invalidate(tensor);
+    return;
+  }
+  auto *begin = static_cast<const char *>(tensor.data());
+  size_t size = BytesOf(tensor);
+  auto *src = static_cast<const uint8_t *>(host_data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  InvalidateLocked(begin, size);
+  if (entries_.size() >= FLAGS_npu_host_mirror_capacity) {
+    for (auto iter = entries_.begin(); iter != entries_.end();) {
+      if (iter->second.holder.expired()) {
+        iter = entries_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    if (entries_.size() >= FLAGS_npu_host_mirror_capacity) {
+      entries_.clear();
+    }
+  }
+  entries_.emplace(begin,
+                   Entry{tensor.Holder(),
+                         InplaceVersionOf(tensor),
+                         tensor.dtype(),
+                         tensor.numel(),
+                         std::vector<uint8_t>(src, src + size)});
+  size_ = entries_.size();
+}
+
+bool NpuHostMirror::Lookup(const phi::DenseTensor &tensor, void *host_data) {
+  if (size_ == 0 || !Mirrorable(tensor)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(static_cast<const char *>(tensor.data()));
+  if (iter == entries_.end()) {
+    return false;
+  }
+  if (!Valid(iter->second, tensor)) {
+    entries_.erase(iter);
+    size_ = entries_.size();
+    return false;
+  }
+  std::memcpy(host_data, iter->second.bytes.data(), BytesOf(tensor));
+  return true;
+}
+
+void NpuHostMirror::Propagate(const phi::DenseTensor &src,
+                              const phi::DenseTensor &dst) {
+  std::vector<uint8_t> bytes(Mirrorable(src) ? BytesOf(src) : 0);
+  if (!bytes.empty() && Lookup(src, bytes.data())) {
+    Record(dst, bytes.data());
+  } else {
+    Invalidate(dst);
+  }
+}
+
+void NpuHostMirror::Invalidate(const phi::DenseTensor &tensor) {
+  if (size_ == 0 || !tensor.initialized()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  InvalidateLocked(static_cast<const char *>(tensor.data()),
+                   BytesOf(tensor));
+}
+
+void NpuHostMirror::InvalidateRange(const void *ptr, size_t size) {
+  if (size_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  InvalidateLocked(static_cast<const char *>(ptr), size);
+}
+
+void NpuHostMirror::InvalidateLocked(const char *begin, size_t size) {
+  // Mirrored tensors are at most FLAGS_npu_host_mirror_max_bytes long, so
+  // only those starting that far before begin can reach into the range.
+  auto iter = entries_.lower_bound(begin - FLAGS_npu_host_mirror_max_bytes);
+  const char *end = begin + std::max<size_t>(size, 1);
+  while (iter != entries_.end() && iter->first < end) {
+    if (iter->first + iter->second.bytes.size() > begin) {
+      iter = entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  size_ = entries_.size();
+}
+
+}  // namespace custom_kernel
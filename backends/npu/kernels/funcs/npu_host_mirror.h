@@ -0,0 +1,83 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/phi/extension.h"
+
+namespace custom_kernel {
+
+// Host copies of small device tensors (shapes, sizes, indices, ...) whose
+// values are known on the host, either because they were uploaded from it
+// or because they have been read back once. Kernels that need such values
+// on the host read them from here instead of copying them back and waiting
+// for the stream.
+//
+// A mirror is valid while the allocation it was recorded for is alive and
+// the tensor has not been written since: NpuOpRunner outputs, TensorCopy
+// destinations and the copies and collectives of the runtime (through its
+// device write hook) invalidate every mirror they overlap, and an in-place
+// version bump or a new holder makes the mirror stale. Kernels writing
+// device memory with raw ACL calls must call InvalidateCachedValues.
+class NpuHostMirror {
+ public:
+  static NpuHostMirror &Instance();
+
+  // Records that tensor holds the bytes at host_data, or drops its mirror
+  // when tensor is too large to be mirrored.
+  void Record(const phi::DenseTensor &tensor, const void *host_data);
+
+  // Copies the mirrored values of tensor to host_data, returns false and
+  // leaves host_data untouched if there is no valid mirror.
+  bool Lookup(const phi::DenseTensor &tensor, void *host_data);
+
+  // Gives dst the mirror of src, for device to device copies.
+  void Propagate(const phi::DenseTensor &src, const phi::DenseTensor &dst);
+
+  // Drops every mirror overlapping tensor, which is about to be written.
+  void Invalidate(const phi::DenseTensor &tensor);
+
+  // Drops every mirror overlapping size bytes at ptr, which are about to be
+  // written.
+  void InvalidateRange(const void *ptr, size_t size);
+
+ private:
+  struct Entry {
+    std::weak_ptr<phi::Allocation> holder;
+    uint32_t version;
+    phi::DataType dtype;
+    int64_t numel;
+    std::vector<uint8_t> bytes;
+  };
+
+  NpuHostMirror() = default;
+
+  bool Valid(const Entry &entry, const phi::DenseTensor &tensor) const;
+  void InvalidateLocked(const char *begin, size_t size);
+
+  std::mutex mutex_;
+  // Keyed by the device address of the mirrored tensor.
+  std::map<const char *, Entry> entries_;
+  // Lets Invalidate, which runs for every op output, skip the lock while
+  // nothing is mirrored.
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace custom_kernel
@@ -14,18 +14,33 @@
 
 #include "kernels/funcs/npu_op_runner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
 #include <map>
+#include <mutex>
+#include <sstream>
 
 #include "acl/acl_op_compiler.h"
 #include "kernels/funcs/npu_enforce.h"
 #include "kernels/funcs/npu_funcs.h"
+#include "kernels/funcs/npu_handle_cache.h"
+#include "kernels/funcs/npu_host_mirror.h"
 #include "pybind11/pybind11.h"
 #include "runtime/runtime.h"
 
-static aclDataBuffer *float_status_buffer_;
-static aclTensorDesc *float_status_desc_;
-
 ENV_uint64(ascend_check_nan_inf, 0);
+// With FLAGS_ascend_check_nan_inf, the float status is checked once every
+// this many ops on a stream instead of after every op. The check does not
+// block the host and a hit is narrowed down to one op by replaying the ops
+// of the window.
+ENV_uint64(ascend_check_nan_inf_window, 1);
+// Number of unused tensor descriptors / op attributes kept for reuse.
+ENV_uint64(npu_tensor_desc_cache_capacity, 4096);
+ENV_uint64(npu_op_attr_cache_capacity, 1024);
+// Bytes of casted tensors TypeAdapter may keep for reuse, 0 disables it.
+ENV_uint64(npu_cast_cache_max_bytes, 64UL << 20);
 
 static std::map<paddle::experimental::DataType, aclDataType>  //
     DTYPE_2_ACL_DTYPE = {
@@ -68,62 +83,151 @@ aclFormat ConvertToNpuFormat(phi::DataLayout layout) {
   return iter->second;
 }
 
-NpuOpRunner::NpuOpRunner() {}
+namespace {
 
-NpuOpRunner::NpuOpRunner(const std::string &op_type) : op_type_(op_type) {}
+struct TensorDescKey {
+  aclDataType dtype;
+  aclFormat format;
+  int rank;
+  std::vector<int64_t> dims;
+  std::string name;
 
-NpuOpRunner::NpuOpRunner(const std::string &op_type,
-                         const std::vector<phi::DenseTensor> &inputs,
-                         const std::vector<phi::DenseTensor> &outputs,
-                         const NPUAttributeMap &attrs)
-    : op_type_(op_type) {
-  AddInputs(inputs);
-  AddOutputs(outputs);
-  AddAttrs(attrs);
-}
+  bool operator==(const TensorDescKey &other) const {
+    return dtype == other.dtype && format == other.format &&
+           rank == other.rank && dims == other.dims && name == other.name;
+  }
+};
 
-NpuOpRunner::~NpuOpRunner() {
-  VLOG(4) << "Free NpuOpRunner(" << this << ") of " << op_type_;
-  // Is it safe to free the descs/buffers after run called in host ?
-  aclopDestroyAttr(attr_);  // return void
-  for (auto desc : input_descs_) {
-    aclDestroyTensorDesc(desc);
+struct TensorDescKeyHash {
+  size_t operator()(const TensorDescKey &key) const {
+    size_t seed = std::hash<std::string>()(key.name);
+    auto combine = [&seed](size_t v) {
+      seed ^= v + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(key.dtype);
+    combine(key.format);
+    combine(key.rank);
+    for (auto d : key.dims) {
+      combine(std::hash<int64_t>()(d));
+    }
+    return seed;
   }
-  for (auto desc : output_descs_) {
+};
+
+using TensorDescCache =
+    NpuHandleCache<aclTensorDesc, TensorDescKey, TensorDescKeyHash>;
+using OpAttrCache = NpuHandleCache<aclopAttr, std::string>;
+
+// Both caches are leaked on purpose, destroying ACL handles from a static
+// destructor may run after the runtime has been finalized.
+TensorDescCache &GetTensorDescCache() {
+  static auto *cache = new TensorDescCache(
+      aclDestroyTensorDesc, FLAGS_npu_tensor_desc_cache_capacity);
+  return *cache;
+}
+
+OpAttrCache &GetOpAttrCache() {
+  static auto *cache =
+      new OpAttrCache(aclopDestroyAttr, FLAGS_npu_op_attr_cache_capacity);
+  return *cache;
+}
+
+aclTensorDesc *AcquireTensorDesc(const TensorDescKey &key) {
+  return GetTensorDescCache().Acquire(key, [&key]() {
+    auto *desc = aclCreateTensorDesc(
+        key.dtype, key.rank, key.dims.data(), key.format);
+    PADDLE_ENFORCE_NOT_NULL(
+        desc, phi::errors::External("Call aclCreateTensorDesc failed."));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorFormat(desc, key.format));
+    PADDLE_ENFORCE_NPU_SUCCESS(
+        aclSetTensorShape(desc, key.rank, key.dims.data()));
+    if (!key.name.empty()) {
+      aclSetTensorDescName(desc, key.name.c_str());
+    }
+    return desc;
+  });
+}
+
+// Descriptors of constant host inputs carry a data pointer and are owned by
+// the runner, everything else comes from the cache.
+void ReleaseTensorDesc(aclTensorDesc *desc) {
+  if (!GetTensorDescCache().Release(desc)) {
     aclDestroyTensorDesc(desc);
   }
-  for (auto buffer : input_buffers_) {
-    PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(buffer));
-  }
-  for (auto buffer : output_buffers_) {
-    PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(buffer));
+}
+
+template <typename T>
+void AppendKey(std::string *key, const T &value) {
+  key->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void AppendKey(std::string *key, const std::string &value) {
+  AppendKey(key, value.size());
+  key->append(value);
+}
+
+void AppendKey(std::string *key, const std::vector<bool> &value) {
+  AppendKey(key, value.size());
+  for (bool v : value) {
+    AppendKey(key, v);
   }
 }
 
-const std::string &NpuOpRunner::Type() { return op_type_; }
+template <typename T>
+void AppendKey(std::string *key, const std::vector<T> &value) {
+  AppendKey(key, value.size());
+  for (const auto &v : value) {
+    AppendKey(key, v);
+  }
+}
 
-NpuOpRunner &NpuOpRunner::SetType(const std::string &name) {
-  op_type_ = name;
-  return *this;
+template <typename T>
+bool AppendAttrValue(std::string *key, const NPUAttribute &attr) {
+  if (attr.type() != typeid(T)) {
+    return false;
+  }
+  AppendKey(key, std::string(typeid(T).name()));
+  AppendKey(key, BOOST_GET_CONST(T, attr));
+  return true;
 }
 
-NpuOpRunner &NpuOpRunner::AddAttr(const std::string &name,
-                                  const NPUAttribute &attr) {
-  if (!attr_) {
-    attr_ = aclopCreateAttr();
+// Serializes one attribute into the attribute cache key.
+void AppendAttrKey(std::string *key,
+                   const std::string &name,
+                   const NPUAttribute &attr) {
+  AppendKey(key, name);
+  bool supported =
+      AppendAttrValue<bool>(key, attr) || AppendAttrValue<int>(key, attr) ||
+      AppendAttrValue<int64_t>(key, attr) ||
+      AppendAttrValue<float>(key, attr) ||
+      AppendAttrValue<std::vector<bool>>(key, attr) ||
+      AppendAttrValue<std::vector<int>>(key, attr) ||
+      AppendAttrValue<std::vector<int64_t>>(key, attr) ||
+      AppendAttrValue<std::vector<float>>(key, attr) ||
+      AppendAttrValue<std::string>(key, attr) ||
+      AppendAttrValue<std::vector<std::string>>(key, attr) ||
+      AppendAttrValue<std::vector<std::vector<int64_t>>>(key, attr);
+  if (!supported) {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "Can not convert attribubte '%s' to convert to aclopAttr", name));
   }
+}
+
+void SetAclAttr(aclopAttr *acl_attr,
+                const std::string &name,
+                const NPUAttribute &attr) {
   if (attr.type() == typeid(bool)) {
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrBool(attr_, name.c_str(), BOOST_GET_CONST(bool, attr)));
+        aclopSetAttrBool(acl_attr, name.c_str(), BOOST_GET_CONST(bool, attr)));
   } else if (attr.type() == typeid(int)) {
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrInt(attr_, name.c_str(), BOOST_GET_CONST(int, attr)));
+        aclopSetAttrInt(acl_attr, name.c_str(), BOOST_GET_CONST(int, attr)));
   } else if (attr.type() == typeid(int64_t)) {
-    PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrInt(attr_, name.c_str(), BOOST_GET_CONST(int64_t, attr)));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrInt(
+        acl_attr, name.c_str(), BOOST_GET_CONST(int64_t, attr)));
   } else if (attr.type() == typeid(float)) {
-    PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrFloat(attr_, name.c_str(), BOOST_GET_CONST(float, attr)));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrFloat(
+        acl_attr, name.c_str(), BOOST_GET_CONST(float, attr)));
   } else if (attr.type() == typeid(std::vector<bool>)) {
     auto a = BOOST_GET_CONST(std::vector<bool>, attr);
     std::vector<uint8_t> cast_a;
@@ -131,27 +235,27 @@ NpuOpRunner &NpuOpRunner::AddAttr(const std::string &name,
       cast_a.push_back(static_cast<uint8_t>(it));
     }
     PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrListBool(
-        attr_, name.c_str(), cast_a.size(), cast_a.data()));
+        acl_attr, name.c_str(), cast_a.size(), cast_a.data()));
   } else if (attr.type() == typeid(std::vector<int>)) {
     auto a = BOOST_GET_CONST(std::vector<int>, attr);
     std::vector<int64_t> cast_a;
     for (auto it : a) {
       cast_a.push_back(static_cast<int64_t>(it));
     }
-    PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrListInt(attr_, name.c_str(), cast_a.size(), cast_a.data()));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrListInt(
+        acl_attr, name.c_str(), cast_a.size(), cast_a.data()));
   } else if (attr.type() == typeid(std::vector<int64_t>)) {
     auto a = BOOST_GET_CONST(std::vector<int64_t>, attr);
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrListInt(attr_, name.c_str(), a.size(), a.data()));
+        aclopSetAttrListInt(acl_attr, name.c_str(), a.size(), a.data()));
   } else if (attr.type() == typeid(std::vector<float>)) {
     auto a = BOOST_GET_CONST(std::vector<float>, attr);
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrListFloat(attr_, name.c_str(), a.size(), a.data()));
+        aclopSetAttrListFloat(acl_attr, name.c_str(), a.size(), a.data()));
   } else if (attr.type() == typeid(std::string)) {
     auto a = BOOST_GET_CONST(std::string, attr);
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrString(attr_, name.c_str(), a.c_str()));
+        aclopSetAttrString(acl_attr, name.c_str(), a.c_str()));
   } else if (attr.type() == typeid(std::vector<std::string>)) {
     auto a = BOOST_GET_CONST(std::vector<std::string>, attr);
     std::vector<const char *> s;
@@ -159,7 +263,7 @@ NpuOpRunner &NpuOpRunner::AddAttr(const std::string &name,
       s.push_back(it.data());
     }
     PADDLE_ENFORCE_NPU_SUCCESS(
-        aclopSetAttrListString(attr_, name.c_str(), s.size(), s.data()));
+        aclopSetAttrListString(acl_attr, name.c_str(), s.size(), s.data()));
   } else if (attr.type() == typeid(std::vector<std::vector<int64_t>>)) {
     auto a = BOOST_GET_CONST(std::vector<std::vector<int64_t>>, attr);
     std::vector<int64_t *> data;
@@ -169,11 +273,253 @@ NpuOpRunner &NpuOpRunner::AddAttr(const std::string &name,
       num.push_back(v.size());
     }
     PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrListListInt(
-        attr_, name.c_str(), data.size(), num.data(), data.data()));
+        acl_attr, name.c_str(), data.size(), num.data(), data.data()));
   } else {
     PADDLE_THROW(phi::errors::Unimplemented(
         "Can not convert attribubte '%s' to convert to aclopAttr", name));
   }
+}
+
+uint32_t InplaceVersionOf(const phi::DenseTensor &tensor) {
+  return const_cast<phi::DenseTensor &>(tensor)
+      .InplaceVersionCounter()
+      .CurrentVersion();
+}
+
+// Casts of TypeAdapter inputs, keyed by the source buffer and the target
+// dtype. An entry is valid while its source allocation is alive and the
+// source has not been written since the cast. Writes are caught like those
+// of NpuHostMirror: NpuOpRunner outputs and the runtime's device write hook
+// drop the casts of every source they overlap, raw ACL writes in kernels go
+// through InvalidateCachedValues, and an in-place version bump or a new
+// holder makes the entry stale.
+class CastCache {
+ public:
+  static CastCache &Instance() {
+    // Leaked on purpose, see GetTensorDescCache.
+    static auto *cache = new CastCache();
+    return *cache;
+  }
+
+  bool Lookup(const phi::DenseTensor &src,
+              phi::DataType dtype,
+              phi::DenseTensor *casted) {
+    if (FLAGS_npu_cast_cache_max_bytes == 0) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find({static_cast<const char *>(src.data()), dtype});
+    if (iter == entries_.end()) {
+      return false;
+    }
+    auto &entry = iter->second;
+    auto holder = entry.holder.lock();
+    if (!holder || holder != src.Holder() ||
+        entry.version != InplaceVersionOf(src) ||
+        entry.src_dtype != src.dtype() || entry.dims != src.dims()) {
+      Erase(iter);
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+    *casted = entry.casted;
+    return true;
+  }
+
+  // Records that casted holds src cast to casted.dtype().
+  void Insert(const phi::DenseTensor &src, const phi::DenseTensor &casted) {
+    if (FLAGS_npu_cast_cache_max_bytes == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Key key{static_cast<const char *>(src.data()), casted.dtype()};
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+      Erase(iter);
+    }
+    lru_.push_front(key);
+    size_t bytes = casted.numel() * phi::SizeOf(casted.dtype());
+    size_t src_bytes = src.numel() * phi::SizeOf(src.dtype());
+    entries_.emplace(key,
+                     Entry{src.Holder(),
+                           InplaceVersionOf(src),
+                           src.dtype(),
+                           src.dims(),
+                           casted,
+                           bytes,
+                           src_bytes,
+                           lru_.begin()});
+    cached_bytes_ += bytes;
+    max_src_bytes_ = std::max(max_src_bytes_, src_bytes);
+    while (cached_bytes_ > FLAGS_npu_cast_cache_max_bytes) {
+      Erase(entries_.find(lru_.back()));
+    }
+    size_ = entries_.size();
+  }
+
+  // Drops every cast of tensor, which is about to be overwritten.
+  void Invalidate(const phi::DenseTensor &tensor) {
+    if (size_ == 0 || !tensor.initialized()) {
+      return;
+    }
+    InvalidateRange(tensor.data(),
+                    tensor.numel() * phi::SizeOf(tensor.dtype()));
+  }
+
+  // Drops every cast of a source overlapping size bytes at ptr.
+  void InvalidateRange(const void *ptr, size_t size) {
+    if (size_ == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Sources are at most max_src_bytes_ long, so only those starting that
+    // far before begin can reach into the range.
+    auto *begin = static_cast<const char *>(ptr);
+    const char *end = begin + std::max<size_t>(size, 1);
+    auto iter = entries_.lower_bound(
+        {begin - max_src_bytes_, phi::DataType::UNDEFINED});
+    while (iter != entries_.end() && iter->first.first < end) {
+      if (iter->first.first + iter->second.src_bytes > begin) {
+        Erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+ private:
+  using Key = std::pair<const char *, phi::DataType>;
+
+  struct Entry {
+    std::weak_ptr<phi::Allocation> holder;
+    uint32_t version;
+    phi::DataType src_dtype;
+    phi::DDim dims;
+    phi::DenseTensor casted;
+    size_t bytes;
+    size_t src_bytes;
+    std::list<Key>::iterator lru_pos;
+  };
+
+  void Erase(std::map<Key, Entry>::iterator iter) {
+    cached_bytes_ -= iter->second.bytes;
+    lru_.erase(iter->second.lru_pos);
+    entries_.erase(iter);
+    size_ = entries_.size();
+  }
+
+  std::mutex mutex_;
+  std::map<Key, Entry> entries_;
+  std::list<Key> lru_;
+  size_t cached_bytes_ = 0;
+  size_t max_src_bytes_ = 0;
+  // Lets Invalidate, which runs for every op output, skip the lock while
+  // nothing is cached.
+  std::atomic<size_t> size_{0};
+};
+
+// Runtime copies and collectives overwrite device memory without going
+// through NpuOpRunner.
+void OnDeviceWrite(const void *ptr, size_t size) {
+  custom_kernel::NpuHostMirror::Instance().InvalidateRange(ptr, size);
+  CastCache::Instance().InvalidateRange(ptr, size);
+}
+
+// Registered before any kernel runs, so no cache entry predates the hook.
+const bool device_write_hook_set = (SetDeviceWriteHook(&OnDeviceWrite), true);
+
+// Whether every value of from survives a cast to to, so that casting the
+// result back reproduces the original tensor.
+bool IsLosslessCast(phi::DataType from, phi::DataType to) {
+  using DataType = phi::DataType;
+  switch (from) {
+    case DataType::BOOL:
+      return to != DataType::BOOL;
+    case DataType::UINT8:
+      return to == DataType::INT16 || to == DataType::INT32 ||
+             to == DataType::INT64 || to == DataType::FLOAT16 ||
+             to == DataType::FLOAT32 || to == DataType::FLOAT64;
+    case DataType::INT8:
+      return to == DataType::INT16 || to == DataType::INT32 ||
+             to == DataType::INT64 || to == DataType::FLOAT16 ||
+             to == DataType::FLOAT32 || to == DataType::FLOAT64;
+    case DataType::INT16:
+      return to == DataType::INT32 || to == DataType::INT64 ||
+             to == DataType::FLOAT32 || to == DataType::FLOAT64;
+    case DataType::INT32:
+      return to == DataType::INT64 || to == DataType::FLOAT64;
+    case DataType::FLOAT16:
+      return to == DataType::FLOAT32 || to == DataType::FLOAT64;
+    case DataType::FLOAT32:
+      return to == DataType::FLOAT64;
+    default:
+      return false;
+  }
+}
+
+// Whether runners keep their tensors so that a windowed NaN/Inf check can
+// replay them.
+bool RecordForReplay() {
+  return FLAGS_ascend_check_nan_inf && FLAGS_ascend_check_nan_inf_window > 1;
+}
+
+}  // namespace
+
+void InvalidateCachedValues(const phi::DenseTensor &tensor) {
+  custom_kernel::NpuHostMirror::Instance().Invalidate(tensor);
+  CastCache::Instance().Invalidate(tensor);
+}
+
+NpuOpRunner::NpuOpRunner() {}
+
+NpuOpRunner::NpuOpRunner(const std::string &op_type) : op_type_(op_type) {}
+
+NpuOpRunner::NpuOpRunner(const std::string &op_type,
+                         const std::vector<phi::DenseTensor> &inputs,
+                         const std::vector<phi::DenseTensor> &outputs,
+                         const NPUAttributeMap &attrs)
+    : op_type_(op_type) {
+  AddInputs(inputs);
+  AddOutputs(outputs);
+  AddAttrs(attrs);
+}
+
+NpuOpRunner::~NpuOpRunner() {
+  VLOG(4) << "Free NpuOpRunner(" << this << ") of " << op_type_;
+  // Is it safe to free the descs/buffers after run called in host ?
+  if (attr_) {
+    GetOpAttrCache().Release(attr_);
+  }
+  for (auto desc : input_descs_) {
+    ReleaseTensorDesc(desc);
+  }
+  for (auto desc : output_descs_) {
+    ReleaseTensorDesc(desc);
+  }
+  for (auto buffer : input_buffers_) {
+    PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(buffer));
+  }
+  for (auto buffer : output_buffers_) {
+    PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(buffer));
+  }
+}
+
+const std::string &NpuOpRunner::Type() { return op_type_; }
+
+NpuOpRunner &NpuOpRunner::SetType(const std::string &name) {
+  op_type_ = name;
+  return *this;
+}
+
+NpuOpRunner &NpuOpRunner::AddAttr(const std::string &name,
+                                  const NPUAttribute &attr) {
+  AppendAttrKey(&attr_key_, name, attr);
+  attr_setters_.emplace_back([name, attr](aclopAttr *acl_attr) {
+    SetAclAttr(acl_attr, name, attr);
+  });
+  if (attr_) {
+    GetOpAttrCache().Release(attr_);
+    attr_ = nullptr;
+  }
   return *this;
 }
 
@@ -184,13 +530,20 @@ NpuOpRunner &NpuOpRunner::AddAttrDataType(const std::string &name,
       true,
       phi::errors::InvalidArgument(
           "Attr type is NOT equal to framework::proto::VarType::Type."));
-  if (!attr_) {
-    attr_ = aclopCreateAttr();
-  }
   VLOG(4) << "AddAttrDataType call";
   auto dtype = ConvertToNpuDtype(
       static_cast<paddle::experimental::DataType>(paddle::get<int>(attr)));
-  PADDLE_ENFORCE_NPU_SUCCESS(aclopSetAttrDataType(attr_, name.c_str(), dtype));
+  AppendKey(&attr_key_, name);
+  AppendKey(&attr_key_, std::string(typeid(aclDataType).name()));
+  AppendKey(&attr_key_, dtype);
+  attr_setters_.emplace_back([name, dtype](aclopAttr *acl_attr) {
+    PADDLE_ENFORCE_NPU_SUCCESS(
+        aclopSetAttrDataType(acl_attr, name.c_str(), dtype));
+  });
+  if (attr_) {
+    GetOpAttrCache().Release(attr_);
+    attr_ = nullptr;
+  }
   return *this;
 }
 
@@ -206,6 +559,10 @@ NpuOpRunner &NpuOpRunner::AddInput(const phi::DenseTensor &tensor) {
   input_descs_.emplace_back(CreateTensorDesc(tensor));
   // create aclDataBuffer
   input_buffers_.emplace_back(CreateDataBuffer(tensor));
+  if (RecordForReplay()) {
+    input_tensors_.emplace_back(tensor);
+    input_mem_types_.emplace_back(ACL_MEMTYPE_DEVICE);
+  }
   return *this;
 }
 
@@ -220,7 +577,10 @@ NpuOpRunner &NpuOpRunner::AddInput(const phi::DenseTensor &tensor,
     PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorConst(
         desc, const_cast<void *>(tensor.data()), tensor.capacity()));
   }
-
+  if (RecordForReplay()) {
+    input_tensors_.emplace_back(tensor);
+    input_mem_types_.emplace_back(mem_type);
+  }
   return *this;
 }
 
@@ -228,8 +588,8 @@ template <typename T>
 void NpuOpRunner::AddConstantInputHelper(const phi::CustomContext &dev_ctx,
                                          const std::vector<T> &values) {
   phi::DenseTensor host_tensor;
-  custom_kernel::TensorFromVector(
-      dev_ctx, values, phi::CPUContext(), &host_tensor);
+  custom_kernel::ConstantTensorFromVector(
+      dev_ctx, values, &host_tensor, /*on_host=*/true);
   host_tensors_.emplace_back(host_tensor);
   // create aclTensorDesc
   auto desc = CreateTensorDesc(host_tensor, ACL_MEMTYPE_HOST);
@@ -239,6 +599,10 @@ void NpuOpRunner::AddConstantInputHelper(const phi::CustomContext &dev_ctx,
   // set tensor const
   PADDLE_ENFORCE_NPU_SUCCESS(
       aclSetTensorConst(desc, host_tensor.data(), host_tensor.capacity()));
+  if (RecordForReplay()) {
+    input_tensors_.emplace_back(host_tensor);
+    input_mem_types_.emplace_back(ACL_MEMTYPE_HOST);
+  }
 }
 
 NpuOpRunner &NpuOpRunner::AddInput(const phi::CustomContext &dev_ctx,
@@ -272,10 +636,14 @@ NpuOpRunner &NpuOpRunner::AddInput(const phi::CustomContext &dev_ctx,
 }
 
 NpuOpRunner &NpuOpRunner::AddOutput(const phi::DenseTensor &tensor) {
+  InvalidateCachedValues(tensor);
   // create aclTensorDesc
   output_descs_.emplace_back(CreateTensorDesc(tensor));
   // create aclDataBuffer
   output_buffers_.emplace_back(CreateDataBuffer(tensor));
+  if (RecordForReplay()) {
+    output_tensors_.emplace_back(tensor);
+  }
   return *this;
 }
 
@@ -288,6 +656,10 @@ NpuOpRunner &NpuOpRunner::AddInputs(
     input_descs_.emplace_back(CreateTensorDesc(tensor));
     // create aclDataBuffer
     input_buffers_.emplace_back(CreateDataBuffer(tensor));
+    if (RecordForReplay()) {
+      input_tensors_.emplace_back(tensor);
+      input_mem_types_.emplace_back(ACL_MEMTYPE_DEVICE);
+    }
   }
   return *this;
 }
@@ -303,8 +675,21 @@ NpuOpRunner &NpuOpRunner::AddInputNames(const std::vector<std::string> &names) {
                         "of input names is %d, the size of input descs is %d.",
                         names.size(),
                         input_descs_.size()));
+  // Cached descriptors are shared, so a named one is looked up under its
+  // own key instead of renaming the shared descriptor in place.
   for (size_t i = 0; i < names.size(); ++i) {
-    aclSetTensorDescName(input_descs_[i], names[i].c_str());
+    TensorDescKey key;
+    if (GetTensorDescCache().GetKey(input_descs_[i], &key)) {
+      key.name = names[i];
+      auto *named = AcquireTensorDesc(key);
+      ReleaseTensorDesc(input_descs_[i]);
+      input_descs_[i] = named;
+    } else {
+      aclSetTensorDescName(input_descs_[i], names[i].c_str());
+    }
+  }
+  if (RecordForReplay()) {
+    input_names_ = names;
   }
   return *this;
 }
@@ -314,10 +699,14 @@ NpuOpRunner &NpuOpRunner::AddOutputs(
   output_descs_.reserve(tensors.size());
   output_buffers_.reserve(tensors.size());
   for (auto tensor : tensors) {
+    InvalidateCachedValues(tensor);
     // create aclTensorDesc
     output_descs_.emplace_back(CreateTensorDesc(tensor));
     // create aclDataBuffer
     output_buffers_.emplace_back(CreateDataBuffer(tensor));
+    if (RecordForReplay()) {
+      output_tensors_.emplace_back(tensor);
+    }
   }
   return *this;
 }
@@ -377,14 +766,18 @@ aclTensorDesc *NpuOpRunner::CreateTensorDesc(phi::DenseTensor tensor,
           << "rank:" << dims.size() << " dims: " << tensor.dims()
           << " format:" << format;
 
+  if (mem_type != ACL_MEMTYPE_HOST) {
+    return AcquireTensorDesc({dtype, format, size, std::move(dims), ""});
+  }
+
+  // Host inputs get their data attached with aclSetTensorConst, so they can
+  // not be shared.
   auto *desc = aclCreateTensorDesc(dtype, size, dims.data(), format);
   PADDLE_ENFORCE_NOT_NULL(
       desc, phi::errors::External("Call aclCreateTensorDesc failed."));
   PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorFormat(desc, format));
   PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorShape(desc, size, dims.data()));
-  if (mem_type == ACL_MEMTYPE_HOST) {
-    PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorPlaceMent(desc, mem_type));
-  }
+  PADDLE_ENFORCE_NPU_SUCCESS(aclSetTensorPlaceMent(desc, mem_type));
   return desc;
 }
 
@@ -397,115 +790,19 @@ aclDataBuffer *NpuOpRunner::CreateDataBuffer(phi::DenseTensor tensor) {
   return buffer;
 }
 
-void NpuOpRunner::AllocFloatStatus(aclrtStream stream) const {
-  std::string op_type = "NPUAllocFloatStatus";
-  // Attr
-  auto attr = aclopCreateAttr();
-  // Execute
-  aclError ret;
-  if (PyGILState_Check()) {
-    pybind11::gil_scoped_release release;
-    ret = aclopCompileAndExecute(op_type.c_str(),
-                                 0,
-                                 nullptr,
-                                 nullptr,
-                                 1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
-                                 attr,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
-  } else {
-    ret = aclopCompileAndExecute(op_type.c_str(),
-                                 0,
-                                 nullptr,
-                                 nullptr,
-                                 1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
-                                 attr,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
-  }
-  PADDLE_ENFORCE_NPU_SUCCESS(ret);
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
-  aclopDestroyAttr(attr);
-}
-
-void NpuOpRunner::ClearFloatStatus(aclrtStream stream) const {
-  std::string op_type = "NPUClearFloatStatus";
-  // Input
-  const std::vector<int64_t> dims{8};
-  auto tmp_desc =
-      aclCreateTensorDesc(ACL_FLOAT, dims.size(), dims.data(), ACL_FORMAT_NCHW);
-  auto tmp_size = aclGetTensorDescSize(tmp_desc);
-  void *tmp_ptr;
-  aclrtMalloc(&tmp_ptr, tmp_size, ACL_MEM_MALLOC_NORMAL_ONLY);
-  auto tmp_buffer = aclCreateDataBuffer(tmp_ptr, tmp_size);
-  // Attr
-  auto attr = aclopCreateAttr();
-  // Execute
-  aclError ret;
-  if (PyGILState_Check()) {
-    pybind11::gil_scoped_release release;
-    ret = aclopCompileAndExecute(op_type.c_str(),
-                                 1,
-                                 &tmp_desc,
-                                 &tmp_buffer,
-                                 1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
-                                 attr,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
-  } else {
-    ret = aclopCompileAndExecute(op_type.c_str(),
-                                 1,
-                                 &tmp_desc,
-                                 &tmp_buffer,
-                                 1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
-                                 attr,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
+aclopAttr *NpuOpRunner::GetAttr() const {
+  if (!attr_ && !attr_setters_.empty()) {
+    attr_ = GetOpAttrCache().Acquire(op_type_ + '\0' + attr_key_, [this]() {
+      auto *attr = aclopCreateAttr();
+      PADDLE_ENFORCE_NOT_NULL(
+          attr, phi::errors::External("Call aclopCreateAttr failed."));
+      for (auto &setter : attr_setters_) {
+        setter(attr);
+      }
+      return attr;
+    });
   }
-  PADDLE_ENFORCE_NPU_SUCCESS(ret);
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
-  PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(tmp_buffer));
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtFree(tmp_ptr));
-  aclDestroyTensorDesc(tmp_desc);
-  aclopDestroyAttr(attr);
-}
-
-void NpuOpRunner::InitFloatStatus(aclrtStream stream) const {
-  // Init float_status_desc_
-  const std::vector<int64_t> dims{8};
-  float_status_desc_ =
-      aclCreateTensorDesc(ACL_FLOAT, dims.size(), dims.data(), ACL_FORMAT_NCHW);
-  auto float_status_size = aclGetTensorDescSize(float_status_desc_);
-  PADDLE_ENFORCE_NOT_NULL(
-      float_status_desc_,
-      phi::errors::External("Call aclCreateTensorDesc failed."));
-  // Init float_status_buffer
-  void *float_status_ptr_;
-  aclrtMalloc(&float_status_ptr_, float_status_size, ACL_MEM_MALLOC_HUGE_FIRST);
-  float_status_buffer_ =
-      aclCreateDataBuffer(float_status_ptr_, float_status_size);
-  PADDLE_ENFORCE_NOT_NULL(
-      float_status_buffer_,
-      phi::errors::External("Call aclCreateDataBuffer failed."));
-  // Alloc&ClearFloatStatus
-  AllocFloatStatus(stream);
-  ClearFloatStatus(stream);
+  return attr_;
 }
 
 void NpuOpRunner::PrintOpInfo() const {
@@ -554,44 +851,41 @@ void NpuOpRunner::PrintOpInfo() const {
     std::vector<float>().swap(cpu_data);
   }
 }
-void NpuOpRunner::GetFloatStatus(aclrtStream stream,
-                                 std::string cur_op_type) const {
-  std::string op_type = "NPUGetFloatStatus";
-  // Output
-  const std::vector<int64_t> dims{8};
-  auto tmp_desc =
-      aclCreateTensorDesc(ACL_FLOAT, dims.size(), dims.data(), ACL_FORMAT_NCHW);
-  auto tmp_size = aclGetTensorDescSize(tmp_desc);
-  void *tmp_ptr;
-  PADDLE_ENFORCE_NPU_SUCCESS(
-      aclrtMalloc(&tmp_ptr, tmp_size, ACL_MEM_MALLOC_NORMAL_ONLY));
-  auto tmp_buffer = aclCreateDataBuffer(tmp_ptr, tmp_size);
-  // Attr
-  auto attr = aclopCreateAttr();
-  // Execute
+namespace {
+
+// Runs one of the NPU*FloatStatus ops, which have no attributes, at most one
+// input and one output.
+void RunFloatStatusOp(const char *op_type,
+                      aclTensorDesc *input_desc,
+                      aclDataBuffer *input_buffer,
+                      aclTensorDesc *output_desc,
+                      aclDataBuffer *output_buffer,
+                      aclrtStream stream) {
+  static aclopAttr *attr = aclopCreateAttr();
+  int num_inputs = input_desc ? 1 : 0;
   aclError ret;
   if (PyGILState_Check()) {
     pybind11::gil_scoped_release release;
-    ret = aclopCompileAndExecute(op_type.c_str(),
+    ret = aclopCompileAndExecute(op_type,
+                                 num_inputs,
+                                 num_inputs ? &input_desc : nullptr,
+                                 num_inputs ? &input_buffer : nullptr,
                                  1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
-                                 1,
-                                 &tmp_desc,
-                                 &tmp_buffer,
+                                 &output_desc,
+                                 &output_buffer,
                                  attr,
                                  ACL_ENGINE_SYS,
                                  ACL_COMPILE_SYS,
                                  NULL,
                                  stream);
   } else {
-    ret = aclopCompileAndExecute(op_type.c_str(),
-                                 1,
-                                 &float_status_desc_,
-                                 &float_status_buffer_,
+    ret = aclopCompileAndExecute(op_type,
+                                 num_inputs,
+                                 num_inputs ? &input_desc : nullptr,
+                                 num_inputs ? &input_buffer : nullptr,
                                  1,
-                                 &tmp_desc,
-                                 &tmp_buffer,
+                                 &output_desc,
+                                 &output_buffer,
                                  attr,
                                  ACL_ENGINE_SYS,
                                  ACL_COMPILE_SYS,
@@ -599,31 +893,395 @@ void NpuOpRunner::GetFloatStatus(aclrtStream stream,
                                  stream);
   }
   PADDLE_ENFORCE_NPU_SUCCESS(ret);
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
-  std::vector<float> cpu_data(8, 0);
-  auto float_status_size = aclGetTensorDescSize(float_status_desc_);
-  auto float_status_ptr = aclGetDataBufferAddr(float_status_buffer_);
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtMemcpy(cpu_data.data(),
-                                         float_status_size,
-                                         float_status_ptr,
-                                         float_status_size,
-                                         ACL_MEMCPY_DEVICE_TO_HOST));
-  float sum = 0.0;
-  for (int i = 0; i < cpu_data.size(); ++i) {
-    sum += cpu_data[i];
-  }
-  if (sum > 1.0) {
-    PrintOpInfo();
-  }
-  PADDLE_ENFORCE_LT(sum,
-                    1.0,
-                    phi::errors::PreconditionNotMet(
-                        "Operator %s contains Nan/Inf.", cur_op_type));
-  PADDLE_ENFORCE_NPU_SUCCESS(aclDestroyDataBuffer(tmp_buffer));
-  PADDLE_ENFORCE_NPU_SUCCESS(aclrtFree(tmp_ptr));
-  // return void
-  aclDestroyTensorDesc(tmp_desc);
-  aclopDestroyAttr(attr);
+}
+
+}  // namespace
+
+// Checks the float status register of the device for NaN/Inf produced by the
+// ops run on a stream.
+//
+// With FLAGS_ascend_check_nan_inf_window <= 1 the status is read back after
+// every op, which synchronizes the stream. With a larger window the status
+// is fetched once per window into pinned host memory, guarded by an event
+// that is polled before later ops, so the host never waits for the device.
+// Runners keep their tensors alive while their window is pending; on a hit
+// the ops of the window are replayed into scratch outputs and bisected until
+// the first op that raises the status is found. A window still open when its
+// stream is synchronized or destroyed is checked right there.
+class FloatStatusMonitor {
+ public:
+  static FloatStatusMonitor &Instance() {
+    // Leaked on purpose, see GetTensorDescCache.
+    static auto *monitor = [] {
+      auto *monitor = new FloatStatusMonitor();
+      SetStreamSyncHook(&FloatStatusMonitor::OnStreamSync);
+      return monitor;
+    }();
+    return *monitor;
+  }
+
+  void BeforeRun(aclrtStream stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &state = GetState(stream);
+    while (!state.pending.empty()) {
+      aclrtEventStatus status;
+      PADDLE_ENFORCE_NPU_SUCCESS(
+          aclrtQueryEvent(state.pending.front().event, &status));
+      if (status != ACL_EVENT_STATUS_COMPLETE) {
+        break;
+      }
+      CheckFrontWindow(&state, stream);
+    }
+  }
+
+  void AfterRun(const NpuOpRunner &runner, aclrtStream stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &state = GetState(stream);
+    if (!RecordForReplay()) {
+      GetStatus(state, stream);
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
+      bool found = ReadStatus(state);
+      ClearStatus(state, stream);
+      if (found) {
+        runner.PrintOpInfo();
+      }
+      PADDLE_ENFORCE_EQ(found,
+                        false,
+                        phi::errors::PreconditionNotMet(
+                            "Operator %s contains Nan/Inf.", runner.op_type_));
+      return;
+    }
+
+    state.current.ops.push_back({runner.op_type_,
+                                 runner.input_tensors_,
+                                 runner.input_mem_types_,
+                                 runner.input_names_,
+                                 runner.output_tensors_,
+                                 runner.attr_key_,
+                                 runner.attr_setters_});
+    if (state.current.ops.size() < FLAGS_ascend_check_nan_inf_window) {
+      return;
+    }
+    CloseWindow(&state, stream);
+    // Bound the number of windows whose tensors are kept alive.
+    if (state.pending.size() > kMaxPendingWindows) {
+      PADDLE_ENFORCE_NPU_SUCCESS(
+          aclrtSynchronizeEvent(state.pending.front().event));
+      CheckFrontWindow(&state, stream);
+    }
+  }
+
+  // Checks the windows still open or pending on stream, or on every stream
+  // when it is null, so that NaN/Inf raised by the last ops before a
+  // synchronization is reported there. With release the per-stream state is
+  // freed afterwards, the stream is about to be destroyed.
+  void Flush(aclrtStream stream, bool release) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto iter = states_.begin(); iter != states_.end();) {
+      if (stream && iter->first != stream) {
+        ++iter;
+        continue;
+      }
+      auto &state = iter->second;
+      if (!state.current.ops.empty()) {
+        CloseWindow(&state, iter->first);
+      }
+      while (!state.pending.empty()) {
+        PADDLE_ENFORCE_NPU_SUCCESS(
+            aclrtSynchronizeEvent(state.pending.front().event));
+        CheckFrontWindow(&state, iter->first);
+      }
+      if (release) {
+        FreeState(&state);
+        iter = states_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kStatusBytes = 8 * sizeof(float);
+  static constexpr size_t kMaxPendingWindows = 2;
+
+  static void OnStreamSync(aclrtStream stream, bool release) {
+    Instance().Flush(stream, release);
+  }
+
+  struct RecordedOp {
+    std::string op_type;
+    std::vector<phi::DenseTensor> inputs;
+    std::vector<aclMemType> input_mem_types;
+    std::vector<std::string> input_names;
+    std::vector<phi::DenseTensor> outputs;
+    std::string attr_key;
+    std::vector<std::function<void(aclopAttr *)>> attr_setters;
+  };
+
+  struct Window {
+    std::vector<RecordedOp> ops;
+    aclrtEvent event = nullptr;
+    float *host_status = nullptr;
+  };
+
+  struct StreamState {
+    aclTensorDesc *status_desc = nullptr;
+    aclDataBuffer *status_buffer = nullptr;
+    void *status_ptr = nullptr;
+    aclTensorDesc *tmp_desc = nullptr;
+    aclDataBuffer *tmp_buffer = nullptr;
+    void *tmp_ptr = nullptr;
+    uint64_t num_windows = 0;
+    Window current;
+    std::deque<Window> pending;
+    std::vector<Window> free_windows;
+  };
+
+  FloatStatusMonitor() = default;
+
+  // Fetches the status of the ops recorded in the current window behind an
+  // event and moves the window to the pending ones.
+  void CloseWindow(StreamState *state_ptr, aclrtStream stream) {
+    auto &state = *state_ptr;
+    auto &window = state.current;
+    if (!window.event) {
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtCreateEvent(&window.event));
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtMallocHost(
+          reinterpret_cast<void **>(&window.host_status), kStatusBytes));
+    }
+    GetStatus(state, stream);
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtMemcpyAsync(window.host_status,
+                                                kStatusBytes,
+                                                state.status_ptr,
+                                                kStatusBytes,
+                                                ACL_MEMCPY_DEVICE_TO_HOST,
+                                                stream));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtRecordEvent(window.event, stream));
+    ClearStatus(state, stream);
+
+    state.pending.push_back(std::move(window));
+    state.current = Window();
+    if (!state.free_windows.empty()) {
+      state.current = std::move(state.free_windows.back());
+      state.free_windows.pop_back();
+    }
+  }
+
+  StreamState &GetState(aclrtStream stream) {
+    auto iter = states_.find(stream);
+    if (iter != states_.end()) {
+      return iter->second;
+    }
+    auto &state = states_[stream];
+    const std::vector<int64_t> dims{8};
+    for (auto desc : {&state.status_desc, &state.tmp_desc}) {
+      *desc = aclCreateTensorDesc(
+          ACL_FLOAT, dims.size(), dims.data(), ACL_FORMAT_NCHW);
+      PADDLE_ENFORCE_NOT_NULL(
+          *desc, phi::errors::External("Call aclCreateTensorDesc failed."));
+    }
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtMalloc(
+        &state.status_ptr, kStatusBytes, ACL_MEM_MALLOC_HUGE_FIRST));
+    PADDLE_ENFORCE_NPU_SUCCESS(
+        aclrtMalloc(&state.tmp_ptr, kStatusBytes, ACL_MEM_MALLOC_NORMAL_ONLY));
+    state.status_buffer = aclCreateDataBuffer(state.status_ptr, kStatusBytes);
+    state.tmp_buffer = aclCreateDataBuffer(state.tmp_ptr, kStatusBytes);
+    RunFloatStatusOp("NPUAllocFloatStatus",
+                     nullptr,
+                     nullptr,
+                     state.status_desc,
+                     state.status_buffer,
+                     stream);
+    ClearStatus(state, stream);
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
+    return state;
+  }
+
+  // Frees what GetState and CloseWindow created, with no window pending.
+  void FreeState(StreamState *state) {
+    auto free_window = [](Window *window) {
+      if (!window->event) return;
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtDestroyEvent(window->event));
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtFreeHost(window->host_status));
+    };
+    free_window(&state->current);
+    for (auto &window : state->free_windows) free_window(&window);
+    aclDestroyDataBuffer(state->status_buffer);
+    aclDestroyDataBuffer(state->tmp_buffer);
+    aclDestroyTensorDesc(state->status_desc);
+    aclDestroyTensorDesc(state->tmp_desc);
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtFree(state->status_ptr));
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtFree(state->tmp_ptr));
+  }
+
+  // NPUGetFloatStatus writes the status register into the status buffer.
+  void GetStatus(const StreamState &state, aclrtStream stream) {
+    RunFloatStatusOp("NPUGetFloatStatus",
+                     state.status_desc,
+                     state.status_buffer,
+                     state.tmp_desc,
+                     state.tmp_buffer,
+                     stream);
+  }
+
+  void ClearStatus(const StreamState &state, aclrtStream stream) {
+    RunFloatStatusOp("NPUClearFloatStatus",
+                     state.tmp_desc,
+                     state.tmp_buffer,
+                     state.status_desc,
+                     state.status_buffer,
+                     stream);
+  }
+
+  static bool HasNanInf(const float *status) {
+    float sum = 0.0;
+    for (size_t i = 0; i < kStatusBytes / sizeof(float); ++i) {
+      sum += status[i];
+    }
+    return sum >= 1.0;
+  }
+
+  // Reads the status buffer after the stream has been synchronized.
+  bool ReadStatus(const StreamState &state) {
+    float status[kStatusBytes / sizeof(float)];
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtMemcpy(status,
+                                           kStatusBytes,
+                                           state.status_ptr,
+                                           kStatusBytes,
+                                           ACL_MEMCPY_DEVICE_TO_HOST));
+    return HasNanInf(status);
+  }
+
+  // Checks the oldest pending window, whose event has completed.
+  void CheckFrontWindow(StreamState *state, aclrtStream stream) {
+    Window window = std::move(state->pending.front());
+    state->pending.pop_front();
+    uint64_t index = state->num_windows++;
+    bool found = HasNanInf(window.host_status);
+    std::vector<RecordedOp> ops;
+    ops.swap(window.ops);
+    state->free_windows.push_back(std::move(window));
+    if (!found) {
+      return;
+    }
+
+    std::ostringstream names;
+    for (size_t i = 0; i < ops.size(); ++i) {
+      names << (i ? ", " : "") << ops[i].op_type;
+    }
+    LOG(ERROR) << "Nan/Inf found in window " << index << " of stream "
+               << stream << ", which ran " << ops.size()
+               << " ops: " << names.str();
+
+    size_t begin = 0, end = ops.size();
+    PADDLE_ENFORCE_EQ(
+        Replay(*state, ops, begin, end, stream),
+        true,
+        phi::errors::PreconditionNotMet(
+            "Nan/Inf found in window %d (%s), but replaying its ops did "
+            "not reproduce it, an input was probably updated in place.",
+            index,
+            names.str()));
+    while (end - begin > 1) {
+      size_t mid = begin + (end - begin) / 2;
+      if (Replay(*state, ops, begin, mid, stream)) {
+        end = mid;
+      } else {
+        begin = mid;
+      }
+    }
+    PADDLE_THROW(phi::errors::PreconditionNotMet(
+        "Operator %s contains Nan/Inf, it is op %d of window %d.",
+        ops[begin].op_type,
+        begin,
+        index));
+  }
+
+  // Runs ops [begin, end) again with their recorded inputs, writing to
+  // scratch outputs, and returns whether they raise the float status.
+  bool Replay(const StreamState &state,
+              const std::vector<RecordedOp> &ops,
+              size_t begin,
+              size_t end,
+              aclrtStream stream) {
+    PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
+    ClearStatus(state, stream);
+    std::vector<void *> scratch;
+    {
+      std::vector<std::unique_ptr<NpuOpRunner>> runners;
+      for (size_t i = begin; i < end; ++i) {
+        const auto &op = ops[i];
+        runners.emplace_back(new NpuOpRunner());
+        auto &runner = *runners.back();
+        runner.SetType(op.op_type);
+        for (size_t j = 0; j < op.inputs.size(); ++j) {
+          runner.AddInput(op.inputs[j], op.input_mem_types[j]);
+        }
+        if (!op.input_names.empty()) {
+          runner.AddInputNames(op.input_names);
+        }
+        for (const auto &output : op.outputs) {
+          void *ptr = nullptr;
+          if (output.capacity() > 0) {
+            PADDLE_ENFORCE_NPU_SUCCESS(aclrtMalloc(
+                &ptr, output.capacity(), ACL_MEM_MALLOC_NORMAL_ONLY));
+            scratch.push_back(ptr);
+          }
+          runner.output_descs_.emplace_back(runner.CreateTensorDesc(output));
+          runner.output_buffers_.emplace_back(
+              aclCreateDataBuffer(ptr, output.capacity()));
+        }
+        runner.attr_key_ = op.attr_key;
+        runner.attr_setters_ = op.attr_setters;
+        PADDLE_ENFORCE_NPU_SUCCESS(runner.Execute(stream));
+      }
+      GetStatus(state, stream);
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtSynchronizeStream(stream));
+    }
+    for (auto ptr : scratch) {
+      PADDLE_ENFORCE_NPU_SUCCESS(aclrtFree(ptr));
+    }
+    bool found = ReadStatus(state);
+    ClearStatus(state, stream);
+    return found;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<aclrtStream, StreamState> states_;
+};
+
+aclError NpuOpRunner::Execute(aclrtStream stream) const {
+  auto *attr = GetAttr();
+  VLOG(4) << "attr: " << attr;
+  // Ensure that the Gil has been released before running
+  // aclopCompileAndExecute.
+  if (PyGILState_Check()) {
+    pybind11::gil_scoped_release release;
+    return aclopCompileAndExecute(op_type_.c_str(),
+                                  input_descs_.size(),
+                                  input_descs_.data(),
+                                  input_buffers_.data(),
+                                  output_descs_.size(),
+                                  output_descs_.data(),
+                                  output_buffers_.data(),
+                                  attr,
+                                  ACL_ENGINE_SYS,
+                                  ACL_COMPILE_SYS,
+                                  NULL,
+                                  stream);
+  }
+  return aclopCompileAndExecute(op_type_.c_str(),
+                                input_descs_.size(),
+                                input_descs_.data(),
+                                input_buffers_.data(),
+                                output_descs_.size(),
+                                output_descs_.data(),
+                                output_buffers_.data(),
+                                attr,
+                                ACL_ENGINE_SYS,
+                                ACL_COMPILE_SYS,
+                                NULL,
+                                stream);
 }
 
 void NpuOpRunner::Run(aclrtStream stream, bool sync) const {
@@ -631,51 +1289,93 @@ void NpuOpRunner::Run(aclrtStream stream, bool sync) const {
       stream,
       phi::errors::External("Stream should not be null, please check."));
   if (FLAGS_ascend_check_nan_inf) {
-    InitFloatStatus(stream);
+    FloatStatusMonitor::Instance().BeforeRun(stream);
   }
   VLOG(5) << "NpuOpRunner(" << this << ") Run:";
   VLOG(4) << "op_type: " << op_type_;
   VLOG(4) << "input_desc.size: " << input_descs_.size();
   VLOG(4) << "output_desc.size: " << output_descs_.size();
-  VLOG(4) << "attr: " << attr_;
   VLOG(4) << "stream: " << stream;
-  aclError ret;
-  // Ensure that the Gil has been released before running
-  // aclopCompileAndExecute.
-  if (PyGILState_Check()) {
-    pybind11::gil_scoped_release release;
-    ret = aclopCompileAndExecute(op_type_.c_str(),
-                                 input_descs_.size(),
-                                 input_descs_.data(),
-                                 input_buffers_.data(),
-                                 output_descs_.size(),
-                                 output_descs_.data(),
-                                 output_buffers_.data(),
-                                 attr_,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
-  } else {
-    ret = aclopCompileAndExecute(op_type_.c_str(),
-                                 input_descs_.size(),
-                                 input_descs_.data(),
-                                 input_buffers_.data(),
-                                 output_descs_.size(),
-                                 output_descs_.data(),
-                                 output_buffers_.data(),
-                                 attr_,
-                                 ACL_ENGINE_SYS,
-                                 ACL_COMPILE_SYS,
-                                 NULL,
-                                 stream);
-  }
+  aclError ret = Execute(stream);
   VLOG(4) << "after aclopCompileAndExecute: " << ret;
   if (sync) {
     ret = aclrtSynchronizeStream(stream);
   }
   PADDLE_ENFORCE_NPU_SUCCESS(ret);
   if (FLAGS_ascend_check_nan_inf) {
-    GetFloatStatus(stream, op_type_);
+    FloatStatusMonitor::Instance().AfterRun(*this, stream);
+  }
+}
+
+void NpuOpRunner::TypeAdapter(
+    const std::vector<phi::DenseTensor> &inputs,
+    const std::vector<phi::DenseTensor> &outputs,
+    const NPUAttributeMap &attrs,
+    const phi::CustomContext &dev_ctx,
+    std::function<void(const std::vector<phi::DenseTensor> &,
+                       const std::vector<phi::DenseTensor> &,
+                       const NPUAttributeMap &,
+                       const phi::CustomContext &)> op_runner,
+    const std::vector<paddle::experimental::DataType> &input_type,
+    const std::vector<paddle::experimental::DataType> &output_type) {
+  auto &cast_cache = CastCache::Instance();
+  std::vector<phi::DenseTensor> tmp_inputs(inputs.size());
+  std::vector<phi::DenseTensor> tmp_outputs(outputs.size());
+
+  for (size_t i = 0; i < input_type.size(); ++i) {
+    bool cast_input =
+        (input_type[i] == paddle::experimental::DataType::UNDEFINED ||
+         input_type[i] != inputs[i].dtype());
+    if (!cast_input) {
+      tmp_inputs[i] = inputs[i];
+    } else if (cast_cache.Lookup(inputs[i], input_type[i], &tmp_inputs[i])) {
+      VLOG(4) << "TypeAdapter reuses the cast of input " << i << " to "
+              << input_type[i];
+    } else {
+      tmp_inputs[i].Resize(inputs[i].dims());
+      dev_ctx.Alloc(&(tmp_inputs[i]), input_type[i]);
+
+      const auto &cast_runner = NpuOpRunner(
+          "Cast",
+          {inputs[i]},
+          {tmp_inputs[i]},
+          {{"dst_type", static_cast<int>(ConvertToNpuDtype(input_type[i]))}});
+      cast_runner.Run(dev_ctx.stream());
+      cast_cache.Insert(inputs[i], tmp_inputs[i]);
+    }
+  }
+  for (size_t i = 0; i < output_type.size(); ++i) {
+    bool cast_output =
+        (output_type[i] == paddle::experimental::DataType::UNDEFINED ||
+         output_type[i] != outputs[i].dtype());
+    if (!cast_output) {
+      tmp_outputs[i] = outputs[i];
+    } else {
+      tmp_outputs[i].Resize(outputs[i].dims());
+      dev_ctx.Alloc(&(tmp_outputs[i]), output_type[i]);
+    }
+    cast_cache.Invalidate(outputs[i]);
+  }
+
+  op_runner(tmp_inputs, tmp_outputs, attrs, dev_ctx);
+
+  for (size_t i = 0; i < output_type.size(); ++i) {
+    bool cast_output =
+        (output_type[i] == paddle::experimental::DataType::UNDEFINED ||
+         output_type[i] != outputs[i].dtype());
+    if (cast_output) {
+      const auto &cast_runner = NpuOpRunner(
+          "Cast",
+          {tmp_outputs[i]},
+          {outputs[i]},
+          {{"dst_type",
+            static_cast<int>(ConvertToNpuDtype(outputs[i].dtype()))}});
+      cast_runner.Run(dev_ctx.stream());
+      // The next adapter that needs outputs[i] as output_type[i] can take
+      // tmp_outputs[i] directly instead of casting it back.
+      if (IsLosslessCast(tmp_outputs[i].dtype(), outputs[i].dtype())) {
+        cast_cache.Insert(outputs[i], tmp_outputs[i]);
+      }
+    }
   }
 }
@@ -23,6 +23,10 @@
 aclDataType ConvertToNpuDtype(paddle::experimental::DataType dtype);
 aclFormat ConvertToNpuFormat(phi::DataLayout layout);
 
+// Drops the host mirror and the casts of tensor. Kernels writing device
+// memory with raw ACL calls instead of NpuOpRunner must call it.
+void InvalidateCachedValues(const phi::DenseTensor &tensor);
+
 using NPUAttribute = paddle::variant<paddle::blank,
                                      int,
                                      float,
@@ -105,6 +109,10 @@ class NpuOpRunner {
 
   void Run(aclrtStream stream = nullptr, bool sync = false) const;
 
+  // Runs op_runner on copies of inputs and outputs cast to input_type and
+  // output_type. When FLAGS_npu_cast_cache_max_bytes is set, casted inputs
+  // are reused across calls while their source is unchanged, which also
+  // skips casting back an output that an earlier call just produced.
   static void TypeAdapter(
       const std::vector<phi::DenseTensor> &inputs,
       const std::vector<phi::DenseTensor> &outputs,
@@ -115,66 +123,14 @@ class NpuOpRunner {
                          const NPUAttributeMap &,
                          const phi::CustomContext &)> op_runner,
       const std::vector<paddle::experimental::DataType> &input_type,
-      const std::vector<paddle::experimental::DataType> &output_type) {
-    std::vector<phi::DenseTensor> tmp_inputs(inputs.size());
-    std::vector<phi::DenseTensor> tmp_outputs(outputs.size());
-
-    for (size_t i = 0; i < input_type.size(); ++i) {
-      bool cast_input =
-          (input_type[i] == paddle::experimental::DataType::UNDEFINED ||
-           input_type[i] != inputs[i].dtype());
-      if (!cast_input) {
-        tmp_inputs[i] = inputs[i];
-      } else {
-        tmp_inputs[i].Resize(inputs[i].dims());
-        dev_ctx.Alloc(&(tmp_inputs[i]), input_type[i]);
-
-        const auto &cast_runner = NpuOpRunner(
-            "Cast",
-            {inputs[i]},
-            {tmp_inputs[i]},
-            {{"dst_type", static_cast<int>(ConvertToNpuDtype(input_type[i]))}});
-        cast_runner.Run(dev_ctx.stream());
-      }
-    }
-    for (size_t i = 0; i < output_type.size(); ++i) {
-      bool cast_output =
-          (output_type[i] == paddle::experimental::DataType::UNDEFINED ||
-           output_type[i] != outputs[i].dtype());
-      if (!cast_output) {
-        tmp_outputs[i] = outputs[i];
-      } else {
-        tmp_outputs[i].Resize(outputs[i].dims());
-        dev_ctx.Alloc(&(tmp_outputs[i]), output_type[i]);
-      }
-    }
-
-    op_runner(tmp_inputs, tmp_outputs, attrs, dev_ctx);
-
-    for (size_t i = 0; i < output_type.size(); ++i) {
-      bool cast_output =
-          (output_type[i] == paddle::experimental::DataType::UNDEFINED ||
-           output_type[i] != outputs[i].dtype());
-      if (cast_output) {
-        const auto &cast_runner = NpuOpRunner(
-            "Cast",
-            {tmp_outputs[i]},
-            {outputs[i]},
-            {{"dst_type",
-              static_cast<int>(ConvertToNpuDtype(outputs[i].dtype()))}});
-        cast_runner.Run(dev_ctx.stream());
-      }
-    }
-  }
+      const std::vector<paddle::experimental::DataType> &output_type);
 
  private:
   aclTensorDesc *CreateTensorDesc(phi::DenseTensor tensor,
                                   aclMemType mem_type = ACL_MEMTYPE_DEVICE);
   aclDataBuffer *CreateDataBuffer(phi::DenseTensor tensor);
-  void GetFloatStatus(aclrtStream stream, std::string op_type) const;
-  void InitFloatStatus(aclrtStream stream) const;
-  void ClearFloatStatus(aclrtStream stream) const;
-  void AllocFloatStatus(aclrtStream stream) const;
+  aclopAttr *GetAttr() const;
+  aclError Execute(aclrtStream stream) const;
   void PrintOpInfo() const;
   template <typename T>
   void AddConstantInputHelper(const phi::CustomContext &dev_ctx,
@@ -187,7 +143,19 @@ class NpuOpRunner {
   std::vector<aclTensorDesc *> input_descs_;
   std::vector<aclTensorDesc *> output_descs_;
   std::vector<phi::DenseTensor> host_tensors_;
-  aclopAttr *attr_{nullptr};
+  // Attributes are recorded by AddAttr and turned into an aclopAttr, shared
+  // through the attribute cache, the first time the runner is run.
+  std::string attr_key_;
+  std::vector<std::function<void(aclopAttr *)>> attr_setters_;
+  mutable aclopAttr *attr_{nullptr};
+  // Tensors kept for FloatStatusMonitor to replay the op when the windowed
+  // NaN/Inf check is on, empty otherwise.
+  std::vector<phi::DenseTensor> input_tensors_;
+  std::vector<aclMemType> input_mem_types_;
+  std::vector<std::string> input_names_;
+  std::vector<phi::DenseTensor> output_tensors_;
+
+  friend class FloatStatusMonitor;
 };
 
 template <typename T>
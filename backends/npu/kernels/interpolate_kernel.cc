@@ -694,10 +694,10 @@ void InterpolateGradKernel(
   // Priority: SizeTensor > OutSize > Scale > scale > out_h & out_w
   if (size_tensor && size_tensor->size() > 0) {
     auto list_new_size_tensor = size_tensor.get();
-    std::vector<int32_t> output_h(1);
-    std::vector<int32_t> output_w(1);
-    TensorToVector(dev_ctx, *(list_new_size_tensor[0]), dev_ctx, &output_h);
-    TensorToVector(dev_ctx, *(list_new_size_tensor[1]), dev_ctx, &output_w);
+    auto output_h =
+        get_new_data_from_tensor<int>(dev_ctx, list_new_size_tensor[0]);
+    auto output_w =
+        get_new_data_from_tensor<int>(dev_ctx, list_new_size_tensor[1]);
     out_h = output_h[0];
     out_w = output_w[0];
   } else if (out_size) {
@@ -63,8 +63,6 @@ void MaskedSelectKernel(const Context& dev_ctx,
     sum_runner.AddAttr("keep_dims", false);
     sum_runner.Run(stream);
 
-    // wait for ReduceSum complete
-    dev_ctx.Wait();
     TensorToVector(dev_ctx, out_size, dev_ctx, &out_size_vec);
   }
 
@@ -128,12 +126,10 @@ void MaskedSelectGradKernel(const Context& dev_ctx,
   phi::DenseTensor mask_int32;
   phi::DenseTensor out_size;
   mask_int32.Resize(mask.dims());
-  out_size.Resize({1});
   dev_ctx.template Alloc<int32_t>(&mask_int32);
-  dev_ctx.template Alloc<int32_t>(&out_size);
 
   std::vector<int32_t> out_size_vec(1, out_grad.numel());
-  TensorFromVector(dev_ctx, out_size_vec, dev_ctx, &out_size);
+  ConstantTensorFromVector(dev_ctx, out_size_vec, &out_size);
   {
     const auto& cast_runner = NpuOpRunner(
         "Cast",
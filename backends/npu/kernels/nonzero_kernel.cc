@@ -58,13 +58,11 @@ void NonZeroKernel(const Context& dev_ctx,
   sumed_true_num.Resize({1});
   dev_ctx.template Alloc<int64_t>(&sumed_true_num);
   phi::DenseTensor cond_axes;
-  cond_axes.Resize({dims.size()});
-  dev_ctx.template Alloc<int>(&cond_axes);
   std::vector<int> axes_vec;
   for (int i = 0; i < dims.size(); ++i) {
     axes_vec.push_back(i);
   }
-  custom_kernel::TensorFromVector(dev_ctx, axes_vec, dev_ctx, &cond_axes);
+  custom_kernel::ConstantTensorFromVector(dev_ctx, axes_vec, &cond_axes);
   const auto& sum_runner = NpuOpRunner("ReduceSum",
                                        {casted_cond, cond_axes},
                                        {sumed_true_num},
@@ -231,18 +231,11 @@ void StridedSliceCompute(const Context& dev_ctx,
   phi::DenseTensor ends_indices_tensor;
   phi::DenseTensor strides_indices_tensor;
 
-  starts_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&starts_indices_tensor);
-  ends_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&ends_indices_tensor);
-  strides_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&strides_indices_tensor);
-
-  TensorFromVector(
-      dev_ctx, starts_indices_vector, dev_ctx, &starts_indices_tensor);
-  TensorFromVector(dev_ctx, ends_indices_vector, dev_ctx, &ends_indices_tensor);
-  TensorFromVector(
-      dev_ctx, strides_indices_vector, dev_ctx, &strides_indices_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, starts_indices_vector, &starts_indices_tensor);
+  ConstantTensorFromVector(dev_ctx, ends_indices_vector, &ends_indices_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, strides_indices_vector, &strides_indices_tensor);
 
   auto out_dims_origin = out_dims;
   if (decrease_axis.size() > 0) {
@@ -321,9 +314,7 @@ void StridedSliceCompute(const Context& dev_ctx,
         reverse_axis_vector.push_back(axes[axis]);
       }
     }
-    reverse_axis.Resize({static_cast<int>(reverse_axis_vector.size())});
-    dev_ctx.template Alloc<int>(&reverse_axis);
-    TensorFromVector(dev_ctx, reverse_axis_vector, dev_ctx, &reverse_axis);
+    ConstantTensorFromVector(dev_ctx, reverse_axis_vector, &reverse_axis);
 
     const auto& runner_reverse =
         NpuOpRunner("ReverseV2", {out_tmp, reverse_axis}, {*out});
@@ -480,25 +471,18 @@ void StridedSliceGradCompute(const Context& dev_ctx,
   phi::DenseTensor ends_indices_tensor;
   phi::DenseTensor strides_indices_tensor;
 
-  starts_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&starts_indices_tensor);
-  ends_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&ends_indices_tensor);
-  strides_indices_tensor.Resize({D});
-  dev_ctx.template Alloc<int64_t>(&strides_indices_tensor);
-
-  TensorFromVector(
-      dev_ctx, starts_indices_vector, dev_ctx, &starts_indices_tensor);
-  TensorFromVector(dev_ctx, ends_indices_vector, dev_ctx, &ends_indices_tensor);
-  TensorFromVector(
-      dev_ctx, strides_indices_vector, dev_ctx, &strides_indices_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, starts_indices_vector, &starts_indices_tensor);
+  ConstantTensorFromVector(dev_ctx, ends_indices_vector, &ends_indices_tensor);
+  ConstantTensorFromVector(
+      dev_ctx, strides_indices_vector, &strides_indices_tensor);
 
   std::vector<int64_t> input_dims_vector;
   for (int i = 0; i < input_dims.size(); i++) {
     input_dims_vector.push_back(input_dims[i]);
   }
   phi::DenseTensor input_dims_tensor;
-  TensorFromVector(dev_ctx, input_dims_vector, dev_ctx, &input_dims_tensor);
+  ConstantTensorFromVector(dev_ctx, input_dims_vector, &input_dims_tensor);
 
   bool need_reverse = false;
   for (size_t axis = 0; axis < axes.size(); axis++) {
@@ -523,9 +507,7 @@ void StridedSliceGradCompute(const Context& dev_ctx,
         reverse_axis_vector.push_back(axes[axis]);
       }
     }
-    reverse_axis.Resize({static_cast<int>(reverse_axis_vector.size())});
-    dev_ctx.template Alloc<int>(&reverse_axis);
-    TensorFromVector(dev_ctx, reverse_axis_vector, dev_ctx, &reverse_axis);
+    ConstantTensorFromVector(dev_ctx, reverse_axis_vector, &reverse_axis);
 
     phi::DenseTensor out_grad_tmp;
     out_grad_tmp.Resize(out_grad.dims());
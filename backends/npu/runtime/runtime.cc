@@ -14,118 +14,607 @@
 
 #include "runtime/runtime.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "glog/logging.h"
 
-class AlignnedAllocator {
+ENV_uint64(npu_pinned_pool_max_bytes, 256UL << 20);
+
+inline size_t get_current_device_id() {
+  int dev_id = 0;
+  ACL_CHECK(aclrtGetDevice(&dev_id));
+  return dev_id;
+}
+
+// Staging buffers for AsyncMemCpyH2D. ACL only copies asynchronously from
+// pinned memory, so pageable sources are first copied into one of these and
+// the buffer is handed back once the stream has consumed it. Peer copies
+// between cards without peer access bounce through the same buffers.
+//
+// Buffers come in power-of-two size classes and are recycled through free
+// lists, and so are the events that guard them, so the steady state does no
+// aclrtMallocHost/aclrtCreateEvent at all. Pending buffers sit in one FIFO
+// per stream: work on a stream completes in submission order, so reclaiming
+// only ever polls the oldest entry of each queue.
+class PinnedStagingPool {
  public:
-  void *Alloc(size_t size, size_t align) {
+  static constexpr size_t kMinClassBytes = 4096;
+  static constexpr size_t kNumClasses = 15;  // 4 KiB .. 64 MiB
+  static constexpr size_t kAlign = 64;
+  // Bounced peer copies go through host memory in chunks of this size, so
+  // they reuse one pooled block however large the tensor.
+  static constexpr size_t kChunkBytes = 4 << 20;
+
+  ~PinnedStagingPool() {
     std::lock_guard<std::mutex> lock(mtx_);
-    ProcessEvents();
-    void *p = nullptr;
-    ACL_CHECK(aclrtMallocHost(&p, size + align));
-    void *ret =
-        reinterpret_cast<void *>(reinterpret_cast<size_t>(p) + align -
-                                 (reinterpret_cast<size_t>(p) & (align - 1)));
-    recorded_events_[ret] = {p, nullptr};
-    return ret;
+    for (auto &queue : pending_) {
+      for (auto &entry : queue.second) {
+        ACL_CHECK(aclrtSynchronizeEvent(entry.event));
+        ACL_CHECK(aclrtDestroyEvent(entry.event));
+        ACL_CHECK(aclrtFreeHost(entry.block.base));
+      }
+    }
+    for (auto &list : free_blocks_) {
+      for (auto &block : list) ACL_CHECK(aclrtFreeHost(block.base));
+    }
+    for (auto event : free_events_) ACL_CHECK(aclrtDestroyEvent(event));
   }
 
-  void Record(void *p, aclrtEvent event) {
+  // Copies size bytes of src into a staging buffer and enqueues the H2D copy
+  // of it on stream.
+  void StageAndCopy(void *dst,
+                    const void *src,
+                    size_t size,
+                    aclrtStream stream) {
+    Block block;
+    aclrtEvent event;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      Reclaim();
+      block = Acquire(size);
+      event = AcquireEvent();
+    }
+    memcpy(block.data, src, size);
+    ACL_CHECK(aclrtMemcpyAsync(
+        dst, size, block.data, size, ACL_MEMCPY_HOST_TO_DEVICE, stream));
+    ACL_CHECK(aclrtRecordEvent(event, stream));
     std::lock_guard<std::mutex> lock(mtx_);
-    recorded_events_[p].second = event;
+    pending_[stream].push_back({block, event});
   }
 
-  void ClearEvent() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    for (auto it = recorded_events_.begin(); it != recorded_events_.end();) {
-      aclrtEvent event = it->second.second;
-      if (!event) continue;
-      ACL_CHECK(aclrtSynchronizeEvent(event));
-      void *ptr = it->second.first;
-      ACL_CHECK(aclrtFreeHost(ptr));
-      ACL_CHECK(aclrtDestroyEvent(event));
-      recorded_events_.erase(it++);
+  // Copies size bytes between two cards without peer access through a
+  // staging buffer of at most kChunkBytes, each half of every chunk issued on
+  // the card owning the memory. The calling card is current again when it
+  // returns.
+  void Bounce(int dst_device,
+              void *dst,
+              int src_device,
+              const void *src,
+              size_t size) {
+    const size_t chunk = size < kChunkBytes ? size : kChunkBytes;
+    BounceScope scope(this, chunk);
+    for (size_t offset = 0; offset < size; offset += chunk) {
+      const size_t bytes = std::min(chunk, size - offset);
+      ACL_CHECK(aclrtSetDevice(src_device));
+      ACL_CHECK(aclrtMemcpy(scope.block.data,
+                            bytes,
+                            static_cast<const char *>(src) + offset,
+                            bytes,
+                            ACL_MEMCPY_DEVICE_TO_HOST));
+      ACL_CHECK(aclrtSetDevice(dst_device));
+      ACL_CHECK(aclrtMemcpy(static_cast<char *>(dst) + offset,
+                            bytes,
+                            scope.block.data,
+                            bytes,
+                            ACL_MEMCPY_HOST_TO_DEVICE));
     }
   }
 
-  void ProcessEvents() {
-    for (auto it = recorded_events_.begin(); it != recorded_events_.end();) {
-      aclrtEvent event = it->second.second;
-      if (!event) continue;
-      aclrtEventStatus status = ACL_EVENT_STATUS_COMPLETE;
-      ACL_CHECK(aclrtQueryEvent(event, &status));
+ private:
+  struct Block {
+    void *base;
+    void *data;
+    size_t cls;  // kNumClasses for oversized, unpooled buffers
+  };
+
+  struct Pending {
+    Block block;
+    aclrtEvent event;
+  };
+
+  // The staging block and the current card of a Bounce, given back and
+  // restored however the copy ends.
+  struct BounceScope {
+    BounceScope(PinnedStagingPool *pool, size_t size)
+        : pool(pool), device(get_current_device_id()) {
+      std::lock_guard<std::mutex> lock(pool->mtx_);
+      pool->Reclaim();
+      block = pool->Acquire(size);
+    }
 
-      if (status == ACL_EVENT_STATUS_COMPLETE) {
-        void *ptr = it->second.first;
-        ACL_CHECK(aclrtFreeHost(ptr));
-        recorded_events_.erase(it++);
-        ACL_CHECK(aclrtDestroyEvent(event));
-      } else {
-        ++it;
+    ~BounceScope() {
+      aclrtSetDevice(device);
+      std::lock_guard<std::mutex> lock(pool->mtx_);
+      pool->Release(block);
+    }
+
+    PinnedStagingPool *pool;
+    int device;
+    Block block;
+  };
+
+  static size_t SizeClass(size_t size) {
+    size_t cls = 0;
+    size_t bytes = kMinClassBytes;
+    while (bytes < size && cls < kNumClasses) {
+      bytes <<= 1;
+      ++cls;
+    }
+    return cls;
+  }
+
+  static size_t ClassBytes(size_t cls) { return kMinClassBytes << cls; }
+
+  Block Acquire(size_t size) {
+    const size_t cls = SizeClass(size);
+    if (cls < kNumClasses && !free_blocks_[cls].empty()) {
+      Block block = free_blocks_[cls].back();
+      free_blocks_[cls].pop_back();
+      pooled_bytes_ -= ClassBytes(cls);
+      return block;
+    }
+    const size_t bytes = cls < kNumClasses ? ClassBytes(cls) : size;
+    Block block{nullptr, nullptr, cls};
+    ACL_CHECK(aclrtMallocHost(&block.base, bytes + kAlign));
+    block.data = reinterpret_cast<void *>(
+        (reinterpret_cast<uintptr_t>(block.base) + kAlign - 1) &
+        ~static_cast<uintptr_t>(kAlign - 1));
+    return block;
+  }
+
+  void Release(const Block &block) {
+    if (block.cls < kNumClasses &&
+        pooled_bytes_ + ClassBytes(block.cls) <=
+            FLAGS_npu_pinned_pool_max_bytes) {
+      free_blocks_[block.cls].push_back(block);
+      pooled_bytes_ += ClassBytes(block.cls);
+    } else {
+      ACL_CHECK(aclrtFreeHost(block.base));
+    }
+  }
+
+  aclrtEvent AcquireEvent() {
+    if (free_events_.empty()) {
+      aclrtEvent event;
+      ACL_CHECK(aclrtCreateEvent(&event));
+      return event;
+    }
+    aclrtEvent event = free_events_.back();
+    free_events_.pop_back();
+    return event;
+  }
+
+  void Reclaim() {
+    for (auto &queue : pending_) {
+      auto &entries = queue.second;
+      while (!entries.empty()) {
+        aclrtEventStatus status = ACL_EVENT_STATUS_COMPLETE;
+        ACL_CHECK(aclrtQueryEvent(entries.front().event, &status));
+        if (status != ACL_EVENT_STATUS_COMPLETE) break;
+        Release(entries.front().block);
+        free_events_.push_back(entries.front().event);
+        entries.pop_front();
       }
     }
   }
 
+  std::mutex mtx_;
+  std::vector<Block> free_blocks_[kNumClasses];
+  size_t pooled_bytes_ = 0;
+  std::vector<aclrtEvent> free_events_;
+  std::unordered_map<aclrtStream, std::deque<Pending>> pending_;
+};
+
+// Host callbacks ordered after the work already submitted to a stream.
+//
+// AddCallback records an event on the stream and queues the callback behind
+// it; one thread per device waits for the oldest event and then runs, as a
+// batch, every queued callback whose event has completed by then. Callbacks
+// of all streams of a device share the FIFO, so they run in submission
+// order. The stream itself is not blocked while a callback runs, but
+// SyncStream and SyncDevice wait for the callbacks queued before them.
+class StreamCallbackQueue {
+ public:
+  explicit StreamCallbackQueue(size_t dev_id)
+      : dev_id_(dev_id), thread_([this] { Loop(); }) {}
+
+  ~StreamCallbackQueue() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    for (auto event : free_events_) ACL_CHECK(aclrtDestroyEvent(event));
+  }
+
+  void Add(C_Device device,
+           C_Stream stream,
+           C_Callback callback,
+           void *user_data) {
+    aclrtEvent event;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      event = AcquireEvent();
+    }
+    ACL_CHECK(aclrtRecordEvent(event, reinterpret_cast<aclrtStream>(stream)));
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      queue_.push_back({event, *device, stream, callback, user_data});
+      last_seq_[stream] = ++queued_seq_;
+    }
+    cv_.notify_all();
+  }
+
+  // Waits until the callbacks queued on stream, or on any stream if stream
+  // is null, have run. A no-op on the callback thread itself, which would
+  // otherwise wait for its own batch.
+  void Flush(C_Stream stream) {
+    if (std::this_thread::get_id() == thread_.get_id()) return;
+    std::unique_lock<std::mutex> lock(mtx_);
+    uint64_t seq = queued_seq_;
+    if (stream) {
+      auto it = last_seq_.find(stream);
+      if (it == last_seq_.end()) return;
+      seq = it->second;
+    }
+    done_cv_.wait(lock, [&] { return done_seq_ >= seq; });
+  }
+
+  // Drops the bookkeeping of a stream that is being destroyed, once its
+  // callbacks have run.
+  void Forget(C_Stream stream) {
+    Flush(stream);
+    std::lock_guard<std::mutex> lock(mtx_);
+    last_seq_.erase(stream);
+  }
+
  private:
-  std::unordered_map<void *, std::pair<void *, aclrtEvent>> recorded_events_;
+  struct Entry {
+    aclrtEvent event;
+    C_Device_st device;
+    C_Stream stream;
+    C_Callback callback;
+    void *user_data;
+  };
+
+  aclrtEvent AcquireEvent() {
+    if (free_events_.empty()) {
+      aclrtEvent event;
+      ACL_CHECK(aclrtCreateEvent(&event));
+      return event;
+    }
+    aclrtEvent event = free_events_.back();
+    free_events_.pop_back();
+    return event;
+  }
+
+  void Loop() {
+    ACL_CHECK(aclrtSetDevice(dev_id_));
+    std::vector<Entry> batch;
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) break;
+
+      // Entries are only popped by this thread, so the front stays valid
+      // while the lock is released.
+      aclrtEvent event = queue_.front().event;
+      lock.unlock();
+      ACL_CHECK(aclrtSynchronizeEvent(event));
+      lock.lock();
+      batch.push_back(queue_.front());
+      queue_.pop_front();
+      while (!queue_.empty()) {
+        aclrtEventStatus status = ACL_EVENT_STATUS_COMPLETE;
+        ACL_CHECK(aclrtQueryEvent(queue_.front().event, &status));
+        if (status != ACL_EVENT_STATUS_COMPLETE) break;
+        batch.push_back(queue_.front());
+        queue_.pop_front();
+      }
+      lock.unlock();
+
+      for (auto &entry : batch) {
+        C_Status ret = C_SUCCESS;
+        entry.callback(&entry.device, entry.stream, entry.user_data, &ret);
+        if (ret != C_SUCCESS) {
+          LOG(ERROR) << "Stream callback on device " << dev_id_
+                     << " failed with status " << ret;
+        }
+      }
+
+      lock.lock();
+      for (auto &entry : batch) free_events_.push_back(entry.event);
+      done_seq_ += batch.size();
+      batch.clear();
+      done_cv_.notify_all();
+    }
+  }
+
+  const size_t dev_id_;
   std::mutex mtx_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  std::deque<Entry> queue_;
+  std::vector<aclrtEvent> free_events_;
+  std::unordered_map<C_Stream, uint64_t> last_seq_;
+  uint64_t queued_seq_ = 0;
+  uint64_t done_seq_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
 };
 
-class AlignnedAllocatorList {
+template <typename T>
+class PerDeviceList {
  public:
-  explicit AlignnedAllocatorList(size_t device_count)
-      : allocator_list(device_count, nullptr) {}
+  explicit PerDeviceList(size_t device_count) : list_(device_count, nullptr) {}
 
-  void Init(size_t dev_id) { allocator_list[dev_id] = new AlignnedAllocator; }
+  ~PerDeviceList() {
+    for (auto item : list_) delete item;
+  }
 
-  void Deinit(size_t dev_id) {
-    delete allocator_list[dev_id];
-    allocator_list[dev_id] = nullptr;
+  template <typename... Args>
+  void Init(size_t dev_id, Args &&...args) {
+    list_[dev_id] = new T(std::forward<Args>(args)...);
   }
 
-  AlignnedAllocator *GetAllocator(size_t dev_id) {
-    return allocator_list[dev_id];
+  void Deinit(size_t dev_id) {
+    delete list_[dev_id];
+    list_[dev_id] = nullptr;
   }
 
+  T *Get(size_t dev_id) { return list_[dev_id]; }
+
  private:
-  std::vector<AlignnedAllocator *> allocator_list;
+  std::vector<T *> list_;
 };
 
-static AlignnedAllocatorList *global_allocator_list = nullptr;
+static PerDeviceList<PinnedStagingPool> *global_staging_pools = nullptr;
+static PerDeviceList<StreamCallbackQueue> *global_callback_queues = nullptr;
+static StreamSyncHook global_stream_sync_hook = nullptr;
 
-inline size_t get_current_device_id() {
-  int dev_id = 0;
-  ACL_CHECK(aclrtGetDevice(&dev_id));
-  return dev_id;
+void SetStreamSyncHook(StreamSyncHook hook) { global_stream_sync_hook = hook; }
+
+static DeviceWriteHook global_device_write_hook = nullptr;
+
+void SetDeviceWriteHook(DeviceWriteHook hook) {
+  global_device_write_hook = hook;
+}
+
+inline void NotifyDeviceWrite(const void *ptr, size_t size) {
+  if (global_device_write_hook && size > 0) {
+    global_device_write_hook(ptr, size);
+  }
 }
 
+// Host memory handed out by HostAllocate is already pinned; H2D copies from
+// it can skip the staging buffer.
+class PinnedRanges {
+ public:
+  static PinnedRanges &Instance() {
+    static PinnedRanges ins;
+    return ins;
+  }
+
+  void Add(void *ptr, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranges_[reinterpret_cast<uintptr_t>(ptr)] = size;
+  }
+
+  void Remove(void *ptr) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranges_.erase(reinterpret_cast<uintptr_t>(ptr));
+  }
+
+  bool Contains(const void *ptr, size_t size) {
+    const auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = ranges_.upper_bound(addr);
+    if (it == ranges_.begin()) return false;
+    --it;
+    return addr + size <= it->first + it->second;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::map<uintptr_t, size_t> ranges_;
+};
+
+// Ranks of the communicators created by XcclCommInitRank, needed to order
+// point-to-point ops, to tell the root of a reduce and to size the output
+// of an all-gather.
+class CommRanks {
+ public:
+  static CommRanks &Instance() {
+    static CommRanks ins;
+    return ins;
+  }
+
+  void Add(C_CCLComm comm, size_t rank, size_t nranks) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranks_[comm] = {rank, nranks};
+  }
+
+  void Remove(C_CCLComm comm) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ranks_.erase(comm);
+  }
+
+  bool Get(C_CCLComm comm, size_t *rank) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = ranks_.find(comm);
+    if (it == ranks_.end()) return false;
+    *rank = it->second.first;
+    return true;
+  }
+
+  // Number of ranks of comm, 1 if it is unknown.
+  size_t Size(C_CCLComm comm) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = ranks_.find(comm);
+    return it == ranks_.end() ? 1 : it->second.second;
+  }
+
+ private:
+  std::mutex mtx_;
+  // Rank and number of ranks of each communicator.
+  std::unordered_map<C_CCLComm, std::pair<size_t, size_t>> ranks_;
+};
+
+// One device buffer per stream for fused all-reduces and for the unused
+// result of a reduce on non-root ranks. Work on a stream runs in order, so
+// reusing the buffer for the next collective on the same stream is safe;
+// growing it waits for the stream before freeing the old one.
+class XcclScratch {
+ public:
+  static XcclScratch &Instance() {
+    static XcclScratch ins;
+    return ins;
+  }
+
+  void *Get(aclrtStream stream, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto &buffer = buffers_[stream];
+    if (buffer.size < size) {
+      if (buffer.ptr) {
+        ACL_CHECK(aclrtSynchronizeStream(stream));
+        ACL_CHECK(aclrtFree(buffer.ptr));
+      }
+      ACL_CHECK(aclrtMalloc(&buffer.ptr, size, ACL_MEM_MALLOC_HUGE_FIRST));
+      buffer.size = size;
+    }
+    return buffer.ptr;
+  }
+
+  void Release(aclrtStream stream) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = buffers_.find(stream);
+    if (it == buffers_.end()) return;
+    ACL_CHECK(aclrtSynchronizeStream(stream));
+    ACL_CHECK(aclrtFree(it->second.ptr));
+    buffers_.erase(it);
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto &buffer : buffers_) {
+      ACL_CHECK(aclrtSynchronizeStream(buffer.first));
+      ACL_CHECK(aclrtFree(buffer.second.ptr));
+    }
+    buffers_.clear();
+  }
+
+ private:
+  struct Buffer {
+    void *ptr = nullptr;
+    size_t size = 0;
+  };
+
+  std::mutex mtx_;
+  std::unordered_map<aclrtStream, Buffer> buffers_;
+};
+
 inline size_t get_devices_count() {
   uint32_t count = 0;
   aclrtGetDeviceCount(&count);
   return static_cast<size_t>(count);
 }
 
+// Peer access each card enabled toward the others in InitDevice. Cards that
+// cannot reach each other, or whose enabling failed, copy through host
+// memory instead.
+class PeerAccess {
+ public:
+  static PeerAccess &Instance() {
+    static PeerAccess ins;
+    return ins;
+  }
+
+  // Called with device current.
+  void Enable(int device, int count) {
+    for (int peer = 0; peer < count; ++peer) {
+      if (peer == device) continue;
+      int32_t can_access = 0;
+      bool ok =
+          aclrtDeviceCanAccessPeer(&can_access, device, peer) ==
+              ACL_ERROR_NONE &&
+          can_access != 0 &&
+          aclrtDeviceEnablePeerAccess(peer, 0) == ACL_ERROR_NONE;
+      VLOG(3) << "NPU peer access from " << device << " to " << peer << ": "
+              << ok;
+      std::lock_guard<std::mutex> lock(mtx_);
+      enabled_[{device, peer}] = ok;
+    }
+  }
+
+  // Called with device current.
+  void Disable(int device) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto it = enabled_.begin(); it != enabled_.end();) {
+      if (it->first.first != device) {
+        ++it;
+        continue;
+      }
+      if (it->second) aclrtDeviceDisablePeerAccess(it->first.second);
+      it = enabled_.erase(it);
+    }
+  }
+
+  // Whether the current card, one of the two, can copy between them
+  // directly.
+  bool CanCopy(int dst_device, int src_device) {
+    const int device = get_current_device_id();
+    if (device != dst_device && device != src_device) return false;
+    const int peer = device == dst_device ? src_device : dst_device;
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = enabled_.find({device, peer});
+    return it != enabled_.end() && it->second;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::map<std::pair<int, int>, bool> enabled_;
+};
+
 C_Status Init() {
   ACL_CHECK(aclInit(nullptr));
   size_t count = get_devices_count();
   if (count) {
-    global_allocator_list = new AlignnedAllocatorList(count);
+    global_staging_pools = new PerDeviceList<PinnedStagingPool>(count);
+    global_callback_queues = new PerDeviceList<StreamCallbackQueue>(count);
   }
   return C_SUCCESS;
 }
 
 C_Status InitDevice(const C_Device device) {
   ACL_CHECK(aclrtSetDevice(device->id));
-  if (global_allocator_list) {
-    global_allocator_list->Init(device->id);
+  if (global_staging_pools) {
+    global_staging_pools->Init(device->id);
+    global_callback_queues->Init(device->id, device->id);
   }
+  PeerAccess::Instance().Enable(device->id, get_devices_count());
   return C_SUCCESS;
 }
 
@@ -141,19 +630,24 @@ C_Status GetDevice(const C_Device device) {
 
 C_Status ReleaseDevice(const C_Device device) {
   ACL_CHECK(aclrtSetDevice(device->id));
-  if (global_allocator_list) {
-    // global_allocator_list->GetAllocator(device->id)->ClearEvent();
-    global_allocator_list->Deinit(device->id);
+  PeerAccess::Instance().Disable(device->id);
+  if (global_staging_pools) {
+    global_callback_queues->Deinit(device->id);
+    global_staging_pools->Deinit(device->id);
   }
   // ACL_CHECK(aclrtResetDevice(device->id));
   return C_SUCCESS;
 }
 
 C_Status Finalize() {
-  if (global_allocator_list) {
-    delete global_allocator_list;
-    global_allocator_list = nullptr;
+  if (global_stream_sync_hook) global_stream_sync_hook(nullptr, true);
+  if (global_staging_pools) {
+    delete global_callback_queues;
+    global_callback_queues = nullptr;
+    delete global_staging_pools;
+    global_staging_pools = nullptr;
   }
+  XcclScratch::Instance().Clear();
   // ACL_CHECK(aclFinalize());
   return C_SUCCESS;
 }
@@ -176,6 +670,7 @@ C_Status MemCpyH2D(const C_Device device,
                    const void *src,
                    size_t size) {
   if (dst == nullptr && size == 0) return C_SUCCESS;
+  NotifyDeviceWrite(dst, size);
   ACL_CHECK(aclrtMemcpy(dst, size, src, size, ACL_MEMCPY_HOST_TO_DEVICE));
   return C_SUCCESS;
 }
@@ -184,6 +679,7 @@ C_Status MemCpyD2D(const C_Device device,
                    void *dst,
                    const void *src,
                    size_t size) {
+  NotifyDeviceWrite(dst, size);
   ACL_CHECK(aclrtMemcpy(dst, size, src, size, ACL_MEMCPY_DEVICE_TO_DEVICE));
   return C_SUCCESS;
 }
@@ -202,15 +698,19 @@ C_Status AsyncMemCpyH2D(const C_Device device,
                         void *dst,
                         const void *src,
                         size_t size) {
-  auto allocator = global_allocator_list->GetAllocator(get_current_device_id());
-  void *tmp = allocator->Alloc(size, 64);
-  aclrtEvent event;
-  ACL_CHECK(aclrtCreateEvent(&event));
-  memcpy(tmp, src, size);
-  ACL_CHECK(aclrtMemcpyAsync(
-      dst, size, tmp, size, ACL_MEMCPY_HOST_TO_DEVICE, (aclrtStream)(stream)));
-  ACL_CHECK(aclrtRecordEvent(event, (aclrtStream)(stream)));
-  allocator->Record(tmp, event);
+  if (size == 0) return C_SUCCESS;
+  NotifyDeviceWrite(dst, size);
+  if (PinnedRanges::Instance().Contains(src, size)) {
+    ACL_CHECK(aclrtMemcpyAsync(dst,
+                               size,
+                               src,
+                               size,
+                               ACL_MEMCPY_HOST_TO_DEVICE,
+                               reinterpret_cast<aclrtStream>(stream)));
+    return C_SUCCESS;
+  }
+  global_staging_pools->Get(get_current_device_id())
+      ->StageAndCopy(dst, src, size, reinterpret_cast<aclrtStream>(stream));
   return C_SUCCESS;
 }
 
@@ -219,6 +719,7 @@ C_Status AsyncMemCpyD2D(const C_Device device,
                         void *dst,
                         const void *src,
                         size_t size) {
+  NotifyDeviceWrite(dst, size);
   ACL_CHECK(aclrtMemcpyAsync(dst,
                              size,
                              src,
@@ -238,6 +739,53 @@ C_Status AsyncMemCpyD2H(const C_Device device,
   return C_SUCCESS;
 }
 
+C_Status MemCpyP2P(const C_Device dst_device,
+                   const C_Device src_device,
+                   void *dst,
+                   const void *src,
+                   size_t size) {
+  if (size == 0) return C_SUCCESS;
+  if (dst_device->id == src_device->id) {
+    return MemCpyD2D(dst_device, dst, src, size);
+  }
+  NotifyDeviceWrite(dst, size);
+  if (PeerAccess::Instance().CanCopy(dst_device->id, src_device->id)) {
+    ACL_CHECK(aclrtMemcpy(dst, size, src, size, ACL_MEMCPY_DEVICE_TO_DEVICE));
+    return C_SUCCESS;
+  }
+  global_staging_pools->Get(get_current_device_id())
+      ->Bounce(dst_device->id, dst, src_device->id, src, size);
+  return C_SUCCESS;
+}
+
+C_Status AsyncMemCpyP2P(const C_Device dst_device,
+                        const C_Device src_device,
+                        C_Stream stream,
+                        void *dst,
+                        const void *src,
+                        size_t size) {
+  if (size == 0) return C_SUCCESS;
+  if (dst_device->id == src_device->id) {
+    return AsyncMemCpyD2D(dst_device, stream, dst, src, size);
+  }
+  NotifyDeviceWrite(dst, size);
+  if (PeerAccess::Instance().CanCopy(dst_device->id, src_device->id)) {
+    ACL_CHECK(aclrtMemcpyAsync(dst,
+                               size,
+                               src,
+                               size,
+                               ACL_MEMCPY_DEVICE_TO_DEVICE,
+                               reinterpret_cast<aclrtStream>(stream)));
+    return C_SUCCESS;
+  }
+  // The host bounce is synchronous, so the work producing src has to be
+  // done first.
+  ACL_CHECK(aclrtSynchronizeStream(reinterpret_cast<aclrtStream>(stream)));
+  global_staging_pools->Get(get_current_device_id())
+      ->Bounce(dst_device->id, dst, src_device->id, src, size);
+  return C_SUCCESS;
+}
+
 C_Status Allocate(const C_Device device, void **ptr, size_t size) {
   ACL_CHECK(aclrtSetDevice(device->id));
   void *data;
@@ -256,6 +804,7 @@ C_Status HostAllocate(const C_Device device, void **ptr, size_t size) {
   void *data = nullptr;
   ACL_CHECK(aclrtMallocHost(&data, size));
   if (data) {
+    PinnedRanges::Instance().Add(data, size);
     *ptr = data;
     return C_SUCCESS;
   } else {
@@ -271,6 +820,7 @@ C_Status Deallocate(const C_Device device, void *ptr, size_t size) {
 }
 
 C_Status HostDeallocate(const C_Device device, void *ptr, size_t size) {
+  PinnedRanges::Instance().Remove(ptr);
   ACL_CHECK(aclrtFreeHost(ptr));
   return C_SUCCESS;
 }
@@ -281,6 +831,13 @@ C_Status CreateStream(const C_Device device, C_Stream *stream) {
 }
 
 C_Status DestroyStream(const C_Device device, C_Stream stream) {
+  if (global_stream_sync_hook) {
+    global_stream_sync_hook(reinterpret_cast<aclrtStream>(stream), true);
+  }
+  XcclScratch::Instance().Release(reinterpret_cast<aclrtStream>(stream));
+  if (global_callback_queues && global_callback_queues->Get(device->id)) {
+    global_callback_queues->Get(device->id)->Forget(stream);
+  }
   ACL_CHECK(aclrtDestroyStream(reinterpret_cast<aclrtStream>(stream)));
   return C_SUCCESS;
 }
@@ -303,11 +860,21 @@ C_Status DestroyEvent(const C_Device device, C_Event event) {
 
 C_Status SyncDevice(const C_Device device) {
   ACL_CHECK(aclrtSynchronizeDevice());
+  if (global_callback_queues && global_callback_queues->Get(device->id)) {
+    global_callback_queues->Get(device->id)->Flush(nullptr);
+  }
+  if (global_stream_sync_hook) global_stream_sync_hook(nullptr, false);
   return C_SUCCESS;
 }
 
 C_Status SyncStream(const C_Device device, C_Stream stream) {
   ACL_CHECK(aclrtSynchronizeStream(reinterpret_cast<aclrtStream>(stream)));
+  if (global_callback_queues && global_callback_queues->Get(device->id)) {
+    global_callback_queues->Get(device->id)->Flush(stream);
+  }
+  if (global_stream_sync_hook) {
+    global_stream_sync_hook(reinterpret_cast<aclrtStream>(stream), false);
+  }
   return C_SUCCESS;
 }
 
@@ -328,9 +895,12 @@ C_Status AddCallback(const C_Device device,
                      C_Stream stream,
                      C_Callback callback,
                      void *user_data) {
-  C_Status ret = C_SUCCESS;
-  callback(device, stream, user_data, &ret);
-  return ret;
+  if (!global_callback_queues || !global_callback_queues->Get(device->id)) {
+    return C_FAILED;
+  }
+  global_callback_queues->Get(device->id)->Add(
+      device, stream, callback, user_data);
+  return C_SUCCESS;
 }
 
 C_Status DeviceMemStats(const C_Device device,
@@ -381,6 +951,315 @@ HcclReduceOp PDReduceOpToHcclReduceOp(C_CCLReduceOp op) {
   }
 }
 
+size_t CDataTypeSize(C_DataType dtype) {
+  switch (dtype) {
+    case C_DataType::INT8:
+      return 1;
+    case C_DataType::FLOAT16:
+      return 2;
+    case C_DataType::FLOAT32:
+    case C_DataType::INT32:
+      return 4;
+    case C_DataType::INT64:
+      return 8;
+    default:
+      LOG(ERROR) << "Datatype " << dtype << " in hccl is not supported.";
+      return 0;
+  }
+}
+
+// Same rule as Alignment in kernels/coalesce_tensor_kernel.cc: 32 bytes of
+// tail required by ascendcl, rounded up to the 512 byte chunk size.
+size_t XcclFusionAlignment(size_t size) {
+  constexpr size_t kAlignment = 1 << 9;
+  size += 32;
+  size_t remaining = size % kAlignment;
+  return remaining == 0 ? size : size + (kAlignment - remaining);
+}
+
+struct XcclTask {
+  enum Kind {
+    kAllReduce,
+    kReduce,
+    kBroadcast,
+    kAllGather,
+    kReduceScatter,
+    kSend,
+    kRecv,
+  };
+
+  Kind kind;
+  void *send_buf;
+  void *recv_buf;
+  size_t count;
+  C_DataType data_type;
+  C_CCLReduceOp op;
+  size_t peer;  // root of broadcast and reduce, peer of send and recv
+  C_CCLComm comm;
+  C_Stream stream;
+
+  size_t Bytes() const { return count * CDataTypeSize(data_type); }
+};
+
+// Reduce is not offered by HCCL, so it is an all-reduce whose result is
+// only kept on the root.
+C_Status IssueReduce(const XcclTask &task) {
+  size_t rank = 0;
+  if (!CommRanks::Instance().Get(task.comm, &rank)) {
+    LOG(ERROR) << "xccl_reduce got a communicator of unknown rank.";
+    return C_FAILED;
+  }
+  auto stream = reinterpret_cast<aclrtStream>(task.stream);
+  void *recv_buf = rank == task.peer
+                       ? task.recv_buf
+                       : XcclScratch::Instance().Get(stream, task.Bytes());
+  HCCL_CHECK(HcclAllReduce(task.send_buf,
+                           recv_buf,
+                           task.count,
+                           PDDataTypeToHcclDataType(task.data_type),
+                           PDReduceOpToHcclReduceOp(task.op),
+                           reinterpret_cast<HcclComm>(task.comm),
+                           stream));
+  return C_SUCCESS;
+}
+
+C_Status IssueXcclTask(const XcclTask &task) {
+  auto dtype = PDDataTypeToHcclDataType(task.data_type);
+  auto comm = reinterpret_cast<HcclComm>(task.comm);
+  auto stream = reinterpret_cast<aclrtStream>(task.stream);
+  switch (task.kind) {
+    case XcclTask::kAllReduce:
+      HCCL_CHECK(HcclAllReduce(task.send_buf,
+                               task.recv_buf,
+                               task.count,
+                               dtype,
+                               PDReduceOpToHcclReduceOp(task.op),
+                               comm,
+                               stream));
+      break;
+    case XcclTask::kReduce:
+      return IssueReduce(task);
+    case XcclTask::kBroadcast:
+      HCCL_CHECK(HcclBroadcast(task.send_buf,
+                               task.count,
+                               dtype,
+                               static_cast<uint32_t>(task.peer),
+                               comm,
+                               stream));
+      break;
+    case XcclTask::kAllGather:
+      HCCL_CHECK(HcclAllGather(
+          task.send_buf, task.recv_buf, task.count, dtype, comm, stream));
+      break;
+    case XcclTask::kReduceScatter:
+      HCCL_CHECK(HcclReduceScatter(task.send_buf,
+                                   task.recv_buf,
+                                   task.count,
+                                   dtype,
+                                   PDReduceOpToHcclReduceOp(task.op),
+                                   comm,
+                                   stream));
+      break;
+    case XcclTask::kSend:
+      HCCL_CHECK(HcclSend(task.send_buf,
+                          task.count,
+                          dtype,
+                          static_cast<uint32_t>(task.peer),
+                          comm,
+                          stream));
+      break;
+    case XcclTask::kRecv:
+      HCCL_CHECK(HcclRecv(task.recv_buf,
+                          task.count,
+                          dtype,
+                          static_cast<uint32_t>(task.peer),
+                          comm,
+                          stream));
+      break;
+  }
+  return C_SUCCESS;
+}
+
+// All-reduces and reduces packed into the scratch buffer of their stream
+// and reduced with a single HcclAllReduce.
+C_Status IssueFusedAllReduce(const std::vector<XcclTask> &tasks) {
+  if (tasks.size() == 1) return IssueXcclTask(tasks[0]);
+
+  const auto &first = tasks[0];
+  const size_t elem = CDataTypeSize(first.data_type);
+  auto stream = reinterpret_cast<aclrtStream>(first.stream);
+  size_t rank = 0;
+  CommRanks::Instance().Get(first.comm, &rank);
+
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  for (const auto &task : tasks) {
+    offsets.push_back(total);
+    total += XcclFusionAlignment(task.Bytes());
+  }
+  auto *buffer =
+      static_cast<uint8_t *>(XcclScratch::Instance().Get(stream, total));
+  // Keep the padding finite, it is reduced along with the data.
+  ACL_CHECK(aclrtMemsetAsync(buffer, total, 0, total, stream));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (tasks[i].count == 0) continue;
+    ACL_CHECK(aclrtMemcpyAsync(buffer + offsets[i],
+                               tasks[i].Bytes(),
+                               tasks[i].send_buf,
+                               tasks[i].Bytes(),
+                               ACL_MEMCPY_DEVICE_TO_DEVICE,
+                               stream));
+  }
+  HCCL_CHECK(HcclAllReduce(buffer,
+                           buffer,
+                           total / elem,
+                           PDDataTypeToHcclDataType(first.data_type),
+                           PDReduceOpToHcclReduceOp(first.op),
+                           reinterpret_cast<HcclComm>(first.comm),
+                           stream));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const auto &task = tasks[i];
+    if (task.count == 0 ||
+        (task.kind == XcclTask::kReduce && task.peer != rank)) {
+      continue;
+    }
+    ACL_CHECK(aclrtMemcpyAsync(task.recv_buf,
+                               task.Bytes(),
+                               buffer + offsets[i],
+                               task.Bytes(),
+                               ACL_MEMCPY_DEVICE_TO_DEVICE,
+                               stream));
+  }
+  return C_SUCCESS;
+}
+
+ENV_uint64(npu_xccl_fusion_bucket_bytes, 32UL << 20);
+
+// Collectives issued between XcclGroupStart and XcclGroupEnd on a thread.
+// They are queued and issued by the outermost XcclGroupEnd:
+// - All-reduces and reduces with the same communicator, stream, data type
+//   and reduce op are packed into buckets of at most
+//   FLAGS_npu_xccl_fusion_bucket_bytes and reduced once per bucket. A
+//   bucket takes the place of its first member; 0 disables fusion.
+// - Other collectives keep their order.
+// - Sends and recvs follow the collectives, ordered by communicator and
+//   peer rank. With each peer the lower rank sends first and the higher
+//   rank receives first, so the blocking pairs of all ranks line up.
+// The same group issued on every rank produces the same sequence, which is
+// what keeps the collectives matched across ranks.
+class XcclGroup {
+ public:
+  static XcclGroup &Current() {
+    thread_local XcclGroup group;
+    return group;
+  }
+
+  bool Active() const { return depth_ > 0; }
+
+  void Start() { ++depth_; }
+
+  void Add(const XcclTask &task) { tasks_.push_back(task); }
+
+  C_Status End() {
+    if (depth_ == 0) {
+      LOG(ERROR) << "xccl_group_end is called without xccl_group_start.";
+      return C_FAILED;
+    }
+    if (--depth_ > 0) return C_SUCCESS;
+
+    std::vector<XcclTask> tasks;
+    tasks.swap(tasks_);
+    std::vector<XcclTask> p2p;
+    // Units issued in order, each either one task or one fused bucket.
+    std::vector<std::vector<XcclTask>> units;
+    std::map<std::tuple<C_CCLComm, C_Stream, int, int>, size_t> open_buckets;
+    std::vector<size_t> bucket_bytes;
+    for (const auto &task : tasks) {
+      if (task.kind == XcclTask::kSend || task.kind == XcclTask::kRecv) {
+        p2p.push_back(task);
+        continue;
+      }
+      const size_t bytes = XcclFusionAlignment(task.Bytes());
+      if ((task.kind != XcclTask::kAllReduce &&
+           task.kind != XcclTask::kReduce) ||
+          bytes > FLAGS_npu_xccl_fusion_bucket_bytes) {
+        units.push_back({task});
+        bucket_bytes.push_back(0);
+        continue;
+      }
+      auto key = std::make_tuple(task.comm,
+                                 task.stream,
+                                 static_cast<int>(task.data_type),
+                                 static_cast<int>(task.op));
+      auto it = open_buckets.find(key);
+      if (it != open_buckets.end() &&
+          bucket_bytes[it->second] + bytes <=
+              FLAGS_npu_xccl_fusion_bucket_bytes) {
+        units[it->second].push_back(task);
+        bucket_bytes[it->second] += bytes;
+        continue;
+      }
+      open_buckets[key] = units.size();
+      units.push_back({task});
+      bucket_bytes.push_back(bytes);
+    }
+
+    for (const auto &unit : units) {
+      C_Status ret = IssueFusedAllReduce(unit);
+      if (ret != C_SUCCESS) return ret;
+    }
+    return IssuePointToPoint(&p2p);
+  }
+
+ private:
+  static C_Status IssuePointToPoint(std::vector<XcclTask> *tasks) {
+    std::vector<C_CCLComm> comms;
+    for (const auto &task : *tasks) {
+      if (std::find(comms.begin(), comms.end(), task.comm) == comms.end()) {
+        comms.push_back(task.comm);
+      }
+    }
+    auto order = [&](const XcclTask &task) {
+      size_t rank = 0;
+      CommRanks::Instance().Get(task.comm, &rank);
+      bool send_first = rank < task.peer;
+      bool is_send = task.kind == XcclTask::kSend;
+      size_t comm_index =
+          std::find(comms.begin(), comms.end(), task.comm) - comms.begin();
+      return std::make_tuple(comm_index, task.peer, is_send != send_first);
+    };
+    std::stable_sort(tasks->begin(),
+                     tasks->end(),
+                     [&](const XcclTask &a, const XcclTask &b) {
+                       return order(a) < order(b);
+                     });
+    for (const auto &task : *tasks) {
+      C_Status ret = IssueXcclTask(task);
+      if (ret != C_SUCCESS) return ret;
+    }
+    return C_SUCCESS;
+  }
+
+  int depth_ = 0;
+  std::vector<XcclTask> tasks_;
+};
+
+C_Status SubmitXcclTask(const XcclTask &task) {
+  if (task.recv_buf) {
+    size_t bytes = task.Bytes();
+    if (task.kind == XcclTask::kAllGather) {
+      bytes *= CommRanks::Instance().Size(task.comm);
+    }
+    NotifyDeviceWrite(task.recv_buf, bytes);
+  }
+  auto &group = XcclGroup::Current();
+  if (group.Active()) {
+    group.Add(task);
+    return C_SUCCESS;
+  }
+  return IssueXcclTask(task);
+}
+
 C_Status XcclGetUniqueIdSize(size_t *size) {
   *size = sizeof(HcclRootInfo);
   return C_SUCCESS;
@@ -405,10 +1284,12 @@ C_Status XcclCommInitRank(size_t nranks,
                            reinterpret_cast<HcclRootInfo *>(unique_id->data),
                            rank,
                            reinterpret_cast<HcclComm *>(comm)));
+  CommRanks::Instance().Add(*comm, rank, nranks);
   return C_SUCCESS;
 }
 
 C_Status XcclDestroyComm(C_CCLComm comm) {
+  CommRanks::Instance().Remove(comm);
   HCCL_CHECK(HcclCommDestroy(reinterpret_cast<HcclComm>(comm)));
   return C_SUCCESS;
 }
@@ -420,14 +1301,15 @@ C_Status XcclAllReduce(void *send_buf,
                        C_CCLReduceOp op,
                        C_CCLComm comm,
                        C_Stream stream) {
-  HCCL_CHECK(HcclAllReduce(send_buf,
-                           recv_buf,
-                           count,
-                           PDDataTypeToHcclDataType(data_type),
-                           PDReduceOpToHcclReduceOp(op),
-                           reinterpret_cast<HcclComm>(comm),
-                           reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kAllReduce,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclBroadcast(void *buf,
@@ -436,13 +1318,15 @@ C_Status XcclBroadcast(void *buf,
                        size_t root,
                        C_CCLComm comm,
                        C_Stream stream) {
-  HCCL_CHECK(HcclBroadcast(buf,
-                           count,
-                           PDDataTypeToHcclDataType(data_type),
-                           static_cast<uint32_t>(root),
-                           reinterpret_cast<HcclComm>(comm),
-                           reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kBroadcast,
+                         buf,
+                         buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         root,
+                         comm,
+                         stream});
 }
 
 C_Status XcclReduce(void *send_buf,
@@ -453,8 +1337,15 @@ C_Status XcclReduce(void *send_buf,
                     size_t root,
                     C_CCLComm comm,
                     C_Stream stream) {
-  LOG(ERROR) << "xccl_reduce is not supported on ascend npu device.";
-  return C_ERROR;
+  return SubmitXcclTask({XcclTask::kReduce,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         root,
+                         comm,
+                         stream});
 }
 
 C_Status XcclAllGather(void *send_buf,
@@ -463,13 +1354,15 @@ C_Status XcclAllGather(void *send_buf,
                        C_DataType data_type,
                        C_CCLComm comm,
                        C_Stream stream) {
-  HCCL_CHECK(HcclAllGather(send_buf,
-                           recv_buf,
-                           count,
-                           PDDataTypeToHcclDataType(data_type),
-                           reinterpret_cast<HcclComm>(comm),
-                           reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kAllGather,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclReduceScatter(void *send_buf,
@@ -479,25 +1372,23 @@ C_Status XcclReduceScatter(void *send_buf,
                            C_CCLReduceOp op,
                            C_CCLComm comm,
                            C_Stream stream) {
-  HCCL_CHECK(HcclReduceScatter(send_buf,
-                               recv_buf,
-                               count,
-                               PDDataTypeToHcclDataType(data_type),
-                               PDReduceOpToHcclReduceOp(op),
-                               reinterpret_cast<HcclComm>(comm),
-                               reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kReduceScatter,
+                         send_buf,
+                         recv_buf,
+                         count,
+                         data_type,
+                         op,
+                         0,
+                         comm,
+                         stream});
 }
 
 C_Status XcclGroupStart() {
-  LOG(ERROR) << "xccl_group_start is not supported on ascend npu device.";
-  return C_ERROR;
+  XcclGroup::Current().Start();
+  return C_SUCCESS;
 }
 
-C_Status XcclGroupEnd() {
-  LOG(ERROR) << "xccl_group_end is not supported on ascend npu device.";
-  return C_ERROR;
-}
+C_Status XcclGroupEnd() { return XcclGroup::Current().End(); }
 
 C_Status XcclSend(void *send_buf,
                   size_t count,
@@ -505,13 +1396,15 @@ C_Status XcclSend(void *send_buf,
                   size_t dest_rank,
                   C_CCLComm comm,
                   C_Stream stream) {
-  HCCL_CHECK(HcclSend(send_buf,
-                      count,
-                      PDDataTypeToHcclDataType(data_type),
-                      static_cast<uint32_t>(dest_rank),
-                      reinterpret_cast<HcclComm>(comm),
-                      reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kSend,
+                         send_buf,
+                         nullptr,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         dest_rank,
+                         comm,
+                         stream});
 }
 
 C_Status XcclRecv(void *recv_buf,
@@ -520,13 +1413,15 @@ C_Status XcclRecv(void *recv_buf,
                   size_t src_rank,
                   C_CCLComm comm,
                   C_Stream stream) {
-  HCCL_CHECK(HcclRecv(recv_buf,
-                      count,
-                      PDDataTypeToHcclDataType(data_type),
-                      static_cast<uint32_t>(src_rank),
-                      reinterpret_cast<HcclComm>(comm),
-                      reinterpret_cast<aclrtStream>(stream)));
-  return C_SUCCESS;
+  return SubmitXcclTask({XcclTask::kRecv,
+                         nullptr,
+                         recv_buf,
+                         count,
+                         data_type,
+                         C_CCLReduceOp::SUM,
+                         src_rank,
+                         comm,
+                         stream});
 }
 
 ENV_string(ascend_profiling_dir, "ascend_profiling");
@@ -618,11 +1513,11 @@ void InitPlugin(CustomRuntimeParams *params) {
   params->interface->memory_copy_h2d = MemCpyH2D;
   params->interface->memory_copy_d2d = MemCpyD2D;
   params->interface->memory_copy_d2h = MemCpyD2H;
-  params->interface->memory_copy_p2p = nullptr;
+  params->interface->memory_copy_p2p = MemCpyP2P;
   params->interface->async_memory_copy_h2d = AsyncMemCpyH2D;
   params->interface->async_memory_copy_d2d = AsyncMemCpyD2D;
   params->interface->async_memory_copy_d2h = AsyncMemCpyD2H;
-  params->interface->async_memory_copy_p2p = nullptr;
+  params->interface->async_memory_copy_p2p = AsyncMemCpyP2P;
   params->interface->device_memory_allocate = Allocate;
   params->interface->host_memory_allocate = HostAllocate;
   params->interface->device_memory_deallocate = Deallocate;
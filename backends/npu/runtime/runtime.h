@@ -81,6 +81,30 @@ C_Status AsyncMemCpyD2H(const C_Device device,
                         void *dst,
                         const void *src,
                         size_t size);
+C_Status MemCpyP2P(const C_Device dst_device,
+                   const C_Device src_device,
+                   void *dst,
+                   const void *src,
+                   size_t size);
+C_Status AsyncMemCpyP2P(const C_Device dst_device,
+                        const C_Device src_device,
+                        C_Stream stream,
+                        void *dst,
+                        const void *src,
+                        size_t size);
+
+// Lets kernel-side state that trails the device settle at synchronization
+// points. The hook runs after a stream, or with a null stream every stream
+// of the device, has been synchronized; with release set it runs before a
+// stream is destroyed and when the runtime is finalized.
+typedef void (*StreamSyncHook)(aclrtStream stream, bool release);
+void SetStreamSyncHook(StreamSyncHook hook);
+
+// Lets kernel-side caches of device memory drop what the runtime overwrites
+// on behalf of the framework. The hook runs with the destination range of
+// every copy to the device and of every collective, before it is issued.
+typedef void (*DeviceWriteHook)(const void *ptr, size_t size);
+void SetDeviceWriteHook(DeviceWriteHook hook);
 
 class AscendProfiler {
  public:
@@ -0,0 +1,164 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Peer copies of the runtime against tools/acl_stub, with two emulated
+// devices and peer access granted, denied or failing to probe.
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "acl/acl.h"
+#include "gtest/gtest.h"
+#include "runtime/runtime.h"
+
+C_Status Init();
+C_Status InitDevice(const C_Device device);
+C_Status ReleaseDevice(const C_Device device);
+C_Status Finalize();
+C_Status CreateStream(const C_Device device, C_Stream *stream);
+C_Status DestroyStream(const C_Device device, C_Stream stream);
+
+namespace {
+
+// Larger than two 4 MiB staging chunks, so bounces take three round trips.
+constexpr size_t kCopyBytes = (8 << 20) + 4096;
+constexpr uint64_t kBounceChunks = 3;
+
+class PeerCopyTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    setenv("ACL_STUB_DEVICE_COUNT", "2", 0);
+    setenv("ACL_STUB_PEER_ACCESS", PeerAccessMode(), 1);
+    ASSERT_EQ(Init(), C_SUCCESS);
+    for (int id = 0; id < 2; ++id) {
+      devices_[id].id = id;
+      ASSERT_EQ(InitDevice(&devices_[id]), C_SUCCESS);
+    }
+    // device 0 is current for the copies.
+    ASSERT_EQ(aclrtSetDevice(0), ACL_ERROR_NONE);
+    ASSERT_EQ(aclrtMalloc(&src_, kCopyBytes, ACL_MEM_MALLOC_HUGE_FIRST),
+              ACL_ERROR_NONE);
+    ASSERT_EQ(aclrtMalloc(&dst_, kCopyBytes, ACL_MEM_MALLOC_HUGE_FIRST),
+              ACL_ERROR_NONE);
+    std::vector<unsigned char> pattern(kCopyBytes);
+    for (size_t i = 0; i < kCopyBytes; ++i) pattern[i] = i * 7 + 1;
+    ASSERT_EQ(aclrtMemcpy(src_,
+                          kCopyBytes,
+                          pattern.data(),
+                          kCopyBytes,
+                          ACL_MEMCPY_HOST_TO_DEVICE),
+              ACL_ERROR_NONE);
+    memset(dst_, 0, kCopyBytes);
+    aclStubReset();
+  }
+
+  void TearDown() override {
+    aclrtFree(src_);
+    aclrtFree(dst_);
+    for (int id = 1; id >= 0; --id) ReleaseDevice(&devices_[id]);
+    Finalize();
+  }
+
+  virtual const char *PeerAccessMode() const = 0;
+
+  // Device memory of the stub is host memory.
+  void ExpectCopied() {
+    EXPECT_EQ(memcmp(dst_, src_, kCopyBytes), 0);
+    int32_t device = -1;
+    aclrtGetDevice(&device);
+    EXPECT_EQ(device, 0);
+  }
+
+  void ExpectDirect() {
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_DEVICE_TO_DEVICE), 1u);
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_DEVICE_TO_HOST), 0u);
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_HOST_TO_DEVICE), 0u);
+  }
+
+  void ExpectBounced() {
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_DEVICE_TO_DEVICE), 0u);
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_DEVICE_TO_HOST), kBounceChunks);
+    EXPECT_EQ(aclStubMemcpyCount(ACL_MEMCPY_HOST_TO_DEVICE), kBounceChunks);
+  }
+
+  void CopyAsync() {
+    C_Stream stream;
+    ASSERT_EQ(CreateStream(&devices_[0], &stream), C_SUCCESS);
+    ASSERT_EQ(AsyncMemCpyP2P(
+                  &devices_[1], &devices_[0], stream, dst_, src_, kCopyBytes),
+              C_SUCCESS);
+    ASSERT_EQ(aclrtSynchronizeStream(reinterpret_cast<aclrtStream>(stream)),
+              ACL_ERROR_NONE);
+    ASSERT_EQ(DestroyStream(&devices_[0], stream), C_SUCCESS);
+  }
+
+  C_Device_st devices_[2];
+  void *src_ = nullptr;
+  void *dst_ = nullptr;
+};
+
+class PeerCopyDirectTest : public PeerCopyTest {
+  const char *PeerAccessMode() const override { return "on"; }
+};
+
+class PeerCopyBounceTest : public PeerCopyTest {
+  const char *PeerAccessMode() const override { return "off"; }
+};
+
+class PeerCopyFailedProbeTest : public PeerCopyTest {
+  const char *PeerAccessMode() const override { return "error"; }
+};
+
+}  // namespace
+
+TEST_F(PeerCopyDirectTest, Sync) {
+  ASSERT_EQ(MemCpyP2P(&devices_[1], &devices_[0], dst_, src_, kCopyBytes),
+            C_SUCCESS);
+  ExpectCopied();
+  ExpectDirect();
+}
+
+TEST_F(PeerCopyDirectTest, Async) {
+  CopyAsync();
+  ExpectCopied();
+  ExpectDirect();
+}
+
+TEST_F(PeerCopyBounceTest, Sync) {
+  ASSERT_EQ(MemCpyP2P(&devices_[1], &devices_[0], dst_, src_, kCopyBytes),
+            C_SUCCESS);
+  ExpectCopied();
+  ExpectBounced();
+}
+
+TEST_F(PeerCopyBounceTest, Async) {
+  CopyAsync();
+  ExpectCopied();
+  ExpectBounced();
+}
+
+TEST_F(PeerCopyFailedProbeTest, Sync) {
+  ASSERT_EQ(MemCpyP2P(&devices_[1], &devices_[0], dst_, src_, kCopyBytes),
+            C_SUCCESS);
+  ExpectCopied();
+  ExpectBounced();
+}
+
+TEST_F(PeerCopyFailedProbeTest, Async) {
+  CopyAsync();
+  ExpectCopied();
+  ExpectBounced();
+}
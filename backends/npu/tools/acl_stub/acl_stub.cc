@@ -0,0 +1,851 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host emulation of the ACL runtime used by the plugin. Device memory is
+// host memory, every stream is a worker thread draining a FIFO of tasks, and
+// aclopCompileAndExecute validates its arguments, counts the launch and
+// returns without computing anything. What remains is the host-side cost of
+// the plugin itself (descriptor construction, attribute packing, casts,
+// allocator traffic), which is what the stub exists to measure. The only
+// device state emulated is the float status register behind the
+// NPU*FloatStatus ops, so the NaN/Inf check can be exercised.
+//
+// Environment:
+//   ACL_STUB_DEVICE_COUNT   number of emulated devices (default 1)
+//   ACL_STUB_DEVICE_MEMORY  bytes reported as device memory (default 32 GiB)
+//   ACL_STUB_NAN_OPS        comma separated op types that raise the float
+//                           status when they run, as if they overflowed
+//   ACL_STUB_PEER_ACCESS    "on" (default): every pair of devices has peer
+//                           access, "off": none has, "error": probing it
+//                           fails. Read on every probe.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "acl/acl.h"
+#include "acl/acl_op_compiler.h"
+#include "acl/acl_prof.h"
+
+struct aclDataBuffer {
+  void *data;
+  size_t size;
+};
+
+struct aclTensorDesc {
+  aclDataType dtype;
+  std::vector<int64_t> dims;
+  aclFormat format;
+  aclMemType placement = ACL_MEMTYPE_DEVICE;
+  std::string name;
+  const void *const_data = nullptr;
+  size_t const_size = 0;
+};
+
+struct aclopAttr {
+  // Values are irrelevant to the stub; names are kept so the cost of
+  // building an attribute set stays comparable to the real library.
+  std::vector<std::string> names;
+};
+
+struct aclprofConfig {
+  std::vector<uint32_t> devices;
+};
+
+struct aclprofStepInfo {};
+
+namespace {
+
+thread_local std::string recent_error;  // NOLINT
+thread_local int32_t current_device = 0;
+std::atomic<uint64_t> launch_count{0};
+std::atomic<uint64_t> memcpy_counts[4];
+std::atomic<float> float_status{0};
+
+aclError Fail(aclError code, const std::string &msg) {
+  recent_error = msg;
+  return code;
+}
+
+size_t EnvSize(const char *name, size_t value) {
+  const char *env = getenv(name);
+  return env ? std::stoull(env) : value;
+}
+
+bool RaisesFloatStatus(const std::string &op_type) {
+  static const std::vector<std::string> ops = [] {
+    std::vector<std::string> ops;
+    const char *env = getenv("ACL_STUB_NAN_OPS");
+    std::string list = env ? env : "";
+    size_t begin = 0;
+    while (begin < list.size()) {
+      size_t end = list.find(',', begin);
+      if (end == std::string::npos) end = list.size();
+      if (end > begin) ops.push_back(list.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    return ops;
+  }();
+  return std::find(ops.begin(), ops.end(), op_type) != ops.end();
+}
+
+uint32_t DeviceCount() {
+  static uint32_t count = EnvSize("ACL_STUB_DEVICE_COUNT", 1);
+  return count;
+}
+
+bool ValidDevice(int32_t device) {
+  return device >= 0 && static_cast<uint32_t>(device) < DeviceCount();
+}
+
+void CountMemcpy(aclrtMemcpyKind kind) {
+  if (kind >= ACL_MEMCPY_HOST_TO_HOST && kind <= ACL_MEMCPY_DEVICE_TO_DEVICE) {
+    ++memcpy_counts[kind];
+  }
+}
+
+// (device, peer) pairs with peer access enabled.
+class PeerAccessTable {
+ public:
+  static PeerAccessTable &Instance() {
+    static PeerAccessTable table;
+    return table;
+  }
+
+  bool Enable(int32_t device, int32_t peer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_.insert({device, peer}).second;
+  }
+
+  bool Disable(int32_t device, int32_t peer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_.erase({device, peer}) != 0;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::set<std::pair<int32_t, int32_t>> enabled_;
+};
+
+class MemoryTracker {
+ public:
+  static MemoryTracker &Instance() {
+    static MemoryTracker tracker;
+    return tracker;
+  }
+
+  void *Alloc(size_t size) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, 64, std::max<size_t>(size, 1)) != 0) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    sizes_[ptr] = size;
+    used_ += size;
+    return ptr;
+  }
+
+  bool Free(void *ptr) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = sizes_.find(ptr);
+      if (it == sizes_.end()) return false;
+      used_ -= it->second;
+      sizes_.erase(it);
+    }
+    free(ptr);
+    return true;
+  }
+
+  size_t used() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<void *, size_t> sizes_;
+  size_t used_ = 0;
+};
+
+class Event {
+ public:
+  // Returns the generation a waiter has to observe, i.e. the value
+  // Complete() will publish once the stream reaches the record point.
+  uint64_t Record() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ++recorded_;
+  }
+
+  void Complete(uint64_t generation) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      completed_ = std::max(completed_, generation);
+    }
+    cv_.notify_all();
+  }
+
+  // Waits for the most recent record, like aclrtSynchronizeEvent.
+  void Wait() { WaitFor(Recorded()); }
+
+  void WaitFor(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return completed_ >= generation; });
+  }
+
+  bool Done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completed_ >= recorded_;
+  }
+
+  uint64_t Recorded() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recorded_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t recorded_ = 0;
+  uint64_t completed_ = 0;
+};
+
+class Stream {
+ public:
+  Stream() : worker_([this] { Loop(); }) {}
+
+  ~Stream() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+
+  void Enqueue(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+      ++pending_;
+    }
+    cv_.notify_all();
+  }
+
+  void Synchronize() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [&] { return pending_ == 0; });
+  }
+
+ private:
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --pending_;
+      }
+      idle_cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void()>> tasks_;
+  size_t pending_ = 0;
+  bool stop_ = false;
+  std::thread worker_;
+};
+
+// Streams are tracked so aclrtSynchronizeDevice can drain all of them.
+class StreamRegistry {
+ public:
+  static StreamRegistry &Instance() {
+    static StreamRegistry registry;
+    return registry;
+  }
+
+  Stream *Create() {
+    auto stream = new Stream();
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.push_back(stream);
+    return stream;
+  }
+
+  bool Destroy(Stream *stream) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = std::find(streams_.begin(), streams_.end(), stream);
+      if (it == streams_.end()) return false;
+      streams_.erase(it);
+    }
+    delete stream;
+    return true;
+  }
+
+  void SynchronizeAll() {
+    std::vector<Stream *> streams;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      streams = streams_;
+    }
+    for (auto stream : streams) stream->Synchronize();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<Stream *> streams_;
+};
+
+// A null stream is the default stream of the device, as in ACL.
+Stream *GetStream(aclrtStream stream) {
+  if (stream) return static_cast<Stream *>(stream);
+  static Stream *default_stream = StreamRegistry::Instance().Create();
+  return default_stream;
+}
+
+size_t ElementCount(const aclTensorDesc *desc) {
+  size_t count = 1;
+  for (auto d : desc->dims) count *= std::max<int64_t>(d, 0);
+  return count;
+}
+
+}  // namespace
+
+extern "C" {
+
+uint64_t aclStubLaunchCount() { return launch_count.load(); }
+
+uint64_t aclStubMemcpyCount(aclrtMemcpyKind kind) {
+  if (kind < ACL_MEMCPY_HOST_TO_HOST || kind > ACL_MEMCPY_DEVICE_TO_DEVICE) {
+    return 0;
+  }
+  return memcpy_counts[kind].load();
+}
+
+void aclStubReset() {
+  launch_count = 0;
+  for (auto &count : memcpy_counts) count = 0;
+}
+
+aclError aclInit(const char *configPath) { return ACL_SUCCESS; }
+
+aclError aclFinalize() {
+  StreamRegistry::Instance().SynchronizeAll();
+  return ACL_SUCCESS;
+}
+
+const char *aclGetRecentErrMsg() {
+  return recent_error.empty() ? nullptr : recent_error.c_str();
+}
+
+size_t aclDataTypeSize(aclDataType dataType) {
+  switch (dataType) {
+    case ACL_INT8:
+    case ACL_UINT8:
+    case ACL_BOOL:
+      return 1;
+    case ACL_FLOAT16:
+    case ACL_BF16:
+    case ACL_INT16:
+    case ACL_UINT16:
+      return 2;
+    case ACL_FLOAT:
+    case ACL_INT32:
+    case ACL_UINT32:
+      return 4;
+    case ACL_INT64:
+    case ACL_UINT64:
+    case ACL_DOUBLE:
+    case ACL_COMPLEX64:
+      return 8;
+    case ACL_COMPLEX128:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+aclDataBuffer *aclCreateDataBuffer(void *data, size_t size) {
+  return new aclDataBuffer{data, size};
+}
+
+aclError aclDestroyDataBuffer(const aclDataBuffer *dataBuffer) {
+  delete dataBuffer;
+  return ACL_SUCCESS;
+}
+
+void *aclGetDataBufferAddr(const aclDataBuffer *dataBuffer) {
+  return dataBuffer ? dataBuffer->data : nullptr;
+}
+
+aclTensorDesc *aclCreateTensorDesc(aclDataType dataType,
+                                   int numDims,
+                                   const int64_t *dims,
+                                   aclFormat format) {
+  if (numDims < 0 || (numDims > 0 && dims == nullptr)) {
+    Fail(ACL_ERROR_INVALID_PARAM, "aclCreateTensorDesc: invalid dims");
+    return nullptr;
+  }
+  auto desc = new aclTensorDesc();
+  desc->dtype = dataType;
+  desc->dims.assign(dims, dims + numDims);
+  desc->format = format;
+  return desc;
+}
+
+void aclDestroyTensorDesc(const aclTensorDesc *desc) { delete desc; }
+
+aclDataType aclGetTensorDescType(const aclTensorDesc *desc) {
+  return desc ? desc->dtype : ACL_DT_UNDEFINED;
+}
+
+size_t aclGetTensorDescElementCount(const aclTensorDesc *desc) {
+  return desc ? ElementCount(desc) : 0;
+}
+
+size_t aclGetTensorDescSize(const aclTensorDesc *desc) {
+  return desc ? ElementCount(desc) * aclDataTypeSize(desc->dtype) : 0;
+}
+
+aclError aclSetTensorFormat(aclTensorDesc *desc, aclFormat format) {
+  if (!desc) return Fail(ACL_ERROR_INVALID_PARAM, "null tensor desc");
+  desc->format = format;
+  return ACL_SUCCESS;
+}
+
+aclError aclSetTensorShape(aclTensorDesc *desc,
+                           int numDims,
+                           const int64_t *dims) {
+  if (!desc || numDims < 0 || (numDims > 0 && dims == nullptr)) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclSetTensorShape: invalid dims");
+  }
+  desc->dims.assign(dims, dims + numDims);
+  return ACL_SUCCESS;
+}
+
+void aclSetTensorDescName(aclTensorDesc *desc, const char *name) {
+  if (desc && name) desc->name = name;
+}
+
+aclError aclSetTensorPlaceMent(aclTensorDesc *desc, aclMemType memType) {
+  if (!desc) return Fail(ACL_ERROR_INVALID_PARAM, "null tensor desc");
+  desc->placement = memType;
+  return ACL_SUCCESS;
+}
+
+aclError aclSetTensorConst(aclTensorDesc *desc,
+                           void *dataBuffer,
+                           size_t length) {
+  if (!desc || !dataBuffer) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclSetTensorConst: null argument");
+  }
+  desc->const_data = dataBuffer;
+  desc->const_size = length;
+  return ACL_SUCCESS;
+}
+
+aclError aclrtSetDevice(int32_t deviceId) {
+  if (deviceId < 0 || static_cast<uint32_t>(deviceId) >= DeviceCount()) {
+    return Fail(ACL_ERROR_INVALID_DEVICE,
+                "invalid device id " + std::to_string(deviceId));
+  }
+  current_device = deviceId;
+  return ACL_SUCCESS;
+}
+
+aclError aclrtResetDevice(int32_t deviceId) {
+  StreamRegistry::Instance().SynchronizeAll();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtGetDevice(int32_t *deviceId) {
+  *deviceId = current_device;
+  return ACL_SUCCESS;
+}
+
+aclError aclrtGetDeviceCount(uint32_t *count) {
+  *count = DeviceCount();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtSynchronizeDevice() {
+  StreamRegistry::Instance().SynchronizeAll();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtDeviceCanAccessPeer(int32_t *canAccessPeer,
+                                  int32_t deviceId,
+                                  int32_t peerDeviceId) {
+  if (!canAccessPeer || !ValidDevice(deviceId) ||
+      !ValidDevice(peerDeviceId) || deviceId == peerDeviceId) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclrtDeviceCanAccessPeer: bad ids");
+  }
+  const char *env = getenv("ACL_STUB_PEER_ACCESS");
+  std::string mode = env ? env : "on";
+  if (mode == "error") {
+    return Fail(ACL_ERROR_FEATURE_UNSUPPORTED,
+                "aclrtDeviceCanAccessPeer: probe disabled by "
+                "ACL_STUB_PEER_ACCESS");
+  }
+  *canAccessPeer = mode == "off" ? 0 : 1;
+  return ACL_SUCCESS;
+}
+
+aclError aclrtDeviceEnablePeerAccess(int32_t peerDeviceId, uint32_t flags) {
+  if (flags != 0 || !ValidDevice(peerDeviceId) ||
+      peerDeviceId == current_device) {
+    return Fail(ACL_ERROR_INVALID_PARAM,
+                "aclrtDeviceEnablePeerAccess: bad peer or flags");
+  }
+  if (!PeerAccessTable::Instance().Enable(current_device, peerDeviceId)) {
+    return Fail(ACL_ERROR_INVALID_PARAM,
+                "aclrtDeviceEnablePeerAccess: already enabled");
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtDeviceDisablePeerAccess(int32_t peerDeviceId) {
+  if (!PeerAccessTable::Instance().Disable(current_device, peerDeviceId)) {
+    return Fail(ACL_ERROR_INVALID_PARAM,
+                "aclrtDeviceDisablePeerAccess: not enabled");
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtCreateStream(aclrtStream *stream) {
+  *stream = StreamRegistry::Instance().Create();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtDestroyStream(aclrtStream stream) {
+  auto s = static_cast<Stream *>(stream);
+  if (!s) return Fail(ACL_ERROR_INVALID_PARAM, "null stream");
+  s->Synchronize();
+  if (!StreamRegistry::Instance().Destroy(s)) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "unknown stream");
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtSynchronizeStream(aclrtStream stream) {
+  GetStream(stream)->Synchronize();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtCreateEvent(aclrtEvent *event) {
+  *event = new Event();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtDestroyEvent(aclrtEvent event) {
+  delete static_cast<Event *>(event);
+  return ACL_SUCCESS;
+}
+
+aclError aclrtRecordEvent(aclrtEvent event, aclrtStream stream) {
+  auto e = static_cast<Event *>(event);
+  if (!e) return Fail(ACL_ERROR_INVALID_PARAM, "null event");
+  const uint64_t generation = e->Record();
+  GetStream(stream)->Enqueue([e, generation] { e->Complete(generation); });
+  return ACL_SUCCESS;
+}
+
+aclError aclrtStreamWaitEvent(aclrtStream stream, aclrtEvent event) {
+  auto e = static_cast<Event *>(event);
+  if (!e) return Fail(ACL_ERROR_INVALID_PARAM, "null event");
+  const uint64_t generation = e->Recorded();
+  GetStream(stream)->Enqueue([e, generation] { e->WaitFor(generation); });
+  return ACL_SUCCESS;
+}
+
+aclError aclrtQueryEvent(aclrtEvent event, aclrtEventStatus *status) {
+  auto e = static_cast<Event *>(event);
+  if (!e) return Fail(ACL_ERROR_INVALID_PARAM, "null event");
+  *status = e->Done() ? ACL_EVENT_STATUS_COMPLETE : ACL_EVENT_STATUS_NOT_READY;
+  return ACL_SUCCESS;
+}
+
+aclError aclrtSynchronizeEvent(aclrtEvent event) {
+  auto e = static_cast<Event *>(event);
+  if (!e) return Fail(ACL_ERROR_INVALID_PARAM, "null event");
+  e->Wait();
+  return ACL_SUCCESS;
+}
+
+aclError aclrtMalloc(void **devPtr, size_t size, aclrtMemMallocPolicy policy) {
+  const size_t total = EnvSize("ACL_STUB_DEVICE_MEMORY", size_t(32) << 30);
+  if (MemoryTracker::Instance().used() + size > total) {
+    return Fail(ACL_ERROR_BAD_ALLOC, "out of emulated device memory");
+  }
+  *devPtr = MemoryTracker::Instance().Alloc(size);
+  return *devPtr ? ACL_SUCCESS
+                 : Fail(ACL_ERROR_BAD_ALLOC, "host allocation failed");
+}
+
+aclError aclrtFree(void *devPtr) {
+  if (!MemoryTracker::Instance().Free(devPtr)) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclrtFree: unknown pointer");
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtMallocHost(void **hostPtr, size_t size) {
+  if (posix_memalign(hostPtr, 64, std::max<size_t>(size, 1)) != 0) {
+    return Fail(ACL_ERROR_BAD_ALLOC, "host allocation failed");
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtFreeHost(void *hostPtr) {
+  free(hostPtr);
+  return ACL_SUCCESS;
+}
+
+aclError aclrtGetMemInfo(aclrtMemAttr attr, size_t *free, size_t *total) {
+  *total = EnvSize("ACL_STUB_DEVICE_MEMORY", size_t(32) << 30);
+  *free = *total - std::min(*total, MemoryTracker::Instance().used());
+  return ACL_SUCCESS;
+}
+
+aclError aclrtMemcpy(void *dst,
+                     size_t destMax,
+                     const void *src,
+                     size_t count,
+                     aclrtMemcpyKind kind) {
+  if (count > destMax) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclrtMemcpy: count > destMax");
+  }
+  // Like the real call this is not ordered against queued stream work;
+  // callers synchronize first.
+  CountMemcpy(kind);
+  if (count) memcpy(dst, src, count);
+  return ACL_SUCCESS;
+}
+
+aclError aclrtMemcpyAsync(void *dst,
+                          size_t destMax,
+                          const void *src,
+                          size_t count,
+                          aclrtMemcpyKind kind,
+                          aclrtStream stream) {
+  if (count > destMax) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclrtMemcpyAsync: count > destMax");
+  }
+  CountMemcpy(kind);
+  if (count) {
+    GetStream(stream)->Enqueue([=] { memcpy(dst, src, count); });
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclrtMemsetAsync(void *devPtr,
+                          size_t maxCount,
+                          int32_t value,
+                          size_t count,
+                          aclrtStream stream) {
+  if (count > maxCount) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclrtMemsetAsync: count > maxCount");
+  }
+  if (count) {
+    GetStream(stream)->Enqueue([=] { memset(devPtr, value, count); });
+  }
+  return ACL_SUCCESS;
+}
+
+aclopAttr *aclopCreateAttr() { return new aclopAttr(); }
+
+void aclopDestroyAttr(const aclopAttr *attr) { delete attr; }
+
+static aclError SetAttr(aclopAttr *attr, const char *name) {
+  if (!attr || !name) return Fail(ACL_ERROR_INVALID_PARAM, "invalid attr");
+  attr->names.emplace_back(name);
+  return ACL_SUCCESS;
+}
+
+aclError aclopSetAttrBool(aclopAttr *attr, const char *name, uint8_t value) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrInt(aclopAttr *attr, const char *name, int64_t value) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrFloat(aclopAttr *attr, const char *name, float value) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrString(aclopAttr *attr,
+                            const char *name,
+                            const char *value) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrDataType(aclopAttr *attr,
+                              const char *name,
+                              aclDataType value) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrListBool(aclopAttr *attr,
+                              const char *name,
+                              int numValues,
+                              const uint8_t *values) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrListInt(aclopAttr *attr,
+                             const char *name,
+                             int numValues,
+                             const int64_t *values) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrListFloat(aclopAttr *attr,
+                               const char *name,
+                               int numValues,
+                               const float *values) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrListString(aclopAttr *attr,
+                                const char *name,
+                                int numValues,
+                                const char **values) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopSetAttrListListInt(aclopAttr *attr,
+                                 const char *name,
+                                 int numLists,
+                                 const int *numValues,
+                                 const int64_t *const values[]) {
+  return SetAttr(attr, name);
+}
+
+aclError aclopCompileAndExecute(const char *opType,
+                                int numInputs,
+                                const aclTensorDesc *const inputDesc[],
+                                const aclDataBuffer *const inputs[],
+                                int numOutputs,
+                                const aclTensorDesc *const outputDesc[],
+                                aclDataBuffer *const outputs[],
+                                const aclopAttr *attr,
+                                aclopEngineType engineType,
+                                aclopCompileType compileFlag,
+                                const char *opPath,
+                                aclrtStream stream) {
+  if (!opType || numInputs < 0 || numOutputs < 0) {
+    return Fail(ACL_ERROR_INVALID_PARAM, "aclopCompileAndExecute: bad args");
+  }
+  for (int i = 0; i < numInputs; ++i) {
+    // Const inputs carry their data in the descriptor.
+    if (!inputDesc[i] ||
+        (!inputs[i] && !inputDesc[i]->const_data &&
+         aclGetTensorDescSize(inputDesc[i]) > 0)) {
+      return Fail(ACL_ERROR_INVALID_PARAM,
+                  std::string(opType) + ": input " + std::to_string(i) +
+                      " has no descriptor or buffer");
+    }
+  }
+  for (int i = 0; i < numOutputs; ++i) {
+    if (!outputDesc[i] || !outputs[i]) {
+      return Fail(ACL_ERROR_INVALID_PARAM,
+                  std::string(opType) + ": output " + std::to_string(i) +
+                      " has no descriptor or buffer");
+    }
+    if (outputs[i]->size < aclGetTensorDescSize(outputDesc[i])) {
+      return Fail(ACL_ERROR_INVALID_PARAM,
+                  std::string(opType) + ": output " + std::to_string(i) +
+                      " buffer is smaller than its descriptor");
+    }
+  }
+  ++launch_count;
+
+  std::string type(opType);
+  if (type == "NPUAllocFloatStatus" || type == "NPUClearFloatStatus") {
+    void *status = outputs[0]->data;
+    size_t size = outputs[0]->size;
+    GetStream(stream)->Enqueue([=] {
+      float_status = 0;
+      memset(status, 0, size);
+    });
+  } else if (type == "NPUGetFloatStatus") {
+    auto *status = static_cast<float *>(inputs[0]->data);
+    GetStream(stream)->Enqueue([=] { status[0] = float_status; });
+  } else if (RaisesFloatStatus(type)) {
+    GetStream(stream)->Enqueue([] { float_status = 1; });
+  }
+  return ACL_SUCCESS;
+}
+
+aclError aclprofInit(const char *profilerResultPath, size_t length) {
+  return ACL_SUCCESS;
+}
+
+aclError aclprofFinalize() { return ACL_SUCCESS; }
+
+aclprofConfig *aclprofCreateConfig(uint32_t *deviceIdList,
+                                   uint32_t deviceNums,
+                                   aclprofAicoreMetrics aicoreMetrics,
+                                   aclprofAicoreEvents *aicoreEvents,
+                                   uint64_t dataTypeConfig) {
+  auto config = new aclprofConfig();
+  config->devices.assign(deviceIdList, deviceIdList + deviceNums);
+  return config;
+}
+
+aclError aclprofDestroyConfig(const aclprofConfig *profilerConfig) {
+  delete profilerConfig;
+  return ACL_SUCCESS;
+}
+
+aclError aclprofStart(const aclprofConfig *profilerConfig) {
+  return ACL_SUCCESS;
+}
+
+aclError aclprofStop(const aclprofConfig *profilerConfig) {
+  return ACL_SUCCESS;
+}
+
+aclprofStepInfo *aclprofCreateStepInfo() { return new aclprofStepInfo(); }
+
+void aclprofDestroyStepInfo(aclprofStepInfo *stepinfo) { delete stepinfo; }
+
+aclError aclprofGetStepTimestamp(aclprofStepInfo *stepInfo,
+                                 aclprofStepTag tag,
+                                 aclrtStream stream) {
+  return ACL_SUCCESS;
+}
+
+}  // extern "C"
@@ -0,0 +1,34 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+# Host-emulated replacement for libascendcl/libhccl/libacl_op_compiler,
+# selected with -DWITH_ACL_STUB=ON. It defines the same variables and
+# targets as cmake/external/ascend.cmake so the plugin links unchanged.
+
+find_package(Threads REQUIRED)
+
+add_library(acl_stub SHARED
+    ${CMAKE_CURRENT_LIST_DIR}/acl_stub.cc
+    ${CMAKE_CURRENT_LIST_DIR}/hccl_stub.cc)
+target_include_directories(acl_stub PUBLIC ${CMAKE_CURRENT_LIST_DIR}/include)
+target_link_libraries(acl_stub PRIVATE Threads::Threads)
+
+include_directories(${CMAKE_CURRENT_LIST_DIR}/include)
+
+set(ascendcl_lib acl_stub)
+set(ascend_hccl_lib "")
+set(acl_op_compiler_lib "")
+add_custom_target(ascend_cl)
+add_dependencies(ascend_cl acl_stub)
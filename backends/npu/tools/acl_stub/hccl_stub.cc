@@ -0,0 +1,148 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Single-rank HCCL emulation on top of the stub streams: with one rank every
+// collective is a copy from the send to the receive buffer (a no-op when
+// they alias), so communication ops still go through the plugin's full host
+// path and stream ordering.
+
+#include <cstring>
+
+#include "acl/acl.h"
+#include "hccl/hccl.h"
+
+namespace {
+
+struct Comm {
+  uint32_t rank;
+};
+
+size_t HcclDataTypeSize(HcclDataType type) {
+  switch (type) {
+    case HCCL_DATA_TYPE_INT8:
+      return 1;
+    case HCCL_DATA_TYPE_INT16:
+    case HCCL_DATA_TYPE_FP16:
+      return 2;
+    case HCCL_DATA_TYPE_INT32:
+    case HCCL_DATA_TYPE_FP32:
+      return 4;
+    case HCCL_DATA_TYPE_INT64:
+    case HCCL_DATA_TYPE_UINT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+HcclResult CopyOnStream(void *dst,
+                        const void *src,
+                        uint64_t count,
+                        HcclDataType type,
+                        HcclComm comm,
+                        aclrtStream stream) {
+  if (!comm) return HCCL_E_PTR;
+  const size_t bytes = count * HcclDataTypeSize(type);
+  if (bytes == 0 || dst == src) return HCCL_SUCCESS;
+  return aclrtMemcpyAsync(
+             dst, bytes, src, bytes, ACL_MEMCPY_DEVICE_TO_DEVICE, stream) ==
+                 ACL_SUCCESS
+             ? HCCL_SUCCESS
+             : HCCL_E_RUNTIME;
+}
+
+}  // namespace
+
+extern "C" {
+
+HcclResult HcclGetRootInfo(HcclRootInfo *rootInfo) {
+  if (!rootInfo) return HCCL_E_PTR;
+  memset(rootInfo->internal, 0, HCCL_ROOT_INFO_BYTES);
+  return HCCL_SUCCESS;
+}
+
+HcclResult HcclCommInitRootInfo(uint32_t nRanks,
+                                const HcclRootInfo *rootInfo,
+                                uint32_t rank,
+                                HcclComm *comm) {
+  if (nRanks != 1 || rank != 0) return HCCL_E_NOT_SUPPORT;
+  *comm = new Comm{rank};
+  return HCCL_SUCCESS;
+}
+
+HcclResult HcclCommDestroy(HcclComm comm) {
+  delete static_cast<Comm *>(comm);
+  return HCCL_SUCCESS;
+}
+
+HcclResult HcclAllReduce(void *sendBuf,
+                         void *recvBuf,
+                         uint64_t count,
+                         HcclDataType dataType,
+                         HcclReduceOp op,
+                         HcclComm comm,
+                         aclrtStream stream) {
+  return CopyOnStream(recvBuf, sendBuf, count, dataType, comm, stream);
+}
+
+HcclResult HcclBroadcast(void *buf,
+                         uint64_t count,
+                         HcclDataType dataType,
+                         uint32_t root,
+                         HcclComm comm,
+                         aclrtStream stream) {
+  return root == 0 ? CopyOnStream(buf, buf, count, dataType, comm, stream)
+                   : HCCL_E_PARA;
+}
+
+HcclResult HcclReduceScatter(void *sendBuf,
+                             void *recvBuf,
+                             uint64_t recvCount,
+                             HcclDataType dataType,
+                             HcclReduceOp op,
+                             HcclComm comm,
+                             aclrtStream stream) {
+  return CopyOnStream(recvBuf, sendBuf, recvCount, dataType, comm, stream);
+}
+
+HcclResult HcclAllGather(void *sendBuf,
+                         void *recvBuf,
+                         uint64_t sendCount,
+                         HcclDataType dataType,
+                         HcclComm comm,
+                         aclrtStream stream) {
+  return CopyOnStream(recvBuf, sendBuf, sendCount, dataType, comm, stream);
+}
+
+// Point-to-point needs a peer, which a single rank does not have.
+HcclResult HcclSend(void *sendBuf,
+                    uint64_t count,
+                    HcclDataType dataType,
+                    uint32_t destRank,
+                    HcclComm comm,
+                    aclrtStream stream) {
+  return HCCL_E_NOT_SUPPORT;
+}
+
+HcclResult HcclRecv(void *recvBuf,
+                    uint64_t count,
+                    HcclDataType dataType,
+                    uint32_t srcRank,
+                    HcclComm comm,
+                    aclrtStream stream) {
+  return HCCL_E_NOT_SUPPORT;
+}
+
+}  // extern "C"
@@ -0,0 +1,38 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "acl/acl_base.h"
+#include "acl/acl_op.h"
+#include "acl/acl_rt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+aclError aclInit(const char *configPath);
+aclError aclFinalize();
+
+// Stub-only introspection, used by tools/benchmark to check that a kernel
+// really reached the device layer and how many launches it issued, and by
+// the runtime tests to tell direct peer copies from host bounces.
+uint64_t aclStubLaunchCount();
+uint64_t aclStubMemcpyCount(aclrtMemcpyKind kind);
+void aclStubReset();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "acl/acl_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct aclopAttr aclopAttr;
+
+aclopAttr *aclopCreateAttr();
+void aclopDestroyAttr(const aclopAttr *attr);
+aclError aclopSetAttrBool(aclopAttr *attr,
+                          const char *attrName,
+                          uint8_t attrValue);
+aclError aclopSetAttrInt(aclopAttr *attr,
+                         const char *attrName,
+                         int64_t attrValue);
+aclError aclopSetAttrFloat(aclopAttr *attr,
+                           const char *attrName,
+                           float attrValue);
+aclError aclopSetAttrString(aclopAttr *attr,
+                            const char *attrName,
+                            const char *attrValue);
+aclError aclopSetAttrDataType(aclopAttr *attr,
+                              const char *attrName,
+                              aclDataType attrValue);
+aclError aclopSetAttrListBool(aclopAttr *attr,
+                              const char *attrName,
+                              int numValues,
+                              const uint8_t *values);
+aclError aclopSetAttrListInt(aclopAttr *attr,
+                             const char *attrName,
+                             int numValues,
+                             const int64_t *values);
+aclError aclopSetAttrListFloat(aclopAttr *attr,
+                               const char *attrName,
+                               int numValues,
+                               const float *values);
+aclError aclopSetAttrListString(aclopAttr *attr,
+                                const char *attrName,
+                                int numValues,
+                                const char **values);
+aclError aclopSetAttrListListInt(aclopAttr *attr,
+                                 const char *attrName,
+                                 int numLists,
+                                 const int *numValues,
+                                 const int64_t *const values[]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "acl/acl_rt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACL_PROF_ACL_API 0x0001
+#define ACL_PROF_TASK_TIME 0x0002
+#define ACL_PROF_AICORE_METRICS 0x0004
+#define ACL_PROF_AICPU 0x0008
+#define ACL_PROF_HCCL_TRACE 0x0020
+#define ACL_PROF_RUNTIME_API 0x0100
+
+typedef enum {
+  ACL_AICORE_ARITHMETIC_UTILIZATION = 0,
+  ACL_AICORE_PIPE_UTILIZATION = 1,
+  ACL_AICORE_MEMORY_BANDWIDTH = 2,
+  ACL_AICORE_L0B_AND_WIDTH = 3,
+  ACL_AICORE_RESOURCE_CONFLICT_RATIO = 4,
+  ACL_AICORE_NONE = 0xFF,
+} aclprofAicoreMetrics;
+
+typedef enum {
+  ACL_STEP_START = 0,
+  ACL_STEP_END = 1,
+} aclprofStepTag;
+
+typedef struct aclprofAicoreEvents aclprofAicoreEvents;
+typedef struct aclprofConfig aclprofConfig;
+typedef struct aclprofStepInfo aclprofStepInfo;
+
+aclError aclprofInit(const char *profilerResultPath, size_t length);
+aclError aclprofFinalize();
+aclprofConfig *aclprofCreateConfig(uint32_t *deviceIdList,
+                                   uint32_t deviceNums,
+                                   aclprofAicoreMetrics aicoreMetrics,
+                                   aclprofAicoreEvents *aicoreEvents,
+                                   uint64_t dataTypeConfig);
+aclError aclprofDestroyConfig(const aclprofConfig *profilerConfig);
+aclError aclprofStart(const aclprofConfig *profilerConfig);
+aclError aclprofStop(const aclprofConfig *profilerConfig);
+aclprofStepInfo *aclprofCreateStepInfo();
+void aclprofDestroyStepInfo(aclprofStepInfo *stepinfo);
+aclError aclprofGetStepTimestamp(aclprofStepInfo *stepInfo,
+                                 aclprofStepTag tag,
+                                 aclrtStream stream);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,74 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "acl/acl_rt.h"
+#include "hccl/hccl_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The stub only emulates single-rank communicators, on which every
+// collective degenerates to a copy from the send to the receive buffer.
+HcclResult HcclGetRootInfo(HcclRootInfo *rootInfo);
+HcclResult HcclCommInitRootInfo(uint32_t nRanks,
+                                const HcclRootInfo *rootInfo,
+                                uint32_t rank,
+                                HcclComm *comm);
+HcclResult HcclCommDestroy(HcclComm comm);
+HcclResult HcclAllReduce(void *sendBuf,
+                         void *recvBuf,
+                         uint64_t count,
+                         HcclDataType dataType,
+                         HcclReduceOp op,
+                         HcclComm comm,
+                         aclrtStream stream);
+HcclResult HcclBroadcast(void *buf,
+                         uint64_t count,
+                         HcclDataType dataType,
+                         uint32_t root,
+                         HcclComm comm,
+                         aclrtStream stream);
+HcclResult HcclReduceScatter(void *sendBuf,
+                             void *recvBuf,
+                             uint64_t recvCount,
+                             HcclDataType dataType,
+                             HcclReduceOp op,
+                             HcclComm comm,
+                             aclrtStream stream);
+HcclResult HcclAllGather(void *sendBuf,
+                         void *recvBuf,
+                         uint64_t sendCount,
+                         HcclDataType dataType,
+                         HcclComm comm,
+                         aclrtStream stream);
+HcclResult HcclSend(void *sendBuf,
+                    uint64_t count,
+                    HcclDataType dataType,
+                    uint32_t destRank,
+                    HcclComm comm,
+                    aclrtStream stream);
+HcclResult HcclRecv(void *recvBuf,
+                    uint64_t count,
+                    HcclDataType dataType,
+                    uint32_t srcRank,
+                    HcclComm comm,
+                    aclrtStream stream);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,187 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Measures the host-side cost of every NPU kernel registered by the plugin.
+
+Meant to run against a plugin built with -DWITH_ACL_STUB=ON (see
+tools/acl_stub/README.md): device work is not executed there, so the time
+per run is the framework plus plugin overhead of launching the op, which is
+what dominates small-op models on real hardware.
+
+Each op is built from its OpProto with random inputs of a fixed small shape
+and default attributes, run `--warmup` times and then timed over `--iters`
+runs. The cost of an empty feed/fetch program is reported as the baseline
+and subtracted. Ops whose inputs cannot be synthesized this way are listed
+as failed together with the error, they are not silently dropped.
+
+    python tools/benchmark/host_overhead.py --ops relu,matmul_v2 --iters 500
+"""
+
+from __future__ import print_function
+
+import argparse
+import csv
+import ctypes
+import os
+import sys
+import time
+
+import numpy as np
+import paddle
+from paddle.fluid import core
+from paddle.fluid import framework
+
+paddle.enable_static()
+
+# Inputs that are indices or shapes rather than data.
+INT_INPUT_HINTS = ('ids', 'index', 'indices', 'label', 'shape', 'axis')
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--ops', default='', help='comma separated op types')
+    parser.add_argument('--shape', default='4,16', help='input shape')
+    parser.add_argument('--dtype', default='float32')
+    parser.add_argument('--warmup', type=int, default=20)
+    parser.add_argument('--iters', type=int, default=200)
+    parser.add_argument('--output', default='', help='csv report path')
+    return parser.parse_args()
+
+
+def load_stub():
+    path = os.environ.get('ACL_STUB_LIB')
+    if not path:
+        return None
+    lib = ctypes.CDLL(path)
+    lib.aclStubLaunchCount.restype = ctypes.c_uint64
+    return lib
+
+
+def registered_npu_ops():
+    kernels = core._get_all_register_op_kernels('all')
+    return sorted(op for op, keys in kernels.items()
+                  if any('npu' in str(key).lower() for key in keys))
+
+
+def var_name(name, i):
+    return '{}_{}'.format(name.replace('@', '_').lower(), i)
+
+
+def input_array(name, shape, dtype):
+    if any(hint in name.lower() for hint in INT_INPUT_HINTS):
+        return np.zeros(shape, dtype='int64')
+    return np.random.uniform(0.1, 1.0, shape).astype(dtype)
+
+
+def build_program(op_type, shape, dtype):
+    proto = framework.OpProtoHolder.instance().get_op_proto(op_type)
+    main = paddle.static.Program()
+    startup = paddle.static.Program()
+    feed = {}
+    with paddle.static.program_guard(main, startup):
+        block = main.global_block()
+        inputs = {}
+        for ipt in proto.inputs:
+            if ipt.dispensable:
+                continue
+            slots = []
+            for i in range(2 if ipt.duplicable else 1):
+                name = var_name(ipt.name, i)
+                feed[name] = input_array(ipt.name, shape, dtype)
+                slots.append(
+                    paddle.static.data(name, shape, str(feed[name].dtype)))
+            inputs[ipt.name] = slots
+        outputs = {}
+        for opt in proto.outputs:
+            outputs[opt.name] = [
+                block.create_var(name=var_name('out_' + opt.name, i))
+                for i in range(2 if opt.duplicable else 1)
+            ]
+        block.append_op(type=op_type, inputs=inputs, outputs=outputs)
+    fetch = [outputs[proto.outputs[0].name][0]] if proto.outputs else []
+    return main, startup, feed, fetch
+
+
+def time_program(exe, program, feed, fetch, warmup, iters, stub):
+    for _ in range(warmup):
+        exe.run(program, feed=feed, fetch_list=fetch)
+    if stub:
+        stub.aclStubReset()
+    start = time.perf_counter()
+    for _ in range(iters):
+        exe.run(program, feed=feed, fetch_list=fetch)
+    elapsed = (time.perf_counter() - start) / iters
+    launches = stub.aclStubLaunchCount() / float(iters) if stub else None
+    return elapsed * 1e6, launches
+
+
+def baseline(exe, shape, dtype, warmup, iters):
+    main = paddle.static.Program()
+    with paddle.static.program_guard(main, paddle.static.Program()):
+        x = paddle.static.data('x', shape, dtype)
+    feed = {'x': np.ones(shape, dtype)}
+    return time_program(exe, main, feed, [x], warmup, iters, None)[0]
+
+
+def main():
+    args = parse_args()
+    shape = [int(s) for s in args.shape.split(',')]
+    place = paddle.CustomPlace('npu', 0)
+    exe = paddle.static.Executor(place)
+    stub = load_stub()
+    if stub is None:
+        print('ACL_STUB_LIB is not set, launch counts are not reported.',
+              file=sys.stderr)
+
+    ops = args.ops.split(',') if args.ops else registered_npu_ops()
+    base_us = baseline(exe, shape, args.dtype, args.warmup, args.iters)
+    print('baseline (feed + fetch only): {:.1f} us'.format(base_us))
+
+    rows = []
+    for op_type in ops:
+        try:
+            program, startup, feed, fetch = build_program(op_type, shape,
+                                                          args.dtype)
+            exe.run(startup)
+            host_us, launches = time_program(exe, program, feed, fetch,
+                                             args.warmup, args.iters, stub)
+            rows.append([
+                op_type, 'ok', '{:.1f}'.format(host_us),
+                '{:.1f}'.format(host_us - base_us),
+                '' if launches is None else '{:.1f}'.format(launches), ''
+            ])
+        except Exception as e:  # pylint: disable=broad-except
+            reason = str(e).strip().splitlines()
+            rows.append([
+                op_type, 'failed', '', '', '', reason[-1] if reason else ''
+            ])
+
+    header = ['op', 'status', 'host_us', 'net_us', 'launches', 'error']
+    measured = sorted((r for r in rows if r[1] == 'ok'),
+                      key=lambda r: -float(r[3]))
+    print('{:<40}{:>12}{:>12}{:>10}'.format('op', 'host_us', 'net_us',
+                                            'launches'))
+    for r in measured:
+        print('{:<40}{:>12}{:>12}{:>10}'.format(r[0], r[2], r[3], r[4]))
+    print('{} ops measured, {} failed'.format(
+        len(measured), len(rows) - len(measured)))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            writer = csv.writer(f)
+            writer.writerow(header)
+            writer.writerows(measured + [r for r in rows if r[1] != 'ok'])
+
+
+if __name__ == '__main__':
+    main()
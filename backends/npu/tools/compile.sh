@@ -40,6 +40,7 @@ Configuring cmake in build ...
     -DWITH_MKLDNN=${WITH_MKLDNN}
     -DWITH_ARM=${WITH_ARM}
     -DON_INFER=${ON_INFER:-OFF}
+    -DWITH_ACL_STUB=${WITH_ACL_STUB:-OFF}
 ========================================
 EOF
 
@@ -51,6 +52,7 @@ cmake .. \
     -DWITH_MKLDNN=${WITH_MKLDNN:-ON} \
     -DWITH_ARM=${WITH_ARM:-OFF} \
     -DON_INFER=${ON_INFER:-OFF} \
+    -DWITH_ACL_STUB=${WITH_ACL_STUB:-OFF} \
     -DCMAKE_EXPORT_COMPILE_COMMANDS=ON;cmake_error=$?
 
 if [ "$cmake_error" != 0 ];then